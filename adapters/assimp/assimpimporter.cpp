@@ -24,6 +24,7 @@
 
 #include "xng/assets/assetscene.hpp"
 #include "xng/assets/mesh.hpp"
+#include "xng/assets/meshoptimizer.hpp"
 #include "xng/assets/material.hpp"
 #include "xng/assets/nodeanimation.hpp"
 
@@ -32,6 +33,7 @@
 #include "xng/math/transform.hpp"
 
 #include "xng/resource/importers/stbiimporter.hpp"
+#include "xng/io/readfile.hpp"
 
 namespace xng::assimp {
     static Mat4f convertMat4(const aiMatrix4x4 &mat) {
@@ -272,9 +274,7 @@ namespace xng::assimp {
 
     static ImageRGBA convertImage(const aiTexture &texture) {
         if (texture.mHeight == 0) {
-            const std::vector buffer(reinterpret_cast<const char *>(texture.pcData),
-                               reinterpret_cast<const char *>(texture.pcData) + texture.mWidth);
-            return StbiImporter::readImageRGBA(buffer);
+            return StbiImporter::readImageRGBA(reinterpret_cast<const char *>(texture.pcData), texture.mWidth);
         }
 
         std::vector<ColorRGBA> pixels;
@@ -331,10 +331,11 @@ namespace xng::assimp {
         return ret;
     }
 
-    static ResourceBundle readAsset(const std::vector<char> &assetBuffer,
+    static ResourceBundle readAsset(std::string_view assetBuffer,
                                     const std::string &hint,
                                     const Uri &path,
-                                    Archive *archive) {
+                                    Archive *archive,
+                                    const bool optimizeMeshes) {
         // TODO: Implement assimp IOSystem pointing to archive
         // Asset exporters store the coordinate system conversions inside the node transforms. https://github.com/assimp/assimp/issues/849#issuecomment-875475292
 
@@ -382,7 +383,10 @@ namespace xng::assimp {
         for (auto i = 0; i < scene.mNumMeshes; i++) {
             const auto &assMesh = *scene.mMeshes[i];
             auto mesh = convertMesh(assMesh);
-            ret.add(std::string(assMesh.mName.C_Str()), std::make_unique<Mesh>(mesh));
+            if (optimizeMeshes) {
+                mesh = MeshOptimizer::optimize(mesh);
+            }
+            ret.add(std::string(assMesh.mName.C_Str()), std::make_unique<Mesh>(std::move(mesh)));
         }
 
         auto boneOffsets = collectBoneOffsets(scene);
@@ -418,17 +422,10 @@ namespace xng::assimp {
     ResourceBundle ResourceImporter::read(std::istream &stream,
                                           const Uri &path,
                                           Archive *archive) {
-        std::vector<char> buffer;
-
-        char c;
-        while (!stream.eof()) {
-            stream.read(&c, 1);
-            if (stream.gcount() == 1) {
-                buffer.emplace_back(c);
-            }
-        }
+        std::vector<char> storage;
+        auto buffer = readStreamView(stream, storage);
 
-        return readAsset(buffer, path.getExtension(), path, archive);
+        return readAsset(buffer, path.getExtension(), path, archive, optimizeMeshes);
     }
 
     const std::set<std::string> &ResourceImporter::getSupportedFormats() const {
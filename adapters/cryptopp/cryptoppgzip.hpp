@@ -21,13 +21,52 @@
 
 #include "xng/crypto/gzip.hpp"
 
+#include <memory>
+
 #include "cryptopp/filters.h"
 #include "cryptopp/gzip.h"
 #include "cryptopp/cryptlib.h"
 
 namespace xng {
+    class CryptoPPGzipTransform : public GZip::Transform {
+    public:
+        explicit CryptoPPGzipTransform(bool compress) {
+            if (compress)
+                filter = std::make_unique<CryptoPP::Gzip>(new CryptoPP::StringSink(buffer));
+            else
+                filter = std::make_unique<CryptoPP::Gunzip>(new CryptoPP::StringSink(buffer));
+        }
+
+        void update(const char *data, size_t length, std::vector<char> &output) override {
+            filter->Put((const CryptoPP::byte *) data, length);
+            drain(output);
+        }
+
+        void finish(std::vector<char> &output) override {
+            filter->MessageEnd();
+            drain(output);
+        }
+
+    private:
+        void drain(std::vector<char> &output) {
+            output.insert(output.end(), buffer.begin(), buffer.end());
+            buffer.clear();
+        }
+
+        std::string buffer; // Written by the sink attached to filter, must outlive filter
+        std::unique_ptr<CryptoPP::BufferedTransformation> filter;
+    };
+
     class CryptoPPGzip : public GZip {
     public:
+        std::unique_ptr<Transform> createCompressor() override {
+            return std::make_unique<CryptoPPGzipTransform>(true);
+        }
+
+        std::unique_ptr<Transform> createDecompressor() override {
+            return std::make_unique<CryptoPPGzipTransform>(false);
+        }
+
         std::vector<char> compress(const char *data, size_t length)override {
             std::string compressed;
             CryptoPP::Gzip zipper(new CryptoPP::StringSink(compressed));
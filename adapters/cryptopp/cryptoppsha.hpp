@@ -21,24 +21,48 @@
 
 #include "xng/crypto/sha.hpp"
 
+#include <memory>
+
 #include "cryptopp/filters.h"
 #include "cryptopp/cryptlib.h"
 #include "cryptopp/sha.h"
 #include "cryptopp/hex.h"
 
 namespace xng {
+    inline std::string encodeSha256(CryptoPP::SHA256 &hash) {
+        std::string tmp;
+        std::string ret;
+        CryptoPP::HexEncoder encoder(new CryptoPP::StringSink(ret));
+        tmp.resize(hash.DigestSize());
+        hash.Final((CryptoPP::byte *) &tmp[0]);
+        CryptoPP::StringSource(tmp, true, new CryptoPP::Redirector(encoder));
+        return ret;
+    }
+
+    class CryptoPPSHAHasher : public SHA::Hasher {
+    public:
+        void update(const char *data, size_t length) override {
+            hash.Update((const CryptoPP::byte *) data, length);
+        }
+
+        std::string finish() override {
+            return encodeSha256(hash);
+        }
+
+    private:
+        CryptoPP::SHA256 hash;
+    };
+
     class CryptoPPSHA : public SHA {
     public:
+        std::unique_ptr<Hasher> createSha256() override {
+            return std::make_unique<CryptoPPSHAHasher>();
+        }
+
         std::string sha256(const char *data, size_t length) override {
-            std::string tmp;
-            std::string ret;
             CryptoPP::SHA256 hash;
-            CryptoPP::HexEncoder encoder(new CryptoPP::StringSink(ret));
             hash.Update((const CryptoPP::byte *) data, length);
-            tmp.resize(hash.DigestSize());
-            hash.Final((CryptoPP::byte *) &tmp[0]);
-            CryptoPP::StringSource(tmp, true, new CryptoPP::Redirector(encoder));
-            return ret;
+            return encodeSha256(hash);
         }
 
         std::string sha256(const std::string &data) override {
@@ -42,6 +42,12 @@ namespace xng::opengl {
                                                *resources.buffers.at(target.getHandle()));
     }
 
+    std::unique_ptr<HeapMapping> HeapGL::mapUnsynchronized(const HeapResource<Buffer> &target) {
+        return std::make_unique<HeapMappingGL>(target,
+                                               *resources.buffers.at(target.getHandle()),
+                                               true);
+    }
+
     size_t HeapGL::getMemoryUsage() {
         size_t total = 0;
         for (const auto &buf: resources.buffers) {
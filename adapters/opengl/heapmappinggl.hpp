@@ -28,9 +28,10 @@ namespace xng::opengl {
     class HeapMappingGL final : public HeapMapping {
     public:
         HeapMappingGL(const rg::HeapResource<rg::Buffer> &resourceHandle,
-                      BufferGL &buffer)
+                      BufferGL &buffer,
+                      const bool unsynchronized = false)
             : resourceHandle(resourceHandle), buffer(buffer) {
-            ptr = buffer.map();
+            ptr = buffer.map(unsynchronized);
         }
 
         ~HeapMappingGL() override {
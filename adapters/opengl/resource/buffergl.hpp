@@ -89,7 +89,10 @@ namespace xng::opengl {
 
         BufferGL &operator=(BufferGL &&) = delete;
 
-        [[nodiscard]] uint8_t *map() const {
+        /**
+         * @param unsynchronized If true the driver does not wait for pending commands which use the buffer.
+         */
+        [[nodiscard]] uint8_t *map(const bool unsynchronized = false) const {
             OGLDebugGroup debug("BufferGL::map");
 
             glBindBuffer(target, handle);
@@ -99,6 +102,9 @@ namespace xng::opengl {
                 access |= GL_MAP_READ_BIT;
             } else if (desc.memoryType == Buffer::MEMORY_CPU_TO_GPU) {
                 access |= GL_MAP_WRITE_BIT | GL_MAP_FLUSH_EXPLICIT_BIT ;
+                if (unsynchronized) {
+                    access |= GL_MAP_UNSYNCHRONIZED_BIT;
+                }
             } else {
                 throw std::runtime_error("Cannot map GPU_ONLY buffer");
             }
@@ -19,17 +19,19 @@
 #include <vector>
 #include <cstring>
 #include <string>
+#include <string_view>
 
 #include "xng/adapters/sndfile/sndfile.hpp"
 
 #include "xng/audio/audioformat.hpp"
 #include "xng/assets/audiodata.hpp"
+#include "xng/io/readfile.hpp"
 
 #include <sndfile.h>
 
 namespace xng::sndfile {
     struct LibSndBuffer {
-        std::vector<char> data;
+        std::string_view data;
         size_t pos;
     };
 
@@ -58,12 +60,12 @@ namespace xng::sndfile {
 
     sf_count_t sf_vio_read(void *ptr, sf_count_t count, void *user_data) {
         auto *buffer = reinterpret_cast<LibSndBuffer *>(user_data);
-        sf_count_t ret;
-        for (ret = 0; ret < count && buffer->pos + ret < buffer->data.size(); ret++) {
-            static_cast<char *>(ptr)[ret] = buffer->data.at(buffer->pos + ret);
-        }
+        if (buffer->pos >= buffer->data.size())
+            return 0;
+        auto ret = std::min(static_cast<size_t>(count), buffer->data.size() - buffer->pos);
+        std::memcpy(ptr, buffer->data.data() + buffer->pos, ret);
         buffer->pos += ret;
-        return ret;
+        return static_cast<sf_count_t>(ret);
     }
 
     sf_count_t sf_vio_write(const void *ptr, sf_count_t count, void *user_data) {
@@ -75,7 +77,7 @@ namespace xng::sndfile {
         return buffer->pos;
     }
 
-    static AudioData readAudio(const std::vector<char> &buf) {
+    static AudioData readAudio(std::string_view buf) {
         SF_VIRTUAL_IO virtio;
         virtio.get_filelen = &sf_vio_get_filelen;
         virtio.seek = &sf_vio_seek;
@@ -145,15 +147,8 @@ namespace xng::sndfile {
     ResourceBundle ResourceImporter::read(std::istream &stream,
                                  const Uri &path,
                                  Archive *archive) {
-        std::vector<char> buffer;
-
-        char c;
-        while (!stream.eof()) {
-            stream.read(&c, 1);
-            if (stream.gcount() == 1) {
-                buffer.emplace_back(c);
-            }
-        }
+        std::vector<char> storage;
+        auto buffer = readStreamView(stream, storage);
 
         ResourceBundle ret;
         ret.add("", std::make_unique<AudioData>(readAudio(buffer)));
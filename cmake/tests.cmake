@@ -9,9 +9,59 @@ add_executable(benchmark-renderer ${BASE_SOURCE_DIR}/tests/benchmark-renderer/sr
 target_include_directories(benchmark-renderer PRIVATE ${CMAKE_CURRENT_SOURCE_DIR}/tests/benchmark-renderer/src/ ${TESTS_COMMON_DIR})
 target_link_libraries(benchmark-renderer Threads::Threads xengine)
 
+add_executable(benchmark-ecs ${BASE_SOURCE_DIR}/tests/benchmark-ecs/src/main.cpp)
+target_include_directories(benchmark-ecs PRIVATE ${CMAKE_CURRENT_SOURCE_DIR}/tests/benchmark-ecs/src/ ${TESTS_COMMON_DIR})
+target_link_libraries(benchmark-ecs Threads::Threads xengine)
+
+add_executable(benchmark-async ${BASE_SOURCE_DIR}/tests/benchmark-async/src/main.cpp)
+target_include_directories(benchmark-async PRIVATE ${CMAKE_CURRENT_SOURCE_DIR}/tests/benchmark-async/src/ ${TESTS_COMMON_DIR})
+target_link_libraries(benchmark-async Threads::Threads xengine)
+
+add_executable(benchmark-crypto ${BASE_SOURCE_DIR}/tests/benchmark-crypto/src/main.cpp)
+target_include_directories(benchmark-crypto PRIVATE ${CMAKE_CURRENT_SOURCE_DIR}/tests/benchmark-crypto/src/ ${TESTS_COMMON_DIR})
+target_link_libraries(benchmark-crypto Threads::Threads xengine)
+
+add_executable(benchmark-resource ${BASE_SOURCE_DIR}/tests/benchmark-resource/src/main.cpp)
+target_include_directories(benchmark-resource PRIVATE ${CMAKE_CURRENT_SOURCE_DIR}/tests/benchmark-resource/src/ ${TESTS_COMMON_DIR})
+target_link_libraries(benchmark-resource Threads::Threads xengine)
+
+add_executable(benchmark-mesh ${BASE_SOURCE_DIR}/tests/benchmark-mesh/src/main.cpp)
+target_include_directories(benchmark-mesh PRIVATE ${CMAKE_CURRENT_SOURCE_DIR}/tests/benchmark-mesh/src/ ${TESTS_COMMON_DIR})
+target_link_libraries(benchmark-mesh Threads::Threads xengine)
+
+add_executable(benchmark-culling ${BASE_SOURCE_DIR}/tests/benchmark-culling/src/main.cpp)
+target_include_directories(benchmark-culling PRIVATE ${CMAKE_CURRENT_SOURCE_DIR}/tests/benchmark-culling/src/ ${TESTS_COMMON_DIR})
+target_link_libraries(benchmark-culling Threads::Threads xengine)
+
+add_executable(benchmark-lights ${BASE_SOURCE_DIR}/tests/benchmark-lights/src/main.cpp)
+target_include_directories(benchmark-lights PRIVATE ${CMAKE_CURRENT_SOURCE_DIR}/tests/benchmark-lights/src/ ${TESTS_COMMON_DIR})
+target_link_libraries(benchmark-lights Threads::Threads xengine)
+
+add_executable(benchmark-frames ${BASE_SOURCE_DIR}/tests/benchmark-frames/src/main.cpp)
+target_include_directories(benchmark-frames PRIVATE ${CMAKE_CURRENT_SOURCE_DIR}/tests/benchmark-frames/src/ ${TESTS_COMMON_DIR})
+target_link_libraries(benchmark-frames Threads::Threads xengine)
+
+add_executable(benchmark-streaming ${BASE_SOURCE_DIR}/tests/benchmark-streaming/src/main.cpp)
+target_include_directories(benchmark-streaming PRIVATE ${CMAKE_CURRENT_SOURCE_DIR}/tests/benchmark-streaming/src/ ${TESTS_COMMON_DIR})
+target_link_libraries(benchmark-streaming Threads::Threads xengine)
+
+add_executable(benchmark-compaction ${BASE_SOURCE_DIR}/tests/benchmark-compaction/src/main.cpp)
+target_include_directories(benchmark-compaction PRIVATE ${CMAKE_CURRENT_SOURCE_DIR}/tests/benchmark-compaction/src/ ${TESTS_COMMON_DIR})
+target_link_libraries(benchmark-compaction Threads::Threads xengine)
+
 if (MSVC)
     target_compile_options(test-pak PUBLIC /bigobj)
     target_compile_options(benchmark-renderer PUBLIC /bigobj)
+    target_compile_options(benchmark-ecs PUBLIC /bigobj)
+    target_compile_options(benchmark-async PUBLIC /bigobj)
+    target_compile_options(benchmark-crypto PUBLIC /bigobj)
+    target_compile_options(benchmark-resource PUBLIC /bigobj)
+    target_compile_options(benchmark-mesh PUBLIC /bigobj)
+    target_compile_options(benchmark-culling PUBLIC /bigobj)
+    target_compile_options(benchmark-lights PUBLIC /bigobj)
+    target_compile_options(benchmark-frames PUBLIC /bigobj)
+    target_compile_options(benchmark-streaming PUBLIC /bigobj)
+    target_compile_options(benchmark-compaction PUBLIC /bigobj)
 endif ()
 
 file(GLOB RESULT ${TESTS_ASSET_DIR}/*)
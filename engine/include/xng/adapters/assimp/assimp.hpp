@@ -24,6 +24,14 @@
 namespace xng::assimp {
     class XENGINE_EXPORT ResourceImporter final : public xng::ResourceImporter {
     public:
+        /**
+         * @param optimizeMeshes If true the imported meshes are reordered with MeshOptimizer::optimize,
+         * disable for assets which are already optimized offline or to preserve the vertex order of the source file.
+         */
+        explicit ResourceImporter(const bool optimizeMeshes = true)
+            : optimizeMeshes(optimizeMeshes) {
+        }
+
         ~ResourceImporter() override = default;
 
         ResourceBundle read(std::istream &stream,
@@ -31,6 +39,9 @@ namespace xng::assimp {
                             Archive *archive) override;
 
         const std::set<std::string> &getSupportedFormats() const override;
+
+    private:
+        bool optimizeMeshes;
     };
 }
 
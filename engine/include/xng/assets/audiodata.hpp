@@ -35,6 +35,10 @@ namespace xng {
             return std::make_unique<AudioData>(*this);
         }
 
+        size_t getSize() const override {
+            return buffer.size();
+        }
+
         std::vector<uint8_t> buffer;
         AudioFormat format;
         unsigned int frequency;
@@ -37,6 +37,10 @@ namespace xng {
         std::unique_ptr<ResourceBase> clone() override {
             return std::make_unique<Font>(*this);
         }
+
+        size_t getSize() const override {
+            return data.size();
+        }
     };
 }
 
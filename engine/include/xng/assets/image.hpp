@@ -107,6 +107,8 @@ namespace xng {
 
         bool empty() const { return buffer.empty(); }
 
+        size_t getSize() const override { return buffer.size() * sizeof(T); }
+
         const T &getPixel(const unsigned int x, const unsigned int y) const {
             return buffer[scanLine(y) + x];
         }
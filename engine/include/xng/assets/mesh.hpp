@@ -19,6 +19,7 @@
 #ifndef XENGINE_MESH_HPP
 #define XENGINE_MESH_HPP
 
+#include <cstdint>
 #include <utility>
 #include <vector>
 
@@ -26,6 +27,8 @@
 
 #include "xng/assets/material.hpp"
 
+#include "xng/math/pi.hpp"
+
 #include "xng/rendergraph/shader/shaderattributelayout.hpp"
 
 namespace xng {
@@ -66,12 +69,21 @@ namespace xng {
         static Mesh sphere(float radius, int latitudes, int longitudes);
 
         /**
-         * Compute smoothed normals + tangents + bitangents for the given mesh.
+         * Compute smoothed normals + tangents + bitangents for the given triangle mesh.
+         *
+         * Positions within weldEpsilon of each other are welded so normals are smoothed across split vertices (Eg. uv seams).
+         * Face normals are weighted by the angle of the face at the vertex.
+         * Faces whose normals differ by more than creaseAngle are not smoothed together,
+         * indexed vertices on such hard edges are duplicated so each side keeps its own normal, which discards the meshlets.
+         *
+         * Tangents are only computed if the mesh has uvs. Large meshes are processed in parallel on the default thread pool.
          *
          * @param mesh
+         * @param weldEpsilon The maximum distance between welded positions, 0 welds only identical positions
+         * @param creaseAngle The maximum angle in radians between smoothed face normals, PI smooths all faces
          * @return
          */
-        static Mesh computeSmoothNormals(const Mesh &mesh);
+        static Mesh computeSmoothNormals(const Mesh &mesh, float weldEpsilon = 0, float creaseAngle = PI);
 
         enum Primitive : int {
             POINTS = 1,
@@ -85,6 +97,36 @@ namespace xng {
             float weight{}; // The weight
         };
 
+        /**
+         * A cluster of up to 256 vertices and their triangles with bounding volumes for culling.
+         * Created by MeshOptimizer::buildMeshlets.
+         */
+        struct Meshlet {
+            unsigned int vertexOffset = 0; // The offset of the first vertex in meshletVertices
+            unsigned int vertexCount = 0;
+            unsigned int triangleOffset = 0; // The offset of the first triangle in meshletTriangles, in triangles
+            unsigned int triangleCount = 0;
+
+            Vec3f center; // The bounding sphere of the meshlet
+            float radius = 0;
+
+            Vec3f coneApex; // The normal cone of the meshlet
+            Vec3f coneAxis;
+            float coneCutoff = 1; // The sine of the cone half angle, 1 if the meshlet cannot be back face culled
+
+            /**
+             * @param cameraPosition The camera position in the space of the mesh
+             * @return True if all triangles of the meshlet face away from the camera
+             */
+            bool isBackFacing(const Vec3f &cameraPosition) const {
+                if (coneCutoff >= 1)
+                    return false;
+                auto direction = coneApex - cameraPosition;
+                auto length = direction.length();
+                return length > 0 && direction.dot(coneAxis) >= coneCutoff * length;
+            }
+        };
+
         struct MorphTarget {
             std::vector<Vec3f> positions;
             std::vector<Vec3f> normals;
@@ -107,6 +149,10 @@ namespace xng {
 
         std::vector<MorphTarget> morphTargets; // The list of morph targets
 
+        std::vector<Meshlet> meshlets; // The meshlets of the mesh, empty if no meshlets were built
+        std::vector<unsigned int> meshletVertices; // The mesh vertex indices referenced by the meshlets
+        std::vector<uint8_t> meshletTriangles; // Three meshlet local vertex indices per triangle
+
         Mesh() = default;
 
         ~Mesh() override = default;
@@ -114,6 +160,26 @@ namespace xng {
         std::unique_ptr<ResourceBase> clone() override {
             return std::make_unique<Mesh>(*this);
         }
+
+        size_t getSize() const override {
+            size_t ret = positions.size() * sizeof(Vec3f)
+                         + normals.size() * sizeof(Vec3f)
+                         + uvs.size() * sizeof(Vec2f)
+                         + tangents.size() * sizeof(Vec3f)
+                         + bitangents.size() * sizeof(Vec3f)
+                         + indices.size() * sizeof(unsigned int);
+            for (auto &pair: boneWeights) {
+                ret += pair.second.size() * sizeof(VertexWeight);
+            }
+            ret += meshlets.size() * sizeof(Meshlet)
+                    + meshletVertices.size() * sizeof(unsigned int)
+                    + meshletTriangles.size();
+            for (auto &target: morphTargets) {
+                ret += (target.positions.size() + target.normals.size() + target.tangents.size() + target.bitangents.size()) * sizeof(Vec3f)
+                        + target.uvs.size() * sizeof(Vec2f);
+            }
+            return ret;
+        }
     };
 }
 
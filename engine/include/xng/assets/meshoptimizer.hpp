@@ -0,0 +1,140 @@
+/**
+ *   xEngine - C++ Game Engine Library
+ *   Copyright (C) 2026 Julia Zampiccoli
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU Lesser General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   Lesser General Public License for more details.
+ *
+ *   You should have received a copy of the Lesser General Public License
+ *   along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef XENGINE_MESHOPTIMIZER_HPP
+#define XENGINE_MESHOPTIMIZER_HPP
+
+#include "xng/assets/mesh.hpp"
+
+namespace xng {
+    /**
+     * Import time optimization of triangle meshes for rendering.
+     *
+     * The optimizations only reorder or merge vertices and triangles, the rendered result is unchanged.
+     * Vertex attributes, bone weights and morph targets are remapped with the vertices,
+     * meshlets are discarded by the functions which reorder vertices and have to be built last.
+     * All functions throw a std::runtime_error if the mesh primitive is not TRIANGLES.
+     */
+    class XENGINE_EXPORT MeshOptimizer {
+    public:
+        static const size_t DEFAULT_CACHE_SIZE = 16; // The post transform cache size simulated by analyzeVertexCache
+
+        static constexpr float DEFAULT_OVERDRAW_THRESHOLD = 1.05f;
+
+        static const size_t DEFAULT_MESHLET_VERTICES = 64;
+        static const size_t DEFAULT_MESHLET_TRIANGLES = 124;
+
+        struct VertexCacheStatistics {
+            size_t triangles = 0;
+            size_t vertices = 0; // The number of unique vertices referenced by the triangles
+            size_t transforms = 0; // The number of vertex shader invocations
+
+            /**
+             * @return The average cache miss ratio, the number of transformed vertices per triangle (0.5 - 3, lower is better)
+             */
+            float getACMR() const {
+                return triangles == 0 ? 0 : static_cast<float>(transforms) / static_cast<float>(triangles);
+            }
+
+            /**
+             * @return The average transform to vertex ratio (1 - 6, lower is better)
+             */
+            float getATVR() const {
+                return vertices == 0 ? 0 : static_cast<float>(transforms) / static_cast<float>(vertices);
+            }
+        };
+
+        /**
+         * Simulate a FIFO post transform vertex cache.
+         *
+         * @param mesh
+         * @param cacheSize The number of cached vertices
+         * @return
+         */
+        static VertexCacheStatistics analyzeVertexCache(const Mesh &mesh, size_t cacheSize = DEFAULT_CACHE_SIZE);
+
+        /**
+         * Merge vertices whose attributes, bone weights and morph targets are identical.
+         * Unindexed meshes are converted to indexed meshes.
+         *
+         * @param mesh
+         * @return
+         */
+        static Mesh removeDuplicateVertices(const Mesh &mesh);
+
+        /**
+         * Reorder the triangles to reduce the number of vertex shader invocations.
+         * Uses the linear speed vertex cache optimization by Tom Forsyth, which is not tuned to a specific cache size.
+         *
+         * @param mesh An indexed mesh
+         * @return
+         */
+        static Mesh optimizeVertexCache(const Mesh &mesh);
+
+        /**
+         * Reorder clusters of triangles so that triangles facing outward of the mesh are drawn first,
+         * which reduces overdraw from most view directions.
+         *
+         * The triangles are split into clusters at the points where the vertex cache restarts in the current order,
+         * so the mesh should be optimized for the vertex cache first.
+         *
+         * @param mesh An indexed mesh
+         * @param threshold The maximum ACMR degradation allowed for smaller clusters, 1 only splits at cache restarts
+         * @return
+         */
+        static Mesh optimizeOverdraw(const Mesh &mesh, float threshold = DEFAULT_OVERDRAW_THRESHOLD);
+
+        /**
+         * Reorder the vertices in the order they are first referenced by the indices to improve the locality of vertex fetches.
+         * Unreferenced vertices are moved to the end.
+         *
+         * @param mesh An indexed mesh
+         * @return
+         */
+        static Mesh optimizeVertexFetch(const Mesh &mesh);
+
+        /**
+         * Split the mesh into meshlets and compute the bounding sphere and normal cone of each meshlet.
+         *
+         * Meshlets are grown from a seed triangle by adding the adjacent triangle which adds the fewest new vertices,
+         * ties are broken by the fewest unused triangles around its vertices and then by the distance to the meshlet.
+         * A meshlet is complete when a limit is reached or no adjacent triangle is left.
+         * Seeds are taken in index order so the mesh should be optimized for the vertex cache first.
+         *
+         * @param mesh An indexed mesh
+         * @param maxVertices The maximum number of vertices per meshlet (3 - 256)
+         * @param maxTriangles The maximum number of triangles per meshlet
+         * @return The mesh with Mesh::meshlets, Mesh::meshletVertices and Mesh::meshletTriangles assigned
+         */
+        static Mesh buildMeshlets(const Mesh &mesh,
+                                  size_t maxVertices = DEFAULT_MESHLET_VERTICES,
+                                  size_t maxTriangles = DEFAULT_MESHLET_TRIANGLES);
+
+        /**
+         * Run the full pipeline: removeDuplicateVertices, optimizeVertexCache, optimizeOverdraw (optional) and optimizeVertexFetch.
+         *
+         * @param mesh
+         * @param overdraw If true the triangle clusters are sorted to reduce overdraw
+         * @return
+         */
+        static Mesh optimize(const Mesh &mesh, bool overdraw = true);
+    };
+}
+
+#endif //XENGINE_MESHOPTIMIZER_HPP
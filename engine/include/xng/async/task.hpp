@@ -23,16 +23,28 @@
 #include <condition_variable>
 #include <mutex>
 #include <atomic>
+#include <memory>
+#include <vector>
 
 namespace xng {
-    class XENGINE_EXPORT Task {
+    /**
+     * A unit of work executed at most once.
+     *
+     * A task completes when its work has been invoked or when it was cancelled before its work was started.
+     * Continuations are invoked on the completing thread after the task has completed.
+     *
+     * Joining a task from a thread pool worker runs other queued tasks of the pool until the task has completed
+     * so that tasks waiting on other tasks cannot exhaust the workers of the pool.
+     */
+    class XENGINE_EXPORT Task : public std::enable_shared_from_this<Task> {
     public:
         Task() : work(),
                  mutex(),
                  workDone(false),
                  workDoneCondition() {};
 
-        Task(const Task &other) : work(other.work),
+        Task(const Task &other) : std::enable_shared_from_this<Task>(),
+                                  work(other.work),
                                   mutex(),
                                   workDone(false),
                                   workDoneCondition() {}
@@ -44,25 +56,77 @@ namespace xng {
 
         Task &operator=(const Task &other);
 
+        /**
+         * Create a task which completes when all the given tasks have completed
+         * or with the exception of the first task that completes with an exception.
+         *
+         * @param tasks
+         * @return
+         */
+        static std::shared_ptr<Task> whenAll(const std::vector<std::shared_ptr<Task>> &tasks);
+
+        /**
+         * Create a task which completes with the exception of the first of the given tasks to complete.
+         *
+         * @param tasks
+         * @return
+         */
+        static std::shared_ptr<Task> whenAny(const std::vector<std::shared_ptr<Task>> &tasks);
+
+        /**
+         * Invoke the work and complete the task, does nothing if the task was already started or cancelled.
+         */
         void execute();
 
         const std::exception_ptr &join();
 
         bool wait(long ms);
 
+        /**
+         * Complete the task without invoking the work if it has not been started yet.
+         * A cancelled task completes with a std::runtime_error.
+         *
+         * @return True if the task was cancelled, false if the work was already started.
+         */
+        bool cancel();
+
+        /**
+         * Invoke callback when the task has completed.
+         * If the task has already completed the callback is invoked immediately on the calling thread.
+         *
+         * @param callback
+         */
+        void addContinuation(std::function<void()> callback);
+
         [[nodiscard]] bool isDone() const { return workDone; }
 
+        [[nodiscard]] bool isCancelled() const { return cancelled; }
+
         /**
          * @return Nullptr if no exception was caught while work was invoked or a copy of an exception caught while work was invoked.
          */
         const std::exception_ptr &getException() { return exception; }
 
     private:
+        friend class ThreadPool;
+
+        /**
+         * Complete the task with the given exception without invoking the work if it has not been started yet.
+         *
+         * @return True if the task was completed by this call
+         */
+        bool complete(const std::exception_ptr &ex);
+
+        void finish(const std::exception_ptr &ex);
+
         std::exception_ptr exception; //If an exception was caught while the work was invoked this stores a pointer to a copy of the exception object.
         std::function<void()> work;
         std::mutex mutex;
         std::atomic<bool> workDone;
         std::condition_variable workDoneCondition;
+        std::atomic<bool> started = false;
+        std::atomic<bool> cancelled = false;
+        std::vector<std::function<void()>> continuations;
     };
 }
 
@@ -21,98 +21,174 @@
 
 #include <memory>
 #include <vector>
+#include <deque>
+#include <array>
 #include <thread>
 #include <functional>
-#include <map>
-#include <cassert>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <iterator>
 #include <stdexcept>
 
 #include "xng/async/task.hpp"
 
 namespace xng {
+    /**
+     * A work stealing thread pool.
+     *
+     * Each worker owns a queue per priority level. Tasks added from a worker thread are pushed to the queue of the worker,
+     * tasks added from other threads are distributed round-robin over the workers.
+     * Workers run the most recently pushed task of their own queue and steal the oldest task from other workers when
+     * their own queue is empty.
+     *
+     * Higher priority tasks always run before lower priority tasks, the execution order within a priority is unspecified.
+     */
     class XENGINE_EXPORT ThreadPool {
     public:
+        enum Priority {
+            PRIORITY_HIGH = 0, // Work that a frame is waiting on
+            PRIORITY_NORMAL,
+            PRIORITY_LOW, // Background work such as streaming
+            PRIORITY_COUNT
+        };
+
         static ThreadPool &getPool();
 
-        explicit ThreadPool(unsigned int numberOfThreads = std::thread::hardware_concurrency()) : mShutdown(false) {
-            assert(numberOfThreads > 0);
-            for (int i = 0; i < numberOfThreads; i++) {
-                threads.emplace_back([this]() { pollTasks(); });
-            }
+        /**
+         * @return The pool of the calling thread if it is a worker thread, otherwise nullptr.
+         */
+        static ThreadPool *getCurrentPool();
+
+        explicit ThreadPool(unsigned int numberOfThreads = std::thread::hardware_concurrency());
+
+        ~ThreadPool();
+
+        ThreadPool(const ThreadPool &other) = delete;
+
+        ThreadPool &operator=(const ThreadPool &other) = delete;
+
+        std::shared_ptr<Task> addTask(const std::function<void()> &work, Priority priority = PRIORITY_NORMAL);
+
+        /**
+         * Add a task which is queued when all predecessors have completed.
+         *
+         * If a predecessor completes with an exception or is cancelled the work is not invoked
+         * and the returned task completes with the exception of the predecessor.
+         *
+         * @param work
+         * @param predecessors
+         * @param priority
+         * @return
+         */
+        std::shared_ptr<Task> addTask(const std::function<void()> &work,
+                                      const std::vector<std::shared_ptr<Task>> &predecessors,
+                                      Priority priority = PRIORITY_NORMAL);
+
+        /**
+         * Add a task which is queued when the given task has completed.
+         */
+        std::shared_ptr<Task> then(const std::shared_ptr<Task> &task,
+                                   const std::function<void()> &work,
+                                   Priority priority = PRIORITY_NORMAL) {
+            return addTask(work, std::vector<std::shared_ptr<Task>>{task}, priority);
         }
 
-        ~ThreadPool() {
-            shutdown();
-            for (auto &thread: threads) {
-                thread.join();
-            }
+        /**
+         * Run the highest priority queued task on the calling thread.
+         *
+         * @return False if no task was queued
+         */
+        bool runPendingTask();
+
+        /**
+         * Invoke func(i) for every i in [begin, end) and return when all invocations have completed.
+         *
+         * The range is split into chunks of grainSize indices which are processed by the workers and the calling thread.
+         * If an invocation throws the remaining chunks are skipped and the first exception is rethrown.
+         *
+         * @param grainSize The number of indices processed by a chunk, 0 to derive the grain size from the number of threads
+         */
+        template<typename F>
+        void parallelFor(size_t begin,
+                         size_t end,
+                         const F &func,
+                         size_t grainSize = 0,
+                         Priority priority = PRIORITY_HIGH) {
+            if (end <= begin)
+                return;
+            runChunked(end - begin,
+                       grainSize,
+                       [begin, &func](size_t chunkBegin, size_t chunkEnd) {
+                           for (auto i = begin + chunkBegin; i < begin + chunkEnd; i++) {
+                               func(i);
+                           }
+                       },
+                       priority);
         }
 
-        std::shared_ptr<Task> addTask(const std::function<void()> &work) {
-            if (mShutdown)
-                throw std::runtime_error("Thread pool was shut down");
-
-            std::shared_ptr<Task> ret;
-            {
-                const std::lock_guard<std::mutex> l(taskMutex);
-                int index;
-                if (unusedTaskIndices.empty()) {
-                    if (taskIndex == std::numeric_limits<int>::max())
-                        throw std::runtime_error("Maximum concurrent tasks reached");
-                    index = taskIndex++;
-                } else {
-                    index = *unusedTaskIndices.begin();
-                    unusedTaskIndices.erase(unusedTaskIndices.begin());
-                }
-                ret = std::make_shared<Task>(work);
-                tasks[index] = ret;
-            }
-
-            taskVar.notify_one();
-
-            return ret;
+        /**
+         * Invoke func(element) for every element in the random access range [begin, end).
+         *
+         * @see parallelFor
+         */
+        template<typename Iterator, typename F>
+        void parallelForEach(Iterator begin,
+                             Iterator end,
+                             const F &func,
+                             size_t grainSize = 0,
+                             Priority priority = PRIORITY_HIGH) {
+            static_assert(std::is_base_of<std::random_access_iterator_tag,
+                                  typename std::iterator_traits<Iterator>::iterator_category>::value,
+                          "parallelForEach requires random access iterators");
+            if (end <= begin)
+                return;
+            runChunked(static_cast<size_t>(end - begin),
+                       grainSize,
+                       [begin, &func](size_t chunkBegin, size_t chunkEnd) {
+                           for (auto it = begin + chunkBegin; it != begin + chunkEnd; it++) {
+                               func(*it);
+                           }
+                       },
+                       priority);
         }
 
-        void shutdown() {
-            mShutdown = true;
-            taskVar.notify_all();
-        }
+        void shutdown();
 
         bool isShutdown() const { return mShutdown; }
 
+        size_t getThreadCount() const { return workers.size(); }
+
     private:
+        struct Worker {
+            std::mutex mutex;
+            std::array<std::deque<std::shared_ptr<Task>>, PRIORITY_COUNT> queues;
+        };
+
+        std::vector<std::unique_ptr<Worker>> workers;
         std::vector<std::thread> threads;
-        std::map<int, std::shared_ptr<Task>> tasks;
 
-        int taskIndex = 0;
-        std::vector<int> unusedTaskIndices;
+        std::atomic<size_t> nextWorker = 0;
+        std::array<std::atomic<size_t>, PRIORITY_COUNT> pendingTasks{};
+
+        std::mutex sleepMutex;
+        std::condition_variable sleepVar;
+        std::atomic<size_t> sleepingWorkers = 0;
 
-        std::mutex taskMutex;
-        std::condition_variable taskVar;
         std::atomic<bool> mShutdown = false;
 
-        void pollTasks() {
-            std::unique_lock<std::mutex> taskLock(taskMutex);
-            while (!mShutdown) {
-                if (!tasks.empty()) {
-                    auto pair = tasks.begin();
-                    int index = pair->first;
-                    std::shared_ptr<Task> task = pair->second;
-
-                    tasks.erase(index);
-                    unusedTaskIndices.emplace_back(index);
-
-                    taskLock.unlock();
-                    task->execute();
-                    taskLock.lock();
-                }
-                taskVar.wait(taskLock, [this] {
-                    if (mShutdown)
-                        return true;
-                    return !tasks.empty();
-                });
-            }
-        }
+        void pushTask(const std::shared_ptr<Task> &task, Priority priority);
+
+        std::shared_ptr<Task> popTask(size_t workerIndex);
+
+        bool hasPendingTasks() const;
+
+        void runChunked(size_t count,
+                        size_t grainSize,
+                        const std::function<void(size_t, size_t)> &func,
+                        Priority priority);
+
+        void pollTasks(size_t workerIndex);
     };
 }
 
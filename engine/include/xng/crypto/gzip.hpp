@@ -21,6 +21,7 @@
 
 #include <string>
 #include <vector>
+#include <memory>
 
 namespace xng {
     /**
@@ -28,6 +29,42 @@ namespace xng {
      */
     class GZip {
     public:
+        /**
+         * Incrementally compresses or decompresses data.
+         */
+        class Transform {
+        public:
+            virtual ~Transform() = default;
+
+            /**
+             * Process the given input.
+             *
+             * @param data The input data
+             * @param length The number of input bytes
+             * @param output The output produced by this call is appended to output
+             */
+            virtual void update(const char *data, size_t length, std::vector<char> &output) = 0;
+
+            /**
+             * Process the end of the input, the transform cannot be updated afterwards.
+             *
+             * @param output The remaining output is appended to output
+             */
+            virtual void finish(std::vector<char> &output) = 0;
+        };
+
+        virtual ~GZip() = default;
+
+        /**
+         * @return A transform which compresses its input into a gzip stream.
+         */
+        virtual std::unique_ptr<Transform> createCompressor() = 0;
+
+        /**
+         * @return A transform which decompresses a gzip stream.
+         */
+        virtual std::unique_ptr<Transform> createDecompressor() = 0;
+
         virtual std::vector<char> compress(const char *data, size_t length) = 0;
 
         virtual std::vector<char> decompress(const char *data, size_t length) = 0;
@@ -0,0 +1,190 @@
+/**
+ *   xEngine - C++ Game Engine Library
+ *   Copyright (C) 2026 Julia Zampiccoli
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU Lesser General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   Lesser General Public License for more details.
+ *
+ *   You should have received a copy of the Lesser General Public License
+ *   along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef XENGINE_GZIPSTREAM_HPP
+#define XENGINE_GZIPSTREAM_HPP
+
+#include <istream>
+#include <ostream>
+#include <streambuf>
+#include <stdexcept>
+
+#include "xng/crypto/gzip.hpp"
+
+namespace xng {
+    /**
+     * A stream buffer which reads from a source stream and returns the output of a transform.
+     */
+    class GZipInputStreamBuf : public std::streambuf {
+    public:
+        GZipInputStreamBuf(std::unique_ptr<GZip::Transform> transform, std::istream &source, size_t bufferSize)
+                : transform(std::move(transform)), source(source), input(bufferSize) {
+            if (bufferSize == 0)
+                throw std::runtime_error("Invalid buffer size");
+        }
+
+    protected:
+        int_type underflow() override {
+            if (gptr() < egptr())
+                return traits_type::to_int_type(*gptr());
+
+            output.clear();
+            while (output.empty() && !finished) {
+                source.read(input.data(), static_cast<std::streamsize>(input.size()));
+                auto count = static_cast<size_t>(source.gcount());
+                if (count > 0) {
+                    transform->update(input.data(), count, output);
+                } else {
+                    transform->finish(output);
+                    finished = true;
+                }
+            }
+
+            if (output.empty())
+                return traits_type::eof();
+
+            setg(output.data(), output.data(), output.data() + output.size());
+            return traits_type::to_int_type(*gptr());
+        }
+
+    private:
+        std::unique_ptr<GZip::Transform> transform;
+        std::istream &source;
+        std::vector<char> input;
+        std::vector<char> output;
+        bool finished = false;
+    };
+
+    /**
+     * A stream buffer which passes the written data through a transform and writes the output to a sink stream.
+     */
+    class GZipOutputStreamBuf : public std::streambuf {
+    public:
+        GZipOutputStreamBuf(std::unique_ptr<GZip::Transform> transform, std::ostream &sink, size_t bufferSize)
+                : transform(std::move(transform)), sink(sink), input(bufferSize) {
+            if (bufferSize == 0)
+                throw std::runtime_error("Invalid buffer size");
+            setp(input.data(), input.data() + input.size());
+        }
+
+        /**
+         * Process the end of the input and write the remaining output to the sink.
+         */
+        void finish() {
+            if (finished)
+                return;
+            flushInput();
+            transform->finish(output);
+            writeOutput();
+            finished = true;
+        }
+
+    protected:
+        int_type overflow(int_type c) override {
+            if (finished)
+                return traits_type::eof();
+            flushInput();
+            if (!traits_type::eq_int_type(c, traits_type::eof())) {
+                *pptr() = traits_type::to_char_type(c);
+                pbump(1);
+            }
+            return traits_type::not_eof(c);
+        }
+
+        std::streamsize xsputn(const char_type *s, std::streamsize count) override {
+            if (finished)
+                return 0;
+            if (count >= static_cast<std::streamsize>(input.size())) {
+                // Pass large writes directly to the transform instead of copying them into the buffer
+                flushInput();
+                transform->update(s, static_cast<size_t>(count), output);
+                writeOutput();
+                return count;
+            }
+            return std::streambuf::xsputn(s, count);
+        }
+
+        int sync() override {
+            if (!finished)
+                flushInput();
+            sink.flush();
+            return sink.fail() ? -1 : 0;
+        }
+
+    private:
+        void flushInput() {
+            auto count = static_cast<size_t>(pptr() - pbase());
+            if (count > 0) {
+                transform->update(pbase(), count, output);
+                writeOutput();
+            }
+            setp(input.data(), input.data() + input.size());
+        }
+
+        void writeOutput() {
+            sink.write(output.data(), static_cast<std::streamsize>(output.size()));
+            output.clear();
+        }
+
+        std::unique_ptr<GZip::Transform> transform;
+        std::ostream &sink;
+        std::vector<char> input;
+        std::vector<char> output;
+        bool finished = false;
+    };
+
+    /**
+     * Reads the output of a transform applied to the data read from a source stream.
+     *
+     * Eg. GZipInputStream(gzip.createDecompressor(), file) reads the decompressed contents of file.
+     */
+    class GZipInputStream : public std::istream {
+    public:
+        GZipInputStream(std::unique_ptr<GZip::Transform> transform, std::istream &source, size_t bufferSize = 64 * 1024)
+                : std::istream(nullptr), buf(std::move(transform), source, bufferSize) {
+            rdbuf(&buf);
+        }
+
+    private:
+        GZipInputStreamBuf buf;
+    };
+
+    /**
+     * Writes the output of a transform applied to the written data to a sink stream.
+     *
+     * Eg. GZipOutputStream(gzip.createCompressor(), file) writes the compressed data to file.
+     * finish must be called after the last write, the destructor does not finish the transform.
+     */
+    class GZipOutputStream : public std::ostream {
+    public:
+        GZipOutputStream(std::unique_ptr<GZip::Transform> transform, std::ostream &sink, size_t bufferSize = 64 * 1024)
+                : std::ostream(nullptr), buf(std::move(transform), sink, bufferSize) {
+            rdbuf(&buf);
+        }
+
+        void finish() {
+            buf.finish();
+        }
+
+    private:
+        GZipOutputStreamBuf buf;
+    };
+}
+
+#endif //XENGINE_GZIPSTREAM_HPP
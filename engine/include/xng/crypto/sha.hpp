@@ -21,6 +21,7 @@
 
 #include <string>
 #include <vector>
+#include <memory>
 
 namespace xng {
     /**
@@ -28,8 +29,30 @@ namespace xng {
      */
     class SHA {
     public:
+        /**
+         * Incrementally hashes data.
+         */
+        class Hasher {
+        public:
+            virtual ~Hasher() = default;
+
+            virtual void update(const char *data, size_t length) = 0;
+
+            /**
+             * Complete the hash, the hasher cannot be updated afterwards.
+             *
+             * @return The hash in the same encoding as returned by sha256()
+             */
+            virtual std::string finish() = 0;
+        };
+
         virtual ~SHA() = default;
 
+        /**
+         * @return A hasher computing the same hash as sha256() over all updated data.
+         */
+        virtual std::unique_ptr<Hasher> createSha256() = 0;
+
         virtual std::string sha256(const char *data, size_t length) = 0;
 
         virtual std::string sha256(const std::string &data) = 0;
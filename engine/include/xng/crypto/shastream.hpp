@@ -0,0 +1,109 @@
+/**
+ *   xEngine - C++ Game Engine Library
+ *   Copyright (C) 2026 Julia Zampiccoli
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU Lesser General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   Lesser General Public License for more details.
+ *
+ *   You should have received a copy of the Lesser General Public License
+ *   along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef XENGINE_SHASTREAM_HPP
+#define XENGINE_SHASTREAM_HPP
+
+#include <ostream>
+#include <streambuf>
+#include <vector>
+#include <stdexcept>
+
+#include "xng/crypto/sha.hpp"
+
+namespace xng {
+    /**
+     * A stream buffer which hashes the written data.
+     */
+    class SHAOutputStreamBuf : public std::streambuf {
+    public:
+        SHAOutputStreamBuf(std::unique_ptr<SHA::Hasher> hasher, size_t bufferSize)
+                : hasher(std::move(hasher)), input(bufferSize) {
+            if (bufferSize == 0)
+                throw std::runtime_error("Invalid buffer size");
+            setp(input.data(), input.data() + input.size());
+        }
+
+        std::string finish() {
+            flushInput();
+            return hasher->finish();
+        }
+
+    protected:
+        int_type overflow(int_type c) override {
+            flushInput();
+            if (!traits_type::eq_int_type(c, traits_type::eof())) {
+                *pptr() = traits_type::to_char_type(c);
+                pbump(1);
+            }
+            return traits_type::not_eof(c);
+        }
+
+        std::streamsize xsputn(const char_type *s, std::streamsize count) override {
+            if (count >= static_cast<std::streamsize>(input.size())) {
+                // Hash large writes directly instead of copying them into the buffer
+                flushInput();
+                hasher->update(s, static_cast<size_t>(count));
+                return count;
+            }
+            return std::streambuf::xsputn(s, count);
+        }
+
+        int sync() override {
+            flushInput();
+            return 0;
+        }
+
+    private:
+        void flushInput() {
+            auto count = static_cast<size_t>(pptr() - pbase());
+            if (count > 0)
+                hasher->update(pbase(), count);
+            setp(input.data(), input.data() + input.size());
+        }
+
+        std::unique_ptr<SHA::Hasher> hasher;
+        std::vector<char> input;
+    };
+
+    /**
+     * Hashes the data written to the stream.
+     *
+     * Eg. SHAOutputStream stream(sha.createSha256()); stream << file.rdbuf(); auto hash = stream.finish();
+     */
+    class SHAOutputStream : public std::ostream {
+    public:
+        explicit SHAOutputStream(std::unique_ptr<SHA::Hasher> hasher, size_t bufferSize = 64 * 1024)
+                : std::ostream(nullptr), buf(std::move(hasher), bufferSize) {
+            rdbuf(&buf);
+        }
+
+        /**
+         * @return The hash of all written data, the stream cannot be written afterwards.
+         */
+        std::string finish() {
+            return buf.finish();
+        }
+
+    private:
+        SHAOutputStreamBuf buf;
+    };
+}
+
+#endif //XENGINE_SHASTREAM_HPP
@@ -0,0 +1,111 @@
+/**
+ *   xEngine - C++ Game Engine Library
+ *   Copyright (C) 2026 Julia Zampiccoli
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU Lesser General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   Lesser General Public License for more details.
+ *
+ *   You should have received a copy of the Lesser General Public License
+ *   along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef XENGINE_COMPONENTACCESS_HPP
+#define XENGINE_COMPONENTACCESS_HPP
+
+#include <set>
+#include <vector>
+#include <functional>
+
+#include "xng/ecs/entityscene.hpp"
+#include "xng/ecs/componenttype.hpp"
+
+namespace xng {
+    /**
+     * The component types a system reads and writes in its update.
+     *
+     * Two systems conflict if one of them writes a component type the other reads or writes.
+     * Async pipelines never run conflicting systems concurrently.
+     *
+     * Exclusive access conflicts with every other system. It is the default for systems that do not declare
+     * their access and must be used by systems that create or destroy entities or modify the scene in other ways
+     * than through the declared component pools.
+     */
+    class ComponentAccess {
+    public:
+        static ComponentAccess exclusive() {
+            ComponentAccess ret;
+            ret.exclusiveAccess = true;
+            return ret;
+        }
+
+        ComponentAccess() = default;
+
+        template<typename T>
+        ComponentAccess &read() {
+            reads.insert(getComponentTypeId<T>());
+            preparers.emplace_back([](EntityScene &scene) { scene.getPool<T>(); });
+            return *this;
+        }
+
+        template<typename T>
+        ComponentAccess &write() {
+            writes.insert(getComponentTypeId<T>());
+            preparers.emplace_back([](EntityScene &scene) { scene.getPool<T>(); });
+            return *this;
+        }
+
+        bool isExclusive() const {
+            return exclusiveAccess;
+        }
+
+        const std::set<ComponentTypeId> &getReads() const {
+            return reads;
+        }
+
+        const std::set<ComponentTypeId> &getWrites() const {
+            return writes;
+        }
+
+        bool conflicts(const ComponentAccess &other) const {
+            if (exclusiveAccess || other.exclusiveAccess)
+                return true;
+            for (auto &id: writes) {
+                if (other.reads.find(id) != other.reads.end()
+                    || other.writes.find(id) != other.writes.end())
+                    return true;
+            }
+            for (auto &id: other.writes) {
+                if (reads.find(id) != reads.end())
+                    return true;
+            }
+            return false;
+        }
+
+        /**
+         * Create the pools of the declared component types so that
+         * concurrently running systems do not modify the pool storage of the scene.
+         *
+         * @param scene
+         */
+        void prepare(EntityScene &scene) const {
+            for (auto &preparer: preparers) {
+                preparer(scene);
+            }
+        }
+
+    private:
+        bool exclusiveAccess = false;
+        std::set<ComponentTypeId> reads;
+        std::set<ComponentTypeId> writes;
+        std::vector<std::function<void(EntityScene &)> > preparers;
+    };
+}
+
+#endif //XENGINE_COMPONENTACCESS_HPP
@@ -20,6 +20,8 @@
 #define XENGINE_COMPONENTPOOL_HPP
 
 #include <map>
+#include <vector>
+#include <limits>
 #include <stdexcept>
 #include <utility>
 
@@ -35,6 +37,8 @@ namespace xng {
 
         virtual std::unique_ptr<ComponentPoolBase> clone() = 0;
 
+        virtual std::string getTypeName() const = 0;
+
         virtual void clear() = 0;
 
         virtual bool check(const EntityHandle &entity) const = 0;
@@ -54,6 +58,13 @@ namespace xng {
     /**
      * Component pools handle the memory layout of components.
      *
+     * The pool is a sparse set, components are stored contiguously in a dense array and
+     * a sparse array indexed by the entity id maps entities to their dense index.
+     * Create, lookup and destroy are O(1), destroy moves the last component into the freed slot.
+     *
+     * Iteration order is therefore not stable across destroy calls and
+     * components must not be created or destroyed while iterating the pool.
+     *
      * @tparam T The concrete type of the component must extend Component
      */
     template<typename T>
@@ -73,10 +84,7 @@ namespace xng {
 
         ComponentPool() = default;
 
-        ComponentPool(const ComponentPool &other)
-            : components(other.components) {
-            updateMapping();
-        }
+        ComponentPool(const ComponentPool &other) = default;
 
         ~ComponentPool() override = default;
 
@@ -84,14 +92,17 @@ namespace xng {
             return std::make_unique<ComponentPool>(*this);
         }
 
+        std::string getTypeName() const override {
+            return T::typeName;
+        }
+
         void clear() override {
             components.clear();
-            entityComponentMapping.clear();
-            entityComponentIndexMapping.clear();
+            sparse.clear();
         }
 
         bool check(const EntityHandle &entity) const override {
-            return entityComponentMapping.find(entity) != entityComponentMapping.end();
+            return getIndex(entity) != INVALID_INDEX;
         }
 
         const Component &get(const EntityHandle &entity) const override {
@@ -118,6 +129,20 @@ namespace xng {
             return components.end();
         }
 
+        size_t size() const {
+            return components.size();
+        }
+
+        /**
+         * Reserve storage for the given number of components and entity ids.
+         *
+         * @param count
+         */
+        void reserve(const size_t count) {
+            components.reserve(count);
+            sparse.reserve(count);
+        }
+
         void create(const EntityHandle &entity, const T &value = {}) {
             createComponent(entity, value);
         }
@@ -131,21 +156,39 @@ namespace xng {
         }
 
     private:
+        static constexpr size_t INVALID_INDEX = std::numeric_limits<size_t>::max();
+
+        size_t getIndex(const EntityHandle &entity) const {
+            if (entity.id < 0 || static_cast<size_t>(entity.id) >= sparse.size())
+                return INVALID_INDEX;
+            return sparse[entity.id];
+        }
+
         void createComponent(const EntityHandle &entity, const T &value) {
-            if (entityComponentMapping.find(entity) != entityComponentMapping.end())
+            if (entity.id < 0)
+                throw std::runtime_error("Invalid entity handle " + entity.toString());
+            if (check(entity))
                 throw std::runtime_error("Entity "
                                          + std::to_string(entity.id)
                                          + " already has component of type "
                                          + T::typeName);
-            components.emplace_back(ComponentPair(entity, value));
-            updateMapping();
+            if (static_cast<size_t>(entity.id) >= sparse.size()) {
+                sparse.resize(entity.id + 1, INVALID_INDEX);
+            }
+            sparse[entity.id] = components.size();
+            components.emplace_back(entity, value);
         }
 
         void destroyComponent(const EntityHandle &entity) {
-            if (entityComponentMapping.find(entity) != entityComponentMapping.end()) {
-                auto index = entityComponentIndexMapping.at(entity);
-                components.erase(components.begin() + index);
-                updateMapping();
+            const auto index = getIndex(entity);
+            if (index != INVALID_INDEX) {
+                const auto last = components.size() - 1;
+                if (index != last) {
+                    components[index] = std::move(components[last]);
+                    sparse[components[index].entity.id] = index;
+                }
+                components.pop_back();
+                sparse[entity.id] = INVALID_INDEX;
             }
         }
 
@@ -154,36 +197,29 @@ namespace xng {
         }
 
         const ComponentPair &getPair(const EntityHandle &entity) const {
-            return entityComponentMapping.at(entity).get();
+            const auto index = getIndex(entity);
+            if (index == INVALID_INDEX) {
+                throw std::out_of_range("No component for type "
+                                        + std::string(T::typeName)
+                                        + " on entity "
+                                        + entity.toString());
+            }
+            return components[index];
         }
 
         void updateComponent(const EntityHandle &entity, const T &value) {
-            auto it = entityComponentIndexMapping.find(entity);
-            if (it == entityComponentIndexMapping.end()) {
+            const auto index = getIndex(entity);
+            if (index == INVALID_INDEX) {
                 throw std::runtime_error("No component for type "
                                          + std::string(T::typeName)
                                          + " on entity "
                                          + entity.toString());
             }
-            components.at(it->second).component = value;
+            components[index].component = value;
         }
 
-        void updateMapping() {
-            entityComponentMapping.clear();
-            for (auto i = 0; i < components.size(); i++) {
-                auto &pair = components.at(i);
-                entityComponentIndexMapping[pair.entity] = i;
-                entityComponentMapping.emplace(pair.entity, pair);
-            }
-        }
-
-        std::vector<ComponentPair> components;
-
-        std::unordered_map<EntityHandle,
-            std::reference_wrapper<const ComponentPair>,
-            EntityHandleHash> entityComponentMapping;
-
-        std::unordered_map<EntityHandle, size_t, EntityHandleHash> entityComponentIndexMapping;
+        std::vector<ComponentPair> components; // Dense component storage
+        std::vector<size_t> sparse; // Entity id to index in components
     };
 }
 
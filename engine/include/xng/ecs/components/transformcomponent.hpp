@@ -30,10 +30,26 @@ namespace xng {
     struct XENGINE_EXPORT TransformComponent final : Component {
         XNG_COMPONENT_TYPENAME(TransformComponent)
 
+        /**
+         * Resolve the world transform by walking the parents of the component.
+         * A parent that does not exist or has no TransformComponent is treated as no parent.
+         *
+         * Systems querying many transforms per frame should use TransformHierarchy which caches the world transforms.
+         *
+         * @param component
+         * @param entityManager
+         * @return
+         */
         static Transform getAbsoluteTransform(const TransformComponent &component, EntityScene &entityManager);
 
+        /**
+         * @return The parent entity, parentEntity if it is set otherwise the entity named parent or an invalid handle if no entity is named parent.
+         */
+        static EntityHandle getParentEntity(const TransformComponent &component, const EntityScene &entityManager);
+
         Transform transform;
-        std::string parent; //The name of the parent transform entity
+        std::string parent; //The name of the parent transform entity, used when parentEntity is not set
+        EntityHandle parentEntity; //The parent transform entity, not serialized
 
         Messageable &operator<<(const Message &message) override {
             message.value("transform", transform);
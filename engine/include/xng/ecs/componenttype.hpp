@@ -0,0 +1,58 @@
+/**
+ *   xEngine - C++ Game Engine Library
+ *   Copyright (C) 2026 Julia Zampiccoli
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU Lesser General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   Lesser General Public License for more details.
+ *
+ *   You should have received a copy of the Lesser General Public License
+ *   along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef XENGINE_COMPONENTTYPE_HPP
+#define XENGINE_COMPONENTTYPE_HPP
+
+#include <string>
+#include <cstddef>
+
+namespace xng {
+    typedef size_t ComponentTypeId;
+
+    /**
+     * Return the integer id of the component type with the given type name, assigning a new id on first use.
+     *
+     * Ids are dense, start at zero and are assigned by the engine library so that they are
+     * consistent across module boundaries. Thread safe.
+     *
+     * @param typeName
+     * @return
+     */
+    XENGINE_EXPORT ComponentTypeId getComponentTypeId(const std::string &typeName);
+
+    /**
+     * @param id
+     * @return The type name the given id was assigned to.
+     */
+    XENGINE_EXPORT const std::string &getComponentTypeName(ComponentTypeId id);
+
+    /**
+     * The string lookup is only done once per component type and module.
+     *
+     * @tparam T The concrete type of the component must extend Component
+     * @return
+     */
+    template<typename T>
+    ComponentTypeId getComponentTypeId() {
+        static const ComponentTypeId id = getComponentTypeId(T::typeName);
+        return id;
+    }
+}
+
+#endif //XENGINE_COMPONENTTYPE_HPP
@@ -20,7 +20,9 @@
 #define XENGINE_ENTITYSCENE_HPP
 
 #include <set>
+#include <vector>
 #include <limits>
+#include <memory>
 #include <functional>
 
 #include "xng/io/messageable.hpp"
@@ -29,6 +31,7 @@
 
 #include "xng/ecs/entityhandle.hpp"
 #include "xng/ecs/componentpool.hpp"
+#include "xng/ecs/componenttype.hpp"
 #include "xng/ecs/componentregistry.hpp"
 
 namespace xng {
@@ -38,6 +41,37 @@ namespace xng {
     public:
         RESOURCE_TYPENAME(EntityScene)
 
+        enum ListenerMode {
+            LISTENER_IMMEDIATE, // Listeners are invoked from inside createComponent, updateComponent and destroyComponent.
+            LISTENER_DEFERRED, // Component changes are recorded and delivered to the listeners in bulk by dispatchChanges().
+        };
+
+        /**
+         * A component change recorded in LISTENER_DEFERRED mode.
+         *
+         * Changes are coalesced per entity and component type,
+         * repeated updates result in one UPDATE and an update after a create is reported as CREATE.
+         * A component created and destroyed between two dispatches is not reported.
+         */
+        struct ComponentChange {
+            enum Type {
+                CREATE,
+                UPDATE,
+                DESTROY
+            };
+
+            Type type;
+            EntityHandle entity;
+            ComponentTypeId typeId;
+
+            /**
+             * For UPDATE the value before the first update since the last dispatch or null if no listener
+             * requires the old value for this component type.
+             * For DESTROY the value of the destroyed component.
+             */
+            std::unique_ptr<Component> oldComponent;
+        };
+
         class XENGINE_EXPORT Listener {
         public:
             virtual ~Listener() = default;
@@ -63,6 +97,30 @@ namespace xng {
                                            const Component &oldComponent,
                                            const Component &newComponent) {
             };
+
+            /**
+             * Return true if onComponentUpdate needs the value of the component before the update for the given type.
+             *
+             * When no registered listener requires it the scene does not copy the old value and
+             * passes the new value as oldComponent.
+             * The returned value must not change while the listener is registered.
+             *
+             * @param typeName
+             * @return
+             */
+            virtual bool requiresOldComponent(const std::string &typeName) {
+                return true;
+            }
+
+            /**
+             * Invoked by dispatchChanges() with the changes recorded in LISTENER_DEFERRED mode.
+             *
+             * The default implementation forwards each change to onComponentCreate, onComponentUpdate and onComponentDestroy.
+             *
+             * @param scene
+             * @param changes
+             */
+            virtual void onComponentChanges(const EntityScene &scene, const std::vector<ComponentChange> &changes);
         };
 
         EntityScene() = default;
@@ -164,11 +222,11 @@ namespace xng {
             for (auto &listener: listeners) {
                 listener->onEntityDestroy(entity);
             }
-            for (auto &p: componentPools) {
-                if (p.second->check(entity)) {
-                    for (auto &listener: listeners) {
-                    }
-                    p.second->destroy(entity);
+            for (ComponentTypeId id = 0; id < componentPools.size(); id++) {
+                auto &pool = componentPools[id];
+                if (pool && pool->check(entity)) {
+                    cancelChange(entity, id);
+                    pool->destroy(entity);
                 }
             }
             idStore.insert(entity.id);
@@ -181,8 +239,11 @@ namespace xng {
         }
 
         void clear() {
-            for (auto &pair: componentPools) {
-                for (auto &cpair: pair.second->getComponents()) {
+            changeLogs.clear();
+            for (auto &pool: componentPools) {
+                if (!pool)
+                    continue;
+                for (auto &cpair: pool->getComponents()) {
                     for (auto &listener: listeners) {
                         listener->onComponentDestroy(cpair.first, cpair.second);
                     }
@@ -207,25 +268,32 @@ namespace xng {
 
         template<typename T>
         ComponentPool<T> &getPool() {
-            auto it = componentPools.find(T::typeName);
-            if (it == componentPools.end()) {
-                componentPools[T::typeName] = std::make_unique<ComponentPool<T> >();
+            const auto id = getComponentTypeId<T>();
+            if (id >= componentPools.size()) {
+                componentPools.resize(id + 1);
+                changeLogs.resize(id + 1);
             }
-            return down_cast<ComponentPool<T> &>(*componentPools.at(T::typeName));
+            auto &pool = componentPools[id];
+            if (!pool) {
+                pool = std::make_unique<ComponentPool<T> >();
+            }
+            // The type id identifies the pool type, no need for a checked cast.
+            return static_cast<ComponentPool<T> &>(*pool);
         }
 
         template<typename T>
         const ComponentPool<T> &getPool() const {
-            auto it = componentPools.find(T::typeName);
-            if (it == componentPools.end()) {
+            const auto id = getComponentTypeId<T>();
+            if (id >= componentPools.size() || !componentPools[id]) {
                 throw std::runtime_error("Pool does not exist");
             }
-            return down_cast<ComponentPool<T> &>(*componentPools.at(T::typeName));
+            return static_cast<const ComponentPool<T> &>(*componentPools[id]);
         }
 
         template<typename T>
         bool checkPool() const {
-            return componentPools.find(T::typeName) != componentPools.end();
+            const auto id = getComponentTypeId<T>();
+            return id < componentPools.size() && componentPools[id] != nullptr;
         }
 
         template<typename T>
@@ -251,17 +319,32 @@ namespace xng {
         template<typename T>
         void createComponent(const EntityHandle &entity, const T &value = {}) {
             getPool<T>().create(entity, value);
-            for (auto &listener: listeners) {
-                listener->onComponentCreate(entity, value);
+            if (listeners.empty())
+                return;
+            if (listenerMode == LISTENER_DEFERRED) {
+                recordChange(ComponentChange::CREATE, entity, getComponentTypeId<T>(), nullptr);
+            } else {
+                for (auto &listener: listeners) {
+                    listener->onComponentCreate(entity, value);
+                }
             }
         }
 
         template<typename T>
         void destroyComponent(const EntityHandle &entity) {
-            auto comp = getComponent<T>(entity);
-            getPool<T>().destroy(entity);
-            for (auto &listener: listeners) {
-                listener->onComponentDestroy(entity, comp);
+            auto &pool = getPool<T>();
+            const auto &component = pool.lookup(entity);
+            if (listeners.empty()) {
+                pool.destroy(entity);
+            } else if (listenerMode == LISTENER_DEFERRED) {
+                recordChange(ComponentChange::DESTROY, entity, getComponentTypeId<T>(), std::make_unique<T>(component));
+                pool.destroy(entity);
+            } else {
+                auto comp = component;
+                pool.destroy(entity);
+                for (auto &listener: listeners) {
+                    listener->onComponentDestroy(entity, comp);
+                }
             }
         }
 
@@ -272,10 +355,31 @@ namespace xng {
 
         template<typename T>
         void updateComponent(const EntityHandle &entity, const T &value) {
-            auto oldValue = getComponent<T>(entity);
-            getPool<T>().update(entity, value);
-            for (auto &listener: listeners) {
-                listener->onComponentUpdate(entity, oldValue, value);
+            auto &pool = getPool<T>();
+            if (listeners.empty()) {
+                pool.update(entity, value);
+                return;
+            }
+            const auto id = getComponentTypeId<T>();
+            if (listenerMode == LISTENER_DEFERRED) {
+                if (!hasChange(entity, id)) {
+                    recordChange(ComponentChange::UPDATE,
+                                 entity,
+                                 id,
+                                 requiresOldComponent(id) ? std::make_unique<T>(pool.lookup(entity)) : nullptr);
+                }
+                pool.update(entity, value);
+            } else if (requiresOldComponent(id)) {
+                auto oldValue = pool.lookup(entity);
+                pool.update(entity, value);
+                for (auto &listener: listeners) {
+                    listener->onComponentUpdate(entity, oldValue, value);
+                }
+            } else {
+                pool.update(entity, value);
+                for (auto &listener: listeners) {
+                    listener->onComponentUpdate(entity, value, value);
+                }
             }
         }
 
@@ -284,6 +388,38 @@ namespace xng {
             return checkPool<T>() && getPool<T>().check(entity);
         }
 
+        /**
+         * Type erased pool access used when only the component type id is known.
+         *
+         * @param typeId
+         * @return
+         */
+        const ComponentPoolBase &getPool(ComponentTypeId typeId) const {
+            if (typeId >= componentPools.size() || !componentPools[typeId]) {
+                throw std::runtime_error("Pool does not exist");
+            }
+            return *componentPools[typeId];
+        }
+
+        ListenerMode getListenerMode() const {
+            return listenerMode;
+        }
+
+        /**
+         * Switching to LISTENER_IMMEDIATE dispatches the pending changes.
+         *
+         * @param mode
+         */
+        void setListenerMode(ListenerMode mode);
+
+        /**
+         * Deliver the component changes recorded in LISTENER_DEFERRED mode to the listeners and clear the change log.
+         * Invoked by the SystemRuntime after every pipeline update.
+         *
+         * The changes are ordered by component type and by the time they were recorded within a type.
+         */
+        void dispatchChanges();
+
         Entity createEntity();
 
         Entity createEntity(const std::string &name);
@@ -321,10 +457,16 @@ namespace xng {
 
         void addListener(Listener &listener) {
             listeners.insert(&listener);
+            for (auto &log: changeLogs) {
+                log.requiresOldComponent = -1;
+            }
         }
 
         void removeListener(Listener &listener) {
             listeners.erase(&listener);
+            for (auto &log: changeLogs) {
+                log.requiresOldComponent = -1;
+            }
         }
 
         void serializeEntity(const EntityHandle &entity, Message &message) const;
@@ -334,6 +476,43 @@ namespace xng {
         std::unique_ptr<ResourceBase> clone() override;
 
     private:
+        struct ChangeLogEntry {
+            ComponentChange change;
+            bool cancelled = false;
+        };
+
+        /**
+         * The change log is kept per component type so that systems writing different component types
+         * can record changes concurrently.
+         */
+        struct ChangeLog {
+            std::vector<ChangeLogEntry> entries;
+            std::vector<size_t> indices; // Entity id to index in entries + 1 of the pending CREATE or UPDATE change
+            int requiresOldComponent = -1; // Cached Listener::requiresOldComponent result, -1 = not evaluated
+        };
+
+        /**
+         * @return The index in the change log of the type + 1 of the pending CREATE or UPDATE change or 0 if there is none.
+         */
+        size_t findChange(const EntityHandle &entity, const ComponentTypeId typeId) const {
+            if (typeId >= changeLogs.size() || static_cast<size_t>(entity.id) >= changeLogs[typeId].indices.size())
+                return 0;
+            return changeLogs[typeId].indices[entity.id];
+        }
+
+        bool hasChange(const EntityHandle &entity, const ComponentTypeId typeId) const {
+            return findChange(entity, typeId) != 0;
+        }
+
+        void recordChange(ComponentChange::Type type,
+                          const EntityHandle &entity,
+                          ComponentTypeId typeId,
+                          std::unique_ptr<Component> oldComponent);
+
+        void cancelChange(const EntityHandle &entity, ComponentTypeId typeId);
+
+        bool requiresOldComponent(ComponentTypeId typeId);
+
         std::set<int> idStore;
         int idCounter = 0;
 
@@ -341,10 +520,13 @@ namespace xng {
         std::map<EntityHandle, std::string> entityNamesReverse;
 
         std::set<EntityHandle> entities;
-        std::map<std::string, std::unique_ptr<ComponentPoolBase> > componentPools;
+        std::vector<std::unique_ptr<ComponentPoolBase> > componentPools; // Indexed by ComponentTypeId, unused ids are null
 
         std::set<Listener *> listeners;
 
+        ListenerMode listenerMode = LISTENER_IMMEDIATE;
+        std::vector<ChangeLog> changeLogs; // Indexed by ComponentTypeId, same size as componentPools
+
         std::string sceneName;
     };
 }
@@ -24,24 +24,41 @@
 
 namespace xng {
     struct ECSFrame : public Messageable {
-        long duration; // Total duration of the frame in milliseconds
+        long long start = 0; // The start of the pipeline update relative to the start of the frame in nanoseconds
+        long long duration = 0; // Total duration of the pipeline update in nanoseconds
         std::string pipeline; // The name of the pipeline that this frame represents
+        size_t thread = 0; // The index of the thread that updated the pipeline
         std::vector<ECSSample> samples;
+        std::vector<std::string> criticalPath; // The names of the systems on the longest dependency chain of an async pipeline
+        long long criticalPathDuration = 0; // Sum of the update durations of the systems on the critical path in nanoseconds
 
         Messageable &operator<<(const Message &message) override {
             samples.clear();
+            message.value("start", start, 0LL);
             message.value("duration", duration);
+            message.value("pipeline", pipeline);
+            message.value("thread", thread, static_cast<size_t>(0));
             for (auto &msg: message["samples"].asList()) {
                 ECSSample sample;
                 sample << msg;
                 samples.emplace_back(sample);
             }
+            criticalPath.clear();
+            if (message.has("criticalPath")) {
+                for (auto &msg: message["criticalPath"].asList()) {
+                    criticalPath.emplace_back(msg.asString());
+                }
+            }
+            message.value("criticalPathDuration", criticalPathDuration, 0LL);
             return *this;
         }
 
         Message &operator>>(Message &message) const override {
             message = Message(Message::DICTIONARY);
+            message["start"] = start;
             message["duration"] = duration;
+            message["pipeline"] = pipeline;
+            message["thread"] = thread;
 
             auto vec = std::vector<Message>();
             for (auto &sample: samples) {
@@ -51,6 +68,13 @@ namespace xng {
             }
             message["samples"] = vec;
 
+            auto path = std::vector<Message>();
+            for (auto &system: criticalPath) {
+                path.emplace_back(system);
+            }
+            message["criticalPath"] = path;
+            message["criticalPathDuration"] = criticalPathDuration;
+
             return message;
         }
     };
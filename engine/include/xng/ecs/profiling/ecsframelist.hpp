@@ -24,7 +24,8 @@
 
 namespace xng {
     struct ECSFrameList : public Messageable {
-        long totalDuration;
+        long long start = 0; // The start of the frame relative to the creation of the profiler in nanoseconds
+        long long totalDuration = 0; // Total duration of the frame in nanoseconds
         std::vector<ECSFrame> frames;
 
         void addFrame(const ECSFrame &frame) {
@@ -33,7 +34,9 @@ namespace xng {
 
         Messageable &operator<<(const Message &message) override {
             frames.clear();
-            for (auto &msg: message.asList()) {
+            message.value("start", start, 0LL);
+            message.value("totalDuration", totalDuration, 0LL);
+            for (auto &msg: message["frames"].asList()) {
                 ECSFrame frame;
                 frame << msg;
                 frames.emplace_back(frame);
@@ -48,7 +51,10 @@ namespace xng {
                 frame >> msg;
                 vec.emplace_back(msg);
             }
-            message = vec;
+            message = Message(Message::DICTIONARY);
+            message["start"] = start;
+            message["totalDuration"] = totalDuration;
+            message["frames"] = vec;
             return message;
         }
     };
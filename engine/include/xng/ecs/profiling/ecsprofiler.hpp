@@ -21,119 +21,123 @@
 
 #include <chrono>
 #include <mutex>
+#include <vector>
+#include <string>
+#include <map>
+#include <thread>
+#include <ostream>
 
 #include "xng/ecs/profiling/ecsframelist.hpp"
+#include "xng/ecs/profiling/ecssystemstatistics.hpp"
 
 namespace xng {
-    class ECSProfiler {
+    /**
+     * Records the durations of the pipeline and system updates of a SystemRuntime with nanosecond resolution.
+     *
+     * The profiler keeps a ring buffer of the most recent frames which can be summarized with getSystemStatistics()
+     * or exported in the Chrome trace event format with exportChromeTrace() for viewing in a trace viewer
+     * such as chrome://tracing or Perfetto.
+     *
+     * endSystemUpdate() may be called concurrently, all other methods must be called from the thread updating the runtime.
+     */
+    class XENGINE_EXPORT ECSProfiler {
     public:
-        ECSProfiler() = default;
+        typedef std::chrono::steady_clock Clock;
 
-        ECSProfiler(const ECSProfiler &other) {
-            frames = other.frames;
-        }
-
-        ECSProfiler &operator=(const ECSProfiler &other) {
-            frames = other.frames;
-            return *this;
-        }
+        explicit ECSProfiler(size_t historySize = 300);
 
-        ECSProfiler(ECSProfiler &&other)  noexcept {
-            frames = std::move(other.frames);
-        }
-
-        ECSProfiler &operator=(ECSProfiler &&other)  noexcept {
-            frames = std::move(other.frames);
-            return *this;
-        }
+        ECSProfiler(const ECSProfiler &other);
 
-        void beginFrame() {
-            frameStart = std::chrono::high_resolution_clock::now();
-            frames = ECSFrameList();
-        }
-
-        void beginPipelineUpdate() {
-            pipelineStart = std::chrono::high_resolution_clock::now();
-        }
-
-        int beginSystemUpdate() {
-            return startSystemUpdate();
-        }
+        ECSProfiler &operator=(const ECSProfiler &other);
 
-        void endSystemUpdate(const std::string &system, int id) {
-            auto systemEnd = std::chrono::high_resolution_clock::now();
+        ECSProfiler(ECSProfiler &&other) noexcept;
 
-            mutex.lock();
+        ECSProfiler &operator=(ECSProfiler &&other) noexcept;
 
-            ECSSample sample;
-            sample.systemName = system;
-            sample.time = std::chrono::duration_cast<std::chrono::milliseconds>(
-                    systemEnd - systemStarts.at(id)).count();
-            frameSamples.emplace_back(sample);
+        void beginFrame();
 
-            endSystemUpdate(id);
+        void beginPipelineUpdate();
 
-            mutex.unlock();
+        /**
+         * @return The start time to pass to endSystemUpdate
+         */
+        Clock::time_point beginSystemUpdate() const {
+            return Clock::now();
         }
 
-        void endPipelineUpdate(const std::string &pipeline) {
-            auto frameEnd = std::chrono::high_resolution_clock::now();
+        void endSystemUpdate(const std::string &system, Clock::time_point start);
 
-            ECSFrame frame;
-            frame.pipeline = pipeline;
-            frame.duration = std::chrono::duration_cast<std::chrono::milliseconds>(frameEnd - frameStart).count();
-            frame.samples = frameSamples;
-            frames.addFrame(frame);
+        void endPipelineUpdate(const std::string &pipeline);
 
-            frameSamples.clear();
-        }
+        /**
+         * Report the critical path of an async pipeline update.
+         * If the pipeline is updated multiple times in a frame the longest path is kept.
+         *
+         * @param systems The names of the systems on the path
+         * @param duration The sum of the system update durations on the path
+         */
+        void submitCriticalPath(std::vector<std::string> systems, std::chrono::nanoseconds duration);
 
-        void endFrame() {
-            auto frameEnd = std::chrono::high_resolution_clock::now();
-            frames.totalDuration = std::chrono::duration_cast<std::chrono::milliseconds>(frameEnd - frameStart).count();
-        }
+        void endFrame();
 
+        /**
+         * @return The most recently completed frame
+         */
         const ECSFrameList &getFrames() const {
             return frames;
         }
 
-    private:
-        int startSystemUpdate() {
-            auto time = std::chrono::high_resolution_clock::now();
-            mutex.lock();
-            int ret;
-            if (systemStartCounterCache.empty()) {
-                if (std::numeric_limits<int>::max() == systemStartCounter) {
-                    throw std::runtime_error("Counter overflow");
-                }
-                ret = systemStartCounter++;
-            } else {
-                ret = *systemStartCounterCache.begin();
-                systemStartCounterCache.erase(systemStartCounterCache.begin());
-            }
-            systemStarts[ret] = time;
-            mutex.unlock();
-            return ret;
-        }
+        /**
+         * @return The recorded frames ordered from oldest to newest
+         */
+        std::vector<ECSFrameList> getHistory() const;
+
+        /**
+         * Set the number of frames to keep, discarding the recorded history.
+         *
+         * @param size
+         */
+        void setHistorySize(size_t size);
 
-        void endSystemUpdate(int id) {
-            systemStarts.erase(id);
-            systemStartCounterCache.insert(id);
+        size_t getHistorySize() const {
+            return history.size();
         }
 
-        std::mutex mutex;
+        /**
+         * @return The update duration statistics of each system over the recorded history, keyed by system name
+         */
+        std::map<std::string, ECSSystemStatistics> getSystemStatistics() const;
 
-        int systemStartCounter = 0;
-        std::set<int> systemStartCounterCache;
-        std::map<int, std::chrono::high_resolution_clock::time_point> systemStarts;
+        /**
+         * Write the recorded history as Chrome trace event JSON.
+         *
+         * Frames, pipelines and systems are written as complete events on the thread that executed them.
+         *
+         * @param stream
+         */
+        void exportChromeTrace(std::ostream &stream) const;
 
-        std::chrono::high_resolution_clock::time_point frameStart;
+    private:
+        size_t getThreadIndex();
+
+        Clock::time_point epoch = Clock::now();
 
-        std::chrono::high_resolution_clock::time_point pipelineStart;
+        Clock::time_point frameStart;
+        Clock::time_point pipelineStart;
 
+        std::mutex mutex;
         std::vector<ECSSample> frameSamples;
+        std::map<std::thread::id, size_t> threadIndices;
 
+        std::vector<std::string> criticalPath;
+        long long criticalPathDuration = 0;
+
+        ECSFrameList currentFrame;
         ECSFrameList frames;
+
+        std::vector<ECSFrameList> history;
+        size_t historyNext = 0; // The index in history to write the next frame to
+        size_t historyCount = 0;
     };
 }
 #endif //XENGINE_ECSPROFILER_HPP
@@ -26,18 +26,24 @@
 namespace xng {
     struct ECSSample : public Messageable {
         std::string systemName; // The name of the system
-        long time; // The time the system update has taken to complete in milliseconds
+        long long start = 0; // The start of the system update relative to the start of the frame in nanoseconds
+        long long time = 0; // The time the system update has taken to complete in nanoseconds
+        size_t thread = 0; // The index of the thread that executed the update, in order of the first sample of the thread
 
         Messageable &operator<<(const Message &message) override {
             message.value("systemName", systemName);
+            message.value("start", start, 0LL);
             message.value("time", time);
+            message.value("thread", thread, static_cast<size_t>(0));
             return *this;
         }
 
         Message &operator>>(Message &message) const override {
             message = Message(Message::DICTIONARY);
             message["systemName"] = systemName;
+            message["start"] = start;
             message["time"] = time;
+            message["thread"] = thread;
             return message;
         }
     };
@@ -0,0 +1,61 @@
+/**
+ *   xEngine - C++ Game Engine Library
+ *   Copyright (C) 2026 Julia Zampiccoli
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU Lesser General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   Lesser General Public License for more details.
+ *
+ *   You should have received a copy of the Lesser General Public License
+ *   along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef XENGINE_ECSSYSTEMSTATISTICS_HPP
+#define XENGINE_ECSSYSTEMSTATISTICS_HPP
+
+#include <string>
+
+#include "xng/io/messageable.hpp"
+
+namespace xng {
+    /**
+     * The update durations of a system over the frame history of a profiler in nanoseconds.
+     */
+    struct ECSSystemStatistics : public Messageable {
+        std::string systemName;
+        size_t samples = 0; // The number of updates in the history
+        long long min = 0;
+        long long average = 0;
+        long long max = 0;
+        long long p99 = 0; // 99% of the updates completed in this time or less
+
+        Messageable &operator<<(const Message &message) override {
+            message.value("systemName", systemName);
+            message.value("samples", samples);
+            message.value("min", min);
+            message.value("average", average);
+            message.value("max", max);
+            message.value("p99", p99);
+            return *this;
+        }
+
+        Message &operator>>(Message &message) const override {
+            message = Message(Message::DICTIONARY);
+            message["systemName"] = systemName;
+            message["samples"] = samples;
+            message["min"] = min;
+            message["average"] = average;
+            message["max"] = max;
+            message["p99"] = p99;
+            return message;
+        }
+    };
+}
+
+#endif //XENGINE_ECSSYSTEMSTATISTICS_HPP
@@ -21,6 +21,7 @@
 
 #include "xng/util/time.hpp"
 #include "xng/ecs/entityscene.hpp"
+#include "xng/ecs/componentaccess.hpp"
 
 #include "xng/event/eventbus.hpp"
 #include "xng/util/time.hpp"
@@ -38,6 +39,15 @@ namespace xng {
         virtual void update(DeltaTime deltaTime, EntityScene &scene, EventBus &eventBus) {}
 
         virtual std::string getName() { return "System"; }
+
+        /**
+         * Declare the component types accessed by update().
+         * Async pipelines run systems with non-conflicting access concurrently.
+         * The returned value must not change while the system is part of a pipeline.
+         *
+         * @return By default exclusive access
+         */
+        virtual ComponentAccess getComponentAccess() { return ComponentAccess::exclusive(); }
     };
 }
 #endif //XENGINE_SYSTEM_HPP
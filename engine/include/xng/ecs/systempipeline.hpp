@@ -23,6 +23,8 @@
 #include <vector>
 #include <chrono>
 #include <algorithm>
+#include <mutex>
+#include <condition_variable>
 
 #include "xng/ecs/system.hpp"
 #include "xng/ecs/profiling/ecsprofiler.hpp"
@@ -35,8 +37,12 @@ namespace xng {
      *
      * Pipelines are executed sequentially by the SystemRuntime.
      *
-     * If runAsync is set the system updates are executed asynchronously.
-     * In that case the user must handle synchronization between the executing systems if required.
+     * If runAsync is set the system updates are executed on the global thread pool.
+     * The pipeline builds a dependency graph from the System::getComponentAccess() declarations where
+     * a system depends on every earlier system in the pipeline with conflicting access,
+     * systems without a dependency between them run concurrently.
+     * Listeners are invoked from the thread of the system modifying the scene, so async pipelines
+     * should be used with EntityScene::LISTENER_DEFERRED or thread safe listeners.
      */
     class SystemPipeline {
     public:
@@ -82,6 +88,7 @@ namespace xng {
 
         void addSystem(const std::shared_ptr<System> &ptr) {
             systems.emplace_back(ptr);
+            dependents.clear();
         }
 
         void start(EntityScene &scene, EventBus &eventBus) {
@@ -146,31 +153,147 @@ namespace xng {
 
         Duration fixedStepAccumulator = Duration();
 
-        void invokeUpdate(DeltaTime deltaTime, EntityScene &scene, EventBus &eventBus, ECSProfiler &profiler,
-                          bool enableProfiling) {
-            if (runAsync) {
-                std::vector<std::shared_ptr<Task>> tasks;
-                for (auto &ptr: systems) {
+        // The dependency graph of the systems for async updates, empty if not yet built.
+        std::vector<ComponentAccess> access;
+        std::vector<std::vector<size_t> > dependents; // The indices of the systems that depend on the system
+        std::vector<size_t> dependencyCounts; // The number of systems that the system depends on
+        std::vector<std::vector<size_t> > dependencies;
+
+        void buildGraph() {
+            access.clear();
+            dependents = std::vector<std::vector<size_t> >(systems.size());
+            dependencies = std::vector<std::vector<size_t> >(systems.size());
+            dependencyCounts = std::vector<size_t>(systems.size(), 0);
+            for (auto &system: systems) {
+                access.emplace_back(system->getComponentAccess());
+            }
+            for (size_t i = 0; i < systems.size(); i++) {
+                for (size_t y = 0; y < i; y++) {
+                    if (access.at(i).conflicts(access.at(y))) {
+                        dependents.at(y).emplace_back(i);
+                        dependencies.at(i).emplace_back(y);
+                        dependencyCounts.at(i)++;
+                    }
+                }
+            }
+        }
+
+        void submitCriticalPath(const std::vector<std::chrono::nanoseconds> &durations, ECSProfiler &profiler) {
+            // Systems are topologically ordered because dependencies always point to earlier systems.
+            std::vector<std::chrono::nanoseconds> pathDurations(systems.size());
+            std::vector<size_t> predecessors(systems.size(), systems.size());
+            size_t end = 0;
+            for (size_t i = 0; i < systems.size(); i++) {
+                auto longest = std::chrono::nanoseconds(0);
+                for (auto &dependency: dependencies.at(i)) {
+                    if (pathDurations.at(dependency) >= longest) {
+                        longest = pathDurations.at(dependency);
+                        predecessors.at(i) = dependency;
+                    }
+                }
+                pathDurations.at(i) = longest + durations.at(i);
+                if (pathDurations.at(i) > pathDurations.at(end)) {
+                    end = i;
+                }
+            }
+            std::vector<std::string> path;
+            for (auto i = end; i < systems.size(); i = predecessors.at(i)) {
+                path.insert(path.begin(), systems.at(i)->getName());
+            }
+            profiler.submitCriticalPath(path, pathDurations.at(end));
+        }
+
+        void invokeUpdateAsync(DeltaTime deltaTime, EntityScene &scene, EventBus &eventBus, ECSProfiler &profiler,
+                               bool enableProfiling) {
+            if (dependents.size() != systems.size()) {
+                buildGraph();
+            }
+            for (auto &a: access) {
+                a.prepare(scene);
+            }
+
+            std::mutex mutex;
+            std::condition_variable completedCondition;
+            std::vector<size_t> remaining = dependencyCounts;
+            std::vector<size_t> ready;
+            std::vector<std::chrono::nanoseconds> durations(systems.size());
+            size_t completed = 0;
+            std::exception_ptr exception;
+
+            for (size_t i = 0; i < systems.size(); i++) {
+                if (remaining.at(i) == 0) {
+                    ready.emplace_back(i);
+                }
+            }
+
+            std::vector<std::shared_ptr<Task> > tasks;
+            std::unique_lock<std::mutex> lock(mutex);
+            while (completed < systems.size()) {
+                auto submit = std::move(ready);
+                ready.clear();
+                lock.unlock();
+                for (auto index: submit) {
+                    auto ptr = systems.at(index);
                     tasks.emplace_back(ThreadPool::getPool().addTask(
-                            [ptr, deltaTime, &scene, &eventBus, &profiler, enableProfiling]() {
-                                if (enableProfiling) {
-                                    int id = profiler.beginSystemUpdate();
-                                    ptr->update(deltaTime, scene, eventBus);
-                                    profiler.endSystemUpdate(ptr->getName(), id);
-                                } else {
+                            [&, ptr, index]() {
+                                const auto start = profiler.beginSystemUpdate();
+                                std::exception_ptr error;
+                                try {
                                     ptr->update(deltaTime, scene, eventBus);
+                                    if (enableProfiling) {
+                                        profiler.endSystemUpdate(ptr->getName(), start);
+                                    }
+                                } catch (...) {
+                                    // Dependents must still be released, otherwise the pipeline never completes.
+                                    error = std::current_exception();
                                 }
-                            }));
-                }
-                for (auto &task: tasks) {
-                    task->join();
+                                const auto end = ECSProfiler::Clock::now();
+
+                                // Notify while holding the lock because the waiting thread owns the condition variable.
+                                std::lock_guard<std::mutex> guard(mutex);
+                                if (error && !exception) {
+                                    exception = error;
+                                }
+                                durations.at(index) = end - start;
+                                for (auto dependent: dependents.at(index)) {
+                                    if (--remaining.at(dependent) == 0) {
+                                        ready.emplace_back(dependent);
+                                    }
+                                }
+                                completed++;
+                                completedCondition.notify_one();
+                            },
+                            ThreadPool::PRIORITY_HIGH));
                 }
+                lock.lock();
+                completedCondition.wait(lock, [&]() {
+                    return !ready.empty() || completed == systems.size();
+                });
+            }
+            lock.unlock();
+
+            for (auto &task: tasks) {
+                task->join();
+            }
+            if (exception) {
+                std::rethrow_exception(exception);
+            }
+
+            if (enableProfiling) {
+                submitCriticalPath(durations, profiler);
+            }
+        }
+
+        void invokeUpdate(DeltaTime deltaTime, EntityScene &scene, EventBus &eventBus, ECSProfiler &profiler,
+                          bool enableProfiling) {
+            if (runAsync) {
+                invokeUpdateAsync(deltaTime, scene, eventBus, profiler, enableProfiling);
             } else {
                 for (auto &ptr: systems) {
                     if (enableProfiling) {
-                        int id = profiler.beginSystemUpdate();
+                        auto start = profiler.beginSystemUpdate();
                         ptr->update(deltaTime, scene, eventBus);
-                        profiler.endSystemUpdate(ptr->getName(), id);
+                        profiler.endSystemUpdate(ptr->getName(), start);
                     } else {
                         ptr->update(deltaTime, scene, eventBus);
                     }
@@ -64,6 +64,8 @@ namespace xng {
 
         const ECSProfiler &getProfiler() const;
 
+        ECSProfiler &getProfiler();
+
         void setEventBus(const std::shared_ptr<EventBus> &ptr) {
             bool reset = started;
             if (started) {
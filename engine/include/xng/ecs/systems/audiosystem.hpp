@@ -53,8 +53,12 @@ namespace xng {
                                const Component &oldComponent,
                                const Component &newComponent) override;
 
+        bool requiresOldComponent(const std::string &typeName) override;
+
         std::string getName() override { return "AudioSystem"; }
 
+        ComponentAccess getComponentAccess() override;
+
         void onEntityDestroy(const EntityHandle &entity) override;
 
     private:
@@ -45,6 +45,8 @@ namespace xng {
 
         std::string getName() override { return "PhysicsSystem"; }
 
+        ComponentAccess getComponentAccess() override;
+
         void onComponentCreate(const EntityHandle &entity, const Component &component) override;
 
         void onComponentDestroy(const EntityHandle &entity, const Component &component) override;
@@ -53,6 +55,8 @@ namespace xng {
                                const Component &oldComponent,
                                const Component &newComponent) override;
 
+        bool requiresOldComponent(const std::string &typeName) override;
+
         void onEntityDestroy(const EntityHandle &entity) override;
 
         void beginContact(const World::Contact &contact) override;
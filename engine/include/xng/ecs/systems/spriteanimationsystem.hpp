@@ -36,6 +36,8 @@ namespace xng {
 
         std::string getName() override { return "SpriteAnimationSystem"; }
 
+        ComponentAccess getComponentAccess() override;
+
         void onComponentCreate(const EntityHandle &entity, const Component &component) override;
 
         void onComponentDestroy(const EntityHandle &entity, const Component &component) override;
@@ -44,6 +46,8 @@ namespace xng {
                                const Component &oldComponent,
                                const Component &newComponent) override;
 
+        bool requiresOldComponent(const std::string &typeName) override;
+
         void onEntityDestroy(const EntityHandle &entity) override;
 
     private:
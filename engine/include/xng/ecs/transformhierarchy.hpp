@@ -0,0 +1,148 @@
+/**
+ *   xEngine - C++ Game Engine Library
+ *   Copyright (C) 2026 Julia Zampiccoli
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU Lesser General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   Lesser General Public License for more details.
+ *
+ *   You should have received a copy of the Lesser General Public License
+ *   along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef XENGINE_TRANSFORMHIERARCHY_HPP
+#define XENGINE_TRANSFORMHIERARCHY_HPP
+
+#include <vector>
+#include <limits>
+
+#include "xng/ecs/entityscene.hpp"
+#include "xng/ecs/components/transformcomponent.hpp"
+
+namespace xng {
+    /**
+     * Caches the world transforms of the TransformComponent entities of a scene.
+     *
+     * The nodes are stored in depth first order so that the subtree of a node occupies a contiguous range
+     * that starts at the node. Updating a TransformComponent marks the node dirty and update() recomputes only the
+     * subtrees of the dirty nodes. Creating or destroying transform components or changing a parent rebuilds the order.
+     *
+     * A parent that does not exist or has no TransformComponent is treated as no parent,
+     * as in TransformComponent::getAbsoluteTransform.
+     *
+     * The hierarchy registers itself as a listener on the scene, which must outlive the hierarchy.
+     * The listener callbacks must not run concurrently with each other or update(), scenes modified by
+     * async pipelines should use EntityScene::LISTENER_DEFERRED.
+     */
+    class XENGINE_EXPORT TransformHierarchy : public EntityScene::Listener {
+    public:
+        explicit TransformHierarchy(EntityScene &scene);
+
+        ~TransformHierarchy() override;
+
+        TransformHierarchy(const TransformHierarchy &other) = delete;
+
+        TransformHierarchy &operator=(const TransformHierarchy &other) = delete;
+
+        /**
+         * Recompute the world transforms of the dirty subtrees.
+         *
+         * @param parallel If true independent subtrees are updated concurrently on the global thread pool.
+         */
+        void update(bool parallel = false);
+
+        bool contains(const EntityHandle &entity) const {
+            return entity.id >= 0
+                   && static_cast<size_t>(entity.id) < indices.size()
+                   && indices.at(entity.id) != INVALID_INDEX;
+        }
+
+        /**
+         * @param entity
+         * @return The world transform of the entity as of the last update()
+         */
+        Transform getWorldTransform(const EntityHandle &entity) const {
+            const auto index = getIndex(entity);
+            return {worldPositions.at(index), worldRotations.at(index), worldScales.at(index)};
+        }
+
+        const Vec3f &getWorldPosition(const EntityHandle &entity) const {
+            return worldPositions.at(getIndex(entity));
+        }
+
+        const Quaternion &getWorldRotation(const EntityHandle &entity) const {
+            return worldRotations.at(getIndex(entity));
+        }
+
+        const Vec3f &getWorldScale(const EntityHandle &entity) const {
+            return worldScales.at(getIndex(entity));
+        }
+
+        const Mat4f &getWorldMatrix(const EntityHandle &entity) const {
+            return worldMatrices.at(getIndex(entity));
+        }
+
+        /**
+         * @return The number of transform nodes as of the last update()
+         */
+        size_t getNodeCount() const {
+            return entities.size();
+        }
+
+        void onEntityDestroy(const EntityHandle &entity) override;
+
+        void onEntityNameChanged(const EntityHandle &entity,
+                                 const std::string &newName,
+                                 const std::string &oldName) override;
+
+        void onComponentCreate(const EntityHandle &entity, const Component &component) override;
+
+        void onComponentDestroy(const EntityHandle &entity, const Component &component) override;
+
+        void onComponentUpdate(const EntityHandle &entity,
+                               const Component &oldComponent,
+                               const Component &newComponent) override;
+
+        bool requiresOldComponent(const std::string &typeName) override;
+
+    private:
+        static constexpr size_t INVALID_INDEX = std::numeric_limits<size_t>::max();
+
+        size_t getIndex(const EntityHandle &entity) const {
+            if (!contains(entity)) {
+                throw std::runtime_error("Entity " + entity.toString() + " is not part of the transform hierarchy");
+            }
+            return indices.at(entity.id);
+        }
+
+        void rebuild();
+
+        void updateRange(const ComponentPool<TransformComponent> &pool, size_t begin, size_t end);
+
+        EntityScene &scene;
+
+        // Nodes in depth first order, the subtree of node i occupies [i, subtreeEnds[i])
+        std::vector<EntityHandle> entities;
+        std::vector<size_t> parents; // The index of the parent node or INVALID_INDEX for roots
+        std::vector<EntityHandle> parentEntities; // The resolved parent entity to detect parent changes
+        std::vector<size_t> subtreeEnds;
+        // The world transforms by node index, stored as separate arrays so that the matrices are contiguous
+        std::vector<Vec3f> worldPositions;
+        std::vector<Quaternion> worldRotations;
+        std::vector<Vec3f> worldScales;
+        std::vector<Mat4f> worldMatrices;
+        std::vector<unsigned char> dirty; // Not vector<bool> because ranges are updated concurrently
+
+        std::vector<size_t> indices; // Node index by entity id
+        std::vector<size_t> dirtyNodes;
+        bool rebuildRequired = true;
+    };
+}
+
+#endif //XENGINE_TRANSFORMHIERARCHY_HPP
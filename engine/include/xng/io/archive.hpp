@@ -21,6 +21,10 @@
 
 #include <iostream>
 #include <memory>
+#include <string>
+#include <vector>
+
+#include "xng/io/readfile.hpp"
 
 namespace xng {
     /**
@@ -28,6 +32,18 @@ namespace xng {
      */
     class XENGINE_EXPORT Archive {
     public:
+        /**
+         * A read only view of the data of a file.
+         * The owner keeps the data valid for as long as a copy of the view exists.
+         */
+        struct FileView {
+            const char *data = nullptr;
+            size_t size = 0;
+            std::shared_ptr<const void> owner;
+
+            explicit operator bool() const { return owner != nullptr; }
+        };
+
         virtual ~Archive() = default;
 
         virtual bool exists(const std::string &name) = 0;
@@ -35,6 +51,40 @@ namespace xng {
         virtual std::unique_ptr<std::istream> open(const std::string &name) = 0;
 
         virtual std::unique_ptr<std::iostream> openRW(const std::string &name) = 0;
+
+        /**
+         * Get the data of a file without copying it.
+         *
+         * @param name
+         * @return The view of the file data or an empty view if the archive cannot provide the data without copying
+         */
+        virtual FileView view(const std::string &name) { return {}; }
+
+        /**
+         * Read the whole file into buffer.
+         * Implementations read directly into the buffer instead of going through a stream where possible.
+         *
+         * @param name
+         * @param buffer Replaced by the file data
+         */
+        virtual void read(const std::string &name, std::vector<char> &buffer) {
+            auto stream = open(name);
+            readStream(*stream, buffer);
+        }
+
+        /**
+         * List the names of all files in the archive in the form accepted by exists and open.
+         * Used by the resource registry to build an index of the files instead of calling exists on every archive.
+         *
+         * @param paths Receives the paths
+         * @return False if the archive cannot list its files
+         */
+        virtual bool list(std::vector<std::string> &paths) { return false; }
+
+        /**
+         * @return True if files may have been added or removed since the last call to list.
+         */
+        virtual bool changed() { return false; }
     };
 }
 
@@ -19,12 +19,21 @@
 #ifndef XENGINE_DIRECTORYARCHIVE_HPP
 #define XENGINE_DIRECTORYARCHIVE_HPP
 
+#include <filesystem>
+#include <utility>
+
 #include "xng/io/archive.hpp"
 
 namespace xng {
     /**
      * A directory representing an archive.
      * Only files relative to the specified directory can be accessed by full or relative path,
+     *
+     * Changes to the listed files are detected by comparing the modification times of the listed directories,
+     * which change when entries are added to or removed from the directory.
+     *
+     * Files are not mapped into views because mapped files cannot be replaced on all platforms while mapped,
+     * read instead reads the file with a single read into the callers buffer.
      */
     class XENGINE_EXPORT DirectoryArchive : public Archive {
     public:
@@ -40,11 +49,19 @@ namespace xng {
 
         std::unique_ptr<std::iostream> openRW(const std::string &path) override;
 
+        void read(const std::string &path, std::vector<char> &buffer) override;
+
+        bool list(std::vector<std::string> &paths) override;
+
+        bool changed() override;
+
     private:
         std::filesystem::path getAbsolutePath(const std::string &path);
 
         std::filesystem::path directory;
         bool readOnly = true;
+
+        std::vector<std::pair<std::filesystem::path, std::filesystem::file_time_type> > listedDirectories;
     };
 }
 
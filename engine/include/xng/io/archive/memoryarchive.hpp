@@ -22,10 +22,18 @@
 #include <map>
 #include <vector>
 #include <sstream>
+#include <cstring>
 
 #include "xng/io/archive.hpp"
+#include "xng/io/memorystream.hpp"
 
 namespace xng {
+    /**
+     * Archive of files held in memory.
+     *
+     * The files are shared with the streams and views returned by the archive instead of being copied,
+     * removing or replacing a file does not invalidate streams which are still open.
+     */
     class XENGINE_EXPORT MemoryArchive : public Archive {
     public:
         MemoryArchive() = default;
@@ -37,28 +45,54 @@ namespace xng {
         }
 
         std::unique_ptr<std::istream> open(const std::string &path) override {
-            auto buf = data.at(path);
-            const auto ret = new std::stringstream(std::string(buf.begin(), buf.end()));
+            auto &buf = data.at(path);
+            auto ret = std::make_unique<MemoryStream>(reinterpret_cast<const char *>(buf->data()), buf->size(), buf);
             std::noskipws(*ret);
-            return std::unique_ptr<std::istream>(ret);
+            return ret;
+        }
+
+        FileView view(const std::string &path) override {
+            auto &buf = data.at(path);
+            return {reinterpret_cast<const char *>(buf->data()), buf->size(), buf};
+        }
+
+        void read(const std::string &path, std::vector<char> &buffer) override {
+            auto &buf = data.at(path);
+            buffer.resize(buf->size());
+            std::memcpy(buffer.data(), buf->data(), buf->size());
         }
 
         std::unique_ptr<std::iostream> openRW(const std::string &path) override {
             throw std::runtime_error("No RW in memory archive allowed");
         }
 
-        void addData(const std::string &path, const std::vector<uint8_t> &bytes) {
+        bool list(std::vector<std::string> &paths) override {
+            modified = false;
+            for (auto &pair: data) {
+                paths.emplace_back(pair.first);
+            }
+            return true;
+        }
+
+        bool changed() override {
+            return modified;
+        }
+
+        void addData(const std::string &path, std::vector<uint8_t> bytes) {
             if (data.find(path) != data.end())
                 throw std::runtime_error("Data already exists at " + path);
-            data[path] = bytes;
+            data[path] = std::make_shared<const std::vector<uint8_t>>(std::move(bytes));
+            modified = true;
         }
 
         void removeData(const std::string &path) {
             data.erase(path);
+            modified = true;
         }
 
     private:
-        std::map<std::string, std::vector<uint8_t>> data;
+        std::map<std::string, std::shared_ptr<const std::vector<uint8_t>>> data;
+        bool modified = false;
     };
 }
 #endif //XENGINE_MEMORYARCHIVE_HPP
@@ -19,17 +19,33 @@
 #ifndef XENGINE_PAKARCHIVE_HPP
 #define XENGINE_PAKARCHIVE_HPP
 
-#include <mutex>
+#include <memory>
 
 #include "xng/io/archive.hpp"
 #include "xng/io/pak.hpp"
 
 namespace xng {
+    /**
+     * An archive reading from a pak.
+     *
+     * Entries stored in blocks are opened as seekable streams which only decode the blocks that are read.
+     * Decoded blocks are kept in a least recently used cache shared by all streams of the archive,
+     * the streams may outlive the archive.
+     *
+     * Views are only available for uncompressed and unencrypted entries of memory mapped paks.
+     */
     class XENGINE_EXPORT PakArchive : public Archive {
     public:
-        PakArchive() = default;
+        static const size_t DEFAULT_BLOCK_CACHE_SIZE = 32 * 1024 * 1024;
 
-        explicit PakArchive(Pak pak, bool verifyHashes = true);
+        PakArchive();
+
+        /**
+         * @param pak
+         * @param verifyHashes If true the hashes of entries or blocks are verified when they are read.
+         * @param blockCacheSize The maximum number of bytes of decoded blocks to cache.
+         */
+        explicit PakArchive(Pak pak, bool verifyHashes = true, size_t blockCacheSize = DEFAULT_BLOCK_CACHE_SIZE);
 
         ~PakArchive() override = default;
 
@@ -39,10 +55,16 @@ namespace xng {
 
         std::unique_ptr<std::iostream> openRW(const std::string &name) override;
 
+        FileView view(const std::string &path) override;
+
+        void read(const std::string &path, std::vector<char> &buffer) override;
+
+        bool list(std::vector<std::string> &paths) override;
+
+        struct State;
+
     private:
-        std::mutex mutex;
-        Pak pak;
-        bool verifyHashes;
+        std::shared_ptr<State> state;
     };
 }
 
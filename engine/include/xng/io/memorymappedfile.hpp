@@ -0,0 +1,54 @@
+/**
+ *   xEngine - C++ Game Engine Library
+ *   Copyright (C) 2026 Julia Zampiccoli
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU Lesser General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   Lesser General Public License for more details.
+ *
+ *   You should have received a copy of the Lesser General Public License
+ *   along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef XENGINE_MEMORYMAPPEDFILE_HPP
+#define XENGINE_MEMORYMAPPEDFILE_HPP
+
+#include <memory>
+#include <filesystem>
+
+namespace xng {
+    /**
+     * A read only view of a file mapped into the address space of the process.
+     */
+    class XENGINE_EXPORT MemoryMappedFile {
+    public:
+        /**
+         * Map the file at the given path.
+         *
+         * @param path
+         * @return
+         */
+        static std::unique_ptr<MemoryMappedFile> open(const std::filesystem::path &path);
+
+        /**
+         * Unmap the file, returned data pointers become invalid.
+         */
+        virtual ~MemoryMappedFile() = default;
+
+        /**
+         * @return The pointer to the first byte of the file or nullptr if the file is empty.
+         */
+        virtual const char *data() const = 0;
+
+        virtual size_t size() const = 0;
+    };
+}
+
+#endif //XENGINE_MEMORYMAPPEDFILE_HPP
@@ -0,0 +1,151 @@
+/**
+ *   xEngine - C++ Game Engine Library
+ *   Copyright (C) 2026 Julia Zampiccoli
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU Lesser General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   Lesser General Public License for more details.
+ *
+ *   You should have received a copy of the Lesser General Public License
+ *   along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef XENGINE_MEMORYSTREAM_HPP
+#define XENGINE_MEMORYSTREAM_HPP
+
+#include <streambuf>
+#include <istream>
+#include <vector>
+#include <algorithm>
+#include <memory>
+
+namespace xng {
+    /**
+     * A read only seekable stream buffer over a contiguous range of memory.
+     *
+     * The buffer either references memory owned by someone else (Eg. a memory mapped file),
+     * shares ownership of the memory through an owner pointer or owns the data passed in by vector.
+     */
+    class MemoryStreamBuf : public std::streambuf {
+    public:
+        MemoryStreamBuf(const char *data, size_t size) {
+            auto *begin = const_cast<char *>(data);
+            setg(begin, begin, begin + size);
+        }
+
+        /**
+         * @param owner Kept alive for the lifetime of the buffer, must keep the data valid.
+         */
+        MemoryStreamBuf(const char *data, size_t size, std::shared_ptr<const void> owner)
+                : owner(std::move(owner)) {
+            auto *begin = const_cast<char *>(data);
+            setg(begin, begin, begin + size);
+        }
+
+        explicit MemoryStreamBuf(std::vector<char> buffer)
+                : owned(std::move(buffer)) {
+            setg(owned.data(), owned.data(), owned.data() + owned.size());
+        }
+
+        MemoryStreamBuf(const MemoryStreamBuf &) = delete;
+
+        MemoryStreamBuf &operator=(const MemoryStreamBuf &) = delete;
+
+        /**
+         * @return Pointer to the data which has not been read yet
+         */
+        const char *current() const {
+            return gptr();
+        }
+
+        /**
+         * @return The number of bytes which have not been read yet
+         */
+        size_t available() const {
+            return static_cast<size_t>(egptr() - gptr());
+        }
+
+        /**
+         * Advance the read position without copying, count is clamped to the available bytes.
+         */
+        void skip(size_t count) {
+            setg(eback(), gptr() + std::min(count, available()), egptr());
+        }
+
+    protected:
+        std::streamsize xsgetn(char_type *s, std::streamsize count) override {
+            auto n = std::min(count, static_cast<std::streamsize>(egptr() - gptr()));
+            std::copy(gptr(), gptr() + n, s);
+            setg(eback(), gptr() + n, egptr()); // gbump takes an int
+            return n;
+        }
+
+        std::streamsize showmanyc() override {
+            auto n = egptr() - gptr();
+            return n > 0 ? n : -1;
+        }
+
+        pos_type seekoff(off_type off,
+                         std::ios_base::seekdir dir,
+                         std::ios_base::openmode which = std::ios_base::in) override {
+            if (!(which & std::ios_base::in))
+                return pos_type(off_type(-1));
+
+            off_type base;
+            if (dir == std::ios_base::beg)
+                base = 0;
+            else if (dir == std::ios_base::cur)
+                base = gptr() - eback();
+            else
+                base = egptr() - eback();
+
+            auto target = base + off;
+            if (target < 0 || target > egptr() - eback())
+                return pos_type(off_type(-1));
+
+            setg(eback(), eback() + target, egptr());
+            return pos_type(target);
+        }
+
+        pos_type seekpos(pos_type pos, std::ios_base::openmode which = std::ios_base::in) override {
+            return seekoff(off_type(pos), std::ios_base::beg, which);
+        }
+
+    private:
+        std::vector<char> owned;
+        std::shared_ptr<const void> owner;
+    };
+
+    /**
+     * An input stream which owns its MemoryStreamBuf.
+     */
+    class MemoryStream : public std::istream {
+    public:
+        MemoryStream(const char *data, size_t size)
+                : std::istream(nullptr), buf(data, size) {
+            rdbuf(&buf);
+        }
+
+        MemoryStream(const char *data, size_t size, std::shared_ptr<const void> owner)
+                : std::istream(nullptr), buf(data, size, std::move(owner)) {
+            rdbuf(&buf);
+        }
+
+        explicit MemoryStream(std::vector<char> buffer)
+                : std::istream(nullptr), buf(std::move(buffer)) {
+            rdbuf(&buf);
+        }
+
+    private:
+        MemoryStreamBuf buf;
+    };
+}
+
+#endif //XENGINE_MEMORYSTREAM_HPP
@@ -24,17 +24,33 @@
 #include <vector>
 #include <memory>
 #include <map>
+#include <mutex>
+#include <filesystem>
 
 #include "xng/crypto/aes.hpp"
 #include "xng/crypto/gzip.hpp"
 #include "xng/crypto/sha.hpp"
 
+#include "xng/io/memorymappedfile.hpp"
+
 namespace xng {
-    static const std::string PAK_FORMAT_VERSION = "01";
+    static const std::string PAK_FORMAT_VERSION = "02";
     static const std::string PAK_HEADER_MAGIC = "\xa9pak\xff" + PAK_FORMAT_VERSION + "\xa9";
+    static const std::string PAK_HEADER_MAGIC_V1 = "\xa9pak\xff" "01" "\xa9";
+    static const size_t PAK_DEFAULT_BLOCK_SIZE = 64 * 1024;
 
     /**
      * The pak file format
+     *
+     * Version 2 paks store a fixed size binary header followed by the entry data and a hashed entry index,
+     * lookups do not require parsing or allocating per entry.
+     * Version 1 paks are still loaded, their json header is converted into the version 2 index on load.
+     *
+     * Paks can be read from streams or memory mapped from files.
+     * The data of uncompressed and unencrypted entries in a memory mapped pak can be accessed without copying through getView.
+     *
+     * Compressed or encrypted entries may be stored as independently compressed, encrypted and hashed blocks,
+     * which allows decoding only the blocks of an entry that are actually read. (See getBlockTable)
      */
     class XENGINE_EXPORT Pak {
     public:
@@ -44,6 +60,36 @@ namespace xng {
             std::string hash;
         };
 
+        /**
+         * A pointer to the data of an entry inside a memory mapped pak file.
+         *
+         * The view stays valid as long as the pak or a copy of it exists.
+         */
+        struct EntryView {
+            const char *data = nullptr;
+            size_t size = 0;
+
+            explicit operator bool() const { return data != nullptr; }
+        };
+
+        struct Block {
+            size_t offset; // The global offset of the stored block data
+            size_t storedSize;
+            size_t size; // The size of the decoded block
+            std::string hash;
+        };
+
+        /**
+         * The blocks of an entry stored in blocks.
+         */
+        struct BlockTable {
+            size_t size = 0; // The size of the decoded entry
+            size_t blockSize = 0; // The size of all decoded blocks except the last
+            bool compressed = false;
+            bool encrypted = false;
+            std::vector<Block> blocks;
+        };
+
         Pak() = default;
 
         Pak(std::vector<std::reference_wrapper<std::istream>> streams, GZip &gzip, SHA &sha);
@@ -76,6 +122,38 @@ namespace xng {
                                 aes,
                                 std::move(key)) {}
 
+        /**
+         * Memory map the given chunk files.
+         *
+         * @param paths The chunk file paths in the order returned by PakBuilder::build
+         */
+        Pak(const std::vector<std::filesystem::path> &paths, GZip &gzip, SHA &sha);
+
+        /**
+         * Memory map the given chunk files.
+         *
+         * @param paths The chunk file paths in the order returned by PakBuilder::build
+         * @param key The key used to decrypt encrypted entries
+         */
+        Pak(const std::vector<std::filesystem::path> &paths,
+            GZip &gzip,
+            SHA &sha,
+            AES &aes,
+            AES::Key key);
+
+        Pak(const std::filesystem::path &path, GZip &gzip, SHA &sha)
+                : Pak(std::vector<std::filesystem::path>{path}, gzip, sha) {}
+
+        Pak(const std::filesystem::path &path,
+            GZip &gzip,
+            SHA &sha,
+            AES &aes,
+            AES::Key key) : Pak(std::vector<std::filesystem::path>{path},
+                                gzip,
+                                sha,
+                                aes,
+                                std::move(key)) {}
+
         /**
          * Load the pak entry from the corresponding chunk stream,
          * and optionally verify its hash.
@@ -88,24 +166,99 @@ namespace xng {
          */
         std::vector<char> get(const std::string &path, bool verifyHash = false);
 
-        bool exists(const std::string &path) {
-            return entries.find(path) != entries.end();
-        }
+        /**
+         * Load the pak entry into buffer, and optionally verify its hash.
+         *
+         * The entry is decoded directly into buffer so that the capacity of buffer is reused.
+         *
+         * @param path The path of the entry
+         * @param buffer Replaced by the entry data
+         * @param verifyHash If true the hash of the loaded data is checked against a hash stored in the pak header and an exception is thrown on mismatch.
+         */
+        void get(const std::string &path, std::vector<char> &buffer, bool verifyHash = false);
+
+        /**
+         * Return a view of the entry data without copying.
+         *
+         * A view is only available if the pak is memory mapped, the entry is neither compressed nor encrypted
+         * and the entry data does not span multiple chunks.
+         *
+         * @param path The path of the entry
+         * @param verifyHash If true the hash of the mapped data is checked against the hash stored in the pak index and an exception is thrown on mismatch.
+         * @return The view or an empty view if the entry data cannot be accessed without copying
+         */
+        EntryView getView(const std::string &path, bool verifyHash = false) const;
+
+        /**
+         * Load the block table of an entry.
+         *
+         * @param path The path of the entry
+         * @return The block table, the table contains no blocks if the entry is not stored in blocks.
+         */
+        BlockTable getBlockTable(const std::string &path);
+
+        /**
+         * Load and decode a single block of an entry.
+         *
+         * @param table The block table returned by getBlockTable
+         * @param block The index of the block
+         * @param verifyHash If true the hash of the decoded block is checked against the hash stored in the block table and an exception is thrown on mismatch.
+         * @return The decoded block data
+         */
+        std::vector<char> getBlock(const BlockTable &table, size_t block, bool verifyHash = false);
+
+        bool exists(const std::string &path) const;
 
-        const std::map<std::string, HeaderEntry> &getEntries() const { return entries; }
+        /**
+         * The entry map is built on the first call, concurrent calls are safe.
+         *
+         * @return The header entries with global offsets
+         */
+        const std::map<std::string, HeaderEntry> &getEntries() const;
+
+        /**
+         * @return True if the pak reads from memory mapped files, reads from mapped paks do not modify the pak and can be made concurrently.
+         */
+        bool isMapped() const { return !maps.empty(); }
+
+        /**
+         * @return The format version of the loaded pak file. ("01" or "02")
+         */
+        const std::string &getFormatVersion() const { return formatVersion; }
 
     private:
-        void loadHeader();
+        void load();
+
+        void loadHeaderV1();
 
-        size_t getRelativeOffset(size_t globalOffset);
+        void loadHeaderV2();
 
-        std::istream &getStreamForOffset(size_t globalOffset);
+        size_t getSourceCount() const;
+
+        size_t getSourceSize(size_t index) const;
+
+        void read(size_t globalOffset, char *destination, size_t size);
+
+        std::vector<char> decode(std::vector<char> data, bool compressed, bool encrypted);
+
+        BlockTable loadBlockTable(size_t recordIndex);
 
         std::vector<std::reference_wrapper<std::istream>> streams;
-        std::map<std::string, HeaderEntry> entries; // The header entries with global offsets
-        long chunkSize{};
-        bool encrypted{};
-        bool compressed{};
+        std::vector<std::shared_ptr<MemoryMappedFile>> maps;
+
+        std::shared_ptr<const std::vector<char>> indexBuffer; // Set if the index is not accessed directly from the mapped file
+        const char *index = nullptr;
+        size_t indexSize = 0;
+
+        struct EntryCache {
+            std::once_flag once;
+            std::map<std::string, HeaderEntry> entries;
+        };
+
+        std::shared_ptr<EntryCache> entries; // Shared by copies which also share the index
+
+        std::string formatVersion;
+        size_t chunkSize{};
 
         AES *aes = nullptr;
         AES::Key key{};
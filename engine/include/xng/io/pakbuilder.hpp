@@ -19,15 +19,51 @@
 #ifndef XENGINE_PAKBUILDER_HPP
 #define XENGINE_PAKBUILDER_HPP
 
+#include <filesystem>
+
 #include "xng/io/pak.hpp"
+#include "xng/async/threadpool.hpp"
 
 namespace xng {
+    /**
+     * Builds version 2 pak files.
+     *
+     * Entries are hashed, compressed and encrypted in parallel on a thread pool
+     * and written in path order, so the output does not depend on the number of threads.
+     * The SHA, GZip and AES implementations passed to build are invoked concurrently.
+     */
     class XENGINE_EXPORT PakBuilder {
     public:
-        PakBuilder() = default;
+        static const size_t DEFAULT_MAX_PENDING_BYTES = 64 * 1024 * 1024;
+
+        PakBuilder() : PakBuilder(ThreadPool::getPool()) {}
+
+        /**
+         * @param pool The pool to run the entry encoding on
+         * @param maxPendingBytes The number of bytes of entry data which may be encoded ahead of the output. A single larger entry is still encoded as a whole before it is written.
+         */
+        explicit PakBuilder(ThreadPool &pool, size_t maxPendingBytes = DEFAULT_MAX_PENDING_BYTES)
+                : pool(&pool), maxPendingBytes(maxPendingBytes) {}
 
         void addEntry(const std::string &name, const std::vector<char> &buffer);
 
+        /**
+         * Add an entry which is read from the given file when the pak is built.
+         *
+         * The file is hashed, compressed and written in pieces, only the stored (compressed / encrypted) data of the entry is held in memory.
+         *
+         * @param name
+         * @param file
+         */
+        void addEntry(const std::string &name, const std::filesystem::path &file);
+
+        /**
+         * Build a version 2 pak from the added entries.
+         *
+         * @param chunkSize If larger than zero the output is split into chunks of chunkSize bytes, must be zero or at least the size of the fixed pak header.
+         * @param blockSize If larger than zero compressed or encrypted entries larger than blockSize are stored in independently decodable blocks of blockSize bytes.
+         * @return The chunks of the pak file, a single chunk if chunkSize is zero
+         */
         std::vector<std::vector<char>> build(size_t chunkSize,
                                              bool compressData,
                                              bool encryptData,
@@ -35,10 +71,51 @@ namespace xng {
                                              GZip &zip,
                                              AES &aes,
                                              const AES::Key &key,
-                                             const AES::InitializationVector &iv);
+                                             const AES::InitializationVector &iv,
+                                             size_t blockSize = PAK_DEFAULT_BLOCK_SIZE);
+
+        /**
+         * Build a version 2 pak from the added entries and write it to disk while building.
+         *
+         * @param path The output file path, if chunkSize is larger than zero the chunk index is appended to the path of each chunk. ("assets.pak.0", "assets.pak.1", ...)
+         * @return The paths of the written chunk files in order
+         */
+        std::vector<std::filesystem::path> build(const std::filesystem::path &path,
+                                                 size_t chunkSize,
+                                                 bool compressData,
+                                                 bool encryptData,
+                                                 SHA &sha,
+                                                 GZip &zip,
+                                                 AES &aes,
+                                                 const AES::Key &key,
+                                                 const AES::InitializationVector &iv,
+                                                 size_t blockSize = PAK_DEFAULT_BLOCK_SIZE);
 
     private:
-        std::map<std::string, std::vector<char>> entries;
+        struct Entry {
+            std::shared_ptr<const std::vector<char>> buffer; // Null if the entry is read from file
+            std::filesystem::path file;
+        };
+
+        class ChunkWriter;
+
+        class MemoryChunkWriter;
+
+        class FileChunkWriter;
+
+        void build(ChunkWriter &writer,
+                   bool compressData,
+                   bool encryptData,
+                   SHA &sha,
+                   GZip &zip,
+                   AES &aes,
+                   const AES::Key &key,
+                   const AES::InitializationVector &iv,
+                   size_t blockSize);
+
+        ThreadPool *pool;
+        size_t maxPendingBytes;
+        std::map<std::string, Entry> entries;
     };
 }
 
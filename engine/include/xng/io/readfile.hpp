@@ -23,15 +23,80 @@
 #include <fstream>
 #include <sstream>
 #include <vector>
+#include <filesystem>
+#include <string_view>
+
+#include "xng/io/memorystream.hpp"
 
 namespace xng {
+    /**
+     * Read the remaining data of the stream into buffer.
+     *
+     * Seekable streams are read with a single read into a buffer of the remaining size,
+     * other streams are read in large chunks.
+     *
+     * @param stream
+     * @param buffer Replaced by the read data
+     */
+    template<typename T>
+    inline void readStream(std::istream &stream, std::vector<T> &buffer) {
+        static_assert(sizeof(T) == 1, "Buffer element type must be byte sized");
+
+        buffer.clear();
+
+        auto start = stream.tellg();
+        if (start != std::streampos(-1)) {
+            stream.seekg(0, std::ios::end);
+            auto end = stream.tellg();
+            stream.seekg(start);
+            if (end != std::streampos(-1) && end >= start) {
+                buffer.resize(static_cast<size_t>(end - start));
+                stream.read(reinterpret_cast<char *>(buffer.data()), static_cast<std::streamsize>(buffer.size()));
+                buffer.resize(static_cast<size_t>(stream.gcount()));
+                return;
+            }
+            stream.clear();
+        }
+
+        const size_t chunkSize = 64 * 1024;
+        while (stream) {
+            auto offset = buffer.size();
+            buffer.resize(offset + chunkSize);
+            stream.read(reinterpret_cast<char *>(buffer.data() + offset), chunkSize);
+            buffer.resize(offset + static_cast<size_t>(stream.gcount()));
+        }
+    }
+
+    /**
+     * Get the remaining data of the stream, consuming it.
+     *
+     * If the stream reads from a MemoryStreamBuf the returned view references the stream memory directly
+     * and no data is copied, otherwise the data is read into storage.
+     *
+     * @param stream
+     * @param storage Holds the data if the stream does not read from memory
+     * @return The view of the data, valid as long as the stream buffer and storage
+     */
+    inline std::string_view readStreamView(std::istream &stream, std::vector<char> &storage) {
+        auto *memory = dynamic_cast<MemoryStreamBuf *>(stream.rdbuf());
+        if (memory != nullptr) {
+            std::string_view ret(memory->current(), memory->available());
+            memory->skip(ret.size());
+            return ret;
+        }
+        readStream(stream, storage);
+        return {storage.data(), storage.size()};
+    }
+
     /**
      * @param path
      * @return
      */
     inline std::vector<char> readFile(const std::filesystem::path &path) {
         std::ifstream ifs(path, std::ios_base::in | std::ios::binary);
-        return {(std::istreambuf_iterator<char>(ifs)), std::istreambuf_iterator<char>()};
+        std::vector<char> ret;
+        readStream(ifs, ret);
+        return ret;
     }
 
     /**
@@ -0,0 +1,154 @@
+/**
+ *   xEngine - C++ Game Engine Library
+ *   Copyright (C) 2026 Julia Zampiccoli
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU Lesser General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   Lesser General Public License for more details.
+ *
+ *   You should have received a copy of the Lesser General Public License
+ *   along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef XENGINE_DRAWCULLER_HPP
+#define XENGINE_DRAWCULLER_HPP
+
+#include <cstdint>
+#include <vector>
+
+#include "xng/math/matrix.hpp"
+#include "xng/math/vector3.hpp"
+
+namespace xng {
+    /**
+     * Frustum culling and distance sorting of draw calls on the cpu.
+     *
+     * The world space bounding boxes of the draws are stored as separate center / extent arrays
+     * so the plane tests over all draws compile to vector instructions.
+     * The culler does not depend on a runtime and can be used headless.
+     */
+    class XENGINE_EXPORT DrawCuller {
+    public:
+        enum SortOrder {
+            SORT_NONE = 0, // Draws keep their submission order
+            SORT_FRONT_TO_BACK, // Nearest draws first, for opaque draws to reduce overdraw
+            SORT_BACK_TO_FRONT, // Farthest draws first, for blended draws
+        };
+
+        struct Statistics {
+            size_t draws = 0; // The number of tested draws
+            size_t culled = 0; // The number of draws outside the frustum
+            size_t submitted = 0; // The number of draws which survived culling
+
+            Statistics &operator+=(const Statistics &other) {
+                draws += other.draws;
+                culled += other.culled;
+                submitted += other.submitted;
+                return *this;
+            }
+        };
+
+        /**
+         * Set the camera used for culling and sorting.
+         * Until a camera is set no draws are culled.
+         *
+         * @param position The camera position in world space
+         * @param view
+         * @param projection
+         */
+        void setCamera(const Vec3f &position, const Mat4f &view, const Mat4f &projection);
+
+        void setEnableCulling(bool enable) {
+            enableCulling = enable;
+        }
+
+        bool isCullingEnabled() const {
+            return enableCulling;
+        }
+
+        void setSortOrder(SortOrder order) {
+            sortOrder = order;
+        }
+
+        SortOrder getSortOrder() const {
+            return sortOrder;
+        }
+
+        /**
+         * @return True if cull() culls or reorders the draws.
+         */
+        bool isEnabled() const {
+            return enableCulling || sortOrder != SORT_NONE;
+        }
+
+        /**
+         * Remove all draws.
+         */
+        void clear();
+
+        void reserve(size_t count);
+
+        /**
+         * Add a draw with the given local space bounding box.
+         *
+         * @param boundsMin The minimum of the local space bounding box
+         * @param boundsMax The maximum of the local space bounding box
+         * @param model The model matrix of the draw
+         */
+        void add(const Vec3f &boundsMin, const Vec3f &boundsMax, const Mat4f &model);
+
+        /**
+         * Add a draw without known bounds (Eg. skinned meshes) which is never culled
+         * and sorted by the translation of the model matrix.
+         *
+         * @param model The model matrix of the draw
+         */
+        void addUnbounded(const Mat4f &model);
+
+        size_t size() const {
+            return centerX.size();
+        }
+
+        /**
+         * Cull and sort the added draws.
+         *
+         * Boxes intersecting the frustum are conservatively reported as visible.
+         * Draws with equal distance keep their relative order.
+         *
+         * @param visible Assigned the indices of the visible draws in the order of add() calls, sorted by distance to the camera if a sort order is set.
+         * @return The statistics of this invocation.
+         */
+        Statistics cull(std::vector<unsigned int> &visible);
+
+    private:
+        bool enableCulling = false;
+        SortOrder sortOrder = SORT_NONE;
+
+        Vec3f cameraPosition;
+
+        // Frustum planes pointing inwards, left, right, bottom, top, near, far
+        float planeX[6]{};
+        float planeY[6]{};
+        float planeZ[6]{};
+        float planeW[6]{};
+
+        std::vector<float> centerX;
+        std::vector<float> centerY;
+        std::vector<float> centerZ;
+        std::vector<float> extentX;
+        std::vector<float> extentY;
+        std::vector<float> extentZ;
+
+        std::vector<uint8_t> inside;
+        std::vector<uint64_t> sortKeys;
+    };
+}
+
+#endif //XENGINE_DRAWCULLER_HPP
@@ -41,6 +41,7 @@ namespace xng {
             : heap(runtime.getResourceHeap()),
               chunkStreamer(chunkStreamer),
               meshStreamer(meshStreamer),
+              meshRevision(meshStreamer.getRevision()),
               virtualTextureStreamer(virtualTextureStreamer),
               layout(std::move(_layout)),
               materialLayout(getMaterialLayout(layout)),
@@ -87,8 +88,14 @@ namespace xng {
 
         void setEnableDistanceSort(bool enable) override;
 
+        void setDistanceSortOrder(DrawCuller::SortOrder order) override;
+
         void setEnableDrawCulling(bool enable) override;
 
+        DrawCuller::Statistics getDrawStatistics() const override {
+            return drawStatistics;
+        }
+
         void commit(RenderQueue &queue) override;
 
         void prepare(RenderQueue &queue) override;
@@ -121,10 +128,12 @@ namespace xng {
             }
 
             void setTransform(const Transform &t) override {
-                buffer.upload(slot, t.model());
+                model = t.model();
+                buffer.upload(slot, model);
             }
 
-            void setTransform(const Mat4f &model) override {
+            void setTransform(const Mat4f &value) override {
+                model = value;
                 buffer.upload(slot, model);
             }
 
@@ -132,6 +141,13 @@ namespace xng {
                 return slot;
             }
 
+            /**
+             * @return The cpu copy of the model matrix for culling
+             */
+            [[nodiscard]] const Mat4f &getModel() const {
+                return model;
+            }
+
             bool isUploadComplete() override {
                 return buffer.isUploadComplete(slot);
             }
@@ -143,6 +159,7 @@ namespace xng {
         private:
             BufferStreamer<Mat4f> &buffer;
             BufferStreamer<Mat4f>::Slot slot;
+            Mat4f model = MatrixMath::identity();
         };
 
         class RenderPipelineMaterialIndirect final : public RenderPipelineMaterial {
@@ -247,6 +264,12 @@ namespace xng {
             }
         };
 
+        struct DrawBounds {
+            Vec3f min;
+            Vec3f max;
+            bool bounded = false; // False if the bounds are unknown on the cpu (Skinned meshes)
+        };
+
         struct BufferAccessRangeHasher {
             size_t operator()(const BufferAccessRange &p) const noexcept {
                 size_t ret;
@@ -270,6 +293,7 @@ namespace xng {
             std::unordered_set<BufferAccessRange, BufferAccessRangeHasher> indexBufferAccessRanges;
 
             std::vector<ShaderDrawCall::CPU> drawCallData;
+            std::vector<DrawBounds> drawCallBounds; // The local space mesh bounds of each entry in drawCallData
 
             DrawCall() = default;
 
@@ -292,8 +316,17 @@ namespace xng {
                 return transform->isUploadComplete() && material->isUploadComplete();
             }
 
+            /**
+             * Load the draw call data from the mesh allocations, called again when compaction relocated meshes.
+             */
             void loadData() {
                 assert(isUploadComplete());
+                transformAccessRanges.clear();
+                materialAccessRanges.clear();
+                vertexBufferAccessRanges.clear();
+                indexBufferAccessRanges.clear();
+                drawCallData.clear();
+                drawCallBounds.clear();
                 for (auto &mesh: meshes) {
                     const auto alloc = mesh.get().getAllocation();
                     ShaderDrawCall::CPU c;
@@ -308,6 +341,7 @@ namespace xng {
                     c.materialIndex = dm.getSlot();
 
                     drawCallData.emplace_back(c);
+                    drawCallBounds.push_back({alloc.boundsMin, alloc.boundsMax, !alloc.skinned});
 
                     transformAccessRanges.insert({dt.getSlot() * sizeof(Mat4f), sizeof(Mat4f)});
                     materialAccessRanges.insert({dm.getSlot() * sizeof(Mat4f), sizeof(Mat4f)});
@@ -339,6 +373,20 @@ namespace xng {
 
             bool updateDrawCallBuffer = false;
 
+            // The draw calls of all members, the draw call buffer contains the visible subset if culling / sorting is enabled.
+            std::vector<ShaderDrawCall::CPU> drawCallData;
+            std::vector<DrawBounds> drawCallBounds;
+            std::vector<const RenderPipelineTransformIndirect *> drawCallTransforms;
+
+            std::vector<unsigned int> visibleDrawCalls;
+            std::vector<ShaderDrawCall::CPU> visibleDrawCallData;
+
+            // The visible draw calls in the draw call buffer, valid if the buffer contains a culled / sorted subset.
+            std::vector<unsigned int> uploadedDrawCalls;
+            bool uploadedDrawCallsValid = false;
+
+            size_t drawCallCount = 0; // The number of draw calls in the draw call buffer
+
             rg::HeapResource<rg::Buffer> indirectBuffer{};
             rg::HeapResource<rg::Buffer> indirectCountBuffer{};
 
@@ -360,17 +408,17 @@ namespace xng {
 
             DrawList(rg::Heap &resourceHeap, ChunkStreamer &chunkStreamer);
 
-            void commit(RenderQueue &queue,
-                        rg::Heap &resourceHeap,
-                        const std::unordered_map<DrawID, DrawCall> &callMap);
-
-            size_t getDrawCallCount(const std::unordered_map<DrawID, DrawCall> &drawMap) const {
-                size_t ret = 0;
-                for (auto &id: drawCalls) {
-                    ret += drawMap.at(id).drawCallData.size();
-                }
-                return ret;
-            }
+            /**
+             * Update the draw call buffer if the members or the visible draw calls changed.
+             *
+             * @return The culling statistics
+             */
+            DrawCuller::Statistics commit(RenderQueue &queue,
+                                          rg::Heap &resourceHeap,
+                                          const std::unordered_map<DrawID, DrawCall> &callMap,
+                                          DrawCuller &culler);
+
+            void updateMembers(rg::Heap &resourceHeap, const std::unordered_map<DrawID, DrawCall> &callMap);
         };
 
         static LayoutStd140 getMaterialLayout(const MaterialLayout &layout) {
@@ -410,6 +458,7 @@ namespace xng {
         rg::Heap &heap;
         ChunkStreamer &chunkStreamer;
         MeshStreamer &meshStreamer;
+        size_t meshRevision = 0; // The mesh streamer revision the draw call data was loaded from
         VirtualTextureStreamer &virtualTextureStreamer;
 
         const MaterialLayout layout;
@@ -421,9 +470,14 @@ namespace xng {
         GenericBufferStreamer materialStreamer;
         BufferStreamer<Mat4f> transformStreamer;
 
-        // Per sortPriority draw lists which are drawn in order and each draw list is additionally sorted in prepass based on camera distance.
+        // Per sortPriority draw lists which are drawn in order and each draw list is additionally culled and sorted based on camera distance.
         std::map<int, DrawList> drawLists{};
 
+        bool enableDistanceSort = false;
+        DrawCuller::SortOrder distanceSortOrder = DrawCuller::SORT_FRONT_TO_BACK;
+        DrawCuller culler;
+        DrawCuller::Statistics drawStatistics;
+
         std::unordered_map<DrawID, DrawCall> drawCalls{};
         std::unordered_set<DrawID> pendingDrawCalls{};
 
@@ -22,6 +22,7 @@
 #include "xng/renderer/objects/rendertexture.hpp"
 #include "xng/renderer/objects/rendermesh.hpp"
 
+#include "xng/renderer/pipeline/drawculler.hpp"
 #include "xng/renderer/pipeline/renderpipelinecompiler.hpp"
 #include "xng/renderer/pipeline/renderpipelinematerial.hpp"
 #include "xng/renderer/pipeline/renderpipelinetransform.hpp"
@@ -111,15 +112,27 @@ namespace xng {
         virtual void setEnableDistanceSort(bool enable) = 0;
 
         /**
-         * The pipeline will cull draw calls in prepare() if enabled.
+         * Set the order of the distance sort, front to back by default.
+         * Pipelines drawing blended geometry should sort back to front.
          *
-         * Currently, this is just a stub because for proper draw culling mesh volumes are required.
-         * This will be properly implemented with meshlet support.
+         * @param order The sort order, SORT_NONE is equivalent to setEnableDistanceSort(false)
+         */
+        virtual void setDistanceSortOrder(DrawCuller::SortOrder order) = 0;
+
+        /**
+         * The pipeline will cull draw calls whose mesh bounding box is outside the camera frustum in commit() if enabled.
+         *
+         * Skinned meshes are never culled because their bounds are not known on the cpu.
          *
          * @param enable Whether to enable draw call culling.
          */
         virtual void setEnableDrawCulling(bool enable) = 0;
 
+        /**
+         * @return The culling statistics of the last commit()
+         */
+        virtual DrawCuller::Statistics getDrawStatistics() const = 0;
+
         /**
          * Commit the internal buffers of the pipeline.
          *
@@ -19,6 +19,8 @@
 #ifndef XENGINE_RENDERER_HPP
 #define XENGINE_RENDERER_HPP
 
+#include <deque>
+
 #include "xng/rendergraph/runtime.hpp"
 
 #include "xng/renderer/renderscene.hpp"
@@ -27,7 +29,6 @@
 #include "xng/io/byte.hpp"
 
 namespace xng {
-    // TODO: Frames in flight implementation
     // TODO: Fix ghosting (Might be linux compositor related or broken synchronization in gl adapter)
     class XENGINE_EXPORT Renderer {
     public:
@@ -45,14 +46,57 @@ namespace xng {
                  size_t streamingBudget,
                  const rg::Shader &skinningShader);
 
+        /**
+         * Waits for frames in flight so that the chunk streamer staging ring is not released while in use.
+         */
+        ~Renderer() {
+            synchronize();
+        }
+
         std::shared_ptr<RenderScene> createScene(size_t tileSize = 256,
                                                  size_t tileBorder = 9,
                                                  float maxAnisotropy = 16);
 
         void setPasses(std::vector<std::shared_ptr<RenderPass> > passes);
 
+        /**
+         * Record and submit a frame.
+         *
+         * Returns once at most getFramesInFlight() - 1 submitted frames are still executing,
+         * so the cpu can prepare the next frame while the gpu executes the previous frames.
+         *
+         * @param surface The surface to draw to
+         * @param scene The scene to draw
+         */
         void draw(const std::shared_ptr<rg::Surface> &surface, RenderScene &scene);
 
+        /**
+         * The number of frames which may be executing on the gpu while the cpu records the next frame.
+         *
+         * A value of 1 waits for every frame to finish at the end of draw().
+         *
+         * Per frame resources (Streaming staging buffers) are recycled once the frame that used them has finished,
+         * so a higher value trades memory and latency for cpu / gpu overlap.
+         *
+         * @param count The maximum number of submitted frames executing concurrently. (Default 2)
+         */
+        void setFramesInFlight(size_t count);
+
+        size_t getFramesInFlight() const;
+
+        /**
+         * Wait for all submitted frames to finish executing.
+         *
+         * Must be called before destroying scenes or resources which were drawn with this renderer.
+         */
+        void synchronize();
+
+        /**
+         * The gpu timings (gpuTime) are from the most recently finished frame, which is the frame submitted
+         * getFramesInFlight() - 1 draw() invocations earlier.
+         *
+         * @return The statistics of the last draw() invocation.
+         */
         RendererStatistics getStatistics() const;
 
     private:
@@ -60,6 +104,8 @@ namespace xng {
 
         rg::ComputePass recordSkinningPass(const RenderScene &scene) const;
 
+        void waitFrame();
+
         rg::Runtime &runtime;
         ChunkStreamer chunkStreamer;
         rg::PipelineCache::Handle skinningPipeline;
@@ -69,6 +115,9 @@ namespace xng {
         RendererStatistics stats;
 
         size_t streamingBudget;
+
+        size_t framesInFlight = 2;
+        std::deque<std::shared_ptr<rg::Fence> > inFlightFrames;
     };
 }
 
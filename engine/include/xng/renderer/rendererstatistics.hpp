@@ -31,7 +31,8 @@ namespace xng {
         std::string renderer{};
         std::string version{};
 
-        size_t drawCalls = 0;
+        size_t drawCalls = 0; // The number of draw calls submitted to the gpu after culling
+        size_t culledDrawCalls = 0; // The number of draw calls culled on the cpu
         size_t polygons = 0;
 
         size_t bufferVRamUsage = 0;
@@ -39,6 +40,8 @@ namespace xng {
         size_t bufferVRamDownload = 0;
         size_t bufferVRamCopy = 0;
 
+        size_t lightBufferUpload = 0; // The number of light bytes uploaded this frame, only changed lights are uploaded.
+
         size_t textureVRamUsage = 0;
         size_t textureVRamUpload = 0;
         size_t textureVRamDownload = 0;
@@ -46,10 +49,13 @@ namespace xng {
 
         size_t tilesInFlight = 0;
 
+        float meshFragmentation = 0; // The fraction of the used mesh buffer memory occupied by holes of destroyed meshes
+        size_t meshReclaimedBytes = 0; // The number of mesh buffer bytes released by compaction since the scene was created
+
         std::chrono::high_resolution_clock::time_point frameStart;
         std::chrono::high_resolution_clock::time_point frameSubmit;
-        std::chrono::high_resolution_clock::time_point frameEnd;
-        std::vector<std::pair<std::string, std::chrono::nanoseconds>> gpuTime;
+        std::chrono::high_resolution_clock::time_point frameEnd; // frameEnd - frameSubmit is the time spent waiting on frames in flight
+        std::vector<std::pair<std::string, std::chrono::nanoseconds>> gpuTime; // The pass timings of the most recently finished frame
 
         size_t streamingBudgetMax;
 
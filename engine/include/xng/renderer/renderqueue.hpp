@@ -64,6 +64,21 @@ namespace xng {
             return fence;
         }
 
+        /**
+         * The returned fence is signaled when the frame graph (pre frame, frame and post frame passes) submitted by
+         * the next submit() invocation has finished executing.
+         *
+         * Used for recycling per frame resources when multiple frames are in flight.
+         *
+         * @return The fence of the frame that is currently being recorded.
+         */
+        std::shared_ptr<SubmitFence> getFrameFence() {
+            if (frameFence == nullptr) {
+                frameFence = std::make_shared<SubmitFence>();
+            }
+            return frameFence;
+        }
+
         void addFrame(rg::Pass pass) {
             frame.addPass(std::move(pass));
         }
@@ -89,6 +104,10 @@ namespace xng {
             for (auto &fence: postFrameFences) {
                 fence->fence = postFrameFence;
             }
+            if (frameFence != nullptr) {
+                frameFence->fence = postFrameFence;
+                frameFence = nullptr;
+            }
             preFrame.clear();
             frame = rg::GraphBuilder();
             postFrame.clear();
@@ -104,6 +123,8 @@ namespace xng {
         rg::GraphBuilder frame;
         std::vector<rg::Pass> postFrame;
         std::vector<std::shared_ptr<SubmitFence> > postFrameFences;
+
+        std::shared_ptr<SubmitFence> frameFence = nullptr;
     };
 }
 
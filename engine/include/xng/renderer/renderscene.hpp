@@ -39,6 +39,7 @@
 #include "xng/renderer/objects/renderspotlight.hpp"
 
 #include "xng/renderer/pipeline/renderpipeline.hpp"
+#include "xng/renderer/stream/slotarray.hpp"
 #include "xng/renderer/renderqueue.hpp"
 
 #include "xng/renderer/renderpath.hpp"
@@ -252,6 +253,11 @@ namespace xng {
 
         void prepare(RenderQueue &queue);
 
+        /**
+         * @return The summed culling statistics of the pipelines of the scene from the last commit()
+         */
+        DrawCuller::Statistics getDrawStatistics() const;
+
         const RenderPipeline &getPbrDeferredPipeline() const {
             return *pbrDeferredPipeline;
         }
@@ -324,6 +330,13 @@ namespace xng {
             return meshStreamer;
         }
 
+        /**
+         * @param budget The cpu time spent per commit on moving meshes into the holes left by destroyed meshes.
+         */
+        void setMeshCompactionBudget(const std::chrono::microseconds budget) {
+            meshStreamer.setCompactionBudget(budget);
+        }
+
         rg::HeapResource<rg::Buffer> getPointLightBuffer() const {
             return pointLightBuffer.getBuffer();
         }
@@ -336,6 +349,13 @@ namespace xng {
             return spotLightBuffer.getBuffer();
         }
 
+        /**
+         * @return The number of light bytes uploaded by the last commit()
+         */
+        size_t getLightUploadBytes() const {
+            return lightUploadBytes;
+        }
+
         const RenderObjectHandle<RenderMesh> &getUnitQuadMesh() const {
             return unitQuadMesh;
         }
@@ -406,17 +426,19 @@ namespace xng {
         StreamBuffer directionalLightBuffer;
         StreamBuffer spotLightBuffer;
 
-        StreamBuffer::Handle pointLightBufferHandle{};
-        StreamBuffer::Handle directionalLightBufferHandle{};
-        StreamBuffer::Handle spotLightBufferHandle{};
+        // Each light owns a stable slot in the light buffer of its type, destroyed slots are zeroed lights.
+        SlotArray<ShaderPointLight::CPU> pointLightSlots;
+        SlotArray<ShaderDirectionalLight::CPU> directionalLightSlots;
+        SlotArray<ShaderSpotLight::CPU> spotLightSlots;
+
+        std::unordered_map<RenderObject::ID, unsigned int> lightSlots;
 
-        bool pointLightResident = false;
-        bool directionalLightResident = false;
-        bool spotLightResident = false;
+        // The uploads of the previous commit, released on the next commit after they finished
+        std::vector<StreamBuffer::Handle> pointLightUploads;
+        std::vector<StreamBuffer::Handle> directionalLightUploads;
+        std::vector<StreamBuffer::Handle> spotLightUploads;
 
-        bool reuploadPointLights = false;
-        bool reuploadDirectionalLights = false;
-        bool reuploadSpotLights = false;
+        size_t lightUploadBytes = 0;
 
         Camera camera;
 
@@ -67,6 +67,10 @@ namespace xng {
             return streamer.getBuffer();
         }
 
+        StreamBuffer::Statistics getStatistics() const {
+            return streamer.getStatistics();
+        }
+
     private:
         GenericBufferStreamer streamer;
     };
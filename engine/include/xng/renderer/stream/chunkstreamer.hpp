@@ -16,64 +16,64 @@
  *   along with this program.  If not, see <https://www.gnu.org/licenses/>.
  */
 
+
 #ifndef XENGINE_CHUNKSTREAMER_HPP
 #define XENGINE_CHUNKSTREAMER_HPP
 
+#include <algorithm>
 #include <cstddef>
 #include <cstdint>
+#include <cstring>
+#include <deque>
+#include <map>
+#include <optional>
 #include <utility>
 
 #include "xng/renderer/renderqueue.hpp"
 #include "xng/rendergraph/heap.hpp"
 #include "xng/rendergraph/builder/graphbuilder.hpp"
 #include "xng/rendergraph/resource/buffer.hpp"
-#include "xng/util/rangeallocator.hpp"
 
 namespace xng {
     /**
      * There should only be one instance of a chunk streamer shared among all streamers.
      *
-     * chunkSize * chunkCount is the expected streaming budget.
-     * The budget is never exceeded without flushing.
-     *
-     * Flushed uploads can cause the chunk streamer to allocate new chunks and exceed the streaming budget.
-     *
-     * This allows hard flushes at the cost of dynamic allocation of staging buffers on budget overflow.
+     * chunkSize * chunkCount is the size of the staging ring, which is the streaming budget.
      *
-     * A large chunkSize means bigger chunk buffer allocations if a flushed upload requires new chunks beyond pinnedChunks.
-     * A small chunkSize means more copy commands per upload but more granular streaming priority because the
-     * non⁻flushed transfers from previous frames may complete faster and become available for flushed transfers.
+     * Upload works by suballocating ranges of at most chunkSize bytes from a staging ring in ram and then copying
+     * the ranges from the staging ring into the same ranges of a back buffer ring and from the back buffer ring
+     * to the target buffer.
      *
-     * Upload works by splitting the uploaded data into fixed size chunks in ram and then uploading individual chunks
-     * by copying into fixed size (chunkSize) staging buffers and from staging buffers to chunk sized back buffers
-     * and from back buffers to the target buffer.
+     * A range flows like so:
      *
-     * A chunk flows like so:
-     *
-     * RAM -> Staging Buffer
+     * RAM -> Staging Ring
      *  - Cpu Copy into driver managed memory
+     *      The ring is mapped unsynchronized, ranges are only reused after the fences of their transfers are signaled.
      *
-     * Staging Buffer -> Back Buffer
+     * Staging Ring -> Back Buffer Ring
      *  - Hardware Copy in transfer context (Dedicated Transfer Queue on vulkan)
      *
-     * Back Buffer -> Target Buffer
+     * Back Buffer Ring -> Target Buffer
      *  - Hardware Copy in render context (Dedicated Graphics Queue on vulkan)
      *      The Graphics queue submission will here wait on a semaphore signaled by the Staging -> BackBuffer copy and
      *      perform the ownership transfer. As this copy is only ever started once the Staging -> BackBuffer copy has
      *      finished (Except Flushed uploads) there is no stall on the graphics queue.
      *
-     * Each chunk gets their own back buffer and thus allows the graphics queue to copy the streamed data without stalling on
-     * in flight uploads.
+     * Ranges are allocated from the ring in order and returned in order once the frame containing the copy into the
+     * target (or the transfer of a released upload) has finished executing, so the staging memory is never written
+     * while in flight, regardless of the number of frames in flight.
+     *
+     * Scheduling:
      *
-     * TODO: Implement ChunkStreamer upload priorities
+     *  Each commit() stages at most the frame budget in bytes. Flushed uploads are staged completely without
+     *  counting towards the budget, if the ring is full they are staged in a temporary buffer instead of waiting.
      *
-     *  Now the chunk streamer can get oversaturated when many uploads are kicked off in one frame and released in the next frame
-     *  which can cause the chunk streamer to lock up and not reach the existing stable uploads. This will be
-     *  solved with upload priority queues where new uploads on the same priority will be processed only after existing ones.
-     *  Also when the user flushes over the chunkCount the non flushed uploads are never reached which can be solved with
-     *  per priority budgets or by not counting flushed uploads to the upload bound.
+     *  Then the oldest pending upload always receives one range, which guarantees that every upload completes
+     *  no matter how saturated the streamer is, and the remaining budget is distributed by descending priority
+     *  and in upload order within a priority.
      *
-     * TODO: (Maybe) Sub Chunk allocation
+     *  Uploads which arrive while nothing is queued are written directly into the staging ring by upload(),
+     *  otherwise the data is kept until the upload is scheduled.
      */
     class ChunkStreamer {
     public:
@@ -81,136 +81,125 @@ namespace xng {
 
         static constexpr Handle INVALID_HANDLE = 0;
 
+        struct Statistics {
+            size_t stagedBytes = 0; // The number of bytes staged in the staging ring for the last commit
+            size_t overflowBytes = 0; // The number of flushed bytes staged in temporary buffers because the ring was full
+            size_t copiedBytes = 0; // The number of bytes copied into target buffers by the last commit
+            size_t pendingBytes = 0; // The number of bytes waiting to be staged after the last commit
+            size_t stagingUsed = 0; // The number of staging ring bytes in use after the last commit
+        };
+
         ChunkStreamer(const ChunkStreamer &other) = delete;
 
         ChunkStreamer &operator=(const ChunkStreamer &other) = delete;
 
         /**
          * @param heap The heap to use for streaming
-         * @param chunkSize The size of one streaming chunk.
-         * @param chunkCount The minimum number of chunk buffers to keep allocated. (Flushing can allocate new chunks)
+         * @param chunkSize The maximum size of one staged range.
+         * @param chunkCount The size of the staging ring in chunks.
          */
         ChunkStreamer(rg::Heap &heap,
                       const size_t chunkSize,
                       const size_t chunkCount)
             : heap(heap),
               chunkSize(chunkSize),
-              pinnedChunkBuffers(chunkCount) {
-            for (auto i = 0; i < pinnedChunkBuffers; i++) {
-                freeChunkBuffers.emplace_back(heap, chunkSize);
+              ringSize(chunkSize * chunkCount),
+              frameBudget(std::max(chunkSize, ringSize / 4)),
+              stagingRing(heap.allocateBuffer(rg::Buffer(ringSize,
+                                                         rg::Buffer::CAPABILITY_TRANSFER_SRC,
+                                                         rg::Buffer::MEMORY_CPU_TO_GPU))),
+              backBufferRing(heap.allocateBuffer(rg::Buffer(ringSize,
+                                                            rg::Buffer::CAPABILITY_TRANSFER_SRC
+                                                            | rg::Buffer::CAPABILITY_TRANSFER_DST,
+                                                            rg::Buffer::MEMORY_GPU_ONLY))) {
+            if (chunkSize == 0 || chunkCount == 0) {
+                throw std::runtime_error("Invalid chunk streamer size");
             }
         }
 
+        /**
+         * @param data The data to upload, copied before returning.
+         * @param dataSize The size of the data
+         * @param targetBuffer The buffer to upload to
+         * @param targetOffset The offset in the target buffer
+         * @param priority Uploads with higher priority are staged first.
+         * @return The handle of the upload
+         */
         Handle upload(const uint8_t *data,
                       const size_t dataSize,
                       const rg::HeapResource<rg::Buffer> &targetBuffer,
-                      const size_t targetOffset) {
-            return upload(std::vector(data, data + dataSize), targetBuffer, targetOffset);
+                      const size_t targetOffset,
+                      const int priority = 0) {
+            const auto ret = createUpload(dataSize, targetBuffer, targetOffset, priority);
+            auto &upload = uploads.at(ret);
+            stageDirect(ret, data);
+            if (upload.stagedBytes < upload.size) {
+                upload.data = std::vector(data + upload.stagedBytes, data + dataSize);
+                upload.dataOffset = upload.stagedBytes;
+                enqueue(ret);
+            }
+            return ret;
         }
 
         Handle upload(std::vector<uint8_t> data,
                       const rg::HeapResource<rg::Buffer> &targetBuffer,
-                      const size_t targetOffset) {
-            if (!(targetBuffer.getDescription().capabilityFlags & rg::Buffer::CAPABILITY_TRANSFER_DST)) {
-                throw std::runtime_error("Target buffer must have CAPABILITY_TRANSFER_DST capability");
-            }
-
-            Handle ret;
-            if (freeHandles.empty()) {
-                ret = nextHandle++;
-            } else {
-                ret = freeHandles.back();
-                freeHandles.pop_back();
+                      const size_t targetOffset,
+                      const int priority = 0) {
+            const auto ret = createUpload(data.size(), targetBuffer, targetOffset, priority);
+            auto &upload = uploads.at(ret);
+            stageDirect(ret, data.data());
+            if (upload.stagedBytes < upload.size) {
+                upload.data = std::move(data);
+                upload.dataOffset = 0;
+                enqueue(ret);
             }
-
-            const auto dataSize = data.size();
-            if (dataSize > chunkSize) {
-                const auto nChunks = (dataSize + chunkSize - 1) / chunkSize;
-                const auto remainder = dataSize % chunkSize;
-                if (remainder > 0) {
-                    for (auto i = 0; i < nChunks - 1; i++) {
-                        const auto chunkOffset = i * chunkSize;
-                        pendingChunks[ret].insert({
-                            pendingChunks[ret].size(),
-                            UploadChunk{
-                                targetOffset + chunkOffset,
-                                chunkOffset,
-                                chunkSize
-                            }
-                        });
-                    }
-                    const auto chunkOffset = (nChunks - 1) * chunkSize;
-                    pendingChunks[ret].insert({
-                        pendingChunks[ret].size(),
-                        UploadChunk{
-                            targetOffset + chunkOffset,
-                            chunkOffset,
-                            remainder
-                        }
-                    });
-                } else {
-                    for (auto i = 0; i < nChunks; i++) {
-                        const auto chunkOffset = i * chunkSize;
-                        pendingChunks[ret].insert({
-                            pendingChunks[ret].size(),
-                            UploadChunk{
-                                targetOffset + chunkOffset,
-                                chunkOffset,
-                                chunkSize
-                            }
-                        });
-                    }
-                }
-            } else {
-                pendingChunks[ret].insert({pendingChunks[ret].size(), UploadChunk{targetOffset, 0, dataSize}});
-            }
-
-            uploadData.emplace(ret, std::move(data));
-
-            targetBuffers[ret] = targetBuffer;
-
             return ret;
         }
 
         void release(const Handle handle) {
-            if (handle == INVALID_HANDLE) {
-                throw std::runtime_error("Invalid handle");
-            }
+            auto &upload = getUpload(handle);
 
-            targetBuffers.erase(handle);
-            uploadData.erase(handle);
-            pendingChunks.erase(handle);
-            flushedUploads.erase(handle);
+            pendingBytes -= upload.size - upload.stagedBytes;
 
-            const auto it = pendingChunkBuffers.find(handle);
-            if (it != pendingChunkBuffers.end()) {
-                for (auto &buffer: it->second) {
-                    if (freeChunkBuffers.size() >= pinnedChunkBuffers) {
-                        break;
-                    }
-                    buffer.pendingTransfer = nullptr;
-                    freeChunkBuffers.emplace_back(std::move(buffer));
+            // Ranges which were never submitted can be reused immediately,
+            // the transfer of submitted ranges might still be in flight.
+            for (auto &piece: stagedPieces) {
+                if (piece.handle == handle) {
+                    retireRange(piece.ringEntry, nullptr);
+                }
+            }
+            stagedPieces.erase(std::remove_if(stagedPieces.begin(),
+                                              stagedPieces.end(),
+                                              [handle](const Piece &piece) { return piece.handle == handle; }),
+                               stagedPieces.end());
+            for (auto &piece: transferringPieces) {
+                if (piece.handle == handle) {
+                    retireRange(piece.ringEntry, piece.transfer);
                 }
-                pendingChunkBuffers.erase(handle);
             }
+            transferringPieces.erase(std::remove_if(transferringPieces.begin(),
+                                                    transferringPieces.end(),
+                                                    [handle](const Piece &piece) { return piece.handle == handle; }),
+                                     transferringPieces.end());
 
+            upload = {};
             freeHandles.push_back(handle);
         }
 
+        /**
+         * @param handle The upload handle
+         * @return True if the upload was flushed or all data has been copied into the target buffer.
+         */
         bool isUploadComplete(const Handle handle) {
-            if (handle == INVALID_HANDLE) {
-                throw std::runtime_error("Invalid handle");
-            }
-            return flushedUploads.find(handle) != flushedUploads.end()
-                   || pendingChunks.find(handle) == pendingChunks.end();
+            const auto &upload = getUpload(handle);
+            return upload.flushed || upload.copiedBytes == upload.size;
         }
 
         void flush(const Handle handle) {
-            if (handle == INVALID_HANDLE) {
-                throw std::runtime_error("Invalid handle");
-            }
-            if (pendingChunks.find(handle) != pendingChunks.end()) {
-                flushedUploads.insert(handle);
+            auto &upload = getUpload(handle);
+            if (!upload.flushed && upload.copiedBytes < upload.size) {
+                upload.flushed = true;
+                flushedUploads.emplace_back(handle, upload.sequence);
             }
         }
 
@@ -221,199 +210,458 @@ namespace xng {
          * @param targetBuffer The target buffer to set
          */
         void setTargetBuffer(const Handle handle, const rg::HeapResource<rg::Buffer> &targetBuffer) {
-            if (handle == INVALID_HANDLE) {
-                throw std::runtime_error("Invalid handle");
-            }
-            targetBuffers[handle] = targetBuffer;
+            getUpload(handle).target = targetBuffer;
         }
 
         void commit(RenderQueue &queue) {
-            for (auto handle: flushedUploads) {
-                const auto it = pendingChunks.find(handle);
-                if (it != pendingChunks.end()) {
-                    for (auto &pair: it->second) {
-                        if (freeChunkBuffers.empty()) {
-                            ChunkBuffer buffer(heap, chunkSize);
-                            buffer.upload(queue,
-                                          handle,
-                                          uploadData.at(handle),
-                                          pair.second.targetOffset,
-                                          pair.second.chunkOffset,
-                                          pair.second.dataSize);
-                            pendingChunkBuffers[handle].emplace_back(std::move(buffer));
-                        } else {
-                            auto buffer = std::move(freeChunkBuffers.back());
-                            freeChunkBuffers.pop_back();
-                            buffer.upload(queue,
-                                          handle,
-                                          uploadData.at(handle),
-                                          pair.second.targetOffset,
-                                          pair.second.chunkOffset,
-                                          pair.second.dataSize);
-                            pendingChunkBuffers[handle].emplace_back(std::move(buffer));
-                        }
+            recycle();
+
+            statistics = {};
+            statistics.stagedBytes = frameStagedBytes;
+
+            auto budget = frameBudget > frameStagedBytes ? frameBudget - frameStagedBytes : 0;
+
+            std::unique_ptr<rg::HeapMapping> mapping;
+            std::vector<Piece> overflowPieces;
+            size_t overflowSize = 0;
+
+            // Flushed uploads are staged completely, in a temporary buffer if the ring is full.
+            for (auto &entry: flushedUploads) {
+                if (!isPending(entry.first, entry.second)) {
+                    continue;
+                }
+                auto &upload = uploads.at(entry.first);
+                while (upload.stagedBytes < upload.size) {
+                    if (!stage(entry.first, std::min(chunkSize, upload.size - upload.stagedBytes), mapping)) {
+                        const auto size = upload.size - upload.stagedBytes;
+                        overflowPieces.push_back({entry.first, 0, overflowSize, upload.stagedBytes, size, nullptr});
+                        overflowSize += size;
+                        upload.stagedBytes = upload.size;
+                        pendingBytes -= size;
+                        statistics.overflowBytes += size;
                     }
-                    it->second.clear();
                 }
             }
 
-            auto stalePendingChunks = std::move(pendingChunks);
-            pendingChunks.reserve(stalePendingChunks.size());
-            for (auto &hPair: stalePendingChunks) {
-                std::unordered_set<size_t> frameChunks;
-                for (auto &pair: hPair.second) {
-                    if (freeChunkBuffers.empty()) {
-                        break;
-                    }
-                    auto buffer = std::move(freeChunkBuffers.back());
-                    freeChunkBuffers.pop_back();
-                    buffer.upload(queue,
-                                  hPair.first,
-                                  uploadData.at(hPair.first),
-                                  pair.second.targetOffset,
-                                  pair.second.chunkOffset,
-                                  pair.second.dataSize);
-                    pendingChunkBuffers[hPair.first].emplace_back(std::move(buffer));
-                    frameChunks.insert(pair.first);
-                }
-                for (auto &index: frameChunks) {
-                    hPair.second.erase(index);
-                }
-                if (!hPair.second.empty()) {
-                    pendingChunks[hPair.first] = std::move(hPair.second);
+            // The oldest upload always makes progress.
+            while (!pendingOrder.empty() && !isPending(pendingOrder.front().second, pendingOrder.front().first)) {
+                pendingOrder.pop_front();
+            }
+            if (!pendingOrder.empty()) {
+                const auto handle = pendingOrder.front().second;
+                const auto &upload = uploads.at(handle);
+                const auto size = std::min(chunkSize, upload.size - upload.stagedBytes);
+                if (stage(handle, size, mapping)) {
+                    budget -= std::min(budget, size);
                 }
             }
 
-            // Copy finished chunks
-            auto stalePendingChunkBuffers = std::move(pendingChunkBuffers);
-            pendingChunkBuffers.reserve(stalePendingChunkBuffers.size());
-            for (auto &pair: stalePendingChunkBuffers) {
-                auto staleBuffers = std::move(pair.second);
-                pair.second.reserve(staleBuffers.size());
-                for (auto &buffer: staleBuffers) {
-                    assert(buffer.pendingTransfer != nullptr);
-                    if (flushedUploads.find(buffer.pendingTransferHandle) != flushedUploads.end()
-                        || buffer.pendingTransfer->isSignaled()) {
-                        // Copy to target on graph
-                        const auto sourceBuffer = buffer.backBuffer;
-                        const auto targetBuffer = targetBuffers.at(buffer.pendingTransferHandle);
-                        const auto offset = buffer.pendingTransferOffset;
-                        const auto size = buffer.pendingTransferSize;
-
-                        if (targetBuffer.getDescription().size < offset + size) {
-                            throw std::runtime_error("Invalid target buffer");
-                        }
-
-                        // This will stall the graphics queue waiting on the transfer queue for flushed uploads.
-                        auto pass = rg::GraphicsPassBuilder("ChunkStreamer/Copy")
-                                .transferRead(buffer.backBuffer, 0, buffer.pendingTransferSize)
-                                .transferWrite(targetBuffer, buffer.pendingTransferOffset, buffer.pendingTransferSize)
-                                .execute([sourceBuffer, targetBuffer, offset, size](rg::RasterContext &,
-                                rg::TransferContext &ctx,
-                                rg::ComputeContext &) {
-                                        ctx.copyBuffer(targetBuffer, sourceBuffer, offset, 0, size);
-                                    });
-
-                        queue.addPreFrame(std::move(pass));
-
-                        if (freeChunkBuffers.size() < pinnedChunkBuffers) {
-                            buffer.pendingTransfer = nullptr;
-                            freeChunkBuffers.emplace_back(std::move(buffer));
-                        }
-                    } else {
-                        pair.second.emplace_back(std::move(buffer));
+            // Distribute the budget by priority
+            bool ringFull = false;
+            for (auto it = pendingQueues.begin(); it != pendingQueues.end() && budget > 0 && !ringFull;) {
+                auto &pending = it->second;
+                while (!pending.empty() && budget > 0) {
+                    const auto sequence = pending.front().first;
+                    const auto handle = pending.front().second;
+                    if (!isPending(handle, sequence)) {
+                        pending.pop_front();
+                        continue;
+                    }
+                    const auto &upload = uploads.at(handle);
+                    const auto size = std::min(std::min(chunkSize, upload.size - upload.stagedBytes), budget);
+                    if (!stage(handle, size, mapping)) {
+                        ringFull = true;
+                        break;
                     }
+                    budget -= size;
                 }
-                if (!pair.second.empty()) {
-                    pendingChunkBuffers[pair.first] = std::move(pair.second);
+                if (pending.empty()) {
+                    it = pendingQueues.erase(it);
+                } else {
+                    ++it;
                 }
             }
 
+            mapping = nullptr;
+
+            recordTransfers(queue);
+            recordCopies(queue, overflowPieces, overflowSize);
+
             flushedUploads.clear();
+            frameStagedBytes = 0;
+
+            statistics.pendingBytes = pendingBytes;
+            statistics.stagingUsed = ringUsed;
+        }
+
+        /**
+         * @param bytes The maximum number of bytes to stage per commit, excluding flushed uploads.
+         */
+        void setFrameBudget(const size_t bytes) {
+            frameBudget = bytes;
         }
 
-        size_t getInFlightChunks() const {
-            return pendingChunks.size();
+        size_t getFrameBudget() const {
+            return frameBudget;
+        }
+
+        /**
+         * @return The number of bytes waiting to be staged.
+         */
+        size_t getPendingBytes() const {
+            return pendingBytes;
+        }
+
+        /**
+         * @return The number of staging ring bytes used by in flight ranges.
+         */
+        size_t getStagingUsage() const {
+            return ringUsed;
+        }
+
+        size_t getStagingSize() const {
+            return ringSize;
+        }
+
+        const Statistics &getStatistics() const {
+            return statistics;
         }
 
     private:
-        struct UploadChunk {
-            size_t targetOffset;
-            size_t chunkOffset;
-            size_t dataSize;
+        struct Upload {
+            rg::HeapResource<rg::Buffer> target;
+            size_t targetOffset = 0;
+            size_t size = 0;
+            int priority = 0;
+            size_t sequence = 0;
+
+            std::vector<uint8_t> data; // The bytes starting at dataOffset which were not staged by upload()
+            size_t dataOffset = 0;
+
+            size_t stagedBytes = 0;
+            size_t copiedBytes = 0;
+
+            bool flushed = false;
+            bool active = false;
+        };
+
+        /**
+         * A staged range of an upload
+         */
+        struct Piece {
+            Handle handle;
+            size_t ringEntry;
+            size_t stagingOffset;
+            size_t uploadOffset;
+            size_t size;
+            std::shared_ptr<RenderQueue::SubmitFence> transfer;
         };
 
-        struct ChunkBuffer {
-            rg::Heap &heap;
+        struct RingEntry {
+            size_t offset;
+            size_t size;
+            std::shared_ptr<RenderQueue::SubmitFence> fence; // Must be signaled before the range can be reused.
+            bool retired; // The range is no longer referenced by a piece
+        };
 
-            rg::HeapResource<rg::Buffer> stagingBuffer;
-            rg::HeapResource<rg::Buffer> backBuffer;
+        Upload &getUpload(const Handle handle) {
+            if (handle == INVALID_HANDLE || handle >= uploads.size() || !uploads.at(handle).active) {
+                throw std::runtime_error("Invalid handle");
+            }
+            return uploads.at(handle);
+        }
 
-            std::shared_ptr<RenderQueue::SubmitFence> pendingTransfer{};
-            Handle pendingTransferHandle{};
-            size_t pendingTransferOffset{};
-            size_t pendingTransferSize{};
+        Handle createUpload(const size_t dataSize,
+                            const rg::HeapResource<rg::Buffer> &targetBuffer,
+                            const size_t targetOffset,
+                            const int priority) {
+            if (!(targetBuffer.getDescription().capabilityFlags & rg::Buffer::CAPABILITY_TRANSFER_DST)) {
+                throw std::runtime_error("Target buffer must have CAPABILITY_TRANSFER_DST capability");
+            }
 
-            ChunkBuffer(rg::Heap &heap, const size_t chunkSize)
-                : heap(heap),
-                  stagingBuffer(heap.allocateBuffer(rg::Buffer(chunkSize,
-                                                               rg::Buffer::CAPABILITY_TRANSFER_SRC,
-                                                               rg::Buffer::MEMORY_CPU_TO_GPU))),
-                  backBuffer(heap.allocateBuffer(rg::Buffer(chunkSize,
-                                                            rg::Buffer::CAPABILITY_TRANSFER_DST,
-                                                            rg::Buffer::MEMORY_GPU_ONLY))) {
+            Handle ret;
+            if (freeHandles.empty()) {
+                ret = uploads.size();
+                uploads.emplace_back();
+            } else {
+                ret = freeHandles.back();
+                freeHandles.pop_back();
             }
 
-            ChunkBuffer(ChunkBuffer &&other) noexcept = default;
+            auto &upload = uploads.at(ret);
+            upload.target = targetBuffer;
+            upload.targetOffset = targetOffset;
+            upload.size = dataSize;
+            upload.priority = priority;
+            upload.sequence = nextSequence++;
+            upload.active = true;
+
+            pendingBytes += dataSize;
+
+            return ret;
+        }
+
+        bool isPending(const Handle handle, const size_t sequence) const {
+            const auto &upload = uploads.at(handle);
+            return upload.active && upload.sequence == sequence && upload.stagedBytes < upload.size;
+        }
 
-            ChunkBuffer(const ChunkBuffer &other) = delete;
+        void enqueue(const Handle handle) {
+            const auto &upload = uploads.at(handle);
+            pendingQueues[upload.priority].emplace_back(upload.sequence, handle);
+            pendingOrder.emplace_back(upload.sequence, handle);
+        }
 
-            void upload(RenderQueue &queue,
-                        const Handle handle,
-                        const std::vector<uint8_t> &data,
-                        const size_t targetOffset,
-                        const size_t chunkOffset,
-                        const size_t size) {
-                assert(pendingTransfer == nullptr);
-                {
-                    const auto mapping = heap.map(stagingBuffer);
-                    mapping->copyFrom(data, chunkOffset, 0, size);
+        /**
+         * Write the upload into the staging ring if nothing is queued and the frame budget allows it.
+         */
+        void stageDirect(const Handle handle, const uint8_t *data) {
+            auto &upload = uploads.at(handle);
+            if (pendingBytes != upload.size) {
+                return;
+            }
+            std::unique_ptr<rg::HeapMapping> mapping;
+            while (upload.stagedBytes < upload.size && frameStagedBytes < frameBudget) {
+                const auto size = std::min(chunkSize, upload.size - upload.stagedBytes);
+                const auto entry = allocateRange(size);
+                if (!entry.has_value()) {
+                    break;
+                }
+                if (mapping == nullptr) {
+                    mapping = heap.mapUnsynchronized(stagingRing);
                 }
+                const auto offset = getRange(entry.value()).offset;
+                std::memcpy(mapping->data() + offset, data + upload.stagedBytes, size);
+                stagedPieces.push_back({handle, entry.value(), offset, upload.stagedBytes, size, nullptr});
+                upload.stagedBytes += size;
+                pendingBytes -= size;
+                frameStagedBytes += size;
+            }
+        }
+
+        /**
+         * Stage the next size bytes of the upload.
+         *
+         * @return False if the staging ring is full.
+         */
+        bool stage(const Handle handle, const size_t size, std::unique_ptr<rg::HeapMapping> &mapping) {
+            const auto entry = allocateRange(size);
+            if (!entry.has_value()) {
+                return false;
+            }
+            if (mapping == nullptr) {
+                mapping = heap.mapUnsynchronized(stagingRing);
+            }
+            auto &upload = uploads.at(handle);
+            const auto offset = getRange(entry.value()).offset;
+            std::memcpy(mapping->data() + offset,
+                        upload.data.data() + (upload.stagedBytes - upload.dataOffset),
+                        size);
+            stagedPieces.push_back({handle, entry.value(), offset, upload.stagedBytes, size, nullptr});
+            upload.stagedBytes += size;
+            pendingBytes -= size;
+            statistics.stagedBytes += size;
+            if (upload.stagedBytes == upload.size) {
+                upload.data = {};
+            }
+            return true;
+        }
+
+        void recordTransfers(RenderQueue &queue) {
+            if (stagedPieces.empty()) {
+                return;
+            }
+
+            std::vector<std::pair<size_t, size_t> > ranges;
+            ranges.reserve(stagedPieces.size());
+            auto builder = rg::TransferPassBuilder("ChunkStreamer/Upload");
+            for (auto &piece: stagedPieces) {
+                builder.read(stagingRing, piece.stagingOffset, piece.size);
+                builder.write(backBufferRing, piece.stagingOffset, piece.size);
+                ranges.emplace_back(piece.stagingOffset, piece.size);
+            }
+
+            auto staging = stagingRing;
+            auto backBuffer = backBufferRing;
+            const auto fence = queue.addTransfer(builder.execute(
+                [staging, backBuffer, ranges = std::move(ranges)](rg::TransferContext &ctx) {
+                    for (auto &range: ranges) {
+                        ctx.copyBuffer(backBuffer, staging, range.first, range.first, range.second);
+                    }
+                }));
 
-                auto backBufferRef = backBuffer;
-                auto stagingBufferRef = stagingBuffer;
-
-                auto pass = rg::TransferPassBuilder("ChunkStreamer/Upload")
-                        .read(stagingBufferRef, 0, size)
-                        .write(backBufferRef, 0, size)
-                        .execute([backBufferRef, stagingBufferRef, size](rg::TransferContext &ctx) {
-                            ctx.copyBuffer(backBufferRef, stagingBufferRef, 0, 0, size);
-                        });
-                pendingTransfer = queue.addTransfer(std::move(pass));
-                pendingTransferHandle = handle;
-                pendingTransferOffset = targetOffset;
-                pendingTransferSize = size;
+            for (auto &piece: stagedPieces) {
+                piece.transfer = fence;
+                transferringPieces.emplace_back(std::move(piece));
             }
+            stagedPieces.clear();
+        }
+
+        struct Copy {
+            rg::HeapResource<rg::Buffer> source;
+            rg::HeapResource<rg::Buffer> target;
+            size_t sourceOffset;
+            size_t targetOffset;
+            size_t size;
         };
 
+        void recordCopies(RenderQueue &queue, const std::vector<Piece> &overflowPieces, const size_t overflowSize) {
+            std::vector<Copy> copies;
+
+            const auto frameFence = queue.getFrameFence();
+
+            auto stalePieces = std::move(transferringPieces);
+            transferringPieces.clear();
+            for (auto &piece: stalePieces) {
+                auto &upload = uploads.at(piece.handle);
+                // Flushed uploads stall the graphics queue on the transfer queue.
+                if (upload.flushed || piece.transfer->isSignaled()) {
+                    copies.push_back({
+                        backBufferRing,
+                        upload.target,
+                        piece.stagingOffset,
+                        upload.targetOffset + piece.uploadOffset,
+                        piece.size
+                    });
+                    upload.copiedBytes += piece.size;
+                    retireRange(piece.ringEntry, frameFence);
+                } else {
+                    transferringPieces.emplace_back(std::move(piece));
+                }
+            }
+
+            if (overflowSize > 0) {
+                const auto overflowBuffer = heap.allocateBuffer(rg::Buffer(overflowSize,
+                                                                           rg::Buffer::CAPABILITY_TRANSFER_SRC,
+                                                                           rg::Buffer::MEMORY_CPU_TO_GPU));
+                const auto mapping = heap.map(overflowBuffer);
+                for (auto &piece: overflowPieces) {
+                    auto &upload = uploads.at(piece.handle);
+                    std::memcpy(mapping->data() + piece.stagingOffset,
+                                upload.data.data() + (piece.uploadOffset - upload.dataOffset),
+                                piece.size);
+                    copies.push_back({
+                        overflowBuffer,
+                        upload.target,
+                        piece.stagingOffset,
+                        upload.targetOffset + piece.uploadOffset,
+                        piece.size
+                    });
+                    upload.copiedBytes += piece.size;
+                    upload.data = {};
+                }
+            }
+
+            if (copies.empty()) {
+                return;
+            }
+
+            auto builder = rg::GraphicsPassBuilder("ChunkStreamer/Copy");
+            for (auto &copy: copies) {
+                if (copy.target.getDescription().size < copy.targetOffset + copy.size) {
+                    throw std::runtime_error("Invalid target buffer");
+                }
+                builder.transferRead(copy.source, copy.sourceOffset, copy.size);
+                builder.transferWrite(copy.target, copy.targetOffset, copy.size);
+                statistics.copiedBytes += copy.size;
+            }
+
+            // The overflow buffers are pinned via HeapResource references in the lambda and
+            // the runtime will pin the buffers additionally until the graph finished execution.
+            queue.addPreFrame(builder.execute([copies = std::move(copies)](rg::RasterContext &,
+                                                                           rg::TransferContext &ctx,
+                                                                           rg::ComputeContext &) {
+                for (auto &copy: copies) {
+                    ctx.copyBuffer(copy.target, copy.source, copy.targetOffset, copy.sourceOffset, copy.size);
+                }
+            }));
+        }
+
+        /**
+         * @return The id of the allocated ring entry or nullopt if the ring has no contiguous range of the given size.
+         */
+        std::optional<size_t> allocateRange(const size_t size) {
+            if (ringUsed == 0) {
+                ringHead = 0;
+            }
+            const auto tail = ringEntries.empty() ? ringHead : ringEntries.front().offset;
+            if (ringUsed > 0 && ringHead <= tail) {
+                if (tail - ringHead < size) {
+                    return std::nullopt;
+                }
+            } else if (ringSize - ringHead < size) {
+                if (tail < size) {
+                    return std::nullopt;
+                }
+                // Skip the end of the ring, the padding is freed together with the preceding ranges.
+                ringEntries.push_back({ringHead, ringSize - ringHead, nullptr, true});
+                ringUsed += ringSize - ringHead;
+                ringHead = 0;
+            }
+            ringEntries.push_back({ringHead, size, nullptr, false});
+            ringUsed += size;
+            ringHead += size;
+            if (ringHead == ringSize) {
+                ringHead = 0;
+            }
+            return ringEntryBase + ringEntries.size() - 1;
+        }
+
+        RingEntry &getRange(const size_t entry) {
+            return ringEntries.at(entry - ringEntryBase);
+        }
+
+        void retireRange(const size_t entry, std::shared_ptr<RenderQueue::SubmitFence> fence) {
+            auto &range = getRange(entry);
+            range.fence = std::move(fence);
+            range.retired = true;
+        }
+
+        /**
+         * Free the retired ranges at the tail of the ring whose fences are signaled.
+         */
+        void recycle() {
+            while (!ringEntries.empty()) {
+                const auto &range = ringEntries.front();
+                if (!range.retired || (range.fence != nullptr && !range.fence->isSignaled())) {
+                    break;
+                }
+                ringUsed -= range.size;
+                ringEntries.pop_front();
+                ringEntryBase++;
+            }
+        }
+
         rg::Heap &heap;
 
         const size_t chunkSize = 0;
-        const size_t pinnedChunkBuffers = 0;
+        const size_t ringSize = 0;
 
-        std::unordered_map<Handle, rg::HeapResource<rg::Buffer> > targetBuffers;
-        std::unordered_map<Handle, std::vector<uint8_t> > uploadData;
+        size_t frameBudget = 0;
+        size_t frameStagedBytes = 0;
+        size_t pendingBytes = 0;
 
-        std::unordered_map<Handle, std::unordered_map<size_t, UploadChunk> > pendingChunks;
+        rg::HeapResource<rg::Buffer> stagingRing;
+        rg::HeapResource<rg::Buffer> backBufferRing;
 
-        std::unordered_map<Handle, std::vector<ChunkBuffer> > pendingChunkBuffers;
+        std::deque<RingEntry> ringEntries;
+        size_t ringEntryBase = 0;
+        size_t ringHead = 0;
+        size_t ringUsed = 0;
 
-        std::unordered_set<Handle> flushedUploads;
+        std::vector<Upload> uploads = std::vector<Upload>(1); // Index 0 is INVALID_HANDLE
+        std::vector<Handle> freeHandles;
+        size_t nextSequence = 0;
 
-        std::vector<ChunkBuffer> freeChunkBuffers;
+        // (sequence, handle) pairs, entries of released or staged uploads are skipped lazily.
+        std::map<int, std::deque<std::pair<size_t, Handle> >, std::greater<> > pendingQueues;
+        std::deque<std::pair<size_t, Handle> > pendingOrder;
+        std::vector<std::pair<Handle, size_t> > flushedUploads;
 
-        Handle nextHandle = INVALID_HANDLE + 1;
-        std::vector<Handle> freeHandles;
+        std::vector<Piece> stagedPieces; // Staged ranges for which the transfer has not been recorded yet
+        std::vector<Piece> transferringPieces; // Ranges waiting on the transfer before being copied to the target
+
+        Statistics statistics;
     };
 }
 
@@ -20,11 +20,16 @@
 #define XENGINE_GENERICBUFFERSTREAMER_HPP
 
 
+#include <set>
+
 #include "xng/renderer/stream/streambuffer.hpp"
 
 namespace xng {
     /**
      * The BufferStreamer streams fixed size data.
+     *
+     * Freed slots are reused lowest first, the buffer shrinks when the slots at its end are destroyed.
+     * Live slots are never moved because their owners reference them by index.
      */
     class GenericBufferStreamer {
     public:
@@ -42,8 +47,8 @@ namespace xng {
 
         Slot create() {
             if (!freeSlots.empty()) {
-                const auto ret = freeSlots.back();
-                freeSlots.pop_back();
+                const auto ret = *freeSlots.begin();
+                freeSlots.erase(freeSlots.begin());
                 return ret;
             }
             return nextSlot++;
@@ -51,7 +56,7 @@ namespace xng {
 
         void destroy(const Slot slot) {
 #ifndef NDEBUG
-            if (std::find(freeSlots.begin(), freeSlots.end(), slot) != freeSlots.end()) {
+            if (freeSlots.find(slot) != freeSlots.end()) {
                 throw std::runtime_error("Slot is already freed");
             }
 #endif
@@ -61,12 +66,19 @@ namespace xng {
                 buffer.release(it->second.handle);
             }
             regions.erase(slot);
-            freeSlots.push_back(slot);
+            freeSlots.insert(slot);
+
+            // Trim the free slots at the end so the buffer can shrink
+            while (!freeSlots.empty() && *freeSlots.rbegin() == nextSlot - 1) {
+                freeSlots.erase(std::prev(freeSlots.end()));
+                nextSlot--;
+                trimmed = true;
+            }
         }
 
         void upload(const Slot slot, const uint8_t *data, const size_t size) {
 #ifndef NDEBUG
-            if (std::find(freeSlots.begin(), freeSlots.end(), slot) != freeSlots.end()) {
+            if (freeSlots.find(slot) != freeSlots.end()) {
                 throw std::runtime_error("Slot is already freed");
             }
 #endif
@@ -86,7 +98,7 @@ namespace xng {
 
         bool isUploadComplete(const Slot slot) {
 #ifndef NDEBUG
-            if (std::find(freeSlots.begin(), freeSlots.end(), slot) != freeSlots.end()) {
+            if (freeSlots.find(slot) != freeSlots.end()) {
                 throw std::runtime_error("Slot is already freed");
             }
 #endif
@@ -98,7 +110,7 @@ namespace xng {
 
         void flush(const Slot slot) {
 #ifndef NDEBUG
-            if (std::find(freeSlots.begin(), freeSlots.end(), slot) != freeSlots.end()) {
+            if (freeSlots.find(slot) != freeSlots.end()) {
                 throw std::runtime_error("Slot is already freed");
             }
 #endif
@@ -113,6 +125,10 @@ namespace xng {
         }
 
         void commit(RenderQueue &queue) {
+            if (trimmed) {
+                buffer.shrink(nextSlot * elementSize);
+                trimmed = false;
+            }
             buffer.commit(queue);
         }
 
@@ -120,6 +136,10 @@ namespace xng {
             return buffer.getBuffer();
         }
 
+        StreamBuffer::Statistics getStatistics() const {
+            return buffer.getStatistics();
+        }
+
     private:
         struct Region {
             StreamBuffer::Handle handle;
@@ -131,7 +151,8 @@ namespace xng {
         StreamBuffer buffer;
 
         Slot nextSlot = 0;
-        std::vector<Slot> freeSlots;
+        std::set<Slot> freeSlots;
+        bool trimmed = false; // True if slots were trimmed since the last shrink
 
         std::unordered_map<Slot, Region> regions;
     };
@@ -19,6 +19,10 @@
 #ifndef XENGINE_MESHSTREAMER_HPP
 #define XENGINE_MESHSTREAMER_HPP
 
+#include <algorithm>
+#include <chrono>
+#include <limits>
+#include <map>
 #include <unordered_map>
 
 #include "xng/assets/mesh.hpp"
@@ -48,6 +52,11 @@ namespace xng {
      * because the draw calls must execute in submission order for correct transparency.
      *
      * For the best performance the forward rendering path would need to write their own default attributes in the buffers.
+     *
+     * Destroying meshes leaves holes in the buffers. Each commit spends up to the compaction budget on moving the
+     * meshes with the highest offsets into the lowest holes and shrinks the buffers once the end is free.
+     * Relocated meshes change their Allocation offsets and increment getRevision(), users which cache allocations
+     * must reload them when the revision changes.
      */
     class MeshStreamer {
     public:
@@ -60,6 +69,17 @@ namespace xng {
             size_t vertexCount{}; // The number of vertices for this mesh
             bool skinned{};
             int skinBaseVertex{}; // The offset applied to each vertex for indexing into the skinned buffers.
+            Vec3f boundsMin; // The local space bounding box of the positions, not valid for skinned meshes.
+            Vec3f boundsMax;
+        };
+
+        struct Statistics {
+            size_t usedBytes = 0; // The number of bytes below the end of the last allocation in the mesh buffers
+            size_t freeBytes = 0; // The number of bytes in holes below the end of the last allocation
+            float fragmentation = 0; // freeBytes / usedBytes
+            size_t relocatedBytes = 0; // The number of bytes moved by compaction since creation
+            size_t reclaimedBytes = 0; // The number of bytes released by shrinking the buffers since creation
+            std::chrono::nanoseconds compactionTime{}; // The cpu time spent on compaction in the last commit
         };
 
         MeshStreamer(rg::Heap &heap, ChunkStreamer &chunkStreamer)
@@ -117,6 +137,19 @@ namespace xng {
 
             const auto vertexCount = mesh.positions.size();
 
+            if (vertexCount > 0) {
+                alloc.boundsMin = mesh.positions.at(0);
+                alloc.boundsMax = mesh.positions.at(0);
+                for (auto &position: mesh.positions) {
+                    alloc.boundsMin = Vec3f(std::min(alloc.boundsMin.x, position.x),
+                                            std::min(alloc.boundsMin.y, position.y),
+                                            std::min(alloc.boundsMin.z, position.z));
+                    alloc.boundsMax = Vec3f(std::max(alloc.boundsMax.x, position.x),
+                                            std::max(alloc.boundsMax.y, position.y),
+                                            std::max(alloc.boundsMax.z, position.z));
+                }
+            }
+
             if (alloc.skinned) {
                 std::map<size_t, std::vector<std::pair<float, std::string> > > boneWeightsMap;
                 for (auto &pair: boneIndices) {
@@ -249,6 +282,16 @@ namespace xng {
 
             allocations.emplace(ret, alloc);
 
+            if (alloc.vertexCount > 0) {
+                vertexCompaction.offsets.emplace(alloc.baseVertex, ret);
+                if (alloc.skinned) {
+                    skinnedCompaction.offsets.emplace(alloc.skinBaseVertex, ret);
+                }
+            }
+            if (alloc.drawCall.count > 0) {
+                indexCompaction.offsets.emplace(alloc.drawCall.offset, ret);
+            }
+
             return ret;
         }
 
@@ -277,6 +320,22 @@ namespace xng {
                 skinnedBufferAlloc.free(alloc.skinBaseVertex, alloc.vertexCount);
             }
 
+            if (alloc.vertexCount > 0) {
+                vertexCompaction.offsets.erase(alloc.baseVertex);
+                if (alloc.skinned) {
+                    skinnedCompaction.offsets.erase(alloc.skinBaseVertex);
+                }
+            }
+            if (alloc.drawCall.count > 0) {
+                indexCompaction.offsets.erase(alloc.drawCall.offset);
+            }
+
+            // New holes can fit allocations which were already checked
+            fragmented = true;
+            vertexCompaction.reset();
+            indexCompaction.reset();
+            skinnedCompaction.reset();
+
             vertexBufferHandles.erase(handle);
             indexBufferHandles.erase(handle);
             skinnedBindPosBufferHandles.erase(handle);
@@ -318,7 +377,59 @@ namespace xng {
             return allocations.at(handle);
         }
 
+        /**
+         * @param budget The cpu time spent on compaction per commit, zero disables compaction.
+         */
+        void setCompactionBudget(const std::chrono::microseconds budget) {
+            compactionBudget = budget;
+        }
+
+        std::chrono::microseconds getCompactionBudget() const {
+            return compactionBudget;
+        }
+
+        /**
+         * @return True if compaction has not yet checked all allocations since the last destroy().
+         */
+        bool isCompactionPending() const {
+            return fragmented;
+        }
+
+        /**
+         * @return The number of commits which relocated allocations.
+         */
+        size_t getRevision() const {
+            return revision;
+        }
+
+        Statistics getStatistics() const {
+            Statistics ret;
+            ret.compactionTime = compactionTime;
+            addRangeStatistics(ret, vertexBufferAlloc, getVertexStride());
+            addRangeStatistics(ret, indexBufferAlloc, 1);
+            addRangeStatistics(ret, skinnedBufferAlloc, skinnedVertexStride);
+            if (ret.usedBytes > 0) {
+                ret.fragmentation = static_cast<float>(ret.freeBytes) / static_cast<float>(ret.usedBytes);
+            }
+            for (auto &pair: vertexBuffers) {
+                addBufferStatistics(ret, pair.second);
+            }
+            addBufferStatistics(ret, indexBuffer);
+            addBufferStatistics(ret, skinnedBindPosBuffer);
+            addBufferStatistics(ret, skinnedBoneIndicesBuffer);
+            addBufferStatistics(ret, skinnedBoneWeightsBuffer);
+            return ret;
+        }
+
         void commit(RenderQueue &queue) {
+            compactionTime = {};
+            if (fragmented && compactionBudget.count() > 0) {
+                const auto start = std::chrono::steady_clock::now();
+                compact();
+                compactionTime = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                    std::chrono::steady_clock::now() - start);
+            }
+
             for (auto &pair: vertexBuffers) {
                 pair.second.commit(queue);
             }
@@ -354,6 +465,239 @@ namespace xng {
         }
 
     private:
+        struct CompactionState {
+            std::map<size_t, Handle> offsets; // The allocations with a non-empty range by offset
+            size_t cursor = std::numeric_limits<size_t>::max(); // The allocations at or above were checked by the pass
+            std::vector<Handle> pending; // The allocations with pending uploads which are checked after the pass
+
+            void reset() {
+                cursor = std::numeric_limits<size_t>::max();
+                pending.clear();
+            }
+        };
+
+        static constexpr size_t skinnedVertexStride = sizeof(float) * 3 + sizeof(int) * 4 + sizeof(float) * 4;
+
+        static size_t getVertexStride() {
+            size_t ret = 0;
+            for (auto attr = ATTRIBUTE_BEGIN;
+                 attr <= ATTRIBUTE_END;
+                 attr = static_cast<VertexAttribute>(attr + 1)) {
+                ret += getVertexAttributeSize(attr);
+            }
+            return ret;
+        }
+
+        static void addRangeStatistics(Statistics &statistics, const RangeAllocator &allocator, const size_t stride) {
+            size_t freeCount = 0;
+            for (auto &pair: allocator.getFreeRanges()) {
+                freeCount += pair.second;
+            }
+            statistics.usedBytes += allocator.getSize() * stride;
+            statistics.freeBytes += freeCount * stride;
+        }
+
+        static void addBufferStatistics(Statistics &statistics, const StreamBuffer &buffer) {
+            const auto bufferStatistics = buffer.getStatistics();
+            statistics.relocatedBytes += bufferStatistics.relocatedBytes;
+            statistics.reclaimedBytes += bufferStatistics.reclaimedBytes;
+        }
+
+        /**
+         * Move the allocations in descending offset order into the lowest hole which fits them until no allocation
+         * can be moved to a lower offset or the deadline is reached.
+         *
+         * The pass continues below the offset of the last checked allocation in the next call. Allocations with
+         * pending uploads are checked again after the pass, later calls only check these until they are relocated.
+         * At least one allocation is checked per call so compaction progresses with any budget.
+         *
+         * @param allocator The allocator of the ranges
+         * @param state The allocations in the allocator and the progress of the pass
+         * @param getRange Assigns the offset and count of the allocation in the allocator.
+         * @param relocate Moves the data of the allocation to the passed offset.
+         * @param deadline The time after which no more allocations are checked
+         * @return True if all allocations were checked, false if the deadline was reached or uploads are pending.
+         */
+        template<typename GetRange, typename Relocate>
+        bool compactRanges(RangeAllocator &allocator,
+                           CompactionState &state,
+                           const GetRange &getRange,
+                           const Relocate &relocate,
+                           const std::chrono::steady_clock::time_point deadline) {
+            size_t checked = 0;
+            const auto expired = [&]() {
+                return checked > 0 && std::chrono::steady_clock::now() >= deadline;
+            };
+
+            allocator.trim();
+            while (!allocator.getFreeRanges().empty()) {
+                auto it = state.offsets.lower_bound(state.cursor);
+                if (it == state.offsets.begin()) {
+                    break;
+                }
+                --it;
+                if (expired()) {
+                    return false;
+                }
+                checked++;
+                state.cursor = it->first;
+                if (!compactRange(allocator, state, it->second, getRange, relocate)) {
+                    state.pending.emplace_back(it->second);
+                }
+            }
+
+            for (auto it = state.pending.begin();
+                 it != state.pending.end() && !allocator.getFreeRanges().empty();) {
+                if (expired()) {
+                    return false;
+                }
+                checked++;
+                if (compactRange(allocator, state, *it, getRange, relocate)) {
+                    it = state.pending.erase(it);
+                } else {
+                    ++it;
+                }
+            }
+
+            if (!state.pending.empty() && !allocator.getFreeRanges().empty()) {
+                return false;
+            }
+            state.reset();
+            return true;
+        }
+
+        /**
+         * Move the allocation into the lowest hole which fits it if the hole is below the allocation.
+         *
+         * @return False if the allocation has pending uploads.
+         */
+        template<typename GetRange, typename Relocate>
+        bool compactRange(RangeAllocator &allocator,
+                          CompactionState &state,
+                          const Handle handle,
+                          const GetRange &getRange,
+                          const Relocate &relocate) {
+            if (!canRelocate(handle)) {
+                return false;
+            }
+            auto &alloc = allocations.at(handle);
+            size_t offset;
+            size_t count;
+            getRange(alloc, offset, count);
+
+            // The allocator returns the lowest hole which fits, the old range is freed after allocating the new
+            // range so the source and target of the copy never overlap.
+            size_t target;
+            if (!allocator.allocate(count, target)) {
+                return true;
+            }
+            if (target >= offset) {
+                allocator.free(target, count);
+                return true;
+            }
+            allocator.free(offset, count);
+            allocator.trim();
+            state.offsets.erase(offset);
+            state.offsets.emplace(target, handle);
+            relocate(handle, alloc, target);
+            return true;
+        }
+
+        /**
+         * @return True if the data of all buffers of the mesh can be relocated.
+         */
+        bool canRelocate(const Handle handle) const {
+            for (auto &pair: vertexBufferHandles.at(handle)) {
+                if (!vertexBuffers.at(pair.first).canRelocate(pair.second)) {
+                    return false;
+                }
+            }
+            if (allocations.at(handle).skinned) {
+                if (!skinnedBindPosBuffer.canRelocate(skinnedBindPosBufferHandles.at(handle))
+                    || !skinnedBoneIndicesBuffer.canRelocate(skinnedBoneIndicesBufferHandles.at(handle))
+                    || !skinnedBoneWeightsBuffer.canRelocate(skinnedBoneWeightsBufferHandles.at(handle))) {
+                    return false;
+                }
+            }
+            return indexBuffer.canRelocate(indexBufferHandles.at(handle));
+        }
+
+        void compact() {
+            const auto deadline = std::chrono::steady_clock::now() + compactionBudget;
+            bool relocated = false;
+
+            const auto vertexDone = compactRanges(vertexBufferAlloc,
+                                                  vertexCompaction,
+                                                  [](const Allocation &alloc, size_t &offset, size_t &count) {
+                                                      offset = alloc.baseVertex;
+                                                      count = alloc.vertexCount;
+                                                  },
+                                                  [this, &relocated](const Handle handle,
+                                                                     Allocation &alloc,
+                                                                     const size_t target) {
+                                                      for (auto &pair: vertexBufferHandles.at(handle)) {
+                                                          vertexBuffers.at(pair.first).relocate(
+                                                              pair.second,
+                                                              target * getVertexAttributeSize(pair.first));
+                                                      }
+                                                      alloc.baseVertex = static_cast<int>(target);
+                                                      relocated = true;
+                                                  },
+                                                  deadline);
+
+            const auto indexDone = compactRanges(indexBufferAlloc,
+                                                 indexCompaction,
+                                                 [](const Allocation &alloc, size_t &offset, size_t &count) {
+                                                     offset = alloc.drawCall.offset;
+                                                     count = alloc.drawCall.count * sizeof(unsigned int);
+                                                 },
+                                                 [this, &relocated](const Handle handle,
+                                                                    Allocation &alloc,
+                                                                    const size_t target) {
+                                                     indexBuffer.relocate(indexBufferHandles.at(handle), target);
+                                                     alloc.drawCall.offset = target;
+                                                     relocated = true;
+                                                 },
+                                                 deadline);
+
+            const auto skinnedDone = compactRanges(skinnedBufferAlloc,
+                                                   skinnedCompaction,
+                                                   [](const Allocation &alloc, size_t &offset, size_t &count) {
+                                                       offset = alloc.skinBaseVertex;
+                                                       count = alloc.vertexCount;
+                                                   },
+                                                   [this, &relocated](const Handle handle,
+                                                                      Allocation &alloc,
+                                                                      const size_t target) {
+                                                       skinnedBindPosBuffer.relocate(
+                                                           skinnedBindPosBufferHandles.at(handle),
+                                                           target * sizeof(float) * 3);
+                                                       skinnedBoneIndicesBuffer.relocate(
+                                                           skinnedBoneIndicesBufferHandles.at(handle),
+                                                           target * sizeof(int) * 4);
+                                                       skinnedBoneWeightsBuffer.relocate(
+                                                           skinnedBoneWeightsBufferHandles.at(handle),
+                                                           target * sizeof(float) * 4);
+                                                       alloc.skinBaseVertex = static_cast<int>(target);
+                                                       relocated = true;
+                                                   },
+                                                   deadline);
+
+            // Release the memory above the last allocation, the buffers only shrink if enough memory is released.
+            for (auto &pair: vertexBuffers) {
+                pair.second.shrink(vertexBufferAlloc.getSize() * getVertexAttributeSize(pair.first));
+            }
+            indexBuffer.shrink(indexBufferAlloc.getSize());
+            skinnedBindPosBuffer.shrink(skinnedBufferAlloc.getSize() * sizeof(float) * 3);
+            skinnedBoneIndicesBuffer.shrink(skinnedBufferAlloc.getSize() * sizeof(int) * 4);
+            skinnedBoneWeightsBuffer.shrink(skinnedBufferAlloc.getSize() * sizeof(float) * 4);
+
+            if (relocated) {
+                revision++;
+            }
+            fragmented = !(vertexDone && indexDone && skinnedDone);
+        }
+
         static std::vector<uint8_t> getBytes(const VertexAttribute attr, const Mesh &mesh) {
             VertexBuilder builder;
             switch (attr) {
@@ -441,6 +785,14 @@ namespace xng {
         std::vector<Handle> freeHandles;
 
         std::unordered_map<Handle, Allocation> allocations;
+
+        std::chrono::microseconds compactionBudget = std::chrono::microseconds(200);
+        bool fragmented = false; // True if meshes were destroyed since the last completed compaction
+        std::chrono::nanoseconds compactionTime{};
+        CompactionState vertexCompaction;
+        CompactionState indexCompaction;
+        CompactionState skinnedCompaction;
+        size_t revision = 0;
     };
 }
 
@@ -0,0 +1,170 @@
+/**
+ *   xEngine - C++ Game Engine Library
+ *   Copyright (C) 2026 Julia Zampiccoli
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU Lesser General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   Lesser General Public License for more details.
+ *
+ *   You should have received a copy of the Lesser General Public License
+ *   along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef XENGINE_SLOTARRAY_HPP
+#define XENGINE_SLOTARRAY_HPP
+
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <stdexcept>
+#include <vector>
+
+namespace xng {
+    /**
+     * The SlotArray is the cpu side copy of a buffer of fixed size elements with stable slots.
+     *
+     * Destroyed slots are reset to a default constructed element and reused by later create() calls,
+     * so the elements never move and a change only dirties the slot of the changed element.
+     * Dirty slots are merged into contiguous byte ranges which can be uploaded with one streamer upload each.
+     *
+     * @tparam T The element type, must be trivially copyable.
+     */
+    template<typename T>
+    class SlotArray {
+    public:
+        /**
+         * The index of the element in the array
+         */
+        typedef unsigned int Slot;
+
+        /**
+         * A range of bytes in the array
+         */
+        struct Range {
+            size_t offset;
+            size_t size;
+        };
+
+        Slot create(const T &value = T{}) {
+            Slot ret;
+            if (!freeSlots.empty()) {
+                ret = freeSlots.back();
+                freeSlots.pop_back();
+                elements.at(ret) = value;
+            } else {
+                ret = static_cast<Slot>(elements.size());
+                elements.emplace_back(value);
+                dirty.emplace_back(false);
+            }
+            markDirty(ret);
+            return ret;
+        }
+
+        void set(const Slot slot, const T &value) {
+            assert(slot < elements.size());
+            elements[slot] = value;
+            markDirty(slot);
+        }
+
+        /**
+         * Reset the slot to a default constructed element and make it available for reuse.
+         *
+         * @param slot The slot to destroy
+         */
+        void destroy(const Slot slot) {
+            if (slot >= elements.size()) {
+                throw std::runtime_error("Invalid slot");
+            }
+            elements[slot] = T{};
+            markDirty(slot);
+            freeSlots.emplace_back(slot);
+        }
+
+        const T &get(const Slot slot) const {
+            return elements.at(slot);
+        }
+
+        /**
+         * @return The number of slots including destroyed slots
+         */
+        size_t size() const {
+            return elements.size();
+        }
+
+        /**
+         * @return The number of slots which are not destroyed
+         */
+        size_t getActiveCount() const {
+            return elements.size() - freeSlots.size();
+        }
+
+        const uint8_t *data() const {
+            return reinterpret_cast<const uint8_t *>(elements.data());
+        }
+
+        bool isDirty() const {
+            return !dirtySlots.empty();
+        }
+
+        /**
+         * @return The byte ranges of the dirty slots in ascending order, adjacent slots are merged into one range.
+         */
+        std::vector<Range> getDirtyRanges() const {
+            std::vector<Range> ret;
+            if (dirtySlots.empty()) {
+                return ret;
+            }
+            // Walk the dirty flags if most slots are dirty, otherwise sort the dirty slots.
+            std::vector<Slot> slots;
+            if (dirtySlots.size() * 8 > elements.size()) {
+                slots.reserve(dirtySlots.size());
+                for (Slot i = 0; i < elements.size(); i++) {
+                    if (dirty[i]) {
+                        slots.emplace_back(i);
+                    }
+                }
+            } else {
+                slots = dirtySlots;
+                std::sort(slots.begin(), slots.end());
+            }
+            for (auto slot: slots) {
+                const auto offset = static_cast<size_t>(slot) * sizeof(T);
+                if (!ret.empty() && ret.back().offset + ret.back().size == offset) {
+                    ret.back().size += sizeof(T);
+                } else {
+                    ret.push_back({offset, sizeof(T)});
+                }
+            }
+            return ret;
+        }
+
+        void clearDirty() {
+            for (auto slot: dirtySlots) {
+                dirty[slot] = false;
+            }
+            dirtySlots.clear();
+        }
+
+    private:
+        void markDirty(const Slot slot) {
+            if (!dirty[slot]) {
+                dirty[slot] = true;
+                dirtySlots.emplace_back(slot);
+            }
+        }
+
+        std::vector<T> elements;
+        std::vector<bool> dirty;
+        std::vector<Slot> dirtySlots;
+        std::vector<Slot> freeSlots;
+    };
+}
+
+#endif //XENGINE_SLOTARRAY_HPP
@@ -23,9 +23,11 @@
 
 namespace xng {
     /**
-     * The stream buffer dynamically grows in size if flushed uploads exceed targetSize and dynamically shrinks back to targetSize.
+     * The stream buffer dynamically grows in size if uploads exceed targetSize.
      *
-     * TODO: Efficient stream buffer shrinking
+     * The stream buffer does not know which released ranges are still in use (e.g. light arrays are read in full
+     * after the uploads of the changed slots were released), so compaction is driven by the owner of the offsets:
+     * relocate() moves finished uploads into holes and shrink() releases the memory above the owner's high-water mark.
      */
     class StreamBuffer {
     public:
@@ -33,6 +35,12 @@ namespace xng {
 
         static constexpr Handle INVALID_HANDLE = ChunkStreamer::INVALID_HANDLE;
 
+        struct Statistics {
+            size_t size = 0; // The current size of the buffer in bytes
+            size_t relocatedBytes = 0; // The number of bytes moved by relocate() since creation
+            size_t reclaimedBytes = 0; // The number of bytes released by shrinking since creation
+        };
+
         StreamBuffer(rg::Heap &heap,
                      ChunkStreamer &chunkStreamer,
                      const rg::Buffer::Capability capabilities,
@@ -60,10 +68,14 @@ namespace xng {
               buffer(std::move(other.buffer)),
               targetSize(other.targetSize),
               bufferSize(other.bufferSize),
+              shrinkThreshold(other.shrinkThreshold),
               uploads(std::move(other.uploads)),
               pendingUploads(std::move(other.pendingUploads)),
               flushedUploads(std::move(other.flushedUploads)),
-              finishedUploads(std::move(other.finishedUploads)) {
+              finishedUploads(std::move(other.finishedUploads)),
+              relocations(std::move(other.relocations)),
+              relocatedBytes(other.relocatedBytes),
+              reclaimedBytes(other.reclaimedBytes) {
         }
 
         StreamBuffer &operator=(StreamBuffer &&other) noexcept {
@@ -71,14 +83,18 @@ namespace xng {
             buffer = std::move(other.buffer);
             targetSize = other.targetSize;
             bufferSize = other.bufferSize;
+            shrinkThreshold = other.shrinkThreshold;
             uploads = std::move(other.uploads);
             pendingUploads = std::move(other.pendingUploads);
             flushedUploads = std::move(other.flushedUploads);
             finishedUploads = std::move(other.finishedUploads);
+            relocations = std::move(other.relocations);
+            relocatedBytes = other.relocatedBytes;
+            reclaimedBytes = other.reclaimedBytes;
             return *this;
         }
 
-        Handle upload(std::vector<uint8_t> data, const size_t offset) {
+        Handle upload(std::vector<uint8_t> data, const size_t offset, const int priority = 0) {
             const auto dataSize = data.size();
 #ifndef NDEBUG
             for (auto &upload: uploads) {
@@ -90,7 +106,7 @@ namespace xng {
 #endif
             bufferSize = std::max(bufferSize, offset + dataSize);
             bufferSize = std::max(bufferSize, targetSize);
-            const auto ret = chunkStreamer.upload(std::move(data), buffer, offset);
+            const auto ret = chunkStreamer.upload(std::move(data), buffer, offset, priority);
             uploads.emplace(ret, PendingUpload{offset, dataSize});
             pendingUploads.insert(ret);
             return ret;
@@ -104,9 +120,10 @@ namespace xng {
          * @param data The pointer to the start of the data to upload
          * @param dataSize The size of the data to upload
          * @param offset The offset into the stable buffer to upload to.
+         * @param priority Uploads with higher priority are streamed first.
          * @return The offset of the data in the stable buffer.
          */
-        Handle upload(const uint8_t *data, const size_t dataSize, const size_t offset) {
+        Handle upload(const uint8_t *data, const size_t dataSize, const size_t offset, const int priority = 0) {
 #ifndef NDEBUG
             for (auto &upload: uploads) {
                 if (upload.second.offset >= offset && upload.second.offset + upload.second.size <= offset + dataSize) {
@@ -116,7 +133,7 @@ namespace xng {
 #endif
             bufferSize = std::max(bufferSize, offset + dataSize);
             bufferSize = std::max(bufferSize, targetSize);
-            const auto ret = chunkStreamer.upload(data, dataSize, buffer, offset);
+            const auto ret = chunkStreamer.upload(data, dataSize, buffer, offset, priority);
             uploads.emplace(ret, PendingUpload{offset, dataSize});
             pendingUploads.insert(ret);
             return ret;
@@ -167,6 +184,101 @@ namespace xng {
             uploads.erase(handle);
         }
 
+        /**
+         * @param handle
+         * @return True if the data of the passed upload was copied into the buffer by a previous frame and can be relocated.
+         */
+        bool canRelocate(const Handle handle) const {
+            // Flushed uploads are copied by the chunk streamer commit of the frame in which they are moved to
+            // finishedUploads, which is recorded after this buffers commit, so they can be relocated from the next frame on.
+            return finishedUploads.find(handle) != finishedUploads.end();
+        }
+
+        /**
+         * Move the data of a finished upload to a different offset in the buffer.
+         *
+         * The copy is recorded on the next commit before the chunk streamer copies of that frame,
+         * so the owner can use the new offset immediately and reuse the old range for new uploads.
+         *
+         * @param handle The handle of the upload to move, canRelocate() must return true.
+         * @param offset The new offset of the data, the range must be inside the buffer and not overlap any other upload.
+         */
+        void relocate(const Handle handle, const size_t offset) {
+            if (!canRelocate(handle)) {
+                throw std::runtime_error("Cannot relocate an unfinished upload");
+            }
+            auto &upload = uploads.at(handle);
+            // The relocations are recorded before a resize, so the target must be inside the current buffer.
+            if (offset + upload.size > buffer.getDescription().size) {
+                throw std::runtime_error("Relocation out of bounds");
+            }
+#ifndef NDEBUG
+            for (auto &pair: uploads) {
+                if (pair.first != handle
+                    && pair.second.offset < offset + upload.size
+                    && offset < pair.second.offset + pair.second.size) {
+                    throw std::runtime_error("Overlapping relocation");
+                }
+            }
+#endif
+            const Relocation relocation{upload.offset, offset, upload.size};
+
+            // Copies in one pass are not ordered against each other,
+            // a relocation touching a range of the current pass starts a new pass.
+            if (relocations.empty()) {
+                relocations.emplace_back();
+            }
+            for (auto &other: relocations.back()) {
+                if (relocation.overlaps(other)) {
+                    relocations.emplace_back();
+                    break;
+                }
+            }
+            relocations.back().emplace_back(relocation);
+
+            upload.offset = offset;
+            relocatedBytes += upload.size;
+        }
+
+        /**
+         * Release the memory above the passed size.
+         *
+         * The owner guarantees that the data above size is not used anymore, the ranges of live uploads are always kept.
+         * The buffer is only reallocated if at least the shrink threshold fraction of the buffer is released.
+         *
+         * @param size The number of bytes used by the owner
+         * @return True if the buffer is reallocated with the reduced size on the next commit
+         */
+        bool shrink(const size_t size) {
+            auto newSize = std::max(size, targetSize);
+            if (!isShrinkable(newSize)) {
+                return false;
+            }
+            for (auto &pair: uploads) {
+                newSize = std::max(newSize, pair.second.offset + pair.second.size);
+            }
+            if (!isShrinkable(newSize)) {
+                return false;
+            }
+            bufferSize = newSize;
+            return true;
+        }
+
+        /**
+         * @param threshold The minimum fraction of the buffer size which must be released by shrink() to reallocate the buffer.
+         */
+        void setShrinkThreshold(const float threshold) {
+            shrinkThreshold = threshold;
+        }
+
+        float getShrinkThreshold() const {
+            return shrinkThreshold;
+        }
+
+        Statistics getStatistics() const {
+            return {buffer.getDescription().size, relocatedBytes, reclaimedBytes};
+        }
+
         /**
          * Commit the pending uploads.
          *
@@ -191,6 +303,24 @@ namespace xng {
             // with other operations on the graphics queue because the runtime can use range granular pipeline barriers
             // as the copy happens completely intra queue.
 
+            // Relocations are recorded before the resize so the moved data is below the new size,
+            // and before the chunk streamer copies so released source ranges can receive new uploads in the same frame.
+            for (auto &pass: relocations) {
+                auto builder = rg::GraphicsPassBuilder("StreamBuffer/Relocate");
+                for (auto &relocation: pass) {
+                    builder.transferRead(buffer, relocation.source, relocation.size);
+                    builder.transferWrite(buffer, relocation.target, relocation.size);
+                }
+                queue.addPreFrame(builder.execute([target = buffer, pass = std::move(pass)](rg::RasterContext &,
+                                                      rg::TransferContext &ctx,
+                                                      rg::ComputeContext &) {
+                        for (auto &relocation: pass) {
+                            ctx.copyBuffer(target, target, relocation.target, relocation.source, relocation.size);
+                        }
+                    }));
+            }
+            relocations.clear();
+
             if (buffer.getDescription().size != bufferSize) {
                 const auto staleBuffer = buffer;
                 buffer = heap.allocateBuffer(rg::Buffer(bufferSize,
@@ -198,16 +328,21 @@ namespace xng {
                                                         buffer.getDescription().memoryType));
 
                 const auto copySize = std::min(staleBuffer.getDescription().size, buffer.getDescription().size);
+                if (bufferSize < staleBuffer.getDescription().size) {
+                    reclaimedBytes += staleBuffer.getDescription().size - bufferSize;
+                }
 
                 auto pass = rg::GraphicsPassBuilder("StreamBuffer/Resize")
-                        .transferRead(staleBuffer, 0, staleBuffer.getDescription().size)
-                        .transferWrite(buffer, 0, staleBuffer.getDescription().size)
-                        .execute([this, staleBuffer, copySize](rg::RasterContext &,
-                                                               rg::TransferContext &ctx,
-                                                               rg::ComputeContext &) {
+                        .transferRead(staleBuffer, 0, copySize)
+                        .transferWrite(buffer, 0, copySize)
+                        .execute([target = buffer, staleBuffer, copySize](rg::RasterContext &,
+                                                                          rg::TransferContext &ctx,
+                                                                          rg::ComputeContext &) {
                             // The stale buffers are pinned via HeapResource references in the lambda and
                             // the runtime will pin the stale buffers additionally until the graph finished execution.
-                            ctx.copyBuffer(buffer, staleBuffer, 0, 0, copySize);
+                            // The target is captured by value because the buffer can be resized again
+                            // before this frame executes.
+                            ctx.copyBuffer(target, staleBuffer, 0, 0, copySize);
                         });
 
                 queue.addPreFrame(std::move(pass));
@@ -251,13 +386,36 @@ namespace xng {
         }
 
     private:
-        static constexpr size_t timeOut = 10'000'000'000ULL;
-
         struct PendingUpload {
             size_t offset;
             size_t size;
         };
 
+        struct Relocation {
+            size_t source;
+            size_t target;
+            size_t size;
+
+            /**
+             * @return True if the source or target range of this relocation intersects the source or target range of other.
+             */
+            bool overlaps(const Relocation &other) const {
+                return intersects(source, other.source, other.size)
+                       || intersects(source, other.target, other.size)
+                       || intersects(target, other.source, other.size)
+                       || intersects(target, other.target, other.size);
+            }
+
+            bool intersects(const size_t offset, const size_t otherOffset, const size_t otherSize) const {
+                return offset < otherOffset + otherSize && otherOffset < offset + size;
+            }
+        };
+
+        bool isShrinkable(const size_t size) const {
+            return size < bufferSize
+                   && static_cast<float>(bufferSize - size) >= static_cast<float>(bufferSize) * shrinkThreshold;
+        }
+
         rg::Heap &heap;
         ChunkStreamer &chunkStreamer;
 
@@ -266,10 +424,17 @@ namespace xng {
         size_t targetSize = 0;
         size_t bufferSize = 0;
 
+        float shrinkThreshold = 0.25f;
+
         std::unordered_map<Handle, PendingUpload> uploads;
         std::unordered_set<Handle> pendingUploads;
         std::unordered_set<Handle> flushedUploads;
         std::unordered_set<Handle> finishedUploads;
+
+        std::vector<std::vector<Relocation> > relocations; // The relocations of the next commit grouped by pass
+
+        size_t relocatedBytes = 0;
+        size_t reclaimedBytes = 0;
     };
 }
 
@@ -27,6 +27,7 @@
 #include "xng/assets/image.hpp"
 #include "xng/rendergraph/heap.hpp"
 #include "xng/rendergraph/resource/texture.hpp"
+#include "xng/util/rangeallocator.hpp"
 
 namespace xng {
     /**
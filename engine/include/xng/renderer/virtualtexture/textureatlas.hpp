@@ -19,11 +19,13 @@
 #ifndef XENGINE_TEXTUREATLAS_HPP
 #define XENGINE_TEXTUREATLAS_HPP
 
+#include <map>
 #include <utility>
 
 #include "xng/rendergraph/runtime.hpp"
 
 #include "xng/renderer/stream/streambuffer.hpp"
+#include "xng/util/rangeallocator.hpp"
 
 namespace xng {
     class TextureAtlas {
@@ -100,6 +102,7 @@ namespace xng {
                                                     uploadBuffer,
                                                     getOffset(slot),
                                                     std::move(texels),
+                                                    priority,
                                                     callback));
             pendingUploadPriorities.emplace(slot, priority);
             pendingUploadQueues[priority].insert(slot);
@@ -284,13 +287,16 @@ namespace xng {
                        UploadBuffer &uploadBuffer,
                        Vec3u offset,
                        std::vector<uint8_t> texels,
+                       const int priority,
                        UploadCallbackHandler &callback)
                 : slot(slot),
                   offset(std::move(offset)),
                   uploadBuffer(uploadBuffer),
                   callback(callback) {
                 uploadBufferSlot = uploadBuffer.allocator.allocate(1);
-                uploadBufferHandle = uploadBuffer.buffer.upload(std::move(texels), uploadBufferSlot * atlasTileBytes);
+                uploadBufferHandle = uploadBuffer.buffer.upload(std::move(texels),
+                                                                uploadBufferSlot * atlasTileBytes,
+                                                                priority);
             }
 
             ~TileUpload() {
@@ -359,7 +365,7 @@ namespace xng {
 
         std::unordered_set<Slot> copiedUploads;
 
-        std::unordered_map<int, std::unordered_set<Slot> > pendingUploadQueues;
+        std::map<int, std::unordered_set<Slot>, std::greater<> > pendingUploadQueues; // Highest priority first
 
         RangeAllocator slotAllocator;
     };
@@ -35,6 +35,7 @@
 #include "xng/renderer/stream/streambuffer.hpp"
 #include "xng/renderer/virtualtexture/textureatlas.hpp"
 #include "xng/renderer/virtualtexture/tileloader.hpp"
+#include "xng/util/rangeallocator.hpp"
 
 namespace xng {
     /**
@@ -132,8 +132,6 @@ namespace xng {
             }
         }
 
-        static constexpr size_t timeOut = 10'000'000'000ULL;
-
         void readback(RenderQueue &queue) {
             // Readback taps
 
@@ -146,9 +144,13 @@ namespace xng {
 
             // RenderDoc appears to not handle coherent mappings correctly.
             // This is now fixed internally in the opengl adapter via explicit flush / invalidate semantics.
+
+            // With multiple frames in flight the previous readback is usually not finished yet.
+            // Instead of stalling on the frame the feedback is consumed once available and there is only ever
+            // one readback in flight because the readback host buffer is mapped here.
             if (readbackFence != nullptr) {
-                if (!readbackFence->wait(timeOut)) {
-                    throw std::runtime_error("Virtual texture readback timed out.");
+                if (!readbackFence->isSignaled()) {
+                    return;
                 }
 
                 std::unordered_map<unsigned int, std::unordered_set<Vec2u> > pinnedTiles;
@@ -83,6 +83,18 @@ namespace xng::rg {
          */
         virtual std::unique_ptr<HeapMapping> map(const HeapResource<Buffer> &target) = 0;
 
+        /**
+         * Map a MEMORY_CPU_TO_GPU buffer into process memory without waiting for executions which use the buffer.
+         *
+         * map() may block until all executions referencing the buffer have finished,
+         * this mapping returns immediately and the caller must guarantee through fences that the ranges it writes
+         * are not in use, for example a staging ring which only reuses ranges whose transfers have completed.
+         *
+         * @param target
+         * @return
+         */
+        virtual std::unique_ptr<HeapMapping> mapUnsynchronized(const HeapResource<Buffer> &target) = 0;
+
         virtual size_t getMemoryUsage() = 0;
 
     private:
@@ -30,6 +30,10 @@ namespace xng {
 
         static ImageRGBF readImageFloat(const std::vector<char> &buffer);
 
+        static ImageRGBA readImageRGBA(const char *buffer, size_t size);
+
+        static ImageRGBF readImageFloat(const char *buffer, size_t size);
+
         ResourceBundle read(std::istream &stream,
                             const Uri &path,
                             Archive *archive) override;
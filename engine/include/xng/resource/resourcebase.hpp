@@ -39,6 +39,14 @@ namespace xng {
          * @return Wheter or not the dependencies of this resource are loaded.
          */
         virtual bool isLoaded() const { return true; }
+
+        /**
+         * The number of bytes of memory used by this resource, used by the registry for enforcing the memory budget.
+         * Resources which do not override this are not accounted for.
+         *
+         * @return The size of the resource data in bytes.
+         */
+        virtual size_t getSize() const { return 0; }
     };
 }
 
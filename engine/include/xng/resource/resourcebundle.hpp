@@ -89,6 +89,17 @@ namespace xng {
             return assets.find(name) != assets.end();
         }
 
+        /**
+         * @return The sum of the sizes of the contained resources in bytes.
+         */
+        size_t getSize() const {
+            size_t ret = 0;
+            for (auto &pair: assets) {
+                ret += pair.second->getSize();
+            }
+            return ret;
+        }
+
         std::unordered_map<std::string, std::unique_ptr<ResourceBase> > assets;
     };
 }
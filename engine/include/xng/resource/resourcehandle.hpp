@@ -28,6 +28,12 @@
 #include "xng/io/messageable.hpp"
 
 namespace xng {
+    /**
+     * A reference to a resource which keeps the bundle of the resource loaded.
+     *
+     * Copying a handle increments the atomic reference count of the bundle without locking the registry,
+     * only creating a handle from an uri and releasing the last handle of a bundle lock the registry.
+     */
     template<typename T>
     class ResourceHandle : public Messageable {
     public:
@@ -37,21 +43,18 @@ namespace xng {
                                 ResourceRegistry *r = nullptr)
             : uri(std::move(u)), registry(r) {
             if (!uri.empty()) {
-                getRegistry().incRef(uri);
+                reference = &getRegistry().acquire(uri);
             }
         }
 
         ~ResourceHandle() override {
-            if (!uri.empty()) {
-                getRegistry().decRef(uri);
-            }
+            release();
         }
 
-        ResourceHandle(const ResourceHandle<T> &other) {
-            uri = other.uri;
-            registry = other.registry;
-            if (!uri.empty()) {
-                getRegistry().incRef(uri);
+        ResourceHandle(const ResourceHandle<T> &other)
+            : uri(other.uri), registry(other.registry), reference(other.reference) {
+            if (reference != nullptr) {
+                ResourceRegistry::addRef(*reference);
             }
         }
 
@@ -59,18 +62,38 @@ namespace xng {
             if (this == &other)
                 return *this;
 
+            if (other.reference != nullptr) {
+                ResourceRegistry::addRef(*other.reference);
+            }
+            release();
+
             uri = other.uri;
             registry = other.registry;
-            if (!uri.empty()) {
-                getRegistry().incRef(uri);
-            }
+            reference = other.reference;
 
             return *this;
         }
 
-        ResourceHandle(ResourceHandle<T> &&other) noexcept = default;
+        ResourceHandle(ResourceHandle<T> &&other) noexcept
+            : uri(std::move(other.uri)), registry(other.registry), reference(other.reference) {
+            other.uri = {};
+            other.reference = nullptr;
+        }
 
-        ResourceHandle<T> &operator=(ResourceHandle<T> &&other) noexcept = default;
+        ResourceHandle<T> &operator=(ResourceHandle<T> &&other) noexcept {
+            if (this == &other)
+                return *this;
+
+            release();
+
+            uri = std::move(other.uri);
+            registry = other.registry;
+            reference = other.reference;
+            other.uri = {};
+            other.reference = nullptr;
+
+            return *this;
+        }
 
         bool operator==(const ResourceHandle<T> &other) const {
             return uri == other.uri
@@ -114,9 +137,10 @@ namespace xng {
         }
 
         Messageable &operator<<(const Message &message) override {
+            release();
             uri << message.getMessage("uri");
             if (!uri.empty()) {
-                getRegistry().incRef(uri);
+                reference = &getRegistry().acquire(uri);
             }
             return *this;
         }
@@ -129,8 +153,16 @@ namespace xng {
         }
 
     private:
+        void release() {
+            if (reference != nullptr) {
+                getRegistry().release(*reference);
+                reference = nullptr;
+            }
+        }
+
         Uri uri;
         ResourceRegistry *registry = nullptr;
+        ResourceRegistry::Reference *reference = nullptr;
     };
 }
 
@@ -19,7 +19,14 @@
 #ifndef XENGINE_RESOURCEREGISTRY_HPP
 #define XENGINE_RESOURCEREGISTRY_HPP
 
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <limits>
+#include <list>
 #include <memory>
+#include <mutex>
+#include <set>
 #include <unordered_map>
 #include <unordered_set>
 #include <condition_variable>
@@ -35,17 +42,69 @@
 
 #include "xng/async/threadpool.hpp"
 
-#include "xng/util/refcounter.hpp"
-
 namespace xng {
     /**
      * A resource registry is responsible for loading and managing resource data.
      * The registry invokes the set importer for importing data.
      * The registry uses reference counting for resource lifetime management.
      * ResourceHandle can be used to do the reference counting with a RAII interface.
+     *
+     * Each bundle has an atomic reference count, only the transitions between zero and non-zero lock the registry.
+     *
+     * Bundles which are no longer referenced are kept in a least recently used cache
+     * until the resident bytes exceed the memory budget.
+     *
+     * Bundles are loaded in two stages, the file data is read from the archive and then decoded by the importer.
+     * Each stage runs the queued loads with the highest priority first and is limited to a number of concurrent loads
+     * so that reads do not occupy all workers of the thread pool while decoded data is waiting.
+     * Loads of bundles which are no longer referenced are cancelled.
      */
     class XENGINE_EXPORT ResourceRegistry {
     public:
+        static const size_t LOAD_LATENCY_BUCKETS = 16;
+
+        /**
+         * The reference count of a bundle.
+         *
+         * References are owned by the registry and stay valid for the lifetime of the registry.
+         */
+        class Reference {
+        public:
+            explicit Reference(Uri uri)
+                : uri(std::move(uri)) {}
+
+            unsigned long getCount() const { return count; }
+
+        private:
+            friend class ResourceRegistry;
+
+            Uri uri;
+            std::atomic<unsigned long> count = 0;
+            bool referenced = false; // True while the bundle is referenced by the registry, guarded by the reference mutex
+        };
+
+        static const size_t DEFAULT_MAX_CONCURRENT_READS = 2;
+
+        static const size_t READ_SIZE = 256 * 1024; // The number of bytes read at once, cancellation is checked between reads
+
+        static constexpr std::chrono::milliseconds DEFAULT_RESCAN_INTERVAL{1000};
+
+        struct Statistics {
+            size_t residentBytes = 0; // The size of all loaded bundles including cached bundles
+            size_t cachedBytes = 0; // The size of the unreferenced bundles in the cache
+            size_t cachedBundles = 0;
+            size_t hits = 0; // The number of references to a bundle which was still in the cache
+            size_t misses = 0; // The number of references to a bundle which had to be loaded
+            size_t evictions = 0;
+
+            /**
+             * The number of loads by latency measured from the reference until the bundle is available.
+             * Bucket 0 counts loads which took less than 1 ms, bucket i counts loads which took less than 2^i ms
+             * and the last bucket counts all slower loads.
+             */
+            std::array<size_t, LOAD_LATENCY_BUCKETS> loadLatency{};
+        };
+
         /**
          * The default registry used by resource handle if no registry is specified.
          *
@@ -82,6 +141,19 @@ namespace xng {
          */
         void setDefaultScheme(const std::string &scheme) { defaultScheme = scheme; }
 
+        /**
+         * Get the archive which contains the file of the uri.
+         *
+         * Uris without a scheme are resolved through an index of the file names listed by the archives,
+         * the uri file must match the listed name exactly.
+         * If the index does not contain the file the archives which changed since they were indexed are indexed again,
+         * at most once per rescan interval, before every archive is asked whether it contains the file.
+         *
+         * @param uri
+         * @return
+         */
+        std::shared_ptr<Archive> resolveUri(const Uri &uri);
+
         /**
          * If the scheme on uri is not set the registry uses the archive of the default scheme and if no default archive is set it
          * returns the first archive for which the uri file exists otherwise an exception is thrown.
@@ -96,6 +168,7 @@ namespace xng {
             if (it != loadTasks.end()) {
                 auto task = it->second;
                 mutex.unlock();
+                prioritize(uri, std::numeric_limits<int>::max());
                 auto ex = task->join();
                 if (ex) {
                     std::rethrow_exception(ex);
@@ -114,7 +187,38 @@ namespace xng {
             }
         }
 
-        void incRef(const Uri &uri);
+        /**
+         * Increment the reference count of the bundle of the uri and queue a load if the bundle is not loaded.
+         *
+         * @param uri
+         * @param priority The priority of the load, loads with a higher priority are started first.
+         * @return The reference of the bundle which can be passed to addRef and release.
+         */
+        Reference &acquire(const Uri &uri, int priority = 0);
+
+        /**
+         * Increment the reference count of a bundle which is already referenced by the caller without locking the registry.
+         *
+         * @param reference
+         */
+        static void addRef(Reference &reference) {
+            reference.count.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        /**
+         * Decrement the reference count of the bundle, the registry is only locked when the count reaches zero.
+         *
+         * @param reference
+         */
+        void release(Reference &reference) {
+            if (reference.count.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+                unreferenced(reference);
+            }
+        }
+
+        void incRef(const Uri &uri, int priority = 0) {
+            acquire(uri, priority);
+        }
 
         void decRef(const Uri &uri);
 
@@ -148,26 +252,150 @@ namespace xng {
 
         bool isLoading(const Uri &uri) {
             std::lock_guard<std::mutex> g(mutex);
-            return loadTasks.find(uri.getFile()) == loadTasks.end();
+            return loadRequests.find(uri.getFile()) != loadRequests.end();
         }
 
+        /**
+         * Set the number of bytes which loaded bundles may occupy before unreferenced bundles are evicted.
+         * Referenced bundles are never evicted, so the resident bytes can exceed the budget.
+         *
+         * The default budget of zero unloads bundles as soon as they are no longer referenced.
+         *
+         * @param bytes
+         */
+        void setMemoryBudget(size_t bytes);
+
+        /**
+         * Set the minimum time between checks of the indexed archives for added files when an uri is not in the index.
+         *
+         * Checking for changes can be expensive, for example directory archives compare the modification times
+         * of all listed directories, so uris which no archive contains do not check on every resolve.
+         *
+         * @param interval
+         */
+        void setRescanInterval(std::chrono::milliseconds interval);
+
+        size_t getMemoryBudget();
+
+        Statistics getStatistics();
+
+        /**
+         * Change the priority of a queued load, has no effect if the bundle is not queued for loading.
+         *
+         * @param uri
+         * @param priority
+         */
+        void prioritize(const Uri &uri, int priority);
+
+        /**
+         * Set the maximum number of loads which read file data and the maximum number of loads which decode file data at the same time.
+         *
+         * @param reads
+         * @param decodes Zero to use the number of threads of the thread pool
+         */
+        void setMaxConcurrentLoads(size_t reads, size_t decodes);
+
     private:
-        void load(const Uri &uri);
+        /**
+         * Unload the bundle if the reference count is still zero.
+         */
+        void unreferenced(Reference &reference);
+
+        struct LoadRequest;
+
+        struct LoadOrder {
+            bool operator()(const std::shared_ptr<LoadRequest> &lhs, const std::shared_ptr<LoadRequest> &rhs) const;
+        };
+
+        typedef std::set<std::shared_ptr<LoadRequest>, LoadOrder> LoadQueue;
+
+        void load(const Uri &uri, int priority);
 
         void unload(const Uri &uri);
 
-        Archive &resolveUri(const Uri &uri);
+        /**
+         * Evict the least recently used cached bundles until the resident bytes fit into the budget.
+         * Must be called with the mutex locked.
+         */
+        void evict();
+
+        /**
+         * Remove the bundle for the given file and its resources.
+         * Must be called with the mutex locked.
+         */
+        void eraseBundle(const std::string &file);
+
+        /**
+         * Destroy the bundles removed by eraseBundle, must be called without holding any lock of the registry
+         * because destroying resources can release the handles they contain.
+         */
+        void destroyReleasedBundles();
+
+        /**
+         * Add tasks for the queued loads until the concurrency limits are reached.
+         * The tasks take the queued load with the highest priority when they start,
+         * so the order in which the thread pool runs the tasks does not affect the load order.
+         * Must be called with the mutex locked.
+         */
+        void dispatchLoads();
+
+        /**
+         * Remove a queued load or flag a running load for cancellation.
+         * Must be called with the mutex locked.
+         */
+        void cancelLoad(std::shared_ptr<LoadRequest> request);
+
+        void readBundle();
+
+        void decodeBundle();
+
+        /**
+         * Complete the load and remove it from the pending loads.
+         * Must be called with the mutex locked.
+         */
+        void finishLoad(std::shared_ptr<LoadRequest> request);
+
+        /**
+         * Add the files of the archive to the path index.
+         * Must be called with the archive mutex locked exclusively.
+         */
+        void indexArchive(const std::string &scheme, Archive &archive);
+
+        /**
+         * Remove the files of the archive from the path index.
+         * Must be called with the archive mutex locked exclusively.
+         */
+        void unindexArchive(const std::string &scheme);
 
         std::mutex mutex;
 
         std::shared_mutex archiveMutex;
 
-        RefCounter<std::string, unsigned long> bundleRefCounter;
+        std::mutex referenceMutex;
+        std::unordered_map<std::string, std::unique_ptr<Reference> > references;
 
         std::unordered_map<std::string, std::shared_ptr<Task> > loadTasks;
+        std::unordered_map<std::string, std::shared_ptr<LoadRequest> > loadRequests;
+
+        LoadQueue readQueue;
+        LoadQueue decodeQueue;
+        size_t activeReads = 0; // The number of read tasks including tasks which have not started yet
+        size_t activeDecodes = 0;
+        size_t pendingReads = 0; // The number of read tasks which have not started yet
+        size_t pendingDecodes = 0;
+        size_t maxConcurrentReads = DEFAULT_MAX_CONCURRENT_READS;
+        size_t maxConcurrentDecodes = 0;
+        unsigned long long nextLoadSequence = 0;
 
         std::unordered_map<std::string, std::shared_ptr<Archive> > archives;
+        std::unordered_map<std::string, std::vector<std::string> > pathIndex; // The schemes of the archives containing a path
+        std::unordered_map<std::string, std::vector<std::string> > indexedPaths; // The indexed paths of an archive
+        std::unordered_set<std::string> unlistedArchives; // The schemes of the archives which cannot list their files
+        std::chrono::milliseconds rescanInterval = DEFAULT_RESCAN_INTERVAL;
+        std::chrono::steady_clock::time_point lastRescan{}; // The time the changed archives were last indexed again
         std::unordered_map<std::string, ResourceBundle> bundles;
+        std::unordered_map<std::string, size_t> bundleSizes;
+        std::vector<ResourceBundle> releasedBundles;
         std::unordered_map<Uri, const ResourceBase &> resources;
 
         std::string defaultScheme;
@@ -178,7 +406,10 @@ namespace xng {
         std::unordered_set<Uri> uris;
         std::unordered_set<Uri> loadingUris;
 
-        std::unordered_set<std::string> abortedBundleLoads;
+        size_t memoryBudget = 0;
+        std::list<std::string> cache; // The unreferenced bundles ordered from most to least recently used
+        std::unordered_map<std::string, std::list<std::string>::iterator> cacheEntries;
+        Statistics statistics;
     };
 }
 #endif //XENGINE_RESOURCEREGISTRY_HPP
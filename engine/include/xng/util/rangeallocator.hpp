@@ -21,6 +21,7 @@
 
 #include <cassert>
 #include <cstddef>
+#include <iterator>
 #include <map>
 
 namespace xng {
@@ -28,7 +29,9 @@ namespace xng {
     public:
         explicit RangeAllocator(const size_t initialSize = 0)
             : rangeCount(initialSize) {
-            freeRanges.emplace(0, initialSize);
+            if (initialSize > 0) {
+                freeRanges.emplace(0, initialSize);
+            }
         }
 
         bool hasFreeRange(const size_t count) const {
@@ -68,6 +71,11 @@ namespace xng {
         }
 
         void free(const size_t index, const size_t count) {
+            // Empty ranges are never stored so getFreeRanges() is empty if there are no holes
+            if (count == 0) {
+                return;
+            }
+
             // Insert freed range
             size_t targetRange = index;
             bool foundFreeRange = false;
@@ -126,6 +134,20 @@ namespace xng {
             }
         }
 
+        /**
+         * Remove the free range at the end so getSize() returns the end of the last allocated range.
+         */
+        void trim() {
+            if (freeRanges.empty()) {
+                return;
+            }
+            const auto it = std::prev(freeRanges.end());
+            if (it->first + it->second == rangeCount) {
+                rangeCount = it->first;
+                freeRanges.erase(it);
+            }
+        }
+
         [[nodiscard]] size_t getSize() const {
             return rangeCount;
         }
@@ -54,6 +54,7 @@
 #include "xng/assets/font.hpp"
 #include "xng/assets/color.hpp"
 #include "xng/assets/mesh.hpp"
+#include "xng/assets/meshoptimizer.hpp"
 #include "xng/layout/flexbox/flexnode.hpp"
 #include "xng/layout/flexbox/flexlayoutengine.hpp"
 #include "xng/layout/flexbox/flexwrap.hpp"
@@ -137,6 +138,8 @@
 #include "xng/rendergraph/shader/shaderprimitive.hpp"
 #include "xng/rendergraph/shader/shaderstructtype.hpp"
 #include "xng/crypto/sha.hpp"
+#include "xng/crypto/shastream.hpp"
+#include "xng/crypto/gzipstream.hpp"
 #include "xng/crypto/gzip.hpp"
 #include "xng/crypto/random.hpp"
 #include "xng/crypto/aes.hpp"
@@ -166,6 +169,8 @@
 #include "xng/io/writefile.hpp"
 #include "xng/io/messageable.hpp"
 #include "xng/io/substreambuf.hpp"
+#include "xng/io/memorystream.hpp"
+#include "xng/io/memorymappedfile.hpp"
 #include "xng/io/archive/memoryarchive.hpp"
 #include "xng/io/archive/directoryarchive.hpp"
 #include "xng/io/archive/pakarchive.hpp"
@@ -221,7 +226,10 @@
 #include "xng/ecs/componentregistry.hpp"
 #include "xng/ecs/system.hpp"
 #include "xng/ecs/componentpool.hpp"
+#include "xng/ecs/componenttype.hpp"
+#include "xng/ecs/componentaccess.hpp"
 #include "xng/ecs/entity.hpp"
+#include "xng/ecs/transformhierarchy.hpp"
 #include "xng/ecs/components.hpp"
 #include "xng/ecs/entityname.hpp"
 #include "xng/ecs/entityscene.hpp"
@@ -261,5 +269,6 @@
 #include "xng/ecs/profiling/ecsframelist.hpp"
 #include "xng/ecs/profiling/ecssample.hpp"
 #include "xng/ecs/profiling/ecsprofiler.hpp"
+#include "xng/ecs/profiling/ecssystemstatistics.hpp"
 
 #endif // XENGINE_ENGINE_HPP
\ No newline at end of file
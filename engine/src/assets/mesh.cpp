@@ -20,6 +20,14 @@
 
 #include "xng/math/pi.hpp"
 
+#include "xng/async/threadpool.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+
 using namespace xng::rg;
 
 namespace xng {
@@ -203,29 +211,225 @@ namespace xng {
         return ret;
     }
 
-    static Mesh computeTangents(const Mesh &mesh) {
-        assert(!mesh.normals.empty());
-        assert(!mesh.uvs.empty());
+    static const size_t PARALLEL_VERTEX_COUNT = 64 * 1024; // Meshes with at least this many vertices are processed in parallel
+    static const unsigned int NO_VERTEX = std::numeric_limits<unsigned int>::max();
 
-        const auto vertexCount = mesh.positions.size();
+    template<typename F>
+    static void forEachIndex(size_t count, bool parallel, const F &func) {
+        if (parallel) {
+            ThreadPool::getPool().parallelFor(0, count, func);
+        } else {
+            for (size_t i = 0; i < count; i++) {
+                func(i);
+            }
+        }
+    }
+
+    struct CellKey {
+        int64_t x, y, z;
+
+        bool operator==(const CellKey &other) const {
+            return x == other.x && y == other.y && z == other.z;
+        }
+    };
+
+    static size_t hashCell(const CellKey &key) {
+        auto h = static_cast<uint64_t>(key.x) * 0x9E3779B97F4A7C15ull
+                 ^ static_cast<uint64_t>(key.y) * 0xC2B2AE3D27D4EB4Full
+                 ^ static_cast<uint64_t>(key.z) * 0x165667B19E3779F9ull;
+        return static_cast<size_t>(h ^ (h >> 29));
+    }
+
+    /**
+     * Hash grid mapping cells to the list of vertices inside the cell, the lists are sorted by vertex index.
+     */
+    class VertexGrid {
+    public:
+        explicit VertexGrid(const std::vector<CellKey> &keys)
+            : next(keys.size(), NO_VERTEX),
+              vertexSlots(keys.size()) {
+            size_t capacity = 16;
+            while (capacity < keys.size() * 2) {
+                capacity *= 2;
+            }
+            mask = capacity - 1;
+            slots.resize(capacity);
+
+            for (auto i = keys.size(); i-- > 0;) {
+                auto slot = findSlot(keys[i]);
+                slots[slot].key = keys[i];
+                next[i] = slots[slot].head;
+                slots[slot].head = static_cast<unsigned int>(i);
+                vertexSlots[i] = static_cast<unsigned int>(slot);
+            }
+        }
+
+        /**
+         * @return The lowest vertex index in the cell or NO_VERTEX
+         */
+        unsigned int first(const CellKey &key) const {
+            return slots[findSlot(key)].head;
+        }
+
+        /**
+         * @return The lowest vertex index in the cell of the given vertex
+         */
+        unsigned int firstOf(size_t vertex) const {
+            return slots[vertexSlots[vertex]].head;
+        }
 
-        std::map<std::tuple<float, float, float>, std::vector<unsigned int> > positionToVertices;
-        for (unsigned int i = 0; i < vertexCount; i++) {
-            const auto &p = mesh.positions.at(i);
-            positionToVertices[{p.x, p.y, p.z}].push_back(i);
+        unsigned int getNext(unsigned int vertex) const {
+            return next[vertex];
+        }
+
+    private:
+        struct Slot {
+            CellKey key{};
+            unsigned int head = NO_VERTEX;
+        };
+
+        size_t findSlot(const CellKey &key) const {
+            auto slot = hashCell(key) & mask;
+            while (slots[slot].head != NO_VERTEX && !(slots[slot].key == key)) {
+                slot = (slot + 1) & mask;
+            }
+            return slot;
+        }
+
+        size_t mask;
+        std::vector<Slot> slots;
+        std::vector<unsigned int> next;
+        std::vector<unsigned int> vertexSlots;
+    };
+
+    /**
+     * Link every vertex to the lowest vertex index within epsilon of its position and assign every vertex
+     * to the group at the end of its chain of links.
+     *
+     * Positions are hashed into a grid with cells of twice the epsilon, so only the cell of the vertex
+     * and the neighbouring cells nearest to the vertex on each axis are searched. With an epsilon of zero the cells are the exact positions.
+     *
+     * Vertices are welded through chains of links, so the vertices of a group may be further than epsilon apart.
+     *
+     * @return The group of each vertex, which is the index of the first vertex of the group
+     */
+    static std::vector<unsigned int> weldPositions(const std::vector<Vec3f> &positions, float epsilon, bool parallel) {
+        const auto cellSize = epsilon * 2;
+
+        std::vector<CellKey> keys(positions.size());
+        std::vector<uint8_t> sides(epsilon > 0 ? positions.size() : 0); // Bit set if the nearest neighbouring cell on the axis is above
+        forEachIndex(positions.size(), parallel, [&](size_t i) {
+            auto &p = positions[i];
+            if (epsilon > 0) {
+                auto x = std::floor(p.x / cellSize);
+                auto y = std::floor(p.y / cellSize);
+                auto z = std::floor(p.z / cellSize);
+                keys[i] = {static_cast<int64_t>(x), static_cast<int64_t>(y), static_cast<int64_t>(z)};
+                sides[i] = static_cast<uint8_t>((p.x / cellSize - x >= 0.5f ? 1 : 0)
+                                                | (p.y / cellSize - y >= 0.5f ? 2 : 0)
+                                                | (p.z / cellSize - z >= 0.5f ? 4 : 0));
+            } else {
+                // Adding zero maps negative zero to positive zero
+                auto bits = [](float value) {
+                    value += 0.0f;
+                    uint32_t ret;
+                    std::memcpy(&ret, &value, sizeof(ret));
+                    return static_cast<int64_t>(ret);
+                };
+                keys[i] = {bits(p.x), bits(p.y), bits(p.z)};
+            }
+        });
+
+        VertexGrid grid(keys);
+
+        std::vector<unsigned int> groups(positions.size());
+        const auto epsilonSquared = epsilon * epsilon;
+        forEachIndex(positions.size(), parallel, [&](size_t i) {
+            if (epsilon <= 0) {
+                groups[i] = grid.firstOf(i);
+                return;
+            }
+            auto &p = positions[i];
+            auto &key = keys[i];
+            auto side = sides[i];
+            auto best = static_cast<unsigned int>(i);
+            for (int cell = 0; cell < 8; cell++) {
+                CellKey neighbour{key.x + (cell & 1 ? (side & 1 ? 1 : -1) : 0),
+                                  key.y + (cell & 2 ? (side & 2 ? 1 : -1) : 0),
+                                  key.z + (cell & 4 ? (side & 4 ? 1 : -1) : 0)};
+                auto v = cell == 0 ? grid.firstOf(i) : grid.first(neighbour);
+                for (; v != NO_VERTEX && v < best; v = grid.getNext(v)) {
+                    auto d = positions[v] - p;
+                    if (d.x * d.x + d.y * d.y + d.z * d.z <= epsilonSquared) {
+                        best = v;
+                        break;
+                    }
+                }
+            }
+            groups[i] = best;
+        });
+
+        // Links point to lower indices, so the link of a vertex has been flattened before the vertex is visited.
+        if (epsilon > 0) {
+            for (size_t i = 0; i < groups.size(); i++) {
+                groups[i] = groups[groups[i]];
+            }
+        }
+        return groups;
+    }
+
+    /**
+     * The triangle corners referencing the vertices of each group, stored contiguously per group.
+     */
+    struct GroupCorners {
+        std::vector<unsigned int> offsets; // The corners of group g are corners[offsets[g]] to corners[offsets[g + 1]]
+        std::vector<unsigned int> corners;
+
+        GroupCorners(const std::vector<unsigned int> &groups, const std::vector<unsigned int> &cornerVertices)
+            : offsets(groups.size() + 1, 0),
+              corners(cornerVertices.size()) {
+            for (auto vertex: cornerVertices) {
+                offsets[groups[vertex] + 1]++;
+            }
+            for (size_t i = 1; i < offsets.size(); i++) {
+                offsets[i] += offsets[i - 1];
+            }
+            std::vector<unsigned int> fill(offsets.begin(), offsets.end() - 1);
+            for (size_t c = 0; c < cornerVertices.size(); c++) {
+                corners[fill[groups[cornerVertices[c]]]++] = static_cast<unsigned int>(c);
+            }
         }
+    };
 
-        std::vector<Vec3f> tangents(vertexCount, Vec3f(0, 0, 0));
-        std::vector<Vec3f> bitangents(vertexCount, Vec3f(0, 0, 0));
+    static Vec3f normalizedOr(const Vec3f &v, const Vec3f &fallback) {
+        float len = v.length();
+        if (len > 1e-6f)
+            return v / len;
+        return fallback;
+    }
+
+    static void computeTangents(Mesh &mesh,
+                                const std::vector<unsigned int> &groups,
+                                const std::vector<unsigned int> &cornerVertices,
+                                const GroupCorners &groupCorners,
+                                bool parallel) {
+        const auto vertexCount = mesh.positions.size();
+        const auto faceCount = cornerVertices.size() / 3;
 
-        auto accumulate = [&](unsigned int i0, unsigned int i1, unsigned int i2) {
-            const Vec3f &p0 = mesh.positions.at(i0);
-            const Vec3f &p1 = mesh.positions.at(i1);
-            const Vec3f &p2 = mesh.positions.at(i2);
+        std::vector<Vec3f> faceTangents(faceCount);
+        std::vector<Vec3f> faceBitangents(faceCount);
+        forEachIndex(faceCount, parallel, [&](size_t f) {
+            auto i0 = cornerVertices[f * 3];
+            auto i1 = cornerVertices[f * 3 + 1];
+            auto i2 = cornerVertices[f * 3 + 2];
 
-            const Vec2f &uv0 = mesh.uvs.at(i0);
-            const Vec2f &uv1 = mesh.uvs.at(i1);
-            const Vec2f &uv2 = mesh.uvs.at(i2);
+            const Vec3f &p0 = mesh.positions[i0];
+            const Vec3f &p1 = mesh.positions[i1];
+            const Vec3f &p2 = mesh.positions[i2];
+
+            const Vec2f &uv0 = mesh.uvs[i0];
+            const Vec2f &uv1 = mesh.uvs[i1];
+            const Vec2f &uv2 = mesh.uvs[i2];
 
             Vec3f edge1 = p1 - p0;
             Vec3f edge2 = p2 - p0;
@@ -239,32 +443,26 @@ namespace xng {
             if (std::abs(denom) < 1e-6f) return;
             float r = 1.0f / denom;
 
-            Vec3f t = (edge1 * dv2 - edge2 * dv1) * r;
-            Vec3f b = (edge2 * du1 - edge1 * du2) * r;
-
-            for (auto idx: {i0, i1, i2}) {
-                const auto &p = mesh.positions.at(idx);
-                for (auto sharedIdx: positionToVertices.at({p.x, p.y, p.z})) {
-                    tangents[sharedIdx] += t;
-                    bitangents[sharedIdx] += b;
-                }
+            faceTangents[f] = (edge1 * dv2 - edge2 * dv1) * r;
+            faceBitangents[f] = (edge2 * du1 - edge1 * du2) * r;
+        });
+
+        // Vertices sharing a position accumulate the tangents of all faces touching the position
+        mesh.tangents.resize(vertexCount);
+        mesh.bitangents.resize(vertexCount);
+        forEachIndex(vertexCount, parallel, [&](size_t i) {
+            Vec3f t(0, 0, 0);
+            Vec3f b(0, 0, 0);
+            auto group = groups[i];
+            for (auto c = groupCorners.offsets[group]; c < groupCorners.offsets[group + 1]; c++) {
+                auto face = groupCorners.corners[c] / 3;
+                t += faceTangents[face];
+                b += faceBitangents[face];
             }
-        };
-
-        if (!mesh.indices.empty()) {
-            for (size_t i = 0; i < mesh.indices.size(); i += 3)
-                accumulate(mesh.indices.at(i), mesh.indices.at(i + 1), mesh.indices.at(i + 2));
-        } else {
-            for (size_t i = 0; i < vertexCount; i += 3)
-                accumulate(i, i + 1, i + 2);
-        }
 
-        // Gram-Schmidt orthogonalize against the smooth normal
-        for (unsigned int i = 0; i < vertexCount; i++) {
-            const Vec3f &n = mesh.normals.at(i);
-            Vec3f t = tangents.at(i);
+            // Gram-Schmidt orthogonalize against the smooth normal
+            const Vec3f &n = mesh.normals[i];
 
-            // Orthogonalize
             t = t - n * n.dot(t);
             float len = t.length();
             if (len > 1e-6f)
@@ -275,9 +473,6 @@ namespace xng {
                 t = fallback / fallback.length();
             }
 
-            tangents.at(i) = t;
-
-            Vec3f b = bitangents.at(i);
             b = b - n * n.dot(b) - t * t.dot(b);
             len = b.length();
             if (len > 1e-6f)
@@ -285,58 +480,188 @@ namespace xng {
             else
                 b = n.cross(t);
 
-            bitangents.at(i) = b;
-        }
-
-        Mesh result = mesh;
-        result.tangents = std::move(tangents);
-        result.bitangents = std::move(bitangents);
-        return result;
+            mesh.tangents[i] = t;
+            mesh.bitangents[i] = b;
+        });
     }
 
-    Mesh Mesh::computeSmoothNormals(const Mesh &mesh) {
-        const auto vertexCount = mesh.positions.size();
+    /**
+     * Duplicate the given vertices with all their attributes, bone weights and morph targets.
+     *
+     * @param sources The source vertex of each vertex appended to the mesh
+     */
+    static void appendVertexCopies(Mesh &mesh, const std::vector<unsigned int> &sources) {
+        if (sources.empty())
+            return;
 
-        std::map<std::tuple<float, float, float>, std::vector<unsigned int> > positionToVertices;
-        for (unsigned int i = 0; i < vertexCount; i++) {
-            const auto &p = mesh.positions.at(i);
-            positionToVertices[{p.x, p.y, p.z}].push_back(i);
-        }
+        const auto vertexCount = mesh.positions.size();
 
-        std::vector<Vec3f> smoothNormals(vertexCount, Vec3f(0, 0, 0));
+        auto copy = [&](auto &attribute) {
+            if (attribute.size() != vertexCount)
+                return;
+            attribute.reserve(vertexCount + sources.size());
+            for (auto source: sources) {
+                attribute.push_back(attribute[source]);
+            }
+        };
 
-        auto accumulate = [&](unsigned int i0, unsigned int i1, unsigned int i2) {
-            const Vec3f &p0 = mesh.positions.at(i0);
-            const Vec3f &p1 = mesh.positions.at(i1);
-            const Vec3f &p2 = mesh.positions.at(i2);
-            Vec3f faceNormal = (p2 - p0).cross(p1 - p0);
+        copy(mesh.positions);
+        copy(mesh.uvs);
+        copy(mesh.tangents);
+        copy(mesh.bitangents);
+        for (auto &target: mesh.morphTargets) {
+            copy(target.positions);
+            copy(target.normals);
+            copy(target.tangents);
+            copy(target.bitangents);
+            copy(target.uvs);
+        }
 
-            for (auto idx: {i0, i1, i2}) {
-                const auto &p = mesh.positions.at(idx);
-                for (auto sharedIdx: positionToVertices.at({p.x, p.y, p.z})) {
-                    smoothNormals[sharedIdx] += faceNormal;
+        if (!mesh.boneWeights.empty()) {
+            std::vector<std::vector<unsigned int> > copies(vertexCount);
+            for (size_t i = 0; i < sources.size(); i++) {
+                copies[sources[i]].push_back(static_cast<unsigned int>(vertexCount + i));
+            }
+            for (auto &pair: mesh.boneWeights) {
+                auto count = pair.second.size();
+                for (size_t i = 0; i < count; i++) {
+                    auto weight = pair.second[i];
+                    if (weight.vertex >= vertexCount)
+                        continue;
+                    for (auto vertex: copies[weight.vertex]) {
+                        pair.second.push_back({vertex, weight.weight});
+                    }
                 }
             }
-        };
+        }
+    }
+
+    Mesh Mesh::computeSmoothNormals(const Mesh &mesh, float weldEpsilon, float creaseAngle) {
+        const auto vertexCount = mesh.positions.size();
+        const bool parallel = vertexCount >= PARALLEL_VERTEX_COUNT;
 
+        std::vector<unsigned int> cornerVertices;
         if (!mesh.indices.empty()) {
-            for (size_t i = 0; i < mesh.indices.size(); i += 3)
-                accumulate(mesh.indices.at(i), mesh.indices.at(i + 1), mesh.indices.at(i + 2));
+            cornerVertices.assign(mesh.indices.begin(), mesh.indices.begin() + mesh.indices.size() / 3 * 3);
         } else {
-            for (size_t i = 0; i < vertexCount; i += 3)
-                accumulate(i, i + 1, i + 2);
+            cornerVertices.resize(vertexCount / 3 * 3);
+            for (size_t i = 0; i < cornerVertices.size(); i++) {
+                cornerVertices[i] = static_cast<unsigned int>(i);
+            }
         }
+        const auto faceCount = cornerVertices.size() / 3;
+
+        auto groups = weldPositions(mesh.positions, weldEpsilon, parallel);
+        GroupCorners groupCorners(groups, cornerVertices);
+
+        // Unit face normals weighted by the angle of the face at each corner
+        std::vector<Vec3f> faceNormals(faceCount);
+        std::vector<float> cornerWeights(cornerVertices.size());
+        forEachIndex(faceCount, parallel, [&](size_t f) {
+            const Vec3f &p0 = mesh.positions[cornerVertices[f * 3]];
+            const Vec3f &p1 = mesh.positions[cornerVertices[f * 3 + 1]];
+            const Vec3f &p2 = mesh.positions[cornerVertices[f * 3 + 2]];
+
+            faceNormals[f] = normalizedOr((p2 - p0).cross(p1 - p0), Vec3f(0, 0, 0));
+
+            auto angle = [](const Vec3f &a, const Vec3f &b) {
+                float len = a.length() * b.length();
+                if (len < 1e-12f)
+                    return 0.0f;
+                return std::acos(std::clamp(a.dot(b) / len, -1.0f, 1.0f));
+            };
+            cornerWeights[f * 3] = angle(p1 - p0, p2 - p0);
+            cornerWeights[f * 3 + 1] = angle(p2 - p1, p0 - p1);
+            cornerWeights[f * 3 + 2] = angle(p0 - p2, p1 - p2);
+        });
+
+        std::vector<Vec3f> groupNormals(vertexCount);
+        forEachIndex(vertexCount, parallel, [&](size_t g) {
+            Vec3f n(0, 0, 0);
+            for (auto c = groupCorners.offsets[g]; c < groupCorners.offsets[g + 1]; c++) {
+                auto corner = groupCorners.corners[c];
+                n += faceNormals[corner / 3] * cornerWeights[corner];
+            }
+            groupNormals[g] = normalizedOr(n, Vec3f(0, 0, 1));
+        });
 
-        for (auto &n: smoothNormals) {
-            float len = n.length();
-            if (len > 1e-6f)
-                n /= len;
-            else
-                n = Vec3f(0, 0, 1);
+        Mesh result = mesh;
+        result.normals.resize(vertexCount);
+        forEachIndex(vertexCount, parallel, [&](size_t i) {
+            result.normals[i] = groupNormals[groups[i]];
+        });
+
+        if (creaseAngle < PI) {
+            // Smooth each corner only with the faces of its group within the crease angle
+            const auto creaseCos = std::cos(creaseAngle);
+            std::vector<Vec3f> cornerNormals(cornerVertices.size());
+            forEachIndex(cornerVertices.size(), parallel, [&](size_t corner) {
+                auto &faceNormal = faceNormals[corner / 3];
+                auto group = groups[cornerVertices[corner]];
+                if (faceNormal.dot(faceNormal) == 0) {
+                    cornerNormals[corner] = groupNormals[group];
+                    return;
+                }
+                Vec3f n(0, 0, 0);
+                for (auto c = groupCorners.offsets[group]; c < groupCorners.offsets[group + 1]; c++) {
+                    auto other = groupCorners.corners[c];
+                    auto &otherNormal = faceNormals[other / 3];
+                    if (otherNormal.dot(faceNormal) >= creaseCos) {
+                        n += otherNormal * cornerWeights[other];
+                    }
+                }
+                cornerNormals[corner] = normalizedOr(n, faceNormal);
+            });
+
+            if (mesh.indices.empty()) {
+                for (size_t i = 0; i < cornerNormals.size(); i++) {
+                    result.normals[i] = cornerNormals[i];
+                }
+            } else {
+                // Split vertices shared by corners on different sides of a hard edge
+                std::vector<bool> assigned(vertexCount, false);
+                std::vector<unsigned int> splits(vertexCount, NO_VERTEX); // The first copy of each vertex
+                std::vector<unsigned int> nextSplit; // The next copy of the same source vertex
+                std::vector<unsigned int> sources;
+                for (size_t corner = 0; corner < cornerVertices.size(); corner++) {
+                    auto vertex = cornerVertices[corner];
+                    auto &normal = cornerNormals[corner];
+                    if (!assigned[vertex]) {
+                        assigned[vertex] = true;
+                        result.normals[vertex] = normal;
+                        continue;
+                    }
+                    if (result.normals[vertex].dot(normal) > 0.9999f)
+                        continue;
+
+                    auto split = splits[vertex];
+                    while (split != NO_VERTEX && result.normals[split].dot(normal) <= 0.9999f) {
+                        split = nextSplit[split - vertexCount];
+                    }
+                    if (split == NO_VERTEX) {
+                        split = static_cast<unsigned int>(vertexCount + sources.size());
+                        sources.push_back(vertex);
+                        nextSplit.push_back(splits[vertex]);
+                        splits[vertex] = split;
+                        result.normals.push_back(normal);
+                        groups.push_back(groups[vertex]);
+                    }
+                    result.indices[corner] = split;
+                    cornerVertices[corner] = split;
+                }
+                appendVertexCopies(result, sources);
+                if (!sources.empty()) {
+                    // The meshlets reference the vertices before splitting
+                    result.meshlets.clear();
+                    result.meshletVertices.clear();
+                    result.meshletTriangles.clear();
+                }
+            }
         }
 
-        Mesh result = mesh;
-        result.normals = std::move(smoothNormals);
-        return computeTangents(result);
+        if (result.uvs.size() == result.positions.size()) {
+            computeTangents(result, groups, cornerVertices, groupCorners, parallel);
+        }
+        return result;
     }
 }
@@ -0,0 +1,741 @@
+/**
+ *   xEngine - C++ Game Engine Library
+ *   Copyright (C) 2026 Julia Zampiccoli
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU Lesser General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   Lesser General Public License for more details.
+ *
+ *   You should have received a copy of the Lesser General Public License
+ *   along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include "xng/assets/meshoptimizer.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <numeric>
+#include <stdexcept>
+#include <tuple>
+
+namespace xng {
+    static const unsigned int NO_VERTEX = std::numeric_limits<unsigned int>::max();
+
+    static void checkTriangles(const Mesh &mesh) {
+        if (mesh.primitive != Mesh::TRIANGLES)
+            throw std::runtime_error("Mesh optimization requires a triangle mesh");
+    }
+
+    static void checkIndexed(const Mesh &mesh) {
+        checkTriangles(mesh);
+        if (mesh.indices.empty() && !mesh.positions.empty())
+            throw std::runtime_error("Mesh optimization requires an indexed mesh");
+    }
+
+    /**
+     * Create a mesh with the vertices moved to remap[vertex], vertices mapped to the same index must be identical.
+     */
+    static Mesh remapVertices(const Mesh &mesh, const std::vector<unsigned int> &remap, size_t vertexCount) {
+        const auto sourceCount = mesh.positions.size();
+
+        // The first source vertex of every output vertex
+        std::vector<unsigned int> sources(vertexCount, NO_VERTEX);
+        for (size_t i = 0; i < sourceCount; i++) {
+            auto target = remap[i];
+            if (target != NO_VERTEX && sources[target] == NO_VERTEX)
+                sources[target] = static_cast<unsigned int>(i);
+        }
+
+        auto gather = [&](const auto &input, auto &output) {
+            if (input.size() != sourceCount) {
+                output = input;
+                return;
+            }
+            output.resize(vertexCount);
+            for (size_t i = 0; i < vertexCount; i++) {
+                output[i] = input[sources[i]];
+            }
+        };
+
+        Mesh ret;
+        ret.primitive = mesh.primitive;
+        gather(mesh.positions, ret.positions);
+        gather(mesh.normals, ret.normals);
+        gather(mesh.uvs, ret.uvs);
+        gather(mesh.tangents, ret.tangents);
+        gather(mesh.bitangents, ret.bitangents);
+
+        ret.morphTargets.resize(mesh.morphTargets.size());
+        for (size_t i = 0; i < mesh.morphTargets.size(); i++) {
+            auto &input = mesh.morphTargets[i];
+            auto &output = ret.morphTargets[i];
+            gather(input.positions, output.positions);
+            gather(input.normals, output.normals);
+            gather(input.tangents, output.tangents);
+            gather(input.bitangents, output.bitangents);
+            gather(input.uvs, output.uvs);
+        }
+
+        for (auto &pair: mesh.boneWeights) {
+            auto &weights = ret.boneWeights[pair.first];
+            for (auto &weight: pair.second) {
+                if (weight.vertex >= sourceCount)
+                    continue;
+                auto target = remap[weight.vertex];
+                if (target != NO_VERTEX && sources[target] == weight.vertex) {
+                    weights.push_back({target, weight.weight});
+                }
+            }
+        }
+
+        ret.indices.resize(mesh.indices.size());
+        for (size_t i = 0; i < mesh.indices.size(); i++) {
+            ret.indices[i] = remap[mesh.indices[i]];
+        }
+        return ret;
+    }
+
+    // The vector types are not trivially copyable, vertices are compared by the bits of their components.
+    static std::array<float, 2> getComponents(const Vec2f &v) {
+        return {v.x, v.y};
+    }
+
+    static std::array<float, 3> getComponents(const Vec3f &v) {
+        return {v.x, v.y, v.z};
+    }
+
+    static Vec3f faceNormal(const Mesh &mesh, size_t triangle) {
+        auto &p0 = mesh.positions[mesh.indices[triangle * 3]];
+        auto &p1 = mesh.positions[mesh.indices[triangle * 3 + 1]];
+        auto &p2 = mesh.positions[mesh.indices[triangle * 3 + 2]];
+        return (p2 - p0).cross(p1 - p0);
+    }
+
+    MeshOptimizer::VertexCacheStatistics MeshOptimizer::analyzeVertexCache(const Mesh &mesh, size_t cacheSize) {
+        checkTriangles(mesh);
+
+        VertexCacheStatistics ret;
+        if (mesh.indices.empty()) {
+            ret.triangles = mesh.positions.size() / 3;
+            ret.vertices = ret.triangles * 3;
+            ret.transforms = ret.vertices;
+            return ret;
+        }
+
+        // A vertex is cached if less than cacheSize vertices were transformed since it was transformed.
+        std::vector<size_t> transformed(mesh.positions.size(), 0);
+        size_t time = cacheSize + 1;
+        ret.triangles = mesh.indices.size() / 3;
+        for (size_t i = 0; i < ret.triangles * 3; i++) {
+            auto vertex = mesh.indices[i];
+            if (transformed[vertex] == 0)
+                ret.vertices++;
+            if (time - transformed[vertex] > cacheSize) {
+                transformed[vertex] = time++;
+                ret.transforms++;
+            }
+        }
+        return ret;
+    }
+
+    Mesh MeshOptimizer::removeDuplicateVertices(const Mesh &mesh) {
+        checkTriangles(mesh);
+
+        const auto vertexCount = mesh.positions.size();
+
+        // The bone weights of each vertex as (bone, weight) pairs sorted by bone
+        std::vector<std::vector<std::pair<size_t, float> > > vertexWeights;
+        if (!mesh.boneWeights.empty()) {
+            vertexWeights.resize(vertexCount);
+            size_t bone = 0;
+            for (auto &pair: mesh.boneWeights) {
+                for (auto &weight: pair.second) {
+                    if (weight.vertex < vertexCount)
+                        vertexWeights[weight.vertex].emplace_back(bone, weight.weight);
+                }
+                bone++;
+            }
+            for (auto &weights: vertexWeights) {
+                std::sort(weights.begin(), weights.end());
+            }
+        }
+
+        auto forEachAttribute = [&](const auto &func) {
+            auto visit = [&](const auto &attribute) {
+                if (attribute.size() == vertexCount)
+                    func(attribute);
+            };
+            visit(mesh.positions);
+            visit(mesh.normals);
+            visit(mesh.uvs);
+            visit(mesh.tangents);
+            visit(mesh.bitangents);
+            for (auto &target: mesh.morphTargets) {
+                visit(target.positions);
+                visit(target.normals);
+                visit(target.tangents);
+                visit(target.bitangents);
+                visit(target.uvs);
+            }
+        };
+
+        auto hashVertex = [&](size_t vertex) {
+            uint64_t hash = 14695981039346656037ull;
+            forEachAttribute([&](const auto &attribute) {
+                auto components = getComponents(attribute[vertex]);
+                for (auto component: components) {
+                    uint32_t bits;
+                    std::memcpy(&bits, &component, sizeof(bits));
+                    hash = (hash ^ bits) * 1099511628211ull;
+                }
+            });
+            return hash;
+        };
+
+        auto equal = [&](size_t a, size_t b) {
+            bool ret = true;
+            forEachAttribute([&](const auto &attribute) {
+                auto ca = getComponents(attribute[a]);
+                auto cb = getComponents(attribute[b]);
+                ret = ret && std::memcmp(ca.data(), cb.data(), sizeof(ca)) == 0;
+            });
+            return ret && (vertexWeights.empty() || vertexWeights[a] == vertexWeights[b]);
+        };
+
+        size_t capacity = 16;
+        while (capacity < vertexCount * 2) {
+            capacity *= 2;
+        }
+        std::vector<unsigned int> table(capacity, NO_VERTEX);
+
+        std::vector<unsigned int> remap(vertexCount);
+        unsigned int uniqueCount = 0;
+        for (size_t i = 0; i < vertexCount; i++) {
+            auto slot = hashVertex(i) & (capacity - 1);
+            while (table[slot] != NO_VERTEX && !equal(table[slot], i)) {
+                slot = (slot + 1) & (capacity - 1);
+            }
+            if (table[slot] == NO_VERTEX) {
+                table[slot] = static_cast<unsigned int>(i);
+                remap[i] = uniqueCount++;
+            } else {
+                remap[i] = remap[table[slot]];
+            }
+        }
+
+        auto ret = remapVertices(mesh, remap, uniqueCount);
+        if (mesh.indices.empty()) {
+            ret.indices.assign(remap.begin(), remap.begin() + vertexCount / 3 * 3);
+        }
+        return ret;
+    }
+
+    Mesh MeshOptimizer::optimizeVertexCache(const Mesh &mesh) {
+        checkIndexed(mesh);
+
+        // Scoring constants of the reference implementation
+        static const size_t CACHE_SIZE = 32;
+        static const size_t MAX_VALENCE_SCORE = 64;
+        const float cacheDecayPower = 1.5f;
+        const float lastTriangleScore = 0.75f;
+        const float valenceBoostScale = 2.0f;
+        const float valenceBoostPower = 0.5f;
+
+        float cacheScores[CACHE_SIZE];
+        for (size_t i = 0; i < CACHE_SIZE; i++) {
+            if (i < 3) {
+                cacheScores[i] = lastTriangleScore;
+            } else {
+                auto scaler = 1.0f - static_cast<float>(i - 3) / static_cast<float>(CACHE_SIZE - 3);
+                cacheScores[i] = std::pow(scaler, cacheDecayPower);
+            }
+        }
+        float valenceScores[MAX_VALENCE_SCORE];
+        for (size_t i = 0; i < MAX_VALENCE_SCORE; i++) {
+            valenceScores[i] = i == 0 ? 0 : valenceBoostScale * std::pow(static_cast<float>(i), -valenceBoostPower);
+        }
+
+        auto score = [&](int cachePosition, unsigned int remaining) {
+            if (remaining == 0)
+                return -1.0f;
+            float ret = cachePosition >= 0 ? cacheScores[cachePosition] : 0.0f;
+            return ret + (remaining < MAX_VALENCE_SCORE
+                              ? valenceScores[remaining]
+                              : valenceBoostScale * std::pow(static_cast<float>(remaining), -valenceBoostPower));
+        };
+
+        const auto vertexCount = mesh.positions.size();
+        const auto triangleCount = mesh.indices.size() / 3;
+
+        // The triangles of each vertex, the first remaining[v] triangles of a vertex have not been emitted
+        std::vector<unsigned int> offsets(vertexCount + 1, 0);
+        for (size_t i = 0; i < triangleCount * 3; i++) {
+            offsets[mesh.indices[i] + 1]++;
+        }
+        std::vector<unsigned int> remaining(vertexCount);
+        for (size_t i = 0; i < vertexCount; i++) {
+            remaining[i] = offsets[i + 1];
+            offsets[i + 1] += offsets[i];
+        }
+        std::vector<unsigned int> adjacency(triangleCount * 3);
+        {
+            std::vector<unsigned int> fill(offsets.begin(), offsets.end() - 1);
+            for (size_t i = 0; i < triangleCount * 3; i++) {
+                adjacency[fill[mesh.indices[i]]++] = static_cast<unsigned int>(i / 3);
+            }
+        }
+
+        std::vector<int> cachePositions(vertexCount, -1);
+        std::vector<float> vertexScores(vertexCount);
+        for (size_t i = 0; i < vertexCount; i++) {
+            vertexScores[i] = score(-1, remaining[i]);
+        }
+
+        std::vector<float> triangleScores(triangleCount);
+        std::vector<bool> emitted(triangleCount, false);
+        for (size_t t = 0; t < triangleCount; t++) {
+            triangleScores[t] = vertexScores[mesh.indices[t * 3]]
+                                + vertexScores[mesh.indices[t * 3 + 1]]
+                                + vertexScores[mesh.indices[t * 3 + 2]];
+        }
+
+        std::vector<unsigned int> cache;
+        std::vector<unsigned int> nextCache;
+        cache.reserve(CACHE_SIZE + 3);
+        nextCache.reserve(CACHE_SIZE + 3);
+
+        Mesh ret = mesh;
+        ret.indices.resize(triangleCount * 3);
+
+        size_t scan = 0; // Triangles before scan have been emitted
+        auto best = static_cast<size_t>(std::max_element(triangleScores.begin(), triangleScores.end())
+                                        - triangleScores.begin());
+        for (size_t output = 0; output < triangleCount; output++) {
+            if (best == triangleCount) {
+                // No cached vertex has remaining triangles, continue with the first remaining triangle
+                while (emitted[scan]) {
+                    scan++;
+                }
+                best = scan;
+            }
+
+            emitted[best] = true;
+            nextCache.clear();
+            for (size_t c = 0; c < 3; c++) {
+                auto vertex = mesh.indices[best * 3 + c];
+                ret.indices[output * 3 + c] = vertex;
+                nextCache.push_back(vertex);
+
+                // Move the emitted triangle out of the remaining triangles of the vertex
+                auto begin = adjacency.begin() + offsets[vertex];
+                auto end = begin + remaining[vertex];
+                std::iter_swap(std::find(begin, end, static_cast<unsigned int>(best)), end - 1);
+                remaining[vertex]--;
+            }
+
+            for (auto vertex: cache) {
+                if (std::find(nextCache.begin(), nextCache.begin() + 3, vertex) == nextCache.begin() + 3)
+                    nextCache.push_back(vertex);
+            }
+
+            // Update the scores of the vertices which moved in or out of the cache
+            for (size_t i = 0; i < nextCache.size(); i++) {
+                auto vertex = nextCache[i];
+                cachePositions[vertex] = i < CACHE_SIZE ? static_cast<int>(i) : -1;
+                vertexScores[vertex] = score(cachePositions[vertex], remaining[vertex]);
+            }
+            if (nextCache.size() > CACHE_SIZE)
+                nextCache.resize(CACHE_SIZE);
+            std::swap(cache, nextCache);
+
+            best = triangleCount;
+            float bestScore = -1;
+            for (auto vertex: cache) {
+                for (auto i = offsets[vertex]; i < offsets[vertex] + remaining[vertex]; i++) {
+                    auto t = adjacency[i];
+                    auto s = vertexScores[mesh.indices[t * 3]]
+                             + vertexScores[mesh.indices[t * 3 + 1]]
+                             + vertexScores[mesh.indices[t * 3 + 2]];
+                    triangleScores[t] = s;
+                    if (s > bestScore) {
+                        bestScore = s;
+                        best = t;
+                    }
+                }
+            }
+        }
+
+        return ret;
+    }
+
+    Mesh MeshOptimizer::optimizeOverdraw(const Mesh &mesh, float threshold) {
+        checkIndexed(mesh);
+
+        const auto triangleCount = mesh.indices.size() / 3;
+        if (triangleCount == 0)
+            return mesh;
+
+        // Simulate the vertex cache in the current order, a triangle of three misses starts a new hard cluster
+        std::vector<size_t> transformed(mesh.positions.size(), 0);
+        size_t time = DEFAULT_CACHE_SIZE + 1;
+        auto transform = [&](unsigned int vertex) {
+            if (time - transformed[vertex] > DEFAULT_CACHE_SIZE) {
+                transformed[vertex] = time++;
+                return 1u;
+            }
+            return 0u;
+        };
+        auto resetCache = [&]() {
+            time += DEFAULT_CACHE_SIZE + 1;
+        };
+
+        std::vector<unsigned int> misses(triangleCount);
+        std::vector<size_t> hardClusters;
+        for (size_t t = 0; t < triangleCount; t++) {
+            misses[t] = transform(mesh.indices[t * 3])
+                        + transform(mesh.indices[t * 3 + 1])
+                        + transform(mesh.indices[t * 3 + 2]);
+            if (t == 0 || misses[t] == 3)
+                hardClusters.push_back(t);
+        }
+        hardClusters.push_back(triangleCount);
+
+        // Split hard clusters further as soon as the ACMR of the cluster from a cold cache is within the threshold
+        std::vector<size_t> clusters;
+        for (size_t h = 0; h + 1 < hardClusters.size(); h++) {
+            auto begin = hardClusters[h];
+            auto end = hardClusters[h + 1];
+            size_t clusterMisses = 0;
+            for (auto t = begin; t < end; t++) {
+                clusterMisses += misses[t];
+            }
+            auto limit = threshold * static_cast<float>(clusterMisses) / static_cast<float>(end - begin);
+
+            resetCache();
+            clusters.push_back(begin);
+            size_t start = begin;
+            size_t softMisses = 0;
+            for (auto t = begin; t < end; t++) {
+                softMisses += transform(mesh.indices[t * 3])
+                        + transform(mesh.indices[t * 3 + 1])
+                        + transform(mesh.indices[t * 3 + 2]);
+                if (t + 1 < end
+                    && static_cast<float>(softMisses) / static_cast<float>(t + 1 - start) <= limit) {
+                    clusters.push_back(t + 1);
+                    start = t + 1;
+                    softMisses = 0;
+                    resetCache();
+                }
+            }
+        }
+        clusters.push_back(triangleCount);
+
+        Vec3f meshCentroid(0, 0, 0);
+        for (auto &position: mesh.positions) {
+            meshCentroid += position;
+        }
+        meshCentroid /= static_cast<float>(std::max<size_t>(mesh.positions.size(), 1));
+
+        // Clusters facing away from the center of the mesh are drawn first
+        const auto clusterCount = clusters.size() - 1;
+        std::vector<float> sortKeys(clusterCount);
+        for (size_t c = 0; c < clusterCount; c++) {
+            Vec3f centroid(0, 0, 0);
+            Vec3f normal(0, 0, 0);
+            float area = 0;
+            for (auto t = clusters[c]; t < clusters[c + 1]; t++) {
+                auto &p0 = mesh.positions[mesh.indices[t * 3]];
+                auto &p1 = mesh.positions[mesh.indices[t * 3 + 1]];
+                auto &p2 = mesh.positions[mesh.indices[t * 3 + 2]];
+                auto n = faceNormal(mesh, t);
+                auto a = n.length();
+                centroid += (p0 + p1 + p2) * (a / 3.0f);
+                normal += n;
+                area += a;
+            }
+            if (area > 0)
+                centroid /= area;
+            auto length = normal.length();
+            if (length > 0)
+                normal /= length;
+            sortKeys[c] = (centroid - meshCentroid).dot(normal);
+        }
+
+        std::vector<size_t> order(clusterCount);
+        std::iota(order.begin(), order.end(), 0);
+        std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+            return sortKeys[a] > sortKeys[b];
+        });
+
+        Mesh ret = mesh;
+        ret.indices.clear();
+        for (auto c: order) {
+            ret.indices.insert(ret.indices.end(),
+                               mesh.indices.begin() + static_cast<std::ptrdiff_t>(clusters[c] * 3),
+                               mesh.indices.begin() + static_cast<std::ptrdiff_t>(clusters[c + 1] * 3));
+        }
+        return ret;
+    }
+
+    Mesh MeshOptimizer::optimizeVertexFetch(const Mesh &mesh) {
+        checkIndexed(mesh);
+
+        std::vector<unsigned int> remap(mesh.positions.size(), NO_VERTEX);
+        unsigned int count = 0;
+        for (auto index: mesh.indices) {
+            if (remap[index] == NO_VERTEX)
+                remap[index] = count++;
+        }
+        for (auto &index: remap) {
+            if (index == NO_VERTEX)
+                index = count++;
+        }
+        return remapVertices(mesh, remap, count);
+    }
+
+    /**
+     * Ritter's bounding sphere, starting from the most distant pair of the extremal points along the axes.
+     */
+    static void computeBoundingSphere(const std::vector<Vec3f> &points, Vec3f &center, float &radius) {
+        size_t minimum[3] = {0, 0, 0};
+        size_t maximum[3] = {0, 0, 0};
+        for (size_t i = 0; i < points.size(); i++) {
+            auto p = getComponents(points[i]);
+            for (size_t axis = 0; axis < 3; axis++) {
+                if (p[axis] < getComponents(points[minimum[axis]])[axis])
+                    minimum[axis] = i;
+                if (p[axis] > getComponents(points[maximum[axis]])[axis])
+                    maximum[axis] = i;
+            }
+        }
+
+        size_t axis = 0;
+        float span = -1;
+        for (size_t i = 0; i < 3; i++) {
+            auto d = points[maximum[i]] - points[minimum[i]];
+            auto distance = d.dot(d);
+            if (distance > span) {
+                span = distance;
+                axis = i;
+            }
+        }
+
+        center = (points[minimum[axis]] + points[maximum[axis]]) * 0.5f;
+        radius = std::sqrt(span) * 0.5f;
+        for (auto &p: points) {
+            auto distance = (p - center).length();
+            if (distance > radius) {
+                auto grown = (radius + distance) * 0.5f;
+                center += (p - center) * ((grown - radius) / distance);
+                radius = grown;
+            }
+        }
+    }
+
+    static void computeMeshletBounds(const Mesh &mesh, Mesh::Meshlet &meshlet) {
+        std::vector<Vec3f> points(meshlet.vertexCount);
+        for (size_t i = 0; i < meshlet.vertexCount; i++) {
+            points[i] = mesh.positions[mesh.meshletVertices[meshlet.vertexOffset + i]];
+        }
+        computeBoundingSphere(points, meshlet.center, meshlet.radius);
+
+        std::vector<Vec3f> normals;
+        std::vector<Vec3f> corners;
+        Vec3f axis(0, 0, 0);
+        for (size_t t = 0; t < meshlet.triangleCount; t++) {
+            auto *triangle = &mesh.meshletTriangles[(meshlet.triangleOffset + t) * 3];
+            auto &p0 = points[triangle[0]];
+            auto &p1 = points[triangle[1]];
+            auto &p2 = points[triangle[2]];
+            auto normal = (p2 - p0).cross(p1 - p0);
+            auto length = normal.length();
+            if (length <= 0)
+                continue;
+            normal /= length;
+            normals.push_back(normal);
+            corners.push_back(p0);
+            axis += normal;
+        }
+
+        meshlet.coneApex = meshlet.center;
+        meshlet.coneAxis = Vec3f(0, 0, 0);
+        meshlet.coneCutoff = 1;
+
+        auto length = axis.length();
+        if (normals.empty() || length <= 0)
+            return;
+        axis /= length;
+
+        float minimumDot = 1;
+        for (auto &normal: normals) {
+            minimumDot = std::min(minimumDot, normal.dot(axis));
+        }
+        if (minimumDot <= 0.1f)
+            return; // The normals span close to a hemisphere, the meshlet cannot be back face culled.
+
+        // Move the apex behind the planes of all triangles so the cone test is conservative for cameras close to the meshlet
+        float offset = 0;
+        for (size_t i = 0; i < normals.size(); i++) {
+            auto distance = (meshlet.center - corners[i]).dot(normals[i]) / axis.dot(normals[i]);
+            offset = std::max(offset, distance);
+        }
+
+        meshlet.coneApex = meshlet.center - axis * offset;
+        meshlet.coneAxis = axis;
+        meshlet.coneCutoff = std::sqrt(1 - minimumDot * minimumDot);
+    }
+
+    Mesh MeshOptimizer::buildMeshlets(const Mesh &mesh, size_t maxVertices, size_t maxTriangles) {
+        checkIndexed(mesh);
+        if (maxVertices < 3 || maxVertices > 256 || maxTriangles < 1)
+            throw std::runtime_error("Invalid meshlet limits");
+
+        const auto vertexCount = mesh.positions.size();
+        const auto triangleCount = mesh.indices.size() / 3;
+
+        std::vector<unsigned int> offsets(vertexCount + 1, 0);
+        for (size_t i = 0; i < triangleCount * 3; i++) {
+            offsets[mesh.indices[i] + 1]++;
+        }
+        for (size_t i = 0; i < vertexCount; i++) {
+            offsets[i + 1] += offsets[i];
+        }
+        std::vector<unsigned int> adjacency(triangleCount * 3);
+        {
+            std::vector<unsigned int> fill(offsets.begin(), offsets.end() - 1);
+            for (size_t i = 0; i < triangleCount * 3; i++) {
+                adjacency[fill[mesh.indices[i]]++] = static_cast<unsigned int>(i / 3);
+            }
+        }
+
+        std::vector<Vec3f> centroids(triangleCount);
+        for (size_t t = 0; t < triangleCount; t++) {
+            centroids[t] = (mesh.positions[mesh.indices[t * 3]]
+                            + mesh.positions[mesh.indices[t * 3 + 1]]
+                            + mesh.positions[mesh.indices[t * 3 + 2]]) / 3.0f;
+        }
+
+        Mesh ret = mesh;
+        ret.meshlets.clear();
+        ret.meshletVertices.clear();
+        ret.meshletTriangles.clear();
+
+        std::vector<int> localIndices(vertexCount, -1);
+        std::vector<bool> used(triangleCount, false);
+        std::vector<unsigned int> liveTriangles(vertexCount);
+        for (size_t i = 0; i < vertexCount; i++) {
+            liveTriangles[i] = offsets[i + 1] - offsets[i];
+        }
+
+        Mesh::Meshlet meshlet;
+        Vec3f centroidSum(0, 0, 0);
+
+        auto countNewVertices = [&](size_t t) {
+            unsigned int ret = 0;
+            for (size_t c = 0; c < 3; c++) {
+                auto vertex = mesh.indices[t * 3 + c];
+                if (localIndices[vertex] < 0
+                    && (c < 1 || mesh.indices[t * 3] != vertex)
+                    && (c < 2 || mesh.indices[t * 3 + 1] != vertex))
+                    ret++;
+            }
+            return ret;
+        };
+
+        auto finish = [&]() {
+            if (meshlet.triangleCount == 0)
+                return;
+            computeMeshletBounds(ret, meshlet);
+            ret.meshlets.push_back(meshlet);
+            for (auto i = meshlet.vertexOffset; i < meshlet.vertexOffset + meshlet.vertexCount; i++) {
+                localIndices[ret.meshletVertices[i]] = -1;
+            }
+            meshlet = {};
+            meshlet.vertexOffset = static_cast<unsigned int>(ret.meshletVertices.size());
+            meshlet.triangleOffset = static_cast<unsigned int>(ret.meshletTriangles.size() / 3);
+            centroidSum = Vec3f(0, 0, 0);
+        };
+
+        size_t scan = 0; // Triangles before scan have been used
+        for (size_t added = 0; added < triangleCount;) {
+            auto best = triangleCount;
+            unsigned int bestNew = 4;
+            unsigned int bestLive = 0;
+            float bestDistance = std::numeric_limits<float>::max();
+            auto center = centroidSum / static_cast<float>(std::max(meshlet.triangleCount, 1u));
+            for (auto i = meshlet.vertexOffset; i < meshlet.vertexOffset + meshlet.vertexCount; i++) {
+                auto vertex = ret.meshletVertices[i];
+                for (auto a = offsets[vertex]; a < offsets[vertex + 1]; a++) {
+                    auto t = adjacency[a];
+                    if (used[t])
+                        continue;
+                    auto newVertices = countNewVertices(t);
+                    if (meshlet.vertexCount + newVertices > maxVertices)
+                        continue;
+                    // Prefer triangles whose vertices have few unused triangles left so no isolated triangles remain
+                    auto live = liveTriangles[mesh.indices[t * 3]]
+                                + liveTriangles[mesh.indices[t * 3 + 1]]
+                                + liveTriangles[mesh.indices[t * 3 + 2]];
+                    auto d = centroids[t] - center;
+                    auto distance = d.dot(d);
+                    if (std::tie(newVertices, live, distance) < std::tie(bestNew, bestLive, bestDistance)) {
+                        best = t;
+                        bestNew = newVertices;
+                        bestLive = live;
+                        bestDistance = distance;
+                    }
+                }
+            }
+
+            if (best == triangleCount) {
+                if (meshlet.triangleCount > 0) {
+                    finish();
+                    continue;
+                }
+                while (used[scan]) {
+                    scan++;
+                }
+                best = scan;
+            }
+
+            used[best] = true;
+            added++;
+            for (size_t c = 0; c < 3; c++) {
+                auto vertex = mesh.indices[best * 3 + c];
+                liveTriangles[vertex]--;
+                if (localIndices[vertex] < 0) {
+                    localIndices[vertex] = static_cast<int>(meshlet.vertexCount++);
+                    ret.meshletVertices.push_back(vertex);
+                }
+                ret.meshletTriangles.push_back(static_cast<uint8_t>(localIndices[vertex]));
+            }
+            meshlet.triangleCount++;
+            centroidSum += centroids[best];
+
+            if (meshlet.triangleCount == maxTriangles)
+                finish();
+        }
+        finish();
+
+        return ret;
+    }
+
+    Mesh MeshOptimizer::optimize(const Mesh &mesh, bool overdraw) {
+        auto ret = optimizeVertexCache(removeDuplicateVertices(mesh));
+        if (overdraw)
+            ret = optimizeOverdraw(ret);
+        return optimizeVertexFetch(ret);
+    }
+}
@@ -17,8 +17,10 @@
  */
 
 #include "xng/async/task.hpp"
+#include "xng/async/threadpool.hpp"
 
 #include <chrono>
+#include <stdexcept>
 
 namespace xng {
     Task &Task::operator=(const Task &other) {
@@ -26,22 +28,74 @@ namespace xng {
         return *this;
     }
 
-    void Task::execute() {
-        try {
-            work();
-        } catch (...) {
-            exception = std::current_exception();
+    std::shared_ptr<Task> Task::whenAll(const std::vector<std::shared_ptr<Task>> &tasks) {
+        auto ret = std::make_shared<Task>();
+        if (tasks.empty()) {
+            ret->complete(nullptr);
+            return ret;
+        }
+        auto remaining = std::make_shared<std::atomic<size_t>>(tasks.size());
+        for (auto &task: tasks) {
+            std::weak_ptr<Task> weakTask = task;
+            task->addContinuation([ret, remaining, weakTask]() {
+                auto ex = weakTask.lock()->getException();
+                if (ex) {
+                    ret->complete(ex);
+                } else if (--*remaining == 0) {
+                    ret->complete(nullptr);
+                }
+            });
         }
+        return ret;
+    }
 
-        {
-            std::unique_lock<std::mutex> lk(mutex);
-            workDone = true;
-            lk.unlock();
+    std::shared_ptr<Task> Task::whenAny(const std::vector<std::shared_ptr<Task>> &tasks) {
+        auto ret = std::make_shared<Task>();
+        if (tasks.empty()) {
+            ret->complete(nullptr);
+            return ret;
         }
-        workDoneCondition.notify_all();
+        for (auto &task: tasks) {
+            std::weak_ptr<Task> weakTask = task;
+            task->addContinuation([ret, weakTask]() {
+                ret->complete(weakTask.lock()->getException());
+            });
+        }
+        return ret;
+    }
+
+    void Task::execute() {
+        if (started.exchange(true))
+            return;
+
+        std::exception_ptr ex;
+        if (work) {
+            try {
+                work();
+            } catch (...) {
+                ex = std::current_exception();
+            }
+        }
+
+        finish(ex);
     }
 
     const std::exception_ptr &Task::join() {
+        auto pool = ThreadPool::getCurrentPool();
+        if (pool) {
+            // Run other tasks instead of blocking the worker, the sleep only happens when the pool has no queued tasks.
+            while (!workDone) {
+                if (!pool->runPendingTask()) {
+                    std::unique_lock<std::mutex> lk(mutex);
+                    workDoneCondition.wait_for(lk,
+                                               std::chrono::microseconds(100),
+                                               [this] { return static_cast<bool>(workDone); });
+                }
+            }
+            std::lock_guard<std::mutex> lk(mutex);
+            return exception;
+        }
+
         std::unique_lock<std::mutex> lk(mutex);
         while (!workDone) {
             workDoneCondition.wait(lk, [this] { return static_cast<bool>(workDone); });
@@ -60,4 +114,45 @@ namespace xng {
         }
         return workDone;
     }
-}
\ No newline at end of file
+
+    bool Task::cancel() {
+        if (started.exchange(true))
+            return false;
+        cancelled = true;
+        finish(std::make_exception_ptr(std::runtime_error("Task was cancelled")));
+        return true;
+    }
+
+    void Task::addContinuation(std::function<void()> callback) {
+        {
+            std::lock_guard<std::mutex> lk(mutex);
+            if (!workDone) {
+                continuations.emplace_back(std::move(callback));
+                return;
+            }
+        }
+        callback();
+    }
+
+    bool Task::complete(const std::exception_ptr &ex) {
+        if (started.exchange(true))
+            return false;
+        finish(ex);
+        return true;
+    }
+
+    void Task::finish(const std::exception_ptr &ex) {
+        std::vector<std::function<void()>> callbacks;
+        {
+            std::unique_lock<std::mutex> lk(mutex);
+            exception = ex;
+            workDone = true;
+            callbacks.swap(continuations);
+        }
+        workDoneCondition.notify_all();
+
+        for (auto &callback: callbacks) {
+            callback();
+        }
+    }
+}
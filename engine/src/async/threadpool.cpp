@@ -18,12 +18,238 @@
 
 #include "xng/async/threadpool.hpp"
 
+#include <cassert>
+#include <algorithm>
+
 namespace xng {
     std::unique_ptr<ThreadPool> pool = nullptr;
 
+    // The pool and worker index of the current thread if it is a worker thread.
+    thread_local ThreadPool *currentPool = nullptr;
+    thread_local size_t currentWorker = 0;
+
     ThreadPool &ThreadPool::getPool() {
         if (!pool)
             pool = std::make_unique<ThreadPool>();
         return *pool;
     }
-}
\ No newline at end of file
+
+    ThreadPool *ThreadPool::getCurrentPool() {
+        return currentPool;
+    }
+
+    ThreadPool::ThreadPool(unsigned int numberOfThreads) {
+        assert(numberOfThreads > 0);
+        for (unsigned int i = 0; i < numberOfThreads; i++) {
+            workers.emplace_back(std::make_unique<Worker>());
+        }
+        for (unsigned int i = 0; i < numberOfThreads; i++) {
+            threads.emplace_back([this, i]() { pollTasks(i); });
+        }
+    }
+
+    ThreadPool::~ThreadPool() {
+        shutdown();
+        for (auto &thread: threads) {
+            thread.join();
+        }
+    }
+
+    std::shared_ptr<Task> ThreadPool::addTask(const std::function<void()> &work, Priority priority) {
+        if (mShutdown)
+            throw std::runtime_error("Thread pool was shut down");
+        auto ret = std::make_shared<Task>(work);
+        pushTask(ret, priority);
+        return ret;
+    }
+
+    std::shared_ptr<Task> ThreadPool::addTask(const std::function<void()> &work,
+                                              const std::vector<std::shared_ptr<Task>> &predecessors,
+                                              Priority priority) {
+        if (mShutdown)
+            throw std::runtime_error("Thread pool was shut down");
+        auto ret = std::make_shared<Task>(work);
+        if (predecessors.empty()) {
+            pushTask(ret, priority);
+            return ret;
+        }
+        auto remaining = std::make_shared<std::atomic<size_t>>(predecessors.size());
+        for (auto &predecessor: predecessors) {
+            std::weak_ptr<Task> weakPredecessor = predecessor;
+            predecessor->addContinuation([this, ret, remaining, weakPredecessor, priority]() {
+                auto ex = weakPredecessor.lock()->getException();
+                if (ex) {
+                    ret->complete(ex);
+                } else if (--*remaining == 0 && !ret->isDone()) {
+                    pushTask(ret, priority);
+                }
+            });
+        }
+        return ret;
+    }
+
+    bool ThreadPool::runPendingTask() {
+        auto task = popTask(currentPool == this ? currentWorker : 0);
+        if (task) {
+            task->execute();
+            return true;
+        }
+        return false;
+    }
+
+    void ThreadPool::shutdown() {
+        {
+            // Lock so that a worker cannot miss the notification between checking the predicate and waiting.
+            std::lock_guard<std::mutex> guard(sleepMutex);
+            mShutdown = true;
+        }
+        sleepVar.notify_all();
+    }
+
+    void ThreadPool::pushTask(const std::shared_ptr<Task> &task, Priority priority) {
+        size_t index;
+        if (currentPool == this) {
+            index = currentWorker;
+        } else {
+            index = nextWorker++ % workers.size();
+        }
+
+        // Count the task before it is visible to other workers so that a worker popping it
+        // cannot decrement the counter below zero.
+        // Sequentially consistent ordering of pendingTasks and sleepingWorkers guarantees that either the sleeping
+        // worker observes the pending task or this thread observes the sleeping worker.
+        pendingTasks.at(priority)++;
+
+        auto &worker = *workers.at(index);
+        {
+            std::lock_guard<std::mutex> guard(worker.mutex);
+            worker.queues.at(priority).emplace_back(task);
+        }
+
+        if (sleepingWorkers > 0) {
+            std::lock_guard<std::mutex> guard(sleepMutex);
+            sleepVar.notify_one();
+        }
+    }
+
+    std::shared_ptr<Task> ThreadPool::popTask(size_t workerIndex) {
+        for (size_t priority = 0; priority < PRIORITY_COUNT; priority++) {
+            if (pendingTasks.at(priority) == 0)
+                continue;
+
+            // Pop the newest task of the own queue
+            {
+                auto &worker = *workers.at(workerIndex);
+                std::lock_guard<std::mutex> guard(worker.mutex);
+                auto &queue = worker.queues.at(priority);
+                if (!queue.empty()) {
+                    auto ret = std::move(queue.back());
+                    queue.pop_back();
+                    pendingTasks.at(priority)--;
+                    return ret;
+                }
+            }
+
+            // Steal the oldest task of another worker
+            for (size_t i = 1; i < workers.size(); i++) {
+                auto &worker = *workers.at((workerIndex + i) % workers.size());
+                std::lock_guard<std::mutex> guard(worker.mutex);
+                auto &queue = worker.queues.at(priority);
+                if (!queue.empty()) {
+                    auto ret = std::move(queue.front());
+                    queue.pop_front();
+                    pendingTasks.at(priority)--;
+                    return ret;
+                }
+            }
+        }
+        return nullptr;
+    }
+
+    bool ThreadPool::hasPendingTasks() const {
+        for (auto &count: pendingTasks) {
+            if (count > 0)
+                return true;
+        }
+        return false;
+    }
+
+    void ThreadPool::runChunked(size_t count,
+                                size_t grainSize,
+                                const std::function<void(size_t, size_t)> &func,
+                                Priority priority) {
+        if (grainSize == 0) {
+            grainSize = std::max<size_t>(1, count / (workers.size() * 4));
+        }
+        const auto chunks = (count + grainSize - 1) / grainSize;
+        if (chunks == 1 || mShutdown) {
+            func(0, count);
+            return;
+        }
+
+        // Shared with the helper tasks which may still be queued when the calling thread returns.
+        struct State {
+            std::atomic<size_t> nextChunk = 0;
+            std::atomic<size_t> completedChunks = 0;
+            std::atomic<bool> failed = false;
+            std::exception_ptr exception;
+            std::mutex mutex;
+            std::condition_variable completed;
+        };
+        auto state = std::make_shared<State>();
+
+        // func is only accessed after claiming a chunk, which cannot happen after all chunks have completed.
+        auto run = [state, &func, count, grainSize, chunks]() {
+            while (true) {
+                const auto chunk = state->nextChunk++;
+                if (chunk >= chunks)
+                    return;
+                if (!state->failed) {
+                    try {
+                        func(chunk * grainSize, std::min(count, (chunk + 1) * grainSize));
+                    } catch (...) {
+                        std::lock_guard<std::mutex> guard(state->mutex);
+                        if (!state->exception) {
+                            state->exception = std::current_exception();
+                        }
+                        state->failed = true;
+                    }
+                }
+                if (++state->completedChunks == chunks) {
+                    std::lock_guard<std::mutex> guard(state->mutex);
+                    state->completed.notify_all();
+                }
+            }
+        };
+
+        const auto helpers = std::min(workers.size(), chunks - 1);
+        for (size_t i = 0; i < helpers; i++) {
+            pushTask(std::make_shared<Task>(run), priority);
+        }
+
+        // The calling thread processes chunks as well so that nested invocations from worker threads make progress.
+        run();
+
+        std::unique_lock<std::mutex> lock(state->mutex);
+        state->completed.wait(lock, [&state, chunks]() { return state->completedChunks == chunks; });
+        if (state->exception) {
+            std::rethrow_exception(state->exception);
+        }
+    }
+
+    void ThreadPool::pollTasks(size_t workerIndex) {
+        currentPool = this;
+        currentWorker = workerIndex;
+        while (!mShutdown) {
+            auto task = popTask(workerIndex);
+            if (task) {
+                task->execute();
+                continue;
+            }
+            std::unique_lock<std::mutex> lock(sleepMutex);
+            sleepingWorkers++;
+            sleepVar.wait(lock, [this]() { return mShutdown || hasPendingTasks(); });
+            sleepingWorkers--;
+        }
+    }
+}
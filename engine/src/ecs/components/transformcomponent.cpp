@@ -20,11 +20,23 @@
 
 namespace xng {
     Transform TransformComponent::getAbsoluteTransform(const TransformComponent &component, EntityScene &scene) {
-        if (!component.parent.empty()) {
+        auto parentEntity = getParentEntity(component, scene);
+        if (parentEntity && scene.checkComponent<TransformComponent>(parentEntity)) {
             return component.transform.getWorldTransform(getAbsoluteTransform(
-                scene.getComponent<TransformComponent>(scene.getEntityByName(component.parent)),
+                scene.getComponent<TransformComponent>(parentEntity),
                 scene));
         }
         return component.transform;
     }
+
+    EntityHandle TransformComponent::getParentEntity(const TransformComponent &component,
+                                                     const EntityScene &scene) {
+        if (component.parentEntity) {
+            return component.parentEntity;
+        }
+        if (scene.entityNameExists(component.parent)) {
+            return scene.getEntityByName(component.parent);
+        }
+        return {};
+    }
 }
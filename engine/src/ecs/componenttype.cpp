@@ -0,0 +1,44 @@
+/**
+ *   xEngine - C++ Game Engine Library
+ *   Copyright (C) 2026 Julia Zampiccoli
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU Lesser General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   Lesser General Public License for more details.
+ *
+ *   You should have received a copy of the Lesser General Public License
+ *   along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "xng/ecs/componenttype.hpp"
+
+#include <mutex>
+#include <deque>
+#include <unordered_map>
+
+namespace xng {
+    static std::mutex typeMutex;
+    static std::unordered_map<std::string, ComponentTypeId> typeIds;
+    static std::deque<std::string> typeNames; // Deque so that returned references stay valid
+
+    ComponentTypeId getComponentTypeId(const std::string &typeName) {
+        std::lock_guard<std::mutex> guard(typeMutex);
+        auto it = typeIds.find(typeName);
+        if (it == typeIds.end()) {
+            it = typeIds.emplace(typeName, typeNames.size()).first;
+            typeNames.emplace_back(typeName);
+        }
+        return it->second;
+    }
+
+    const std::string &getComponentTypeName(const ComponentTypeId id) {
+        std::lock_guard<std::mutex> guard(typeMutex);
+        return typeNames.at(id);
+    }
+}
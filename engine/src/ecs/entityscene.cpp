@@ -28,19 +28,20 @@ namespace xng {
             message["name"] = it->second;
         }
         auto cmap = std::map<std::string, Message>();
-        for (auto &pair: componentPools) {
-            if (pair.first == GenericComponent::typeName) {
-                if (pair.second->check(entity)) {
-                    auto &comp = pair.second->get<GenericComponent>(entity);
-                    for (auto &p: comp.components) {
-                        cmap[p.first] = p.second;
-                    }
+        for (auto &pool: componentPools) {
+            if (!pool || !pool->check(entity))
+                continue;
+            const auto typeName = pool->getTypeName();
+            if (typeName == GenericComponent::typeName) {
+                auto &comp = pool->get<GenericComponent>(entity);
+                for (auto &p: comp.components) {
+                    cmap[p.first] = p.second;
                 }
-            } else if (pair.second->check(entity)) {
-                auto serializer = ComponentRegistry::instance().getSerializer(pair.first);
+            } else {
+                auto serializer = ComponentRegistry::instance().getSerializer(typeName);
                 Message msg;
                 serializer(*this, entity, msg);
-                cmap[pair.first] = msg;
+                cmap[typeName] = msg;
             }
         }
 
@@ -69,6 +70,113 @@ namespace xng {
         }
     }
 
+    void EntityScene::Listener::onComponentChanges(const EntityScene &scene,
+                                                   const std::vector<ComponentChange> &changes) {
+        for (auto &change: changes) {
+            if (change.type == ComponentChange::DESTROY) {
+                onComponentDestroy(change.entity, *change.oldComponent);
+                continue;
+            }
+            auto &pool = scene.getPool(change.typeId);
+            if (!pool.check(change.entity)) {
+                // Destroyed by a listener during this dispatch
+                continue;
+            }
+            auto &component = pool.get(change.entity);
+            if (change.type == ComponentChange::CREATE) {
+                onComponentCreate(change.entity, component);
+            } else {
+                onComponentUpdate(change.entity,
+                                  change.oldComponent ? *change.oldComponent : component,
+                                  component);
+            }
+        }
+    }
+
+    void EntityScene::setListenerMode(const ListenerMode mode) {
+        if (mode == LISTENER_IMMEDIATE) {
+            dispatchChanges();
+        }
+        listenerMode = mode;
+    }
+
+    void EntityScene::dispatchChanges() {
+        std::vector<ComponentChange> changes;
+        for (auto &log: changeLogs) {
+            // Listeners may modify the scene while handling the changes, which records into fresh logs.
+            for (auto &entry: log.entries) {
+                if (static_cast<size_t>(entry.change.entity.id) < log.indices.size()) {
+                    log.indices[entry.change.entity.id] = 0;
+                }
+                if (!entry.cancelled) {
+                    changes.emplace_back(std::move(entry.change));
+                }
+            }
+            log.entries.clear();
+        }
+
+        if (changes.empty())
+            return;
+
+        for (auto &listener: std::set<Listener *>(listeners)) {
+            listener->onComponentChanges(*this, changes);
+        }
+    }
+
+    void EntityScene::recordChange(const ComponentChange::Type type,
+                                   const EntityHandle &entity,
+                                   const ComponentTypeId typeId,
+                                   std::unique_ptr<Component> oldComponent) {
+        auto &log = changeLogs.at(typeId);
+        const auto index = findChange(entity, typeId);
+        if (index != 0) {
+            auto &entry = log.entries.at(index - 1);
+            if (type == ComponentChange::UPDATE) {
+                return;
+            }
+            if (type == ComponentChange::DESTROY) {
+                if (entry.change.type == ComponentChange::CREATE) {
+                    entry.cancelled = true;
+                } else {
+                    entry.change.type = ComponentChange::DESTROY;
+                    entry.change.oldComponent = std::move(oldComponent);
+                }
+                log.indices[entity.id] = 0;
+                return;
+            }
+        }
+        if (static_cast<size_t>(entity.id) >= log.indices.size()) {
+            log.indices.resize(entity.id + 1, 0);
+        }
+        // Only pending CREATE and UPDATE changes are indexed.
+        log.indices[entity.id] = type == ComponentChange::DESTROY ? 0 : log.entries.size() + 1;
+        log.entries.emplace_back(ChangeLogEntry{ComponentChange{type, entity, typeId, std::move(oldComponent)}});
+    }
+
+    void EntityScene::cancelChange(const EntityHandle &entity, const ComponentTypeId typeId) {
+        const auto index = findChange(entity, typeId);
+        if (index != 0) {
+            auto &log = changeLogs.at(typeId);
+            log.entries.at(index - 1).cancelled = true;
+            log.indices[entity.id] = 0;
+        }
+    }
+
+    bool EntityScene::requiresOldComponent(const ComponentTypeId typeId) {
+        auto &ret = changeLogs.at(typeId).requiresOldComponent;
+        if (ret == -1) {
+            ret = 0;
+            const auto &typeName = getComponentTypeName(typeId);
+            for (auto &listener: listeners) {
+                if (listener->requiresOldComponent(typeName)) {
+                    ret = 1;
+                    break;
+                }
+            }
+        }
+        return ret == 1;
+    }
+
     Entity EntityScene::createEntity() {
         return {create(), *this};
     }
@@ -87,8 +195,8 @@ namespace xng {
 
     EntityScene::EntityScene(const EntityScene &other) {
         componentPools.clear();
-        for (auto &p: other.componentPools) {
-            componentPools[p.first] = p.second->clone();
+        for (auto &pool: other.componentPools) {
+            componentPools.emplace_back(pool ? pool->clone() : nullptr);
         }
         entities = other.entities;
         entityNames = other.entityNames;
@@ -96,12 +204,14 @@ namespace xng {
         sceneName = other.sceneName;
         idCounter = other.idCounter;
         idStore = other.idStore;
+        listenerMode = other.listenerMode;
+        changeLogs = std::vector<ChangeLog>(componentPools.size());
     }
 
     EntityScene &EntityScene::operator=(const EntityScene &other) {
         componentPools.clear();
-        for (auto &p: other.componentPools) {
-            componentPools[p.first] = p.second->clone();
+        for (auto &pool: other.componentPools) {
+            componentPools.emplace_back(pool ? pool->clone() : nullptr);
         }
         entities = other.entities;
         entityNames = other.entityNames;
@@ -109,6 +219,8 @@ namespace xng {
         sceneName = other.sceneName;
         idCounter = other.idCounter;
         idStore = other.idStore;
+        listenerMode = other.listenerMode;
+        changeLogs = std::vector<ChangeLog>(componentPools.size());
         return *this;
     }
 
@@ -0,0 +1,263 @@
+/**
+ *   xEngine - C++ Game Engine Library
+ *   Copyright (C) 2026 Julia Zampiccoli
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU Lesser General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   Lesser General Public License for more details.
+ *
+ *   You should have received a copy of the Lesser General Public License
+ *   along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "xng/ecs/profiling/ecsprofiler.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+#include "xng/io/protocol/jsonprotocol.hpp"
+
+namespace xng {
+    static long long toNanoseconds(std::chrono::steady_clock::duration duration) {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count();
+    }
+
+    static Message createTraceEvent(const std::string &name,
+                                    const std::string &category,
+                                    long long start,
+                                    long long duration,
+                                    size_t thread) {
+        Message ret(Message::DICTIONARY);
+        ret["name"] = name;
+        ret["cat"] = category;
+        ret["ph"] = std::string("X");
+        ret["ts"] = static_cast<double>(start) / 1000.0; // Trace event timestamps are in microseconds
+        ret["dur"] = static_cast<double>(duration) / 1000.0;
+        ret["pid"] = 0;
+        ret["tid"] = thread;
+        return ret;
+    }
+
+    ECSProfiler::ECSProfiler(size_t historySize)
+        : history(std::max<size_t>(1, historySize)) {
+    }
+
+    ECSProfiler::ECSProfiler(const ECSProfiler &other)
+        : epoch(other.epoch),
+          threadIndices(other.threadIndices),
+          frames(other.frames),
+          history(other.history),
+          historyNext(other.historyNext),
+          historyCount(other.historyCount) {
+    }
+
+    ECSProfiler &ECSProfiler::operator=(const ECSProfiler &other) {
+        if (this == &other)
+            return *this;
+        epoch = other.epoch;
+        threadIndices = other.threadIndices;
+        frames = other.frames;
+        history = other.history;
+        historyNext = other.historyNext;
+        historyCount = other.historyCount;
+        return *this;
+    }
+
+    ECSProfiler::ECSProfiler(ECSProfiler &&other) noexcept
+        : epoch(other.epoch),
+          threadIndices(std::move(other.threadIndices)),
+          frames(std::move(other.frames)),
+          history(std::move(other.history)),
+          historyNext(other.historyNext),
+          historyCount(other.historyCount) {
+    }
+
+    ECSProfiler &ECSProfiler::operator=(ECSProfiler &&other) noexcept {
+        epoch = other.epoch;
+        threadIndices = std::move(other.threadIndices);
+        frames = std::move(other.frames);
+        history = std::move(other.history);
+        historyNext = other.historyNext;
+        historyCount = other.historyCount;
+        return *this;
+    }
+
+    void ECSProfiler::beginFrame() {
+        frameStart = Clock::now();
+        currentFrame.frames.clear();
+        currentFrame.start = toNanoseconds(frameStart - epoch);
+
+        // Assign the first index to the thread updating the runtime.
+        std::lock_guard<std::mutex> guard(mutex);
+        getThreadIndex();
+    }
+
+    void ECSProfiler::beginPipelineUpdate() {
+        pipelineStart = Clock::now();
+    }
+
+    void ECSProfiler::endSystemUpdate(const std::string &system, Clock::time_point start) {
+        const auto end = Clock::now();
+
+        ECSSample sample;
+        sample.systemName = system;
+        sample.start = toNanoseconds(start - frameStart);
+        sample.time = toNanoseconds(end - start);
+
+        std::lock_guard<std::mutex> guard(mutex);
+        sample.thread = getThreadIndex();
+        frameSamples.emplace_back(std::move(sample));
+    }
+
+    void ECSProfiler::endPipelineUpdate(const std::string &pipeline) {
+        const auto end = Clock::now();
+
+        std::lock_guard<std::mutex> guard(mutex);
+
+        ECSFrame frame;
+        frame.pipeline = pipeline;
+        frame.start = toNanoseconds(pipelineStart - frameStart);
+        frame.duration = toNanoseconds(end - pipelineStart);
+        frame.thread = getThreadIndex();
+        frame.samples = std::move(frameSamples);
+        frame.criticalPath = std::move(criticalPath);
+        frame.criticalPathDuration = criticalPathDuration;
+        currentFrame.addFrame(frame);
+
+        frameSamples.clear();
+        criticalPath.clear();
+        criticalPathDuration = 0;
+    }
+
+    void ECSProfiler::submitCriticalPath(std::vector<std::string> systems, std::chrono::nanoseconds duration) {
+        if (criticalPath.empty() || duration.count() > criticalPathDuration) {
+            criticalPath = std::move(systems);
+            criticalPathDuration = duration.count();
+        }
+    }
+
+    void ECSProfiler::endFrame() {
+        currentFrame.totalDuration = toNanoseconds(Clock::now() - frameStart);
+
+        // Assign instead of move so the ring buffer entries keep their allocations.
+        history.at(historyNext) = currentFrame;
+        historyNext = (historyNext + 1) % history.size();
+        historyCount = std::min(historyCount + 1, history.size());
+
+        frames = currentFrame;
+    }
+
+    std::vector<ECSFrameList> ECSProfiler::getHistory() const {
+        std::vector<ECSFrameList> ret;
+        ret.reserve(historyCount);
+        const auto first = (historyNext + history.size() - historyCount) % history.size();
+        for (size_t i = 0; i < historyCount; i++) {
+            ret.emplace_back(history.at((first + i) % history.size()));
+        }
+        return ret;
+    }
+
+    void ECSProfiler::setHistorySize(size_t size) {
+        history = std::vector<ECSFrameList>(std::max<size_t>(1, size));
+        historyNext = 0;
+        historyCount = 0;
+    }
+
+    std::map<std::string, ECSSystemStatistics> ECSProfiler::getSystemStatistics() const {
+        std::map<std::string, std::vector<long long> > durations;
+        for (size_t i = 0; i < historyCount; i++) {
+            for (auto &frame: history.at(i).frames) {
+                for (auto &sample: frame.samples) {
+                    durations[sample.systemName].emplace_back(sample.time);
+                }
+            }
+        }
+
+        std::map<std::string, ECSSystemStatistics> ret;
+        for (auto &pair: durations) {
+            auto &values = pair.second;
+            std::sort(values.begin(), values.end());
+
+            long long sum = 0;
+            for (auto &value: values) {
+                sum += value;
+            }
+
+            ECSSystemStatistics statistics;
+            statistics.systemName = pair.first;
+            statistics.samples = values.size();
+            statistics.min = values.front();
+            statistics.max = values.back();
+            statistics.average = sum / static_cast<long long>(values.size());
+
+            // Nearest rank percentile
+            const auto rank = static_cast<size_t>(std::ceil(0.99 * static_cast<double>(values.size())));
+            statistics.p99 = values.at(std::max<size_t>(rank, 1) - 1);
+
+            ret[pair.first] = statistics;
+        }
+        return ret;
+    }
+
+    void ECSProfiler::exportChromeTrace(std::ostream &stream) const {
+        std::vector<Message> events;
+
+        size_t threadCount = 1;
+        for (auto &frameList: getHistory()) {
+            events.emplace_back(createTraceEvent("Frame",
+                                                 "frame",
+                                                 frameList.start,
+                                                 frameList.totalDuration,
+                                                 frameList.frames.empty() ? 0 : frameList.frames.front().thread));
+            for (auto &frame: frameList.frames) {
+                events.emplace_back(createTraceEvent(frame.pipeline,
+                                                     "pipeline",
+                                                     frameList.start + frame.start,
+                                                     frame.duration,
+                                                     frame.thread));
+                threadCount = std::max(threadCount, frame.thread + 1);
+                for (auto &sample: frame.samples) {
+                    events.emplace_back(createTraceEvent(sample.systemName,
+                                                         "system",
+                                                         frameList.start + sample.start,
+                                                         sample.time,
+                                                         sample.thread));
+                    threadCount = std::max(threadCount, sample.thread + 1);
+                }
+            }
+        }
+
+        for (size_t i = 0; i < threadCount; i++) {
+            Message args(Message::DICTIONARY);
+            args["name"] = "Thread " + std::to_string(i);
+
+            Message event(Message::DICTIONARY);
+            event["name"] = std::string("thread_name");
+            event["ph"] = std::string("M");
+            event["pid"] = 0;
+            event["tid"] = i;
+            event["args"] = args;
+            events.emplace_back(event);
+        }
+
+        Message trace(Message::DICTIONARY);
+        trace["traceEvents"] = events;
+        trace["displayTimeUnit"] = std::string("ns");
+        JsonProtocol().serialize(stream, trace);
+    }
+
+    size_t ECSProfiler::getThreadIndex() {
+        const auto id = std::this_thread::get_id();
+        auto it = threadIndices.find(id);
+        if (it == threadIndices.end()) {
+            it = threadIndices.emplace(id, threadIndices.size()).first;
+        }
+        return it->second;
+    }
+}
@@ -53,12 +53,14 @@ namespace xng {
             for (auto &pipeline: pipelines) {
                 profiler.beginPipelineUpdate();
                 pipeline.update(deltaTime, *scene, *eventBus, profiler, enableProfiling);
+                scene->dispatchChanges();
                 profiler.endPipelineUpdate(pipeline.getName());
             }
             profiler.endFrame();
         } else {
             for (auto &pipeline: pipelines) {
                 pipeline.update(deltaTime, *scene, *eventBus, profiler, enableProfiling);
+                scene->dispatchChanges();
             }
         }
     }
@@ -98,4 +100,8 @@ namespace xng {
     const ECSProfiler &SystemRuntime::getProfiler() const {
         return profiler;
     }
+
+    ECSProfiler &SystemRuntime::getProfiler() {
+        return profiler;
+    }
 }
\ No newline at end of file
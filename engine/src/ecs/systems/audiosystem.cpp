@@ -109,6 +109,16 @@ namespace xng {
         }
     }
 
+    bool AudioSystem::requiresOldComponent(const std::string &typeName) {
+        return typeName == AudioSourceComponent::typeName;
+    }
+
+    ComponentAccess AudioSystem::getComponentAccess() {
+        return ComponentAccess().read<AudioListenerComponent>()
+                .read<TransformComponent>()
+                .write<AudioSourceComponent>();
+    }
+
     void AudioSystem::onComponentUpdate(const EntityHandle &entity,
                                         const Component &oldComponent,
                                         const Component &newComponent) {
@@ -53,6 +53,15 @@ namespace xng {
         }
     }
 
+    bool NodeAnimationSystem::requiresOldComponent(const std::string &typeName) {
+        return typeName == NodeAnimationComponent::typeName;
+    }
+
+    ComponentAccess NodeAnimationSystem::getComponentAccess() {
+        return ComponentAccess().read<SkinnedModelComponent>()
+                .write<NodeAnimationComponent>();
+    }
+
     void NodeAnimationSystem::onComponentUpdate(const EntityHandle &entity,
                                                const Component &oldComponent,
                                                const Component &newComponent) {
@@ -228,6 +228,17 @@ namespace xng {
         }
     }
 
+    bool PhysicsSystem::requiresOldComponent(const std::string &typeName) {
+        return typeName == ColliderComponent::typeName;
+    }
+
+    ComponentAccess PhysicsSystem::getComponentAccess() {
+        return ComponentAccess().read<ColliderComponent>()
+                .read<MeshColliderComponent>()
+                .write<RigidBodyComponent>()
+                .write<TransformComponent>();
+    }
+
     void PhysicsSystem::onComponentUpdate(const EntityHandle &entity,
                                           const Component &oldComponent,
                                           const Component &newComponent) {
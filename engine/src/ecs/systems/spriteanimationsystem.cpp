@@ -82,6 +82,15 @@ namespace xng {
         animations.erase(entity);
     }
 
+    bool SpriteAnimationSystem::requiresOldComponent(const std::string &typeName) {
+        return typeName == SpriteAnimationComponent::typeName;
+    }
+
+    ComponentAccess SpriteAnimationSystem::getComponentAccess() {
+        return ComponentAccess().write<SpriteAnimationComponent>()
+                .write<SpriteComponent>();
+    }
+
     void SpriteAnimationSystem::onComponentUpdate(const EntityHandle &entity,
                                                   const Component &oldComponent,
                                                   const Component &newComponent) {
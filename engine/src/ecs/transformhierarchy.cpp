@@ -0,0 +1,249 @@
+/**
+ *   xEngine - C++ Game Engine Library
+ *   Copyright (C) 2026 Julia Zampiccoli
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU Lesser General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   Lesser General Public License for more details.
+ *
+ *   You should have received a copy of the Lesser General Public License
+ *   along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "xng/ecs/transformhierarchy.hpp"
+
+#include <algorithm>
+
+#include "xng/async/threadpool.hpp"
+
+namespace xng {
+    TransformHierarchy::TransformHierarchy(EntityScene &scene)
+        : scene(scene) {
+        scene.addListener(*this);
+    }
+
+    TransformHierarchy::~TransformHierarchy() {
+        scene.removeListener(*this);
+    }
+
+    void TransformHierarchy::update(bool parallel) {
+        if (rebuildRequired) {
+            rebuild();
+            return;
+        }
+
+        if (dirtyNodes.empty())
+            return;
+
+        // Collect the ranges of the dirty subtrees, skipping dirty nodes inside the subtree of another dirty node.
+        std::sort(dirtyNodes.begin(), dirtyNodes.end());
+        std::vector<std::pair<size_t, size_t> > ranges;
+        size_t end = 0;
+        for (auto node: dirtyNodes) {
+            if (node < end && !ranges.empty())
+                continue;
+            end = subtreeEnds.at(node);
+            ranges.emplace_back(node, end);
+        }
+        dirtyNodes.clear();
+
+        // The parents of the range roots are outside of all ranges, so ranges can be updated in any order.
+        const auto &pool = scene.getPool<TransformComponent>();
+        if (parallel && ranges.size() > 1) {
+            ThreadPool::getPool().parallelForEach(ranges.begin(),
+                                                  ranges.end(),
+                                                  [this, &pool](const std::pair<size_t, size_t> &range) {
+                                                      updateRange(pool, range.first, range.second);
+                                                  });
+        } else {
+            for (auto &range: ranges) {
+                updateRange(pool, range.first, range.second);
+            }
+        }
+    }
+
+    void TransformHierarchy::onEntityDestroy(const EntityHandle &entity) {
+        if (contains(entity)) {
+            rebuildRequired = true;
+        }
+    }
+
+    void TransformHierarchy::onEntityNameChanged(const EntityHandle &entity,
+                                                 const std::string &newName,
+                                                 const std::string &oldName) {
+        // Components may reference the entity as parent by name
+        rebuildRequired = true;
+    }
+
+    void TransformHierarchy::onComponentCreate(const EntityHandle &entity, const Component &component) {
+        if (component.getTypeName() == TransformComponent::typeName) {
+            rebuildRequired = true;
+        }
+    }
+
+    void TransformHierarchy::onComponentDestroy(const EntityHandle &entity, const Component &component) {
+        if (component.getTypeName() == TransformComponent::typeName) {
+            rebuildRequired = true;
+        }
+    }
+
+    void TransformHierarchy::onComponentUpdate(const EntityHandle &entity,
+                                               const Component &oldComponent,
+                                               const Component &newComponent) {
+        if (rebuildRequired
+            || newComponent.getTypeName() != TransformComponent::typeName)
+            return;
+
+        if (!contains(entity)) {
+            rebuildRequired = true;
+            return;
+        }
+
+        const auto &component = down_cast<const TransformComponent &>(newComponent);
+        const auto index = indices.at(entity.id);
+
+        const auto parent = TransformComponent::getParentEntity(component, scene);
+        if (parent != parentEntities.at(index)) {
+            rebuildRequired = true;
+        } else if (!dirty.at(index)) {
+            dirty.at(index) = true;
+            dirtyNodes.emplace_back(index);
+        }
+    }
+
+    bool TransformHierarchy::requiresOldComponent(const std::string &typeName) {
+        // Parent changes are detected by comparing against the resolved parent of the node
+        return false;
+    }
+
+    void TransformHierarchy::rebuild() {
+        const auto &pool = scene.getPool<TransformComponent>();
+
+        // Resolve the parents and build the child lists of every component in pool order.
+        std::vector<EntityHandle> poolEntities;
+        std::vector<EntityHandle> poolParents;
+        poolEntities.reserve(pool.size());
+        poolParents.reserve(pool.size());
+        std::vector<size_t> poolIndices;
+        for (auto &pair: pool) {
+            if (static_cast<size_t>(pair.entity.id) >= poolIndices.size()) {
+                poolIndices.resize(pair.entity.id + 1, INVALID_INDEX);
+            }
+            poolIndices.at(pair.entity.id) = poolEntities.size();
+            poolEntities.emplace_back(pair.entity);
+
+            poolParents.emplace_back(TransformComponent::getParentEntity(pair.component, scene));
+        }
+
+        const auto count = poolEntities.size();
+        std::vector<size_t> firstChild(count, INVALID_INDEX);
+        std::vector<size_t> nextSibling(count, INVALID_INDEX);
+        std::vector<size_t> roots;
+        for (size_t i = count; i-- > 0;) {
+            const auto &parent = poolParents.at(i);
+            if (parent
+                && static_cast<size_t>(parent.id) < poolIndices.size()
+                && poolIndices.at(parent.id) != INVALID_INDEX) {
+                const auto parentIndex = poolIndices.at(parent.id);
+                nextSibling.at(i) = firstChild.at(parentIndex);
+                firstChild.at(parentIndex) = i;
+            } else {
+                poolParents.at(i) = EntityHandle();
+                roots.emplace_back(i);
+            }
+        }
+        std::reverse(roots.begin(), roots.end());
+
+        entities.clear();
+        parents.clear();
+        parentEntities.clear();
+        subtreeEnds.clear();
+        entities.reserve(count);
+        parents.reserve(count);
+        parentEntities.reserve(count);
+        subtreeEnds.reserve(count);
+
+        indices.assign(poolIndices.size(), INVALID_INDEX);
+
+        // Depth first traversal, the stack holds the pool index of the node and its parent node index.
+        std::vector<std::pair<size_t, size_t> > stack;
+        std::vector<size_t> open; // Node indices of the nodes whose subtree is not complete yet
+        for (auto root: roots) {
+            stack.emplace_back(root, INVALID_INDEX);
+            while (!stack.empty()) {
+                const auto poolIndex = stack.back().first;
+                const auto parentIndex = stack.back().second;
+                stack.pop_back();
+
+                // Close the subtrees of the nodes that are not ancestors of this node
+                while (!open.empty() && open.back() != parentIndex) {
+                    subtreeEnds.at(open.back()) = entities.size();
+                    open.pop_back();
+                }
+
+                const auto index = entities.size();
+                indices.at(poolEntities.at(poolIndex).id) = index;
+                entities.emplace_back(poolEntities.at(poolIndex));
+                parents.emplace_back(parentIndex);
+                parentEntities.emplace_back(poolParents.at(poolIndex));
+                subtreeEnds.emplace_back(INVALID_INDEX);
+                open.emplace_back(index);
+
+                // Push the children in reverse so that they are visited in pool order
+                const auto childrenBegin = stack.size();
+                for (auto child = firstChild.at(poolIndex); child != INVALID_INDEX; child = nextSibling.at(child)) {
+                    stack.emplace_back(child, index);
+                }
+                std::reverse(stack.begin() + static_cast<long>(childrenBegin), stack.end());
+            }
+            while (!open.empty()) {
+                subtreeEnds.at(open.back()) = entities.size();
+                open.pop_back();
+            }
+        }
+
+        if (entities.size() != count) {
+            throw std::runtime_error("Transform hierarchy contains a cycle");
+        }
+
+        worldPositions.resize(count);
+        worldRotations.resize(count);
+        worldScales.resize(count);
+        worldMatrices.resize(count);
+        dirty.assign(count, false);
+        dirtyNodes.clear();
+        rebuildRequired = false;
+
+        updateRange(pool, 0, count);
+    }
+
+    void TransformHierarchy::updateRange(const ComponentPool<TransformComponent> &pool, size_t begin, size_t end) {
+        for (auto i = begin; i < end; i++) {
+            const auto &local = pool.lookup(entities.at(i)).transform;
+            const auto parent = parents.at(i);
+            if (parent == INVALID_INDEX) {
+                worldPositions.at(i) = local.getPosition();
+                worldRotations.at(i) = local.getRotation();
+                worldScales.at(i) = local.getScale();
+                worldMatrices.at(i) = local.model();
+            } else {
+                // Same composition as Transform::getWorldTransform
+                const auto &position = local.getPosition();
+                const auto worldPosition = worldMatrices.at(parent) * Vec4f(position.x, position.y, position.z, 1.0f);
+                worldPositions.at(i) = Vec3f(worldPosition.x, worldPosition.y, worldPosition.z);
+                worldRotations.at(i) = worldRotations.at(parent) * local.getRotation();
+                worldScales.at(i) = local.getScale() * worldScales.at(parent);
+                worldMatrices.at(i) = MatrixMath::translate(worldPositions.at(i))
+                                      * worldRotations.at(i).matrix()
+                                      * MatrixMath::scale(worldScales.at(i));
+            }
+            dirty.at(i) = false;
+        }
+    }
+}
@@ -69,6 +69,53 @@ namespace xng {
         return std::move(ret);
     }
 
+    void DirectoryArchive::read(const std::string &path, std::vector<char> &buffer) {
+        auto targetPath = getAbsolutePath(path);
+
+        std::ifstream stream(targetPath.string(), std::ios_base::in | std::ios_base::binary);
+        if (!stream) {
+            throw std::runtime_error("Failed to open file " + targetPath.string());
+        }
+
+        std::error_code error;
+        auto size = std::filesystem::file_size(targetPath, error);
+        if (error) {
+            readStream(stream, buffer);
+            return;
+        }
+
+        buffer.resize(size);
+        stream.read(buffer.data(), static_cast<std::streamsize>(size));
+        buffer.resize(static_cast<size_t>(stream.gcount()));
+    }
+
+    bool DirectoryArchive::list(std::vector<std::string> &paths) {
+        if (directory.empty())
+            return false;
+        listedDirectories.clear();
+        listedDirectories.emplace_back(directory, std::filesystem::last_write_time(directory));
+        for (auto &entry: std::filesystem::recursive_directory_iterator(directory)) {
+            if (entry.is_directory()) {
+                listedDirectories.emplace_back(entry.path(), entry.last_write_time());
+            } else if (entry.is_regular_file()) {
+                paths.emplace_back(std::filesystem::relative(entry.path(), directory).generic_string());
+            }
+        }
+        return true;
+    }
+
+    bool DirectoryArchive::changed() {
+        if (listedDirectories.empty())
+            return true;
+        std::error_code error;
+        for (auto &pair: listedDirectories) {
+            auto time = std::filesystem::last_write_time(pair.first, error);
+            if (error || time != pair.second)
+                return true;
+        }
+        return false;
+    }
+
     std::filesystem::path DirectoryArchive::getAbsolutePath(const std::string &path) {
         if (path.at(0) != '/') {
             //Allow relative paths without a leading slash
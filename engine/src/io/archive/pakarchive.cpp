@@ -18,28 +18,231 @@
 
 #include "xng/io/archive/pakarchive.hpp"
 
-#include <filesystem>
-#include <sstream>
+#include <list>
+#include <map>
+#include <mutex>
 #include <utility>
 
+#include "xng/io/memorystream.hpp"
+
 namespace xng {
-    PakArchive::PakArchive(Pak pak, bool verifyHashes)
-            : pak(std::move(pak)),
-              verifyHashes(verifyHashes) {}
+    typedef std::shared_ptr<const std::vector<char>> BlockData;
+
+    struct PakArchive::State {
+        std::mutex mutex;
+        Pak pak;
+        bool verifyHashes;
+
+        // Least recently used decoded blocks, the front is the most recently used block.
+        typedef std::pair<std::string, size_t> BlockKey;
+        std::list<std::pair<BlockKey, BlockData>> blocks;
+        std::map<BlockKey, std::list<std::pair<BlockKey, BlockData>>::iterator> blockLookup;
+        size_t cacheSize = 0;
+        size_t cacheCapacity;
+
+        State(Pak pak, bool verifyHashes, size_t cacheCapacity)
+                : pak(std::move(pak)), verifyHashes(verifyHashes), cacheCapacity(cacheCapacity) {}
+
+        BlockData getBlock(const std::string &path, const Pak::BlockTable &table, size_t index) {
+            BlockKey key(path, index);
+            {
+                std::lock_guard<std::mutex> guard(mutex);
+                auto it = blockLookup.find(key);
+                if (it != blockLookup.end()) {
+                    blocks.splice(blocks.begin(), blocks, it->second);
+                    return it->second->second;
+                }
+            }
+
+            BlockData data;
+            if (pak.isMapped()) {
+                // Reads from mapped paks do not modify the pak
+                data = std::make_shared<const std::vector<char>>(pak.getBlock(table, index, verifyHashes));
+            } else {
+                std::lock_guard<std::mutex> guard(mutex);
+                data = std::make_shared<const std::vector<char>>(pak.getBlock(table, index, verifyHashes));
+            }
+
+            std::lock_guard<std::mutex> guard(mutex);
+            if (blockLookup.find(key) == blockLookup.end() && data->size() <= cacheCapacity) {
+                blocks.emplace_front(key, data);
+                blockLookup[key] = blocks.begin();
+                cacheSize += data->size();
+                while (cacheSize > cacheCapacity) {
+                    auto &back = blocks.back();
+                    cacheSize -= back.second->size();
+                    blockLookup.erase(back.first);
+                    blocks.pop_back();
+                }
+            }
+            return data;
+        }
+    };
+
+    /**
+     * A seekable stream buffer over an entry stored in blocks, blocks are loaded when a byte of the block is read.
+     */
+    class PakBlockStreamBuf : public std::streambuf {
+    public:
+        PakBlockStreamBuf(std::shared_ptr<PakArchive::State> state, std::string path, Pak::BlockTable table)
+                : state(std::move(state)), path(std::move(path)), table(std::move(table)) {}
+
+    protected:
+        int_type underflow() override {
+            if (gptr() != nullptr && gptr() < egptr())
+                return traits_type::to_int_type(*gptr());
+
+            auto pos = getPosition();
+            if (pos >= table.size)
+                return traits_type::eof();
+
+            loadBlock(pos / table.blockSize);
+            auto *begin = const_cast<char *>(block->data());
+            setg(begin, begin + (pos - blockIndex * table.blockSize), begin + block->size());
+            return traits_type::to_int_type(*gptr());
+        }
+
+        std::streamsize showmanyc() override {
+            auto pos = getPosition();
+            return pos < table.size ? static_cast<std::streamsize>(table.size - pos) : -1;
+        }
+
+        pos_type seekoff(off_type off,
+                         std::ios_base::seekdir dir,
+                         std::ios_base::openmode which = std::ios_base::in) override {
+            if (!(which & std::ios_base::in))
+                return pos_type(off_type(-1));
+
+            off_type base;
+            if (dir == std::ios_base::beg)
+                base = 0;
+            else if (dir == std::ios_base::cur)
+                base = static_cast<off_type>(getPosition());
+            else
+                base = static_cast<off_type>(table.size);
+
+            auto target = base + off;
+            if (target < 0 || static_cast<size_t>(target) > table.size)
+                return pos_type(off_type(-1));
+
+            auto t = static_cast<size_t>(target);
+            if (block && t >= blockIndex * table.blockSize && t < blockIndex * table.blockSize + block->size()) {
+                auto *begin = const_cast<char *>(block->data());
+                setg(begin, begin + (t - blockIndex * table.blockSize), begin + block->size());
+            } else {
+                position = t;
+                setg(nullptr, nullptr, nullptr);
+            }
+            return pos_type(target);
+        }
+
+        pos_type seekpos(pos_type pos, std::ios_base::openmode which = std::ios_base::in) override {
+            return seekoff(off_type(pos), std::ios_base::beg, which);
+        }
+
+    private:
+        size_t getPosition() const {
+            if (gptr() == nullptr)
+                return position;
+            return blockIndex * table.blockSize + static_cast<size_t>(gptr() - eback());
+        }
+
+        void loadBlock(size_t index) {
+            if (block && blockIndex == index)
+                return;
+            block = state->getBlock(path, table, index);
+            blockIndex = index;
+        }
+
+        std::shared_ptr<PakArchive::State> state;
+        std::string path;
+        Pak::BlockTable table;
+
+        BlockData block;
+        size_t blockIndex = 0;
+        size_t position = 0; // The read position while no block is loaded
+    };
+
+    class PakBlockStream : public std::istream {
+    public:
+        PakBlockStream(std::shared_ptr<PakArchive::State> state, std::string path, Pak::BlockTable table)
+                : std::istream(nullptr), buf(std::move(state), std::move(path), std::move(table)) {
+            rdbuf(&buf);
+        }
+
+    private:
+        PakBlockStreamBuf buf;
+    };
+
+    PakArchive::PakArchive()
+            : PakArchive(Pak()) {}
+
+    PakArchive::PakArchive(Pak pak, bool verifyHashes, size_t blockCacheSize)
+            : state(std::make_shared<State>(std::move(pak), verifyHashes, blockCacheSize)) {}
 
     bool PakArchive::exists(const std::string &path) {
-        return pak.exists(path);
+        return state->pak.exists(path);
     }
 
     std::unique_ptr<std::istream> PakArchive::open(const std::string &path) {
-        std::lock_guard<std::mutex> guard(mutex);
-        auto data = pak.get(path, verifyHashes);
-        auto ret = std::make_unique<std::stringstream>(std::string(data.begin(), data.end()));
+        auto &pak = state->pak;
+        std::unique_ptr<std::istream> ret;
+        if (pak.isMapped()) {
+            // Reads from mapped paks do not modify the pak
+            auto view = pak.getView(path, state->verifyHashes);
+            if (view) {
+                ret = std::make_unique<MemoryStream>(view.data, view.size, state);
+            } else {
+                auto table = pak.getBlockTable(path);
+                if (table.blocks.empty()) {
+                    ret = std::make_unique<MemoryStream>(pak.get(path, state->verifyHashes));
+                } else {
+                    ret = std::make_unique<PakBlockStream>(state, path, std::move(table));
+                }
+            }
+        } else {
+            std::unique_lock<std::mutex> guard(state->mutex);
+            auto table = pak.getBlockTable(path);
+            if (table.blocks.empty()) {
+                ret = std::make_unique<MemoryStream>(pak.get(path, state->verifyHashes));
+            } else {
+                guard.unlock();
+                ret = std::make_unique<PakBlockStream>(state, path, std::move(table));
+            }
+        }
         std::noskipws(*ret);
-        return std::move(ret);
+        return ret;
+    }
+
+    Archive::FileView PakArchive::view(const std::string &path) {
+        auto &pak = state->pak;
+        if (!pak.isMapped())
+            return {};
+        auto view = pak.getView(path, state->verifyHashes);
+        if (!view)
+            return {};
+        return {view.data, view.size, state};
+    }
+
+    void PakArchive::read(const std::string &path, std::vector<char> &buffer) {
+        auto &pak = state->pak;
+        if (pak.isMapped()) {
+            pak.get(path, buffer, state->verifyHashes);
+        } else {
+            std::lock_guard<std::mutex> guard(state->mutex);
+            pak.get(path, buffer, state->verifyHashes);
+        }
     }
 
     std::unique_ptr<std::iostream> PakArchive::openRW(const std::string &name) {
         throw std::runtime_error("Writing to pak is not supported");
     }
-}
\ No newline at end of file
+
+    bool PakArchive::list(std::vector<std::string> &paths) {
+        std::lock_guard<std::mutex> guard(state->mutex);
+        for (auto &pair: state->pak.getEntries()) {
+            paths.emplace_back(pair.first);
+        }
+        return true;
+    }
+}
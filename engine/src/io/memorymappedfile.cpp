@@ -0,0 +1,32 @@
+/**
+ *   xEngine - C++ Game Engine Library
+ *   Copyright (C) 2026 Julia Zampiccoli
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU Lesser General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   Lesser General Public License for more details.
+ *
+ *   You should have received a copy of the Lesser General Public License
+ *   along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include "xng/io/memorymappedfile.hpp"
+
+#ifdef _WIN32
+#include "io/mmap/memorymappedfilewin32.hpp"
+#else
+#include "io/mmap/memorymappedfileposix.hpp"
+#endif
+
+namespace xng {
+    std::unique_ptr<MemoryMappedFile> MemoryMappedFile::open(const std::filesystem::path &path) {
+        return std::make_unique<MemoryMappedFileOS>(path);
+    }
+}
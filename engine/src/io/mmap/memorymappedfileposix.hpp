@@ -0,0 +1,86 @@
+/**
+ *   xEngine - C++ Game Engine Library
+ *   Copyright (C) 2026 Julia Zampiccoli
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU Lesser General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   Lesser General Public License for more details.
+ *
+ *   You should have received a copy of the Lesser General Public License
+ *   along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef XENGINE_MEMORYMAPPEDFILEPOSIX_HPP
+#define XENGINE_MEMORYMAPPEDFILEPOSIX_HPP
+
+#include "xng/io/memorymappedfile.hpp"
+
+#include <stdexcept>
+#include <string>
+#include <cstring>
+#include <cerrno>
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace xng {
+    class MemoryMappedFilePosix : public MemoryMappedFile {
+    public:
+        explicit MemoryMappedFilePosix(const std::filesystem::path &path) {
+            auto fd = ::open(path.c_str(), O_RDONLY);
+            if (fd < 0) {
+                throw std::runtime_error("Failed to open file at: " + path.string() + " Error: " + strerror(errno));
+            }
+
+            struct stat st{};
+            if (fstat(fd, &st) != 0) {
+                ::close(fd);
+                throw std::runtime_error("Failed to stat file at: " + path.string() + " Error: " + strerror(errno));
+            }
+
+            fileSize = static_cast<size_t>(st.st_size);
+
+            if (fileSize > 0) {
+                auto *ptr = mmap(nullptr, fileSize, PROT_READ, MAP_PRIVATE, fd, 0);
+                if (ptr == MAP_FAILED) {
+                    ::close(fd);
+                    throw std::runtime_error("Failed to map file at: " + path.string() + " Error: " + strerror(errno));
+                }
+                mapping = static_cast<const char *>(ptr);
+            }
+
+            // The mapping stays valid after the descriptor is closed.
+            ::close(fd);
+        }
+
+        ~MemoryMappedFilePosix() override {
+            if (mapping != nullptr)
+                munmap(const_cast<char *>(mapping), fileSize);
+        }
+
+        const char *data() const override {
+            return mapping;
+        }
+
+        size_t size() const override {
+            return fileSize;
+        }
+
+    private:
+        const char *mapping = nullptr;
+        size_t fileSize = 0;
+    };
+
+    typedef MemoryMappedFilePosix MemoryMappedFileOS;
+}
+
+#endif //XENGINE_MEMORYMAPPEDFILEPOSIX_HPP
@@ -0,0 +1,94 @@
+/**
+ *   xEngine - C++ Game Engine Library
+ *   Copyright (C) 2026 Julia Zampiccoli
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU Lesser General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   Lesser General Public License for more details.
+ *
+ *   You should have received a copy of the Lesser General Public License
+ *   along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef XENGINE_MEMORYMAPPEDFILEWIN32_HPP
+#define XENGINE_MEMORYMAPPEDFILEWIN32_HPP
+
+#include "xng/io/memorymappedfile.hpp"
+
+#include <stdexcept>
+#include <string>
+#include <windows.h>
+
+namespace xng {
+    class MemoryMappedFileWin32 : public MemoryMappedFile {
+    public:
+        explicit MemoryMappedFileWin32(const std::filesystem::path &path) {
+            file = CreateFileW(path.c_str(),
+                               GENERIC_READ,
+                               FILE_SHARE_READ,
+                               nullptr,
+                               OPEN_EXISTING,
+                               FILE_ATTRIBUTE_NORMAL,
+                               nullptr);
+            if (file == INVALID_HANDLE_VALUE) {
+                throw std::runtime_error("Failed to open file at: " + path.string());
+            }
+
+            LARGE_INTEGER s;
+            if (!GetFileSizeEx(file, &s)) {
+                CloseHandle(file);
+                throw std::runtime_error("Failed to get size of file at: " + path.string());
+            }
+
+            fileSize = static_cast<size_t>(s.QuadPart);
+
+            if (fileSize > 0) {
+                mappingHandle = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+                if (mappingHandle == nullptr) {
+                    CloseHandle(file);
+                    throw std::runtime_error("Failed to create mapping for file at: " + path.string());
+                }
+
+                mapping = static_cast<const char *>(MapViewOfFile(mappingHandle, FILE_MAP_READ, 0, 0, 0));
+                if (mapping == nullptr) {
+                    CloseHandle(mappingHandle);
+                    CloseHandle(file);
+                    throw std::runtime_error("Failed to map file at: " + path.string());
+                }
+            }
+        }
+
+        ~MemoryMappedFileWin32() override {
+            if (mapping != nullptr)
+                UnmapViewOfFile(mapping);
+            if (mappingHandle != nullptr)
+                CloseHandle(mappingHandle);
+            CloseHandle(file);
+        }
+
+        const char *data() const override {
+            return mapping;
+        }
+
+        size_t size() const override {
+            return fileSize;
+        }
+
+    private:
+        HANDLE file = INVALID_HANDLE_VALUE;
+        HANDLE mappingHandle = nullptr;
+        const char *mapping = nullptr;
+        size_t fileSize = 0;
+    };
+
+    typedef MemoryMappedFileWin32 MemoryMappedFileOS;
+}
+
+#endif //XENGINE_MEMORYMAPPEDFILEWIN32_HPP
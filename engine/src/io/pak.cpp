@@ -20,6 +20,7 @@
 
 #include <utility>
 #include <filesystem>
+#include <cstring>
 
 #include "thirdparty/json.hpp"
 #include "thirdparty/base64.hpp"
@@ -28,10 +29,14 @@
 #include "xng/crypto/gzip.hpp"
 #include "xng/crypto/sha.hpp"
 
+#include "io/pakformat.hpp"
+
 namespace xng {
+    using namespace pakformat;
+
     Pak::Pak(std::vector<std::reference_wrapper<std::istream>> streams, GZip &gzip, SHA &sha)
             : streams(std::move(streams)), gzip(&gzip), sha(&sha) {
-        loadHeader();
+        load();
     }
 
     Pak::Pak(std::vector<std::reference_wrapper<std::istream>> streams,
@@ -40,157 +45,241 @@ namespace xng {
              AES &aes,
              AES::Key key)
             : streams(std::move(streams)),
+              aes(&aes),
+              key(std::move(key)),
+              gzip(&gzip),
+              sha(&sha) {
+        load();
+    }
+
+    Pak::Pak(const std::vector<std::filesystem::path> &paths, GZip &gzip, SHA &sha)
+            : gzip(&gzip), sha(&sha) {
+        for (auto &path: paths) {
+            maps.emplace_back(MemoryMappedFile::open(path));
+        }
+        load();
+    }
+
+    Pak::Pak(const std::vector<std::filesystem::path> &paths,
+             GZip &gzip,
+             SHA &sha,
+             AES &aes,
+             AES::Key key)
+            : aes(&aes),
               key(std::move(key)),
               gzip(&gzip),
-              sha(&sha),
-              aes(&aes) {
-        loadHeader();
+              sha(&sha) {
+        for (auto &path: paths) {
+            maps.emplace_back(MemoryMappedFile::open(path));
+        }
+        load();
     }
 
     std::vector<char> Pak::get(const std::string &path, bool verifyHash) {
         std::vector<char> ret;
-        auto hEntry = entries.at(path);
-
-        if (chunkSize == 0) {
-            auto &stream = getStreamForOffset(hEntry.offset);
-            std::vector<char> tmp(hEntry.size);
-            stream.seekg(static_cast<std::streamoff>(hEntry.offset));
-            stream.read(tmp.data(), static_cast<std::streamoff>(hEntry.size));
-            if (stream.gcount() != hEntry.size)
-                throw std::runtime_error("Failed to read pak entry");
-            ret.insert(ret.begin(), tmp.begin(), tmp.end());
-        } else {
-            auto beginOffset = hEntry.offset % chunkSize; // The offset into the first chunk stream
-            auto beginCount = chunkSize - beginOffset; // The number of bytes in the first chunk stream
+        get(path, ret, verifyHash);
+        return ret;
+    }
 
-            if (hEntry.size < beginCount) {
-                beginCount = hEntry.size;
+    void Pak::get(const std::string &path, std::vector<char> &buffer, bool verifyHash) {
+        if (index == nullptr)
+            throw std::runtime_error("Pak entry not found: " + path);
+
+        IndexReader reader(index, indexSize);
+        auto recordIndex = reader.find(path);
+        if (recordIndex < 0)
+            throw std::runtime_error("Pak entry not found: " + path);
+
+        auto record = reader.getRecord(recordIndex);
+
+        if (record.flags & PAK_ENTRY_BLOCKS) {
+            auto table = loadBlockTable(recordIndex);
+
+            // Decode block by block so that only a single stored block is held in addition to the output
+            buffer.resize(table.size);
+            size_t offset = 0;
+            for (size_t i = 0; i < table.blocks.size(); i++) {
+                auto data = getBlock(table, i, verifyHash);
+                if (data.size() > buffer.size() - offset)
+                    throw std::runtime_error("Pak block size mismatch");
+                std::memcpy(buffer.data() + offset, data.data(), data.size());
+                offset += data.size();
             }
-
-            auto remainingCount = static_cast<int>(hEntry.size - beginCount); // The number of remaining bytes
-
-            auto remainChunks = remainingCount / chunkSize; // The number of full chunks that the remaining bytes fill
-
-            auto lastCount = remainingCount %
-                             chunkSize; // The number of bytes in the last partial chunk stream. If the data size matches chunk size a "middle" chunk is the end.
-
-            // Read first chunk
-            if (beginCount > 0) {
-                auto &firstStream = getStreamForOffset(hEntry.offset);
-                std::vector<char> tmp(beginCount);
-                firstStream.seekg(static_cast<std::streamoff>(beginOffset));
-                firstStream.read(tmp.data(), static_cast<std::streamoff>(beginCount));
-                if (firstStream.gcount() != beginCount)
-                    throw std::runtime_error("Failed to read pak entry");
-                ret.insert(ret.begin(), tmp.begin(), tmp.end());
+            if (offset != buffer.size())
+                throw std::runtime_error("Pak block size mismatch");
+        } else if (record.flags & (PAK_ENTRY_COMPRESSED | PAK_ENTRY_ENCRYPTED)) {
+            std::vector<char> data(record.storedSize);
+            read(record.offset, data.data(), data.size());
+            if (record.flags & PAK_ENTRY_ENCRYPTED) {
+                data = decode(std::move(data), false, true);
             }
-
-            if (remainChunks > 0) {
-                //Read full chunks
-                for (int i = 0; i < remainChunks; i++) {
-                    std::vector<char> chunk(chunkSize);
-                    auto gOffset = hEntry.offset + beginCount + (i * chunkSize);
-                    auto &stream = getStreamForOffset(gOffset);
-                    stream.seekg(0);
-                    stream.read(chunk.data(), static_cast<std::streamoff>(chunk.size()));
-                    if (stream.gcount() != chunk.size())
-                        throw std::runtime_error("Failed to read pak chunk");
-                    ret.insert(ret.end(), chunk.begin(), chunk.end());
-                }
+            if (record.flags & PAK_ENTRY_COMPRESSED) {
+                // Decompress into the buffer so that its capacity is reused
+                buffer.clear();
+                buffer.reserve(record.uncompressedSize);
+                auto decompressor = gzip->createDecompressor();
+                decompressor->update(data.data(), data.size(), buffer);
+                decompressor->finish(buffer);
+            } else {
+                buffer.assign(data.begin(), data.end());
             }
+        } else {
+            buffer.resize(record.storedSize);
+            read(record.offset, buffer.data(), buffer.size());
+        }
 
-            if (lastCount > 0) {
-                // Read last partial chunk
-                std::vector<char> lastChunk(lastCount);
-                auto gOffset = hEntry.offset + beginCount + (remainChunks * chunkSize);
-                auto &lastStream = getStreamForOffset(gOffset);
-                lastStream.seekg(0);
-                lastStream.read(lastChunk.data(), static_cast<std::streamoff>(lastChunk.size()));
-
-                if (lastStream.gcount() != lastChunk.size())
-                    throw std::runtime_error("Failed to read pak chunk");
-
-                ret.insert(ret.begin()
-                           + static_cast<std::streamoff>(beginCount)
-                           + static_cast<std::streamoff>(remainChunks) * chunkSize,
-                           lastChunk.begin(),
-                           lastChunk.end());
+        if (verifyHash) {
+            auto hash = sha->sha256(buffer);
+            if (hash.size() != record.hashLength
+                || hash.compare(0, hash.size(), record.hash, record.hashLength) != 0) {
+                throw std::runtime_error("Pak entry data hash mismatch");
             }
         }
+    }
 
-        if (encrypted) {
-            ret = aes->decrypt(key, iv, ret);
+    Pak::EntryView Pak::getView(const std::string &path, bool verifyHash) const {
+        if (maps.empty() || index == nullptr)
+            return {};
+
+        IndexReader reader(index, indexSize);
+        auto recordIndex = reader.find(path);
+        if (recordIndex < 0)
+            return {};
+
+        auto record = reader.getRecord(recordIndex);
+        if (record.flags != 0)
+            return {};
+
+        size_t source = 0;
+        size_t relativeOffset = record.offset;
+        if (chunkSize > 0) {
+            source = record.offset / chunkSize;
+            relativeOffset = record.offset % chunkSize;
+            if (relativeOffset + record.storedSize > chunkSize)
+                return {};
         }
 
-        if (compressed) {
-            ret = gzip->decompress(ret);
-        }
+        if (source >= maps.size())
+            return {};
+
+        auto &map = *maps.at(source);
+        if (map.data() == nullptr || relativeOffset + record.storedSize > map.size())
+            return {};
 
         if (verifyHash) {
-            auto hash = sha->sha256(ret);
-            if (hEntry.hash != hash) {
+            auto hash = sha->sha256(map.data() + relativeOffset, record.storedSize);
+            if (hash.size() != record.hashLength
+                || hash.compare(0, hash.size(), record.hash, record.hashLength) != 0) {
                 throw std::runtime_error("Pak entry data hash mismatch");
             }
         }
 
-        return ret;
+        return {map.data() + relativeOffset, record.storedSize};
     }
 
-    void Pak::loadHeader() {
-        size_t dataBegin{};
-        std::string headerStr{};
-        std::string headerSizeStr{};
-        size_t headerSize{};
-        int scope = -1;
-        char c;
-        int streamIndex = 0;
-        auto calChunkSize = 0;
-        for (auto i = 0; i < std::numeric_limits<size_t>::max(); i++) {
-            auto &s = streams.at(streamIndex).get();
-            auto offset = i - ((calChunkSize) * streamIndex);
-
-            s.seekg(static_cast<std::streamoff>(offset));
-            s.read(&c, 1);
-
-            if (s.eof()) {
-                if (streams.size() < streamIndex + 1) {
-                    throw std::runtime_error("Failed to load header (End of file)");
-                }
+    Pak::BlockTable Pak::getBlockTable(const std::string &path) {
+        if (index == nullptr)
+            throw std::runtime_error("Pak entry not found: " + path);
 
-                if (calChunkSize == 0)
-                    calChunkSize = i;
+        auto recordIndex = IndexReader(index, indexSize).find(path);
+        if (recordIndex < 0)
+            throw std::runtime_error("Pak entry not found: " + path);
 
-                streamIndex++;
+        return loadBlockTable(recordIndex);
+    }
 
-                offset = i - ((calChunkSize) * streamIndex);
+    std::vector<char> Pak::getBlock(const BlockTable &table, size_t block, bool verifyHash) {
+        auto &b = table.blocks.at(block);
 
-                auto &tmp = streams.at(streamIndex).get();
-                tmp.seekg(static_cast<std::streamoff>(offset));
-                tmp.read(&c, 1);
-            } else if (s.gcount() == 0) {
-                throw std::runtime_error("Failed to load header (End of file gcount)");
-            }
+        std::vector<char> ret(b.storedSize);
+        read(b.offset, ret.data(), ret.size());
 
-            if (i < PAK_HEADER_MAGIC.size())
-                continue;
+        ret = decode(std::move(ret), table.compressed, table.encrypted);
 
-            if (c == '\xa7' && scope != 2) {
-                if (scope == -1) {
-                    scope = 1;
-                } else {
-                    headerSize = std::stoul(headerSizeStr);
-                    dataBegin = i + 1 + headerSize;
-                    scope = 2;
-                }
-            } else if (scope == 1) {
-                headerSizeStr += c;
-            } else if (scope == 2) {
-                headerStr += c;
-                if (headerStr.size() == headerSize)
-                    break;
+        if (ret.size() != b.size)
+            throw std::runtime_error("Pak block size mismatch");
+
+        if (verifyHash && sha->sha256(ret) != b.hash)
+            throw std::runtime_error("Pak block data hash mismatch");
+
+        return ret;
+    }
+
+    bool Pak::exists(const std::string &path) const {
+        if (index == nullptr)
+            return false;
+        return IndexReader(index, indexSize).find(path) >= 0;
+    }
+
+    const std::map<std::string, Pak::HeaderEntry> &Pak::getEntries() const {
+        static const std::map<std::string, HeaderEntry> empty;
+        if (!entries)
+            return empty;
+        std::call_once(entries->once, [this]() {
+            if (index == nullptr)
+                return;
+            IndexReader reader(index, indexSize);
+            for (size_t i = 0; i < reader.getRecordCount(); i++) {
+                auto record = reader.getRecord(i);
+                entries->entries.emplace_hint(entries->entries.end(),
+                                              std::string(record.path, record.pathLength),
+                                              HeaderEntry{record.offset,
+                                                          record.storedSize,
+                                                          std::string(record.hash, record.hashLength)});
             }
+        });
+        return entries->entries;
+    }
+
+    void Pak::load() {
+        if (getSourceCount() == 0)
+            throw std::runtime_error("No pak chunks specified");
+
+        std::string magic(PAK_MAGIC_SIZE, 0);
+        read(0, magic.data(), magic.size());
+
+        if (magic == PAK_HEADER_MAGIC) {
+            loadHeaderV2();
+        } else if (magic == PAK_HEADER_MAGIC_V1) {
+            loadHeaderV1();
+        } else {
+            throw std::runtime_error("Invalid pak magic");
+        }
+
+        entries = std::make_shared<EntryCache>();
+    }
+
+    void Pak::loadHeaderV1() {
+        formatVersion = "01";
+
+        // The chunk size is stored inside the header, until the header is parsed the size of the first chunk is used.
+        if (getSourceCount() > 1)
+            chunkSize = getSourceSize(0);
+
+        auto offset = PAK_HEADER_MAGIC_V1.size();
+
+        char c;
+        read(offset++, &c, 1);
+        if (c != '\xa7')
+            throw std::runtime_error("Failed to load header (Invalid size prefix)");
+
+        std::string headerSizeStr;
+        while (true) {
+            read(offset++, &c, 1);
+            if (c == '\xa7')
+                break;
+            if (c < '0' || c > '9' || headerSizeStr.size() > 20)
+                throw std::runtime_error("Failed to load header (Invalid size)");
+            headerSizeStr += c;
         }
 
+        auto headerSize = std::stoul(headerSizeStr);
+        std::string headerStr(headerSize, 0);
+        read(offset, headerStr.data(), headerStr.size());
+
+        auto dataBegin = offset + headerSize;
+
+        bool encrypted = false;
         auto headerJson = nlohmann::json::from_bson(headerStr);
         if (headerJson.contains("edata")) {
             encrypted = true;
@@ -216,35 +305,201 @@ namespace xng {
             headerJson = nlohmann::json::parse(decodedHeader);
         }
 
-        compressed = headerJson["compressed"];
+        bool compressed = headerJson["compressed"];
         chunkSize = headerJson["chunkSize"];
 
+        uint32_t flags = 0;
+        if (compressed)
+            flags |= PAK_ENTRY_COMPRESSED;
+        if (encrypted)
+            flags |= PAK_ENTRY_ENCRYPTED;
+
+        std::vector<Record> records;
         for (auto &pair: headerJson.value<std::map<std::string, nlohmann::json>>("entries", {})) {
-            auto &path = pair.first;
             auto &entry = pair.second;
-            size_t offset = entry["offset"];
-            size_t size = entry["size"];
-            std::string hash = entry["hash"];
-            entries[path] = {dataBegin + offset, size, hash};
+            Record record;
+            record.path = pair.first;
+            record.hash = entry["hash"];
+            record.offset = dataBegin + static_cast<size_t>(entry["offset"]);
+            record.storedSize = entry["size"];
+            record.uncompressedSize = flags == 0 ? record.storedSize : 0; // Not stored in v1 paks
+            record.flags = flags;
+            records.emplace_back(std::move(record));
         }
+
+        auto buffer = std::make_shared<std::vector<char>>(writeIndex(records));
+        index = buffer->data();
+        indexSize = buffer->size();
+        indexBuffer = std::move(buffer);
     }
 
-    size_t Pak::getRelativeOffset(size_t globalOffset) {
-        if (chunkSize <= 0)
-            return globalOffset;
+    void Pak::loadHeaderV2() {
+        formatVersion = PAK_FORMAT_VERSION;
+
+        std::vector<char> headerData(PAK_HEADER_SIZE);
+        read(0, headerData.data(), headerData.size());
+
+        auto header = readHeader(headerData.data());
+        chunkSize = header.chunkSize;
+        iv = header.iv;
 
-        if (globalOffset < chunkSize) {
-            return globalOffset;
+        if (chunkSize > 0 && chunkSize < PAK_HEADER_SIZE)
+            throw std::runtime_error("Invalid pak chunk size");
+
+        auto encrypted = (header.flags & PAK_FLAG_ENCRYPTED) != 0;
+
+        size_t source = 0;
+        size_t relativeOffset = header.indexOffset;
+        if (chunkSize > 0) {
+            source = header.indexOffset / chunkSize;
+            relativeOffset = header.indexOffset % chunkSize;
+        }
+
+        if (!encrypted
+            && !maps.empty()
+            && source < maps.size()
+            && (chunkSize == 0 || relativeOffset + header.indexSize <= chunkSize)
+            && relativeOffset + header.indexSize <= maps.at(source)->size()) {
+            // Access the index directly from the mapped file
+            index = maps.at(source)->data() + relativeOffset;
+            indexSize = header.indexSize;
         } else {
-            auto rChunk = globalOffset % chunkSize; // The relative offset ( Remainder )
-            return rChunk;
+            auto buffer = std::make_shared<std::vector<char>>(header.indexSize);
+            read(header.indexOffset, buffer->data(), buffer->size());
+
+            if (encrypted) {
+                if (aes == nullptr) {
+                    throw std::runtime_error("Pak data is encrypted but no aes implementation was specified.");
+                }
+                try {
+                    *buffer = aes->decrypt(key, iv, *buffer);
+                } catch (const std::exception &e) {
+                    std::string error = "Failed to decrypt pak index (Wrong Key?): " + std::string(e.what());
+                    throw std::runtime_error(error);
+                }
+            }
+
+            index = buffer->data();
+            indexSize = buffer->size();
+            indexBuffer = std::move(buffer);
         }
+
+        IndexReader reader(index, indexSize);
+        reader.validate();
+        if (reader.getRecordCount() != header.entryCount)
+            throw std::runtime_error("Pak index entry count mismatch");
     }
 
-    std::istream &Pak::getStreamForOffset(size_t globalOffset) {
-        if (chunkSize <= 0)
-            return streams.at(0);
-        auto nChunk = globalOffset / chunkSize;
-        return streams.at(nChunk);
+    std::vector<char> Pak::decode(std::vector<char> data, bool compressed, bool encrypted) {
+        if (encrypted) {
+            if (aes == nullptr)
+                throw std::runtime_error("Pak data is encrypted but no aes implementation was specified.");
+            data = aes->decrypt(key, iv, data);
+        }
+
+        if (compressed) {
+            data = gzip->decompress(data);
+        }
+
+        return data;
+    }
+
+    Pak::BlockTable Pak::loadBlockTable(size_t recordIndex) {
+        auto record = IndexReader(index, indexSize).getRecord(recordIndex);
+
+        BlockTable ret;
+        ret.size = record.uncompressedSize;
+        ret.compressed = record.flags & PAK_ENTRY_COMPRESSED;
+        ret.encrypted = record.flags & PAK_ENTRY_ENCRYPTED;
+
+        if (!(record.flags & PAK_ENTRY_BLOCKS))
+            return ret;
+
+        ret.blockSize = record.blockSize;
+
+        if (record.storedSize < 8)
+            throw std::runtime_error("Invalid pak block table");
+
+        char tableSizeData[8];
+        read(record.offset, tableSizeData, sizeof(tableSizeData));
+        auto tableSize = readU64(tableSizeData);
+        if (tableSize > record.storedSize - 8)
+            throw std::runtime_error("Invalid pak block table");
+
+        std::vector<char> table(tableSize);
+        read(record.offset + 8, table.data(), table.size());
+
+        if (ret.encrypted) {
+            table = decode(std::move(table), false, true);
+        }
+
+        auto blockCount = (ret.size + ret.blockSize - 1) / ret.blockSize;
+        if (table.size() != blockCount * PAK_BLOCK_RECORD_SIZE)
+            throw std::runtime_error("Invalid pak block table");
+
+        auto dataOffset = 8 + tableSize;
+        auto dataSize = record.storedSize - dataOffset;
+
+        ret.blocks.reserve(blockCount);
+        for (size_t i = 0; i < blockCount; i++) {
+            auto *b = table.data() + i * PAK_BLOCK_RECORD_SIZE;
+            auto offset = readU64(b);
+            auto storedSize = readU64(b + 8);
+            if (offset > dataSize || storedSize > dataSize - offset)
+                throw std::runtime_error("Invalid pak block table");
+            ret.blocks.emplace_back(Block{record.offset + dataOffset + offset,
+                                          storedSize,
+                                          std::min<size_t>(ret.blockSize, ret.size - i * ret.blockSize),
+                                          std::string(b + 16, PAK_BLOCK_HASH_SIZE)});
+        }
+
+        return ret;
+    }
+
+    size_t Pak::getSourceCount() const {
+        return maps.empty() ? streams.size() : maps.size();
+    }
+
+    size_t Pak::getSourceSize(size_t sourceIndex) const {
+        if (!maps.empty())
+            return maps.at(sourceIndex)->size();
+        auto &stream = streams.at(sourceIndex).get();
+        stream.clear();
+        stream.seekg(0, std::ios::end);
+        return static_cast<size_t>(stream.tellg());
+    }
+
+    void Pak::read(size_t globalOffset, char *destination, size_t size) {
+        while (size > 0) {
+            size_t source = 0;
+            size_t relativeOffset = globalOffset;
+            size_t count = size;
+            if (chunkSize > 0) {
+                source = globalOffset / chunkSize;
+                relativeOffset = globalOffset % chunkSize;
+                count = std::min(size, chunkSize - relativeOffset);
+            }
+
+            if (source >= getSourceCount())
+                throw std::runtime_error("Failed to read pak data (Missing chunk)");
+
+            if (!maps.empty()) {
+                auto &map = *maps.at(source);
+                if (relativeOffset + count > map.size())
+                    throw std::runtime_error("Failed to read pak data (End of file)");
+                std::memcpy(destination, map.data() + relativeOffset, count);
+            } else {
+                auto &stream = streams.at(source).get();
+                stream.clear();
+                stream.seekg(static_cast<std::streamoff>(relativeOffset));
+                stream.read(destination, static_cast<std::streamsize>(count));
+                if (stream.gcount() != static_cast<std::streamsize>(count))
+                    throw std::runtime_error("Failed to read pak data (End of file)");
+            }
+
+            globalOffset += count;
+            destination += count;
+            size -= count;
+        }
     }
-}
\ No newline at end of file
+}
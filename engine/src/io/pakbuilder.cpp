@@ -18,16 +18,212 @@
 
 #include "xng/io/pakbuilder.hpp"
 
-#include "thirdparty/json.hpp"
-#include "thirdparty/base64.hpp"
+#include <deque>
+#include <fstream>
+
 #include "xng/crypto/gzip.hpp"
 #include "xng/crypto/sha.hpp"
 
+#include "io/pakformat.hpp"
+
 namespace xng {
+    using namespace pakformat;
+
+    /**
+     * Writes the pak data sequentially and splits it into chunks.
+     */
+    class PakBuilder::ChunkWriter {
+    public:
+        explicit ChunkWriter(size_t chunkSize)
+                : chunkSize(chunkSize) {}
+
+        virtual ~ChunkWriter() = default;
+
+        void write(const char *data, size_t size) {
+            forEachChunk(offset, size, [&](size_t chunk, size_t relativeOffset, size_t count) {
+                append(chunk, data, count);
+                data += count;
+            });
+            offset += size;
+        }
+
+        /**
+         * Overwrite previously written data, may only be called after finish.
+         */
+        void patch(size_t globalOffset, const char *data, size_t size) {
+            forEachChunk(globalOffset, size, [&](size_t chunk, size_t relativeOffset, size_t count) {
+                overwrite(chunk, relativeOffset, data, count);
+                data += count;
+            });
+        }
+
+        size_t getOffset() const {
+            return offset;
+        }
+
+        size_t getChunkSize() const {
+            return chunkSize;
+        }
+
+        virtual void finish() {}
+
+    protected:
+        virtual void append(size_t chunk, const char *data, size_t size) = 0;
+
+        virtual void overwrite(size_t chunk, size_t offset, const char *data, size_t size) = 0;
+
+    private:
+        template<typename T>
+        void forEachChunk(size_t globalOffset, size_t size, T &&callback) {
+            while (size > 0) {
+                size_t chunk = 0;
+                size_t relativeOffset = globalOffset;
+                size_t count = size;
+                if (chunkSize > 0) {
+                    chunk = globalOffset / chunkSize;
+                    relativeOffset = globalOffset % chunkSize;
+                    count = std::min(size, chunkSize - relativeOffset);
+                }
+                callback(chunk, relativeOffset, count);
+                globalOffset += count;
+                size -= count;
+            }
+        }
+
+        size_t chunkSize;
+        size_t offset = 0;
+    };
+
+    class PakBuilder::MemoryChunkWriter : public PakBuilder::ChunkWriter {
+    public:
+        explicit MemoryChunkWriter(size_t chunkSize)
+                : ChunkWriter(chunkSize) {}
+
+        std::vector<std::vector<char>> chunks;
+
+    protected:
+        void append(size_t chunk, const char *data, size_t size) override {
+            if (chunk >= chunks.size())
+                chunks.resize(chunk + 1);
+            chunks.at(chunk).insert(chunks.at(chunk).end(), data, data + size);
+        }
+
+        void overwrite(size_t chunk, size_t offset, const char *data, size_t size) override {
+            std::copy(data, data + size, chunks.at(chunk).begin() + static_cast<long>(offset));
+        }
+    };
+
+    class PakBuilder::FileChunkWriter : public PakBuilder::ChunkWriter {
+    public:
+        FileChunkWriter(std::filesystem::path path, size_t chunkSize)
+                : ChunkWriter(chunkSize), path(std::move(path)), chunked(chunkSize > 0) {}
+
+        void finish() override {
+            if (stream.is_open()) {
+                stream.close();
+                if (stream.fail())
+                    throw std::runtime_error("Failed to write pak chunk: " + paths.back().string());
+            }
+        }
+
+        std::vector<std::filesystem::path> paths;
+
+    protected:
+        void append(size_t chunk, const char *data, size_t size) override {
+            if (chunk >= paths.size()) {
+                finish();
+                paths.emplace_back(chunked ? std::filesystem::path(path.string() + "." + std::to_string(chunk)) : path);
+                stream.open(paths.back(), std::ios::out | std::ios::binary | std::ios::trunc);
+                if (!stream.is_open())
+                    throw std::runtime_error("Failed to open pak chunk: " + paths.back().string());
+            }
+            stream.write(data, static_cast<std::streamsize>(size));
+            if (stream.fail())
+                throw std::runtime_error("Failed to write pak chunk: " + paths.back().string());
+        }
+
+        void overwrite(size_t chunk, size_t offset, const char *data, size_t size) override {
+            std::fstream fs(paths.at(chunk), std::ios::in | std::ios::out | std::ios::binary);
+            fs.seekp(static_cast<std::streamoff>(offset));
+            fs.write(data, static_cast<std::streamsize>(size));
+            if (fs.fail())
+                throw std::runtime_error("Failed to write pak chunk: " + paths.at(chunk).string());
+        }
+
+    private:
+        std::filesystem::path path;
+        bool chunked;
+        std::ofstream stream;
+    };
+
+    namespace {
+        /**
+         * An entry which is being encoded by the thread pool.
+         */
+        struct PendingEntry {
+            std::string name;
+            std::shared_ptr<const std::vector<char>> data; // Null if the entry is read from file
+            std::filesystem::path file;
+            size_t size = 0;
+            bool blocked = false;
+            std::string hash;
+            std::vector<std::string> blockHashes;
+            std::vector<std::vector<char>> outputs; // The stored data of each block or of the whole entry
+            std::vector<std::shared_ptr<Task>> tasks;
+
+            void join() {
+                std::exception_ptr exception;
+                for (auto &task: tasks) {
+                    auto &ex = task->join();
+                    if (ex && !exception)
+                        exception = ex;
+                }
+                tasks.clear();
+                if (exception)
+                    std::rethrow_exception(exception);
+            }
+
+            /**
+             * Invoke callback with the entry data in the given range,
+             * file entries are read in pieces so that the whole file is never held in memory.
+             */
+            template<typename T>
+            void read(size_t offset, size_t count, T &&callback) const {
+                if (data) {
+                    callback(data->data() + offset, count);
+                    return;
+                }
+
+                std::ifstream fs(file, std::ios::in | std::ios::binary);
+                if (!fs.is_open())
+                    throw std::runtime_error("Failed to open pak entry file: " + file.string());
+                fs.seekg(static_cast<std::streamoff>(offset));
+
+                std::vector<char> buffer(std::min(count, FILE_READ_SIZE));
+                while (count > 0) {
+                    auto n = std::min(count, buffer.size());
+                    fs.read(buffer.data(), static_cast<std::streamsize>(n));
+                    if (fs.gcount() != static_cast<std::streamsize>(n))
+                        throw std::runtime_error("Failed to read pak entry file: " + file.string());
+                    callback(buffer.data(), n);
+                    count -= n;
+                }
+            }
+
+            static const size_t FILE_READ_SIZE = 1024 * 1024;
+        };
+    }
+
     void PakBuilder::addEntry(const std::string &name, const std::vector<char> &buffer) {
         if (entries.find(name) != entries.end())
             throw std::runtime_error("Entry with name " + name + " already exists");
-        entries[name] = buffer;
+        entries[name] = {std::make_shared<const std::vector<char>>(buffer), {}};
+    }
+
+    void PakBuilder::addEntry(const std::string &name, const std::filesystem::path &file) {
+        if (entries.find(name) != entries.end())
+            throw std::runtime_error("Entry with name " + name + " already exists");
+        entries[name] = {nullptr, file};
     }
 
     std::vector<std::vector<char>> PakBuilder::build(size_t chunkSize,
@@ -37,90 +233,245 @@ namespace xng {
                                                      GZip &zip,
                                                      AES &aes,
                                                      const AES::Key &key,
-                                                     const AES::InitializationVector &iv) {
-        std::vector<char> data;
-        size_t currentOffset = 0;
+                                                     const AES::InitializationVector &iv,
+                                                     size_t blockSize) {
+        MemoryChunkWriter writer(chunkSize);
+        build(writer, compressData, encryptData, sha, zip, aes, key, iv, blockSize);
+        if (writer.chunks.empty())
+            writer.chunks.emplace_back();
+        return std::move(writer.chunks);
+    }
+
+    std::vector<std::filesystem::path> PakBuilder::build(const std::filesystem::path &path,
+                                                         size_t chunkSize,
+                                                         bool compressData,
+                                                         bool encryptData,
+                                                         SHA &sha,
+                                                         GZip &zip,
+                                                         AES &aes,
+                                                         const AES::Key &key,
+                                                         const AES::InitializationVector &iv,
+                                                         size_t blockSize) {
+        FileChunkWriter writer(path, chunkSize);
+        build(writer, compressData, encryptData, sha, zip, aes, key, iv, blockSize);
+        return writer.paths;
+    }
+
+    void PakBuilder::build(ChunkWriter &writer,
+                           bool compressData,
+                           bool encryptData,
+                           SHA &sha,
+                           GZip &zip,
+                           AES &aes,
+                           const AES::Key &key,
+                           const AES::InitializationVector &iv,
+                           size_t blockSize) {
+        if (writer.getChunkSize() > 0 && writer.getChunkSize() < PAK_HEADER_SIZE)
+            throw std::runtime_error("Chunk size must be zero or at least " + std::to_string(PAK_HEADER_SIZE) + " bytes");
+
+        if (blockSize > UINT32_MAX)
+            throw std::runtime_error("Block size too large");
 
-        std::map<std::string, Pak::HeaderEntry> headerEntries;
-        for (auto &pair: entries) {
-            auto d = pair.second;
+        uint32_t entryFlags = 0;
+        if (compressData)
+            entryFlags |= PAK_ENTRY_COMPRESSED;
+        if (encryptData)
+            entryFlags |= PAK_ENTRY_ENCRYPTED;
 
+        auto encode = [&zip, &aes, &key, &iv, compressData, encryptData](const char *data, size_t size) {
+            std::vector<char> ret;
             if (compressData) {
-                d = zip.compress(d);
+                ret = zip.compress(data, size);
+            } else {
+                ret.assign(data, data + size);
             }
 
             if (encryptData) {
-                d = aes.encrypt(key, iv, d);
+                ret = aes.encrypt(key, iv, ret);
             }
 
-            headerEntries[pair.first].offset = currentOffset;
-            headerEntries[pair.first].size = d.size();
-            headerEntries[pair.first].hash = sha.sha256(pair.second);
+            return ret;
+        };
 
-            currentOffset += d.size();
+        // The header is written once the index offset is known.
+        std::vector<char> placeholder(PAK_HEADER_SIZE);
+        writer.write(placeholder.data(), placeholder.size());
 
-            data.insert(data.end(), d.begin(), d.end());
-        }
+        std::vector<Record> records;
+        records.reserve(entries.size());
 
-        nlohmann::json headerJson;
-        headerJson["chunkSize"] = chunkSize;
-        headerJson["compressed"] = compressData;
-        for (auto &pair: headerEntries) {
-            auto &element = headerJson["entries"][pair.first];
-            element["offset"] = pair.second.offset;
-            element["size"] = pair.second.size;
-            element["hash"] = pair.second.hash;
-        }
+        std::deque<std::unique_ptr<PendingEntry>> pending;
+        size_t pendingBytes = 0;
 
-        auto headerStr = headerJson.dump();
+        // Write the oldest pending entry once its tasks have completed.
+        auto writeEntry = [&]() {
+            auto &entry = *pending.front();
+            entry.join();
 
-        if (encryptData) {
-            headerStr = aes.encrypt(key, iv, headerStr);
-        }
+            Record record;
+            record.path = entry.name;
+            record.hash = entry.hash;
+            record.offset = writer.getOffset();
+            record.uncompressedSize = entry.size;
+            record.flags = entryFlags;
 
-        nlohmann::json outHeaderJson;
-        if (encryptData) {
-            outHeaderJson["iv"] = std::string(iv.begin(), iv.end());
-            outHeaderJson["edata"] = headerStr;
-        } else {
-            outHeaderJson = headerJson;
-        }
+            if (entry.blocked) {
+                record.flags |= PAK_ENTRY_BLOCKS;
+                record.blockSize = static_cast<uint32_t>(blockSize);
+
+                std::vector<char> table(entry.outputs.size() * PAK_BLOCK_RECORD_SIZE);
+                size_t blockOffset = 0;
+                for (size_t i = 0; i < entry.outputs.size(); i++) {
+                    auto &hash = entry.blockHashes.at(i);
+                    if (hash.size() != PAK_BLOCK_HASH_SIZE)
+                        throw std::runtime_error("Unexpected sha256 hash size");
 
-        auto outHeader = nlohmann::json::to_bson(outHeaderJson);
+                    auto *dst = table.data() + i * PAK_BLOCK_RECORD_SIZE;
+                    writeU64(dst, blockOffset);
+                    writeU64(dst + 8, entry.outputs.at(i).size());
+                    std::copy(hash.begin(), hash.end(), dst + 16);
+                    blockOffset += entry.outputs.at(i).size();
+                }
 
-        auto outHeaderStr = std::string(outHeader.begin(), outHeader.end());
+                if (encryptData) {
+                    table = aes.encrypt(key, iv, table);
+                }
 
-        auto hdr = PAK_HEADER_MAGIC + "\xa7" + std::to_string(outHeaderStr.size()) + "\xa7" + outHeaderStr;
+                char tableSize[8];
+                writeU64(tableSize, table.size());
 
-        if (chunkSize > 0) {
-            auto totalSize = hdr.size() + data.size();
-            auto totalWholeChunks = totalSize / chunkSize;
-            auto totalRemainder = totalSize % chunkSize;
+                writer.write(tableSize, sizeof(tableSize));
+                writer.write(table.data(), table.size());
+                for (auto &output: entry.outputs) {
+                    writer.write(output.data(), output.size());
+                }
+            } else if (compressData || encryptData) {
+                writer.write(entry.outputs.at(0).data(), entry.outputs.at(0).size());
+            } else {
+                entry.read(0, entry.size, [&](const char *data, size_t count) {
+                    writer.write(data, count);
+                });
+            }
+
+            record.storedSize = writer.getOffset() - record.offset;
+            records.emplace_back(std::move(record));
+
+            pendingBytes -= entry.size;
+            pending.pop_front();
+        };
+
+        try {
+            for (auto &pair: entries) {
+                size_t size = pair.second.buffer ? pair.second.buffer->size() : std::filesystem::file_size(pair.second.file);
+                while (!pending.empty() && pendingBytes + size > maxPendingBytes) {
+                    writeEntry();
+                }
 
-            auto totalChunks = totalWholeChunks;
-            if (totalRemainder != 0)
-                totalChunks += 1;
+                auto entry = std::make_unique<PendingEntry>();
+                entry->name = pair.first;
+                entry->data = pair.second.buffer;
+                entry->file = pair.second.file;
+                entry->size = size;
+                entry->blocked = (compressData || encryptData) && blockSize > 0 && size > blockSize;
 
-            std::vector<std::vector<char>> ret(totalChunks);
+                auto *e = entry.get();
 
-            size_t chunkIndex = 0;
-            for (auto i = 0; i < totalSize; i++) {
-                auto &chunk = ret.at(chunkIndex);
+                e->tasks.emplace_back(pool->addTask([e, &sha]() {
+                    if (e->data) {
+                        e->hash = sha.sha256(*e->data);
+                    } else {
+                        auto hasher = sha.createSha256();
+                        e->read(0, e->size, [&](const char *data, size_t count) {
+                            hasher->update(data, count);
+                        });
+                        e->hash = hasher->finish();
+                    }
+                }));
 
-                if (i < hdr.size()) {
-                    chunk.emplace_back(hdr.at(i));
-                } else {
-                    chunk.emplace_back(data.at(i - hdr.size()));
+                if (e->blocked) {
+                    auto blockCount = (size + blockSize - 1) / blockSize;
+                    e->outputs.resize(blockCount);
+                    e->blockHashes.resize(blockCount);
+                    for (size_t i = 0; i < blockCount; i++) {
+                        auto offset = i * blockSize;
+                        auto count = std::min(blockSize, size - offset);
+                        e->tasks.emplace_back(pool->addTask([e, &sha, &encode, i, offset, count]() {
+                            std::vector<char> block;
+                            const char *begin;
+                            if (e->data) {
+                                begin = e->data->data() + offset;
+                            } else {
+                                block.reserve(count);
+                                e->read(offset, count, [&](const char *data, size_t n) {
+                                    block.insert(block.end(), data, data + n);
+                                });
+                                begin = block.data();
+                            }
+                            e->blockHashes.at(i) = sha.sha256(begin, count);
+                            e->outputs.at(i) = encode(begin, count);
+                        }));
+                    }
+                } else if (compressData || encryptData) {
+                    e->outputs.resize(1);
+                    e->tasks.emplace_back(pool->addTask([e, &zip, &aes, &key, &iv, &encode, compressData, encryptData]() {
+                        if (e->data) {
+                            e->outputs.at(0) = encode(e->data->data(), e->data->size());
+                        } else if (compressData) {
+                            auto compressor = zip.createCompressor();
+                            std::vector<char> output;
+                            e->read(0, e->size, [&](const char *data, size_t count) {
+                                compressor->update(data, count, output);
+                            });
+                            compressor->finish(output);
+                            if (encryptData) {
+                                output = aes.encrypt(key, iv, output);
+                            }
+                            e->outputs.at(0) = std::move(output);
+                        } else {
+                            std::vector<char> input;
+                            input.reserve(e->size);
+                            e->read(0, e->size, [&](const char *data, size_t count) {
+                                input.insert(input.end(), data, data + count);
+                            });
+                            e->outputs.at(0) = encode(input.data(), input.size());
+                        }
+                    }));
                 }
 
-                if (chunk.size() == chunkSize)
-                    chunkIndex++;
+                pendingBytes += size;
+                pending.emplace_back(std::move(entry));
             }
 
-            return ret;
-        } else {
-            data.insert(data.begin(), hdr.begin(), hdr.end());
-            return {data};
+            while (!pending.empty()) {
+                writeEntry();
+            }
+        } catch (...) {
+            // The tasks reference the pending entries
+            for (auto &entry: pending) {
+                for (auto &task: entry->tasks) {
+                    task->join();
+                }
+            }
+            throw;
+        }
+
+        auto index = writeIndex(records);
+        if (encryptData) {
+            index = aes.encrypt(key, iv, index);
         }
+
+        Header header;
+        header.flags = (compressData ? PAK_FLAG_COMPRESSED : 0) | (encryptData ? PAK_FLAG_ENCRYPTED : 0);
+        header.chunkSize = writer.getChunkSize();
+        header.indexOffset = writer.getOffset();
+        header.indexSize = index.size();
+        header.entryCount = records.size();
+        header.iv = iv;
+
+        writer.write(index.data(), index.size());
+        writer.finish();
+
+        auto hdr = writeHeader(PAK_HEADER_MAGIC, header);
+        writer.patch(0, hdr.data(), hdr.size());
     }
-}
\ No newline at end of file
+}
@@ -0,0 +1,366 @@
+/**
+ *   xEngine - C++ Game Engine Library
+ *   Copyright (C) 2026 Julia Zampiccoli
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU Lesser General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   Lesser General Public License for more details.
+ *
+ *   You should have received a copy of the Lesser General Public License
+ *   along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef XENGINE_PAKFORMAT_HPP
+#define XENGINE_PAKFORMAT_HPP
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <stdexcept>
+#include <algorithm>
+
+#include "xng/crypto/aes.hpp"
+
+/**
+ * Binary layout of the version 2 pak format. All integers are little endian.
+ *
+ * [Header][Entry data][Index]
+ *
+ * Header (PAK_HEADER_SIZE bytes)
+ *      char[8]     magic
+ *      uint32      flags (PAK_FLAG_*)
+ *      uint32      headerSize
+ *      uint64      chunkSize
+ *      uint64      indexOffset (global)
+ *      uint64      indexSize (stored, encrypted if PAK_FLAG_ENCRYPTED is set)
+ *      uint64      entryCount
+ *      char[128]   iv
+ *
+ * Index
+ *      uint64      recordCount
+ *      uint64      bucketCount (power of two or zero)
+ *      Record[recordCount] sorted by path
+ *      uint32[bucketCount] record index by path hash, linear probing, PAK_INDEX_EMPTY_BUCKET marks empty buckets
+ *      char[]      string table containing the paths and hashes
+ *
+ * Record (PAK_RECORD_SIZE bytes)
+ *      uint64      pathHash (FNV-1a)
+ *      uint64      offset (global)
+ *      uint64      storedSize
+ *      uint64      uncompressedSize
+ *      uint32      pathOffset (into the string table)
+ *      uint32      pathLength
+ *      uint32      hashOffset (into the string table)
+ *      uint32      hashLength
+ *      uint32      flags (PAK_ENTRY_*)
+ *      uint32      blockSize (uncompressed bytes per block if PAK_ENTRY_BLOCKS is set)
+ *
+ * Entry data with PAK_ENTRY_BLOCKS set
+ *      uint64      tableSize (stored, encrypted if PAK_ENTRY_ENCRYPTED is set)
+ *      Block[]     ceil(uncompressedSize / blockSize) blocks
+ *      char[]      block data, each block compressed and encrypted independently according to the entry flags
+ *
+ * Block (PAK_BLOCK_RECORD_SIZE bytes)
+ *      uint64      offset (relative to the start of the block data)
+ *      uint64      storedSize
+ *      char[64]    hash (hex sha256 of the uncompressed block)
+ */
+namespace xng::pakformat {
+    static const size_t PAK_MAGIC_SIZE = 8;
+    static const size_t PAK_HEADER_SIZE = 48 + AES::BLOCKSIZE;
+    static const size_t PAK_INDEX_PREFIX_SIZE = 16;
+    static const size_t PAK_RECORD_SIZE = 56;
+    static const uint32_t PAK_INDEX_EMPTY_BUCKET = 0xFFFFFFFF;
+    static const size_t PAK_BLOCK_RECORD_SIZE = 80;
+    static const size_t PAK_BLOCK_HASH_SIZE = 64;
+
+    static const uint32_t PAK_FLAG_COMPRESSED = 1;
+    static const uint32_t PAK_FLAG_ENCRYPTED = 2;
+
+    static const uint32_t PAK_ENTRY_COMPRESSED = 1;
+    static const uint32_t PAK_ENTRY_ENCRYPTED = 2;
+    static const uint32_t PAK_ENTRY_BLOCKS = 4;
+
+    struct Header {
+        uint32_t flags{};
+        uint64_t chunkSize{};
+        uint64_t indexOffset{};
+        uint64_t indexSize{};
+        uint64_t entryCount{};
+        AES::InitializationVector iv{};
+    };
+
+    struct Record {
+        std::string path;
+        std::string hash;
+        uint64_t offset{};
+        uint64_t storedSize{};
+        uint64_t uncompressedSize{};
+        uint32_t flags{};
+        uint32_t blockSize{};
+    };
+
+    /**
+     * A record decoded from an index buffer, the strings point into the index.
+     */
+    struct RecordView {
+        const char *path;
+        size_t pathLength;
+        const char *hash;
+        size_t hashLength;
+        uint64_t offset;
+        uint64_t storedSize;
+        uint64_t uncompressedSize;
+        uint32_t flags;
+        uint32_t blockSize;
+    };
+
+    inline uint64_t hashPath(const char *data, size_t length) {
+        uint64_t hash = 14695981039346656037ull;
+        for (size_t i = 0; i < length; i++) {
+            hash ^= static_cast<unsigned char>(data[i]);
+            hash *= 1099511628211ull;
+        }
+        return hash;
+    }
+
+    inline void writeU32(char *dst, uint32_t value) {
+        for (int i = 0; i < 4; i++) {
+            dst[i] = static_cast<char>((value >> (i * 8)) & 0xFF);
+        }
+    }
+
+    inline void writeU64(char *dst, uint64_t value) {
+        for (int i = 0; i < 8; i++) {
+            dst[i] = static_cast<char>((value >> (i * 8)) & 0xFF);
+        }
+    }
+
+    inline uint32_t readU32(const char *src) {
+        uint32_t ret = 0;
+        for (int i = 0; i < 4; i++) {
+            ret |= static_cast<uint32_t>(static_cast<unsigned char>(src[i])) << (i * 8);
+        }
+        return ret;
+    }
+
+    inline uint64_t readU64(const char *src) {
+        uint64_t ret = 0;
+        for (int i = 0; i < 8; i++) {
+            ret |= static_cast<uint64_t>(static_cast<unsigned char>(src[i])) << (i * 8);
+        }
+        return ret;
+    }
+
+    inline std::vector<char> writeHeader(const std::string &magic, const Header &header) {
+        if (magic.size() != PAK_MAGIC_SIZE)
+            throw std::runtime_error("Invalid pak magic size");
+        std::vector<char> ret(PAK_HEADER_SIZE);
+        std::copy(magic.begin(), magic.end(), ret.begin());
+        writeU32(ret.data() + 8, header.flags);
+        writeU32(ret.data() + 12, static_cast<uint32_t>(PAK_HEADER_SIZE));
+        writeU64(ret.data() + 16, header.chunkSize);
+        writeU64(ret.data() + 24, header.indexOffset);
+        writeU64(ret.data() + 32, header.indexSize);
+        writeU64(ret.data() + 40, header.entryCount);
+        for (size_t i = 0; i < header.iv.size(); i++) {
+            ret.at(48 + i) = static_cast<char>(header.iv.at(i));
+        }
+        return ret;
+    }
+
+    /**
+     * @param data The PAK_HEADER_SIZE bytes of the header including the magic.
+     */
+    inline Header readHeader(const char *data) {
+        if (readU32(data + 12) != PAK_HEADER_SIZE)
+            throw std::runtime_error("Invalid pak header size");
+        Header ret;
+        ret.flags = readU32(data + 8);
+        ret.chunkSize = readU64(data + 16);
+        ret.indexOffset = readU64(data + 24);
+        ret.indexSize = readU64(data + 32);
+        ret.entryCount = readU64(data + 40);
+        for (size_t i = 0; i < ret.iv.size(); i++) {
+            ret.iv.at(i) = static_cast<unsigned char>(data[48 + i]);
+        }
+        return ret;
+    }
+
+    /**
+     * Serialize the records into an index.
+     *
+     * @param records The records sorted by path
+     */
+    inline std::vector<char> writeIndex(const std::vector<Record> &records) {
+        if (records.size() >= PAK_INDEX_EMPTY_BUCKET)
+            throw std::runtime_error("Too many pak entries");
+
+        uint64_t bucketCount = 0;
+        if (!records.empty()) {
+            bucketCount = 1;
+            while (bucketCount < records.size() * 2)
+                bucketCount *= 2;
+        }
+
+        size_t stringsSize = 0;
+        for (auto &record: records) {
+            stringsSize += record.path.size() + record.hash.size();
+        }
+
+        auto recordsOffset = PAK_INDEX_PREFIX_SIZE;
+        auto bucketsOffset = recordsOffset + records.size() * PAK_RECORD_SIZE;
+        auto stringsOffset = bucketsOffset + bucketCount * 4;
+
+        if (stringsSize > UINT32_MAX)
+            throw std::runtime_error("Pak string table too large");
+
+        std::vector<char> ret(stringsOffset + stringsSize);
+        writeU64(ret.data(), records.size());
+        writeU64(ret.data() + 8, bucketCount);
+
+        for (uint64_t i = 0; i < bucketCount; i++) {
+            writeU32(ret.data() + bucketsOffset + i * 4, PAK_INDEX_EMPTY_BUCKET);
+        }
+
+        uint32_t stringOffset = 0;
+        for (size_t i = 0; i < records.size(); i++) {
+            auto &record = records.at(i);
+            auto *dst = ret.data() + recordsOffset + i * PAK_RECORD_SIZE;
+
+            auto pathHash = hashPath(record.path.data(), record.path.size());
+
+            writeU64(dst, pathHash);
+            writeU64(dst + 8, record.offset);
+            writeU64(dst + 16, record.storedSize);
+            writeU64(dst + 24, record.uncompressedSize);
+            writeU32(dst + 32, stringOffset);
+            writeU32(dst + 36, static_cast<uint32_t>(record.path.size()));
+            std::copy(record.path.begin(), record.path.end(), ret.begin() + static_cast<long>(stringsOffset + stringOffset));
+            stringOffset += static_cast<uint32_t>(record.path.size());
+            writeU32(dst + 40, stringOffset);
+            writeU32(dst + 44, static_cast<uint32_t>(record.hash.size()));
+            std::copy(record.hash.begin(), record.hash.end(), ret.begin() + static_cast<long>(stringsOffset + stringOffset));
+            stringOffset += static_cast<uint32_t>(record.hash.size());
+            writeU32(dst + 48, record.flags);
+            writeU32(dst + 52, record.blockSize);
+
+            auto bucket = pathHash & (bucketCount - 1);
+            while (readU32(ret.data() + bucketsOffset + bucket * 4) != PAK_INDEX_EMPTY_BUCKET) {
+                bucket = (bucket + 1) & (bucketCount - 1);
+            }
+            writeU32(ret.data() + bucketsOffset + bucket * 4, static_cast<uint32_t>(i));
+        }
+
+        return ret;
+    }
+
+    /**
+     * A read only accessor for a serialized index.
+     */
+    class IndexReader {
+    public:
+        IndexReader() = default;
+
+        IndexReader(const char *data, size_t size)
+                : data(data), size(size) {
+            if (size < PAK_INDEX_PREFIX_SIZE)
+                throw std::runtime_error("Invalid pak index");
+
+            recordCount = readU64(data);
+            bucketCount = readU64(data + 8);
+            bucketsOffset = PAK_INDEX_PREFIX_SIZE + recordCount * PAK_RECORD_SIZE;
+            stringsOffset = bucketsOffset + bucketCount * 4;
+        }
+
+        /**
+         * Check the index layout and all record bounds, must be called once before accessing an untrusted index.
+         */
+        void validate() const {
+            if (recordCount >= PAK_INDEX_EMPTY_BUCKET
+                || bucketCount > size
+                || (bucketCount & (bucketCount - 1)) != 0
+                || (recordCount > 0 && bucketCount < recordCount)) {
+                throw std::runtime_error("Invalid pak index");
+            }
+
+            if (stringsOffset > size)
+                throw std::runtime_error("Invalid pak index");
+
+            auto stringsSize = size - stringsOffset;
+            for (uint64_t i = 0; i < recordCount; i++) {
+                auto *r = data + PAK_INDEX_PREFIX_SIZE + i * PAK_RECORD_SIZE;
+                if (static_cast<uint64_t>(readU32(r + 32)) + readU32(r + 36) > stringsSize
+                    || static_cast<uint64_t>(readU32(r + 40)) + readU32(r + 44) > stringsSize
+                    || ((readU32(r + 48) & PAK_ENTRY_BLOCKS) && readU32(r + 52) == 0)) {
+                    throw std::runtime_error("Invalid pak index record");
+                }
+            }
+            for (uint64_t i = 0; i < bucketCount; i++) {
+                auto v = readU32(data + bucketsOffset + i * 4);
+                if (v != PAK_INDEX_EMPTY_BUCKET && v >= recordCount)
+                    throw std::runtime_error("Invalid pak index bucket");
+            }
+        }
+
+        size_t getRecordCount() const {
+            return recordCount;
+        }
+
+        RecordView getRecord(size_t index) const {
+            auto *r = data + PAK_INDEX_PREFIX_SIZE + index * PAK_RECORD_SIZE;
+            auto *strings = data + stringsOffset;
+            return {
+                    strings + readU32(r + 32),
+                    readU32(r + 36),
+                    strings + readU32(r + 40),
+                    readU32(r + 44),
+                    readU64(r + 8),
+                    readU64(r + 16),
+                    readU64(r + 24),
+                    readU32(r + 48),
+                    readU32(r + 52)
+            };
+        }
+
+        /**
+         * @return The index of the record with the given path or -1 if not found.
+         */
+        long find(const std::string &path) const {
+            if (bucketCount == 0)
+                return -1;
+            auto pathHash = hashPath(path.data(), path.size());
+            auto bucket = pathHash & (bucketCount - 1);
+            for (uint64_t probe = 0; probe < bucketCount; probe++) {
+                auto v = readU32(data + bucketsOffset + bucket * 4);
+                if (v == PAK_INDEX_EMPTY_BUCKET)
+                    return -1;
+                auto *r = data + PAK_INDEX_PREFIX_SIZE + v * PAK_RECORD_SIZE;
+                if (readU64(r) == pathHash
+                    && readU32(r + 36) == path.size()
+                    && path.compare(0, path.size(), data + stringsOffset + readU32(r + 32), path.size()) == 0) {
+                    return static_cast<long>(v);
+                }
+                bucket = (bucket + 1) & (bucketCount - 1);
+            }
+            return -1;
+        }
+
+    private:
+        const char *data = nullptr;
+        size_t size = 0;
+        uint64_t recordCount = 0;
+        uint64_t bucketCount = 0;
+        size_t bucketsOffset = 0;
+        size_t stringsOffset = 0;
+    };
+}
+
+#endif //XENGINE_PAKFORMAT_HPP
@@ -0,0 +1,187 @@
+/**
+ *   xEngine - C++ Game Engine Library
+ *   Copyright (C) 2026 Julia Zampiccoli
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU Lesser General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   Lesser General Public License for more details.
+ *
+ *   You should have received a copy of the Lesser General Public License
+ *   along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include "xng/renderer/pipeline/drawculler.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+namespace xng {
+    void DrawCuller::setCamera(const Vec3f &position, const Mat4f &view, const Mat4f &projection) {
+        cameraPosition = position;
+
+        // Gribb / Hartmann plane extraction, the planes are rows of the view projection matrix
+        // added to / subtracted from the w row. With a [0, 1] depth range the near plane is conservative.
+        const auto viewProjection = projection * view;
+        for (int i = 0; i < 6; i++) {
+            const auto row = i / 2;
+            const auto sign = i % 2 == 0 ? 1.0f : -1.0f;
+            const auto x = viewProjection.get(0, 3) + sign * viewProjection.get(0, row);
+            const auto y = viewProjection.get(1, 3) + sign * viewProjection.get(1, row);
+            const auto z = viewProjection.get(2, 3) + sign * viewProjection.get(2, row);
+            const auto w = viewProjection.get(3, 3) + sign * viewProjection.get(3, row);
+            const auto length = std::sqrt(x * x + y * y + z * z);
+            const auto scale = length > 0 ? 1.0f / length : 0.0f;
+            planeX[i] = x * scale;
+            planeY[i] = y * scale;
+            planeZ[i] = z * scale;
+            planeW[i] = w * scale;
+        }
+    }
+
+    void DrawCuller::clear() {
+        centerX.clear();
+        centerY.clear();
+        centerZ.clear();
+        extentX.clear();
+        extentY.clear();
+        extentZ.clear();
+    }
+
+    void DrawCuller::reserve(const size_t count) {
+        centerX.reserve(count);
+        centerY.reserve(count);
+        centerZ.reserve(count);
+        extentX.reserve(count);
+        extentY.reserve(count);
+        extentZ.reserve(count);
+    }
+
+    void DrawCuller::add(const Vec3f &boundsMin, const Vec3f &boundsMax, const Mat4f &model) {
+        const float center[3] = {
+            (boundsMin.x + boundsMax.x) * 0.5f,
+            (boundsMin.y + boundsMax.y) * 0.5f,
+            (boundsMin.z + boundsMax.z) * 0.5f
+        };
+        const float extent[3] = {
+            (boundsMax.x - boundsMin.x) * 0.5f,
+            (boundsMax.y - boundsMin.y) * 0.5f,
+            (boundsMax.z - boundsMin.z) * 0.5f
+        };
+
+        // The world space box enclosing the transformed box (Arvo)
+        float worldCenter[3];
+        float worldExtent[3];
+        for (int row = 0; row < 3; row++) {
+            worldCenter[row] = model.get(3, row);
+            worldExtent[row] = 0;
+            for (int col = 0; col < 3; col++) {
+                worldCenter[row] += model.get(col, row) * center[col];
+                worldExtent[row] += std::abs(model.get(col, row)) * extent[col];
+            }
+        }
+
+        centerX.emplace_back(worldCenter[0]);
+        centerY.emplace_back(worldCenter[1]);
+        centerZ.emplace_back(worldCenter[2]);
+        extentX.emplace_back(worldExtent[0]);
+        extentY.emplace_back(worldExtent[1]);
+        extentZ.emplace_back(worldExtent[2]);
+    }
+
+    void DrawCuller::addUnbounded(const Mat4f &model) {
+        // The plane distance of an infinite extent is infinite for any plane so the draw is never culled.
+        centerX.emplace_back(model.get(3, 0));
+        centerY.emplace_back(model.get(3, 1));
+        centerZ.emplace_back(model.get(3, 2));
+        extentX.emplace_back(std::numeric_limits<float>::max());
+        extentY.emplace_back(std::numeric_limits<float>::max());
+        extentZ.emplace_back(std::numeric_limits<float>::max());
+    }
+
+    DrawCuller::Statistics DrawCuller::cull(std::vector<unsigned int> &visible) {
+        const auto count = size();
+
+        visible.clear();
+        visible.reserve(count);
+
+        if (enableCulling) {
+            inside.resize(count);
+
+            const auto *cx = centerX.data();
+            const auto *cy = centerY.data();
+            const auto *cz = centerZ.data();
+            const auto *ex = extentX.data();
+            const auto *ey = extentY.data();
+            const auto *ez = extentZ.data();
+            auto *result = inside.data();
+
+            float absX[6];
+            float absY[6];
+            float absZ[6];
+            for (int p = 0; p < 6; p++) {
+                absX[p] = std::abs(planeX[p]);
+                absY[p] = std::abs(planeY[p]);
+                absZ[p] = std::abs(planeZ[p]);
+            }
+
+            // A box is outside if it is completely behind any plane.
+            // The loop is branch free so the compiler can vectorize it over the draws.
+            for (size_t i = 0; i < count; i++) {
+                float distance = std::numeric_limits<float>::max();
+                for (int p = 0; p < 6; p++) {
+                    const auto d = planeX[p] * cx[i] + planeY[p] * cy[i] + planeZ[p] * cz[i] + planeW[p]
+                                   + absX[p] * ex[i] + absY[p] * ey[i] + absZ[p] * ez[i];
+                    distance = std::min(distance, d);
+                }
+                result[i] = distance >= 0 ? 1 : 0;
+            }
+
+            for (size_t i = 0; i < count; i++) {
+                if (result[i]) {
+                    visible.emplace_back(static_cast<unsigned int>(i));
+                }
+            }
+        } else {
+            for (size_t i = 0; i < count; i++) {
+                visible.emplace_back(static_cast<unsigned int>(i));
+            }
+        }
+
+        if (sortOrder != SORT_NONE) {
+            // The bits of non-negative floats order like the floats, so the distance and index are packed
+            // into a single integer key which sorts faster than a comparator on pairs.
+            // Ties are ordered by index which keeps the submission order of draws at equal distance.
+            const uint32_t flip = sortOrder == SORT_FRONT_TO_BACK ? 0 : 0xFFFFFFFFu;
+            sortKeys.clear();
+            sortKeys.reserve(visible.size());
+            for (auto index: visible) {
+                const auto x = centerX[index] - cameraPosition.x;
+                const auto y = centerY[index] - cameraPosition.y;
+                const auto z = centerZ[index] - cameraPosition.z;
+                const auto distance = x * x + y * y + z * z;
+                uint32_t bits;
+                std::memcpy(&bits, &distance, sizeof(bits));
+                sortKeys.emplace_back(static_cast<uint64_t>(bits ^ flip) << 32 | index);
+            }
+            std::sort(sortKeys.begin(), sortKeys.end());
+            for (size_t i = 0; i < sortKeys.size(); i++) {
+                visible[i] = static_cast<unsigned int>(sortKeys[i] & 0xFFFFFFFFu);
+            }
+        }
+
+        Statistics ret;
+        ret.draws = count;
+        ret.submitted = visible.size();
+        ret.culled = count - visible.size();
+        return ret;
+    }
+}
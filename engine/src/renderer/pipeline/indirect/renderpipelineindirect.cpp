@@ -96,14 +96,22 @@ namespace xng {
                                                  sizeof(RenderPipelineCompilerIndirect::ShaderCamera::CPU),
                                                  0);
         cameraBuffer.flush(cameraBufferHandle);
+
+        culler.setCamera(position, view, projection);
+    }
+
+    void RenderPipelineIndirect::setEnableDistanceSort(const bool enable) {
+        enableDistanceSort = enable;
+        culler.setSortOrder(enableDistanceSort ? distanceSortOrder : DrawCuller::SORT_NONE);
     }
 
-    void RenderPipelineIndirect::setEnableDistanceSort(bool enable) {
-        //TODO: Distance sort
+    void RenderPipelineIndirect::setDistanceSortOrder(const DrawCuller::SortOrder order) {
+        distanceSortOrder = order;
+        culler.setSortOrder(enableDistanceSort ? distanceSortOrder : DrawCuller::SORT_NONE);
     }
 
-    void RenderPipelineIndirect::setEnableDrawCulling(bool enable) {
-        // TODO: Volume Culling (Meshlets)
+    void RenderPipelineIndirect::setEnableDrawCulling(const bool enable) {
+        culler.setEnableCulling(enable);
     }
 
     void RenderPipelineIndirect::commit(RenderQueue &queue) {
@@ -127,12 +135,24 @@ namespace xng {
             pendingDrawCalls.erase(id);
         }
 
+        // Mesh compaction changed the offsets of allocations referenced by the loaded draw call data.
+        if (meshRevision != meshStreamer.getRevision()) {
+            meshRevision = meshStreamer.getRevision();
+            for (auto &pair: drawLists) {
+                for (auto &id: pair.second.drawCalls) {
+                    drawCalls.at(id).loadData();
+                }
+                pair.second.updateDrawCallBuffer = true;
+            }
+        }
+
         // Commit draw lists
         cameraBuffer.commit(queue);
         transformStreamer.commit(queue);
         materialStreamer.commit(queue);
+        drawStatistics = {};
         for (auto &pair: drawLists) {
-            pair.second.commit(queue, heap, drawCalls);
+            drawStatistics += pair.second.commit(queue, heap, drawCalls, culler);
         }
     }
 
@@ -377,7 +397,7 @@ namespace xng {
                 }
 
                 for (const auto &pair: drawLists) {
-                    if (pair.second.drawCalls.empty()) {
+                    if (pair.second.drawCallCount == 0) {
                         continue;
                     }
                     cmd.bindStorageBuffer(RenderPipelineCompilerIndirect::drawMeshBufferName,
@@ -389,7 +409,7 @@ namespace xng {
                                                       pair.second.indirectCountBuffer,
                                                       0,
                                                       0,
-                                                      pair.second.getDrawCallCount(drawCalls),
+                                                      pair.second.drawCallCount,
                                                       sizeof(ShaderScript::ShaderDrawIndirectIndexed::CPU));
                 }
 
@@ -406,19 +426,81 @@ namespace xng {
         indirectCountBuffer = resourceHeap.allocateBuffer(desc);
     }
 
-    void RenderPipelineIndirect::DrawList::commit(RenderQueue &queue,
-                                                  rg::Heap &resourceHeap,
-                                                  const std::unordered_map<DrawID, DrawCall> &callMap) {
-        if (!updateDrawCallBuffer) {
-            return;
+    DrawCuller::Statistics RenderPipelineIndirect::DrawList::commit(RenderQueue &queue,
+                                                                    rg::Heap &resourceHeap,
+                                                                    const std::unordered_map<DrawID, DrawCall> &callMap,
+                                                                    DrawCuller &culler) {
+        const auto membersChanged = updateDrawCallBuffer;
+        if (updateDrawCallBuffer) {
+            updateMembers(resourceHeap, callMap);
+        } else if (!culler.isEnabled()) {
+            DrawCuller::Statistics ret;
+            ret.draws = drawCallCount;
+            ret.submitted = drawCallCount;
+            return ret;
         }
 
         updateDrawCallBuffer = false;
 
+        // Cull and sort the draw calls, the transforms can change every frame so the culling runs every commit.
+        DrawCuller::Statistics ret;
+        const ShaderDrawCall::CPU *data = drawCallData.data();
+        size_t count = drawCallData.size();
+        if (culler.isEnabled()) {
+            culler.clear();
+            culler.reserve(drawCallData.size());
+            for (size_t i = 0; i < drawCallData.size(); i++) {
+                const auto &bounds = drawCallBounds.at(i);
+                if (bounds.bounded) {
+                    culler.add(bounds.min, bounds.max, drawCallTransforms.at(i)->getModel());
+                } else {
+                    culler.addUnbounded(drawCallTransforms.at(i)->getModel());
+                }
+            }
+            ret = culler.cull(visibleDrawCalls);
+
+            // The draw call data only changes with the members, so the buffer is current if the same draws are visible.
+            if (!membersChanged && uploadedDrawCallsValid && visibleDrawCalls == uploadedDrawCalls) {
+                return ret;
+            }
+            uploadedDrawCalls = visibleDrawCalls;
+            uploadedDrawCallsValid = true;
+
+            visibleDrawCallData.clear();
+            visibleDrawCallData.reserve(visibleDrawCalls.size());
+            for (auto index: visibleDrawCalls) {
+                visibleDrawCallData.emplace_back(drawCallData[index]);
+            }
+            data = visibleDrawCallData.data();
+            count = visibleDrawCallData.size();
+        } else {
+            ret.draws = count;
+            ret.submitted = count;
+            uploadedDrawCallsValid = false;
+        }
+
+        // Upload draw call buffer
         if (drawCallBufferHandle != StreamBuffer::INVALID_HANDLE) {
             drawCallBuffer.release(drawCallBufferHandle);
+            drawCallBufferHandle = StreamBuffer::INVALID_HANDLE;
         }
 
+        if (count > 0) {
+            drawCallBufferHandle = drawCallBuffer.upload(reinterpret_cast<const uint8_t *>(data),
+                                                         count * sizeof(ShaderDrawCall::CPU),
+                                                         0);
+            drawCallBuffer.flush(drawCallBufferHandle);
+        }
+
+        drawCallBuffer.commit(queue);
+
+        drawCallCount = count;
+
+        return ret;
+    }
+
+    void RenderPipelineIndirect::DrawList::updateMembers(rg::Heap &resourceHeap,
+                                                         const std::unordered_map<DrawID, DrawCall> &callMap) {
         std::unordered_set<BufferAccessRange, BufferAccessRangeHasher> transformAccess;
         std::unordered_set<BufferAccessRange, BufferAccessRangeHasher> materialAccess;
         std::unordered_map<VertexAttribute, std::unordered_set<BufferAccessRange, BufferAccessRangeHasher> >
@@ -426,10 +508,16 @@ namespace xng {
         std::unordered_set<BufferAccessRange, BufferAccessRangeHasher> indexBufferAccess;
 
         // Fetch draw call data and accesses
-        std::vector<ShaderDrawCall::CPU> drawCallData;
+        drawCallData.clear();
+        drawCallBounds.clear();
+        drawCallTransforms.clear();
         for (auto &id: drawCalls) {
             auto &drawCall = callMap.at(id);
             drawCallData.insert(drawCallData.end(), drawCall.drawCallData.begin(), drawCall.drawCallData.end());
+            drawCallBounds.insert(drawCallBounds.end(), drawCall.drawCallBounds.begin(), drawCall.drawCallBounds.end());
+            drawCallTransforms.insert(drawCallTransforms.end(),
+                                      drawCall.drawCallData.size(),
+                                      &down_cast<const RenderPipelineTransformIndirect &>(*drawCall.transform));
             transformAccess.insert(drawCall.transformAccessRanges.begin(), drawCall.transformAccessRanges.end());
             materialAccess.insert(drawCall.materialAccessRanges.begin(), drawCall.materialAccessRanges.end());
             for (auto &pair: drawCall.vertexBufferAccessRanges) {
@@ -438,15 +526,7 @@ namespace xng {
             indexBufferAccess.insert(drawCall.indexBufferAccessRanges.begin(), drawCall.indexBufferAccessRanges.end());
         }
 
-        // Upload draw call buffer
-        drawCallBufferHandle = drawCallBuffer.upload(reinterpret_cast<const uint8_t *>(drawCallData.data()),
-                                                     drawCallData.size() * sizeof(ShaderDrawCall::CPU),
-                                                     0);
-        drawCallBuffer.flush(drawCallBufferHandle);
-
-        drawCallBuffer.commit(queue);
-
-        // Update indirect / drawMesh buffers
+        // Update indirect / drawMesh buffers, sized for all members so culling does not reallocate them.
         const auto indirectBufferSize = drawCallData.size() * sizeof(ShaderScript::ShaderDrawIndirectIndexed::CPU);
         if (indirectBuffer.getDescription().size != indirectBufferSize && indirectBufferSize > 0) {
             const rg::Buffer desc(indirectBufferSize,
@@ -494,7 +574,7 @@ namespace xng {
     }
 
     void RenderPipelineIndirect::recordPrePass(RenderQueue &queue, const DrawList &drawList) const {
-        if (drawList.drawCalls.empty()) {
+        if (drawList.drawCallCount == 0) {
             return;
         }
 
@@ -521,9 +601,9 @@ namespace xng {
             ctx.bindStorageBuffer("commandCountBuffer", drawList.indirectCountBuffer, 0, 0);
 
             ctx.setShaderParameter("batchSize",
-                                   rg::ShaderPrimitive(static_cast<int>(drawList.getDrawCallCount(drawCalls))));
+                                   rg::ShaderPrimitive(static_cast<int>(drawList.drawCallCount)));
 
-            ctx.dispatch(Vec3u((drawList.getDrawCallCount(drawCalls) + (prePassLocalSize - 1)) / prePassLocalSize,
+            ctx.dispatch(Vec3u((drawList.drawCallCount + (prePassLocalSize - 1)) / prePassLocalSize,
                                1,
                                1));
         }));
@@ -51,7 +51,7 @@ namespace xng {
     void Renderer::draw(const std::shared_ptr<rg::Surface> &surface, RenderScene &scene) {
         stats = {};
         stats.frameStart = std::chrono::high_resolution_clock::now();
-        stats.streamingBudgetUsed = chunkStreamer.getInFlightChunks() * KB(256);
+        stats.streamingBudgetUsed = chunkStreamer.getPendingBytes();
         stats.streamingBudgetMax = streamingBudget;
 
         RenderQueue queue;
@@ -59,6 +59,15 @@ namespace xng {
         // Commit Scene
         scene.commit(queue);
 
+        const auto drawStatistics = scene.getDrawStatistics();
+        stats.drawCalls = drawStatistics.submitted;
+        stats.culledDrawCalls = drawStatistics.culled;
+        stats.lightBufferUpload = scene.getLightUploadBytes();
+
+        const auto meshStatistics = scene.getMeshStreamer().getStatistics();
+        stats.meshFragmentation = meshStatistics.fragmentation;
+        stats.meshReclaimedBytes = meshStatistics.reclaimedBytes;
+
         // Record compute skinning
         queue.getFrameBuilder().addPass(recordSkinningPass(scene));
 
@@ -72,19 +81,53 @@ namespace xng {
         }
 
         // Execute Graph
-        const auto sem = queue.submit(runtime);
+        inFlightFrames.emplace_back(queue.submit(runtime));
+        stats.frameSubmit = std::chrono::high_resolution_clock::now();
 
-        // Sync every Frame (Frames in flight will do more advanced syncing here)
-        static constexpr size_t timeOut = 10'000'000'000ULL;
-        if (!sem->wait(timeOut)) {
-            throw std::runtime_error("Renderer timed out");
+        // Throttle the cpu to framesInFlight submitted frames,
+        // the per frame streaming resources are recycled by the chunk streamer based on the frame fences.
+        while (inFlightFrames.size() >= framesInFlight) {
+            waitFrame();
         }
 
         stats.tilesInFlight = scene.getVirtualTextureStreamer().getTilesInFlight();
-        stats.frameSubmit = sem->getTimeline().submitTimeHost;
+        stats.frameEnd = std::chrono::high_resolution_clock::now();
+    }
 
+    void Renderer::setFramesInFlight(const size_t count) {
+        if (count == 0) {
+            throw std::runtime_error("At least one frame must be in flight");
+        }
+        framesInFlight = count;
+    }
+
+    size_t Renderer::getFramesInFlight() const {
+        return framesInFlight;
+    }
+
+    void Renderer::synchronize() {
+        while (!inFlightFrames.empty()) {
+            waitFrame();
+        }
+    }
+
+    RendererStatistics Renderer::getStatistics() const {
+        return stats;
+    }
+
+    void Renderer::waitFrame() {
+        static constexpr size_t timeOut = 10'000'000'000ULL;
+
+        const auto fence = std::move(inFlightFrames.front());
+        inFlightFrames.pop_front();
+
+        if (!fence->wait(timeOut)) {
+            throw std::runtime_error("Renderer timed out");
+        }
+
+        stats.gpuTime.clear();
         std::unordered_map<std::string, size_t> passSliceIndices;
-        for (auto &slice: sem->getTimeline().slices) {
+        for (auto &slice: fence->getTimeline().slices) {
             const auto sliceDuration = slice.end - slice.start;
             if (passSliceIndices.find(slice.passName) != passSliceIndices.end()) {
                 stats.gpuTime.at(passSliceIndices.at(slice.passName)).second += sliceDuration;
@@ -93,11 +136,6 @@ namespace xng {
                 passSliceIndices.emplace(slice.passName, stats.gpuTime.size() - 1);
             }
         }
-        stats.frameEnd = std::chrono::high_resolution_clock::now();
-    }
-
-    RendererStatistics Renderer::getStatistics() const {
-        return stats;
     }
 
     rg::ComputePass Renderer::recordSkinningPass(const RenderScene &scene) const {
@@ -22,6 +22,37 @@
 #include "xng/renderer/pipeline/indirect/renderpipelineindirect.hpp"
 
 namespace xng {
+    /**
+     * Upload the dirty ranges of the light slots.
+     *
+     * @return The number of uploaded bytes
+     */
+    template<typename T>
+    static size_t commitLights(SlotArray<T> &lights,
+                               StreamBuffer &buffer,
+                               std::vector<StreamBuffer::Handle> &uploads) {
+        if (!lights.isDirty()) {
+            return 0;
+        }
+
+        // The uploads of the previous commit were flushed and have finished,
+        // releasing them does not discard data and allows uploading to overlapping ranges.
+        for (auto handle: uploads) {
+            buffer.release(handle);
+        }
+        uploads.clear();
+
+        size_t ret = 0;
+        for (auto &range: lights.getDirtyRanges()) {
+            const auto handle = buffer.upload(lights.data() + range.offset, range.size, range.offset);
+            buffer.flush(handle);
+            uploads.emplace_back(handle);
+            ret += range.size;
+        }
+        lights.clearDirty();
+        return ret;
+    }
+
     RenderScene::RenderScene(rg::Runtime &runtime,
                              ChunkStreamer &chunkStreamer,
                              const size_t tileSize,
@@ -43,6 +74,16 @@ namespace xng {
           canvasPipeline(createPipeline(CanvasMaterial::getLayout())) {
         unitQuadMesh->flush();
         unitCubeMesh->flush();
+
+        // Opaque deferred draws front to back for early depth rejection,
+        // forward draws may be blended and are drawn back to front.
+        pbrDeferredPipeline->setEnableDrawCulling(true);
+        pbrDeferredPipeline->setEnableDistanceSort(true);
+        pbrDeferredPipeline->setDistanceSortOrder(DrawCuller::SORT_FRONT_TO_BACK);
+
+        pbrForwardPipeline->setEnableDrawCulling(true);
+        pbrForwardPipeline->setEnableDistanceSort(true);
+        pbrForwardPipeline->setDistanceSortOrder(DrawCuller::SORT_BACK_TO_FRONT);
     }
 
     void RenderScene::setCamera(const Camera &value) {
@@ -157,6 +198,7 @@ namespace xng {
                                                                pipelineConfiguration) {
         const auto id = allocateID();
         auto pipeline = createPipeline(std::move(materialLayout));
+        pipeline->setEnableDrawCulling(true);
         auto shader = pipeline->getCompiler().compile(uShaders,
                                                       pipelineConfiguration,
                                                       {
@@ -418,8 +460,10 @@ namespace xng {
                                                                        const float shadowNearPlane,
                                                                        const float shadowFarPlane) {
         const auto id = allocateID();
-        pointLights.emplace(id, RenderPointLight([this]() {
-            reuploadPointLights = true;
+        const auto slot = pointLightSlots.create();
+        lightSlots[id] = slot;
+        pointLights.emplace(id, RenderPointLight([this, id, slot]() {
+            pointLightSlots.set(slot, pointLights.at(id).getData());
         }));
         pointLights.at(id).set(position, color, power, castShadows, shadowNearPlane, shadowFarPlane);
 
@@ -429,8 +473,10 @@ namespace xng {
 
     RenderObjectHandle<RenderDirectionalLight> RenderScene::createDirectionalLight() {
         const auto id = allocateID();
-        directionalLights.emplace(id, RenderDirectionalLight([this]() {
-            reuploadDirectionalLights = true;
+        const auto slot = directionalLightSlots.create();
+        lightSlots[id] = slot;
+        directionalLights.emplace(id, RenderDirectionalLight([this, id, slot]() {
+            directionalLightSlots.set(slot, directionalLights.at(id).getData());
         }));
         types[id] = RenderObject::RENDER_LIGHT_DIRECTIONAL;
         return {this, id, directionalLights.at(id)};
@@ -438,74 +484,21 @@ namespace xng {
 
     RenderObjectHandle<RenderSpotLight> RenderScene::createSpotLight() {
         const auto id = allocateID();
-        spotLights.emplace(id, RenderSpotLight([this]() {
-            reuploadSpotLights = true;
+        const auto slot = spotLightSlots.create();
+        lightSlots[id] = slot;
+        spotLights.emplace(id, RenderSpotLight([this, id, slot]() {
+            spotLightSlots.set(slot, spotLights.at(id).getData());
         }));
         types[id] = RenderObject::RENDER_LIGHT_SPOT;
         return {this, id, spotLights.at(id)};
     }
 
     void RenderScene::commit(RenderQueue &queue) {
-        //TODO: Design light buffer technique.
-
-        // Light iteration in shaders is expensive.
-        // One solution is storing lights in a separate buffer with gaps and using an index table.
-        // This indirection is bad for cache performance, so lights should be in a single contiguous (uniform) buffer
-        // that handles gaps by moving the lights / reallocating on grow / shrink.
-        if (reuploadPointLights) {
-            if (pointLightResident) {
-                pointLightBuffer.release(pointLightBufferHandle);
-            }
-
-            std::vector<uint8_t> lightData;
-            lightData.reserve(pointLights.size() * sizeof(ShaderPointLight::CPU));
-            for (const auto &pair: pointLights) {
-                lightData.insert(lightData.end(),
-                                 reinterpret_cast<const uint8_t *>(&pair.second.getData()),
-                                 reinterpret_cast<const uint8_t *>(&pair.second.getData()) + sizeof(
-                                     ShaderPointLight::CPU));
-            }
-            pointLightBufferHandle = pointLightBuffer.upload(std::move(lightData), 0);
-            pointLightBuffer.flush(pointLightBufferHandle);
-            reuploadPointLights = false;
-            pointLightResident = true;
-        }
-
-        if (reuploadDirectionalLights) {
-            if (directionalLightResident) {
-                directionalLightBuffer.release(directionalLightBufferHandle);
-            }
-            std::vector<uint8_t> lightData;
-            lightData.reserve(directionalLights.size() * sizeof(ShaderDirectionalLight::CPU));
-            for (const auto &pair: directionalLights) {
-                lightData.insert(lightData.end(),
-                                 reinterpret_cast<const uint8_t *>(&pair.second.getData()),
-                                 reinterpret_cast<const uint8_t *>(&pair.second.getData()) + sizeof(
-                                     ShaderDirectionalLight::CPU));
-            }
-            directionalLightBufferHandle = directionalLightBuffer.upload(std::move(lightData), 0);
-            directionalLightBuffer.flush(directionalLightBufferHandle);
-            reuploadDirectionalLights = false;
-            directionalLightResident = true;
-        }
-
-        if (reuploadSpotLights) {
-            if (spotLightResident) {
-                spotLightBuffer.release(spotLightBufferHandle);
-            }
-            std::vector<uint8_t> lightData;
-            lightData.reserve(spotLights.size() * sizeof(ShaderSpotLight::CPU));
-            for (const auto &pair: spotLights) {
-                lightData.insert(lightData.end(),
-                                 reinterpret_cast<const uint8_t *>(&pair.second.getData()),
-                                 reinterpret_cast<const uint8_t *>(&pair.second.getData()) + sizeof(
-                                     ShaderSpotLight::CPU));
-            }
-            spotLightBufferHandle = spotLightBuffer.upload(std::move(lightData), 0);
-            spotLightBuffer.flush(spotLightBufferHandle);
-            reuploadSpotLights = false;
-            spotLightResident = true;
-        }
+        // Lights are stored in a single contiguous buffer per type which shaders iterate directly.
+        // Lights keep their slot for their lifetime so only the slots of changed lights are uploaded.
+        lightUploadBytes = commitLights(pointLightSlots, pointLightBuffer, pointLightUploads)
+                           + commitLights(directionalLightSlots, directionalLightBuffer, directionalLightUploads)
+                           + commitLights(spotLightSlots, spotLightBuffer, spotLightUploads);
 
         pointLightBuffer.commit(queue);
         directionalLightBuffer.commit(queue);
@@ -531,6 +524,22 @@ namespace xng {
         chunkStreamer.commit(queue);
     }
 
+    DrawCuller::Statistics RenderScene::getDrawStatistics() const {
+        DrawCuller::Statistics ret;
+        ret += pbrDeferredPipeline->getDrawStatistics();
+        ret += pbrForwardPipeline->getDrawStatistics();
+        ret += shadowCastersPipeline->getDrawStatistics();
+
+        for (auto &pair: shaders) {
+            ret += pair.second.getPipeline()->getDrawStatistics();
+        }
+
+        for (auto &pair: canvases) {
+            ret += pair.second.getPipeline().getDrawStatistics();
+        }
+        return ret;
+    }
+
     void RenderScene::prepare(RenderQueue &queue) {
         pbrDeferredPipeline->prepare(queue);
         pbrForwardPipeline->prepare(queue);
@@ -668,16 +677,19 @@ namespace xng {
 
     void RenderScene::destroyPointLight(const RenderObject::ID id) {
         pointLights.erase(id);
-        reuploadPointLights = true;
+        pointLightSlots.destroy(lightSlots.at(id));
+        lightSlots.erase(id);
     }
 
     void RenderScene::destroyDirectionalLight(const RenderObject::ID id) {
         directionalLights.erase(id);
-        reuploadDirectionalLights = true;
+        directionalLightSlots.destroy(lightSlots.at(id));
+        lightSlots.erase(id);
     }
 
     void RenderScene::destroySpotLight(const RenderObject::ID id) {
         spotLights.erase(id);
-        reuploadSpotLights = true;
+        spotLightSlots.destroy(lightSlots.at(id));
+        lightSlots.erase(id);
     }
 }
@@ -21,23 +21,17 @@
 #include "xng/resource/importers/fontimporter.hpp"
 
 #include "xng/assets/font.hpp"
+#include "xng/io/readfile.hpp"
 
 namespace xng {
     ResourceBundle FontImporter::read(std::istream &stream,
                                       const Uri &path,
                                       Archive *archive) {
         std::vector<uint8_t> buffer;
-
-        char c;
-        while (!stream.eof()) {
-            stream.read(&c, 1);
-            if (stream.gcount() == 1) {
-                buffer.emplace_back(c);
-            }
-        }
+        readStream(stream, buffer);
 
         ResourceBundle ret;
-        ret.add("", std::make_unique<Font>(Font(buffer)));
+        ret.add("", std::make_unique<Font>(Font(std::move(buffer))));
         return ret;
     }
 
@@ -67,8 +67,7 @@ namespace xng {
         return ret;
     }
 
-    static ResourceBundle readJsonBundle(const std::vector<char> &buffer) {
-        auto stream = std::stringstream(std::string(buffer.begin(), buffer.end()));
+    static ResourceBundle readJsonBundle(std::istream &stream) {
         const Message m = JsonProtocol().deserialize(stream);
 
         ResourceBundle ret;
@@ -105,17 +104,7 @@ namespace xng {
     ResourceBundle JsonImporter::read(std::istream &stream,
                                       const Uri &path,
                                       Archive *archive) {
-        std::vector<char> buffer;
-
-        char c;
-        while (!stream.eof()) {
-            stream.read(&c, 1);
-            if (stream.gcount() == 1) {
-                buffer.emplace_back(c);
-            }
-        }
-
-        return readJsonBundle(buffer);
+        return readJsonBundle(stream);
     }
 
     const std::set<std::string> &JsonImporter::getSupportedFormats() const {
@@ -25,9 +25,13 @@
 
 namespace xng {
     ImageRGBA StbiImporter::readImageRGBA(const std::vector<char> &buffer) {
+        return readImageRGBA(buffer.data(), buffer.size());
+    }
+
+    ImageRGBA StbiImporter::readImageRGBA(const char *buffer, size_t size) {
         int width, height, nrChannels;
-        stbi_uc *data = stbi_load_from_memory(reinterpret_cast<const stbi_uc *>(buffer.data()),
-                                              static_cast<int>(buffer.size()),
+        stbi_uc *data = stbi_load_from_memory(reinterpret_cast<const stbi_uc *>(buffer),
+                                              static_cast<int>(size),
                                               &width,
                                               &height,
                                               &nrChannels,
@@ -54,9 +58,13 @@ namespace xng {
     }
 
     ImageRGBF StbiImporter::readImageFloat(const std::vector<char> &buffer) {
+        return readImageFloat(buffer.data(), buffer.size());
+    }
+
+    ImageRGBF StbiImporter::readImageFloat(const char *buffer, size_t size) {
         int width, height, nrChannels;
-        float *data = stbi_loadf_from_memory(reinterpret_cast<const stbi_uc *>(buffer.data()),
-                                             static_cast<int>(buffer.size()),
+        float *data = stbi_loadf_from_memory(reinterpret_cast<const stbi_uc *>(buffer),
+                                             static_cast<int>(size),
                                              &width,
                                              &height,
                                              &nrChannels,
@@ -85,13 +93,9 @@ namespace xng {
     ResourceBundle StbiImporter::read(std::istream &stream,
                                       const Uri &path,
                                       Archive *archive) {
-        std::vector<char> buffer;
-
-        std::array<char, 1024> readBuffer;
-        while (!stream.eof()) {
-            stream.read(readBuffer.data(), readBuffer.size());
-            buffer.insert(buffer.end(), readBuffer.begin(), readBuffer.begin() + stream.gcount());
-        }
+        // Streams over memory are decoded in place
+        std::vector<char> storage;
+        auto buffer = readStreamView(stream, storage);
 
         //Try to read source as image
         int x, y, n;
@@ -104,11 +108,11 @@ namespace xng {
             //Source is image
             ResourceBundle ret;
             if (path.getExtension() == ".hdr") {
-                auto img = readImageFloat(buffer);
-                ret.add("", std::make_unique<ImageRGBF>(img));
+                auto img = readImageFloat(buffer.data(), buffer.size());
+                ret.add("", std::make_unique<ImageRGBF>(std::move(img)));
             } else {
-                auto img = readImageRGBA(buffer);
-                ret.add("", std::make_unique<ImageRGBA>(img));
+                auto img = readImageRGBA(buffer.data(), buffer.size());
+                ret.add("", std::make_unique<ImageRGBA>(std::move(img)));
             }
             return ret;
         }
@@ -18,13 +18,47 @@
 
 #include "xng/resource/resourceregistry.hpp"
 
+#include <algorithm>
+#include <thread>
 #include <utility>
 
 #include "xng/resource/resourceimporter.hpp"
 #include "xng/io/archive/memoryarchive.hpp"
+#include "xng/io/memorystream.hpp"
 #include "xng/log/log.hpp"
 
 namespace xng {
+    struct ResourceRegistry::LoadRequest {
+        enum State {
+            QUEUED_READ,
+            READING,
+            QUEUED_DECODE,
+            DECODING
+        };
+
+        Uri uri;
+        int priority = 0;
+        unsigned long long sequence = 0;
+        std::chrono::steady_clock::time_point start;
+
+        State state = QUEUED_READ;
+        std::atomic<bool> cancelled = false;
+
+        std::shared_ptr<Archive> archive;
+        Archive::FileView view; // The file data if the archive provides it without copying
+        std::vector<char> data; // The file data read from the archive otherwise
+        std::exception_ptr exception;
+
+        std::shared_ptr<Task> task; // Completes when the load has finished, failed or was cancelled
+    };
+
+    bool ResourceRegistry::LoadOrder::operator()(const std::shared_ptr<LoadRequest> &lhs,
+                                                 const std::shared_ptr<LoadRequest> &rhs) const {
+        if (lhs->priority != rhs->priority)
+            return lhs->priority > rhs->priority;
+        return lhs->sequence < rhs->sequence;
+    }
+
     ResourceRegistry &ResourceRegistry::getDefaultRegistry() {
         static ResourceRegistry defRepo;
         return defRepo;
@@ -32,28 +66,48 @@ namespace xng {
 
     ResourceRegistry::ResourceRegistry() {
         archives["memory"] = std::make_shared<MemoryArchive>();
+        indexArchive("memory", *archives["memory"]);
     }
 
     ResourceRegistry::~ResourceRegistry() {
-        auto tasks = loadTasks;
-        for (auto &pair: tasks) {
-            auto ex = pair.second->join();
-            if (ex) {
-                std::rethrow_exception(ex);
+        {
+            std::lock_guard<std::mutex> g(mutex);
+            auto requests = loadRequests;
+            for (auto &pair: requests) {
+                cancelLoad(pair.second);
+            }
+        }
+
+        // The load tasks reference the registry, help the pool run them until all have completed.
+        auto &pool = ThreadPool::getPool();
+        while (true) {
+            {
+                std::lock_guard<std::mutex> g(mutex);
+                if (activeReads == 0 && activeDecodes == 0)
+                    break;
+            }
+            if (!pool.runPendingTask()) {
+                std::this_thread::yield();
             }
         }
-        bundles.clear();
+
+        // Resources can contain handles which release references to this registry when they are destroyed.
+        destroyReleasedBundles();
+        auto remaining = std::move(bundles);
+        remaining.clear();
     }
 
     void ResourceRegistry::addArchive(const std::string &scheme, std::shared_ptr<Archive> archive) {
         std::unique_lock g(archiveMutex);
         if (archives.find(scheme) != archives.end())
             throw std::runtime_error("Archive with scheme " + scheme + " already exists");
+        indexArchive(scheme, *archive);
         archives[scheme] = std::move(archive);
     }
 
     void ResourceRegistry::removeArchive(const std::string &scheme) {
         std::unique_lock l(archiveMutex);
+        unindexArchive(scheme);
         archives.erase(scheme);
     }
 
@@ -79,40 +133,87 @@ namespace xng {
         return *archives.at(scheme);
     }
 
-    void ResourceRegistry::incRef(const Uri &uri) {
-        if (bundleRefCounter.inc(uri.getFile())) {
-            load(uri);
+    ResourceRegistry::Reference &ResourceRegistry::acquire(const Uri &uri, int priority) {
+        std::lock_guard<std::mutex> g(referenceMutex);
+        auto &reference = references[uri.getFile()];
+        if (!reference) {
+            reference = std::make_unique<Reference>(uri);
+        }
+        // The count can be zero while the bundle is still referenced if the last reference is being released concurrently.
+        if (reference->count.fetch_add(1, std::memory_order_acq_rel) == 0 && !reference->referenced) {
+            reference->uri = uri;
+            reference->referenced = true;
+            load(uri, priority);
         }
+        return *reference;
     }
 
     void ResourceRegistry::decRef(const Uri &uri) {
-        if (bundleRefCounter.dec(uri.getFile())) {
-            unload(uri);
+        Reference *reference;
+        {
+            std::lock_guard<std::mutex> g(referenceMutex);
+            auto it = references.find(uri.getFile());
+            if (it == references.end() || it->second->count == 0)
+                throw std::runtime_error("Counter underflow");
+            reference = it->second.get();
         }
+        release(*reference);
+    }
+
+    void ResourceRegistry::unreferenced(Reference &reference) {
+        {
+            std::lock_guard<std::mutex> g(referenceMutex);
+            if (reference.count == 0 && reference.referenced) {
+                reference.referenced = false;
+                unload(reference.uri);
+            }
+        }
+        destroyReleasedBundles();
     }
 
     void ResourceRegistry::reload(const Uri &uri) {
         std::shared_ptr<Task> task;
+        int priority = 0;
         {
             std::lock_guard<std::mutex> g(mutex);
             auto it = loadTasks.find(uri.getFile());
             if (it != loadTasks.end()) {
-                abortedBundleLoads.insert(uri.getFile());
                 task = it->second;
             }
+            auto request = loadRequests.find(uri.getFile());
+            if (request != loadRequests.end()) {
+                priority = request->second->priority;
+                cancelLoad(request->second);
+            }
         }
 
         if (task != nullptr) {
             task->join();
         }
 
-        std::lock_guard<std::mutex> g(mutex);
+        bool referenced = true;
+        {
+            std::lock_guard<std::mutex> g(mutex);
 
-        resources.erase(uri);
-        bundles.erase(uri.getFile());
-        uris.erase(uri);
+            auto cached = cacheEntries.find(uri.getFile());
+            if (cached != cacheEntries.end()) {
+                // Unreferenced bundles are loaded again when they are referenced the next time.
+                statistics.cachedBytes -= bundleSizes.at(uri.getFile());
+                statistics.cachedBundles--;
+                cache.erase(cached->second);
+                cacheEntries.erase(cached);
+                referenced = false;
+            } else {
+                loadTasks.erase(uri.getFile());
+                uris.erase(uri);
+            }
+            eraseBundle(uri.getFile());
+        }
 
-        load(uri);
+        if (referenced) {
+            load(uri, priority);
+        }
+        destroyReleasedBundles();
     }
 
     void ResourceRegistry::await(const Uri &uri) {
@@ -134,50 +235,120 @@ namespace xng {
         return uris;
     }
 
-    void ResourceRegistry::load(const Uri &uri) {
+    void ResourceRegistry::setRescanInterval(const std::chrono::milliseconds interval) {
+        std::unique_lock l(archiveMutex);
+        rescanInterval = interval;
+    }
+
+    void ResourceRegistry::setMemoryBudget(size_t bytes) {
+        {
+            std::lock_guard<std::mutex> g(mutex);
+            memoryBudget = bytes;
+            evict();
+        }
+        destroyReleasedBundles();
+    }
+
+    size_t ResourceRegistry::getMemoryBudget() {
+        std::lock_guard<std::mutex> g(mutex);
+        return memoryBudget;
+    }
+
+    ResourceRegistry::Statistics ResourceRegistry::getStatistics() {
+        std::lock_guard<std::mutex> g(mutex);
+        return statistics;
+    }
+
+    void ResourceRegistry::prioritize(const Uri &uri, int priority) {
+        std::lock_guard<std::mutex> g(mutex);
+        auto it = loadRequests.find(uri.getFile());
+        if (it == loadRequests.end() || it->second->priority == priority)
+            return;
+
+        // The queues are ordered by priority so the request has to be reinserted.
+        auto request = it->second;
+        LoadQueue *queue = nullptr;
+        if (request->state == LoadRequest::QUEUED_READ) {
+            queue = &readQueue;
+        } else if (request->state == LoadRequest::QUEUED_DECODE) {
+            queue = &decodeQueue;
+        }
+        if (queue != nullptr) {
+            queue->erase(request);
+        }
+        request->priority = priority;
+        if (queue != nullptr) {
+            queue->insert(request);
+        }
+    }
+
+    void ResourceRegistry::setMaxConcurrentLoads(size_t reads, size_t decodes) {
+        if (reads == 0)
+            throw std::runtime_error("The maximum number of concurrent reads must be at least 1");
+        std::lock_guard<std::mutex> g(mutex);
+        maxConcurrentReads = reads;
+        maxConcurrentDecodes = decodes;
+        dispatchLoads();
+    }
+
+    void ResourceRegistry::load(const Uri &uri, int priority) {
         std::lock_guard<std::mutex> g(mutex);
 
         uris.insert(uri);
 
-        auto it = loadTasks.find(uri.getFile());
-        if (it == loadTasks.end() && bundles.find(uri.getFile()) == bundles.end()) {
-            loadingUris.insert(uri);
-            loadTasks[uri.getFile()] = ThreadPool::getPool().addTask([this, uri]() {
-                try {
-                    std::shared_lock l(importerMutex);
-
-                    auto &archive = resolveUri(uri);
-                    std::filesystem::path path(uri.getFile());
-                    auto stream = archive.open(path.string());
-                    auto bundle = getImporter(path.extension().string()).read(*stream, uri, &archive);
-
-                    std::lock_guard<std::mutex> g(mutex);
-
-                    if (abortedBundleLoads.find(uri.getFile()) == abortedBundleLoads.end()) {
-                        bundles[uri.getFile()] = std::move(bundle);
-                    } else {
-                        abortedBundleLoads.erase(uri.getFile());
-                        uris.erase(uri);
-                    }
+        auto cached = cacheEntries.find(uri.getFile());
+        if (cached != cacheEntries.end()) {
+            statistics.hits++;
+            statistics.cachedBytes -= bundleSizes.at(uri.getFile());
+            statistics.cachedBundles--;
+            cache.erase(cached->second);
+            cacheEntries.erase(cached);
+            return;
+        }
+
+        auto pending = loadRequests.find(uri.getFile());
+        if (pending != loadRequests.end()) {
+            // The bundle was referenced again before the cancelled load has completed.
+            pending->second->cancelled = false;
+            return;
+        }
+
+        // Failed loads keep their task so that get can rethrow the exception until the bundle is loaded again.
+        loadTasks.erase(uri.getFile());
 
-                    loadTasks.erase(uri.getFile());
-                    loadingUris.erase(uri);
-                } catch (const std::runtime_error &e) {
-                    Log::instance().log(ERROR, e.what());
+        if (bundles.find(uri.getFile()) == bundles.end()) {
+            statistics.misses++;
+            loadingUris.insert(uri);
 
-                    throw e;
+            auto request = std::make_shared<LoadRequest>();
+            request->uri = uri;
+            request->priority = priority;
+            request->sequence = nextLoadSequence++;
+            request->start = std::chrono::steady_clock::now();
+            std::weak_ptr<LoadRequest> weakRequest = request;
+            request->task = std::make_shared<Task>([weakRequest]() {
+                auto ex = weakRequest.lock()->exception;
+                if (ex) {
+                    std::rethrow_exception(ex);
                 }
             });
+
+            loadRequests[uri.getFile()] = request;
+            loadTasks[uri.getFile()] = request->task;
+            readQueue.insert(request);
+
+            dispatchLoads();
         }
     }
 
     void ResourceRegistry::unload(const Uri &uri) {
         std::lock_guard<std::mutex> g(mutex);
 
-        auto it = loadTasks.find(uri.getFile());
-        if (it != loadTasks.end()) {
-            abortedBundleLoads.insert(uri.getFile());
+        auto it = loadRequests.find(uri.getFile());
+        if (it != loadRequests.end()) {
+            cancelLoad(it->second);
         } else {
+            loadTasks.erase(uri.getFile());
             uris.erase(uri);
             resources.erase(uri);
             bool bundleReferenced = false;
@@ -187,27 +358,343 @@ namespace xng {
                     break;
                 }
             }
-            if (!bundleReferenced) {
-                bundles.erase(uri.getFile());
+            if (!bundleReferenced
+                && bundles.find(uri.getFile()) != bundles.end()
+                && cacheEntries.find(uri.getFile()) == cacheEntries.end()) {
+                cache.push_front(uri.getFile());
+                cacheEntries[uri.getFile()] = cache.begin();
+                statistics.cachedBytes += bundleSizes.at(uri.getFile());
+                statistics.cachedBundles++;
+                evict();
             }
         }
     }
 
-    Archive &ResourceRegistry::resolveUri(const Uri &uri) {
-        std::shared_lock l(archiveMutex);
-        if (uri.getScheme().empty()) {
-            if (defaultScheme.empty()) {
-                for (auto &a: archives) {
-                    if (a.second->exists(uri.getFile())) {
-                        return *a.second;
+    void ResourceRegistry::evict() {
+        // A zero budget disables the cache, bundles which do not report their size would otherwise never exceed it.
+        while (!cache.empty() && (memoryBudget == 0 || statistics.residentBytes > memoryBudget)) {
+            auto file = cache.back();
+            cache.pop_back();
+            cacheEntries.erase(file);
+            statistics.cachedBytes -= bundleSizes.at(file);
+            statistics.cachedBundles--;
+            statistics.evictions++;
+            eraseBundle(file);
+        }
+    }
+
+    void ResourceRegistry::eraseBundle(const std::string &file) {
+        for (auto it = resources.begin(); it != resources.end();) {
+            if (it->first.getFile() == file) {
+                it = resources.erase(it);
+            } else {
+                ++it;
+            }
+        }
+        auto size = bundleSizes.find(file);
+        if (size != bundleSizes.end()) {
+            statistics.residentBytes -= size->second;
+            bundleSizes.erase(size);
+        }
+        auto bundle = bundles.find(file);
+        if (bundle != bundles.end()) {
+            releasedBundles.emplace_back(std::move(bundle->second));
+            bundles.erase(bundle);
+        }
+    }
+
+    void ResourceRegistry::destroyReleasedBundles() {
+        std::vector<ResourceBundle> released;
+        {
+            std::lock_guard<std::mutex> g(mutex);
+            released.swap(releasedBundles);
+        }
+    }
+
+    void ResourceRegistry::cancelLoad(std::shared_ptr<LoadRequest> request) {
+        if (request->state == LoadRequest::QUEUED_READ) {
+            readQueue.erase(request);
+            request->cancelled = true;
+            finishLoad(request);
+        } else if (request->state == LoadRequest::QUEUED_DECODE) {
+            decodeQueue.erase(request);
+            request->cancelled = true;
+            finishLoad(request);
+        } else {
+            // The running stage checks the flag and finishes the load.
+            request->cancelled = true;
+        }
+    }
+
+    void ResourceRegistry::dispatchLoads() {
+        auto &pool = ThreadPool::getPool();
+        auto maxDecodes = maxConcurrentDecodes == 0 ? pool.getThreadCount() : maxConcurrentDecodes;
+
+        // Decodes run before reads so that read data does not pile up while waiting to be decoded.
+        while (activeDecodes < maxDecodes && pendingDecodes < decodeQueue.size()) {
+            activeDecodes++;
+            pendingDecodes++;
+            pool.addTask([this]() { decodeBundle(); }, ThreadPool::PRIORITY_NORMAL);
+        }
+
+        while (activeReads < maxConcurrentReads && pendingReads < readQueue.size()) {
+            activeReads++;
+            pendingReads++;
+            pool.addTask([this]() { readBundle(); }, ThreadPool::PRIORITY_LOW);
+        }
+    }
+
+    void ResourceRegistry::readBundle() {
+        std::shared_ptr<LoadRequest> request;
+        {
+            std::lock_guard<std::mutex> g(mutex);
+            pendingReads--;
+            if (readQueue.empty()) {
+                // The load was cancelled before the task started.
+                activeReads--;
+                return;
+            }
+            request = *readQueue.begin();
+            readQueue.erase(readQueue.begin());
+            request->state = LoadRequest::READING;
+        }
+
+        std::shared_ptr<Archive> archive;
+        Archive::FileView view;
+        std::vector<char> data;
+        bool complete = false;
+        std::exception_ptr exception;
+        try {
+            archive = resolveUri(request->uri);
+            auto path = std::filesystem::path(request->uri.getFile()).string();
+            view = archive->view(path);
+            if (view) {
+                complete = true;
+            } else {
+                auto stream = archive->open(path);
+
+                // Allocate the buffer once if the size of the stream is known
+                size_t size = 0;
+                bool sized = false;
+                auto begin = stream->tellg();
+                if (begin != std::streampos(-1)) {
+                    stream->seekg(0, std::ios::end);
+                    auto end = stream->tellg();
+                    if (end != std::streampos(-1) && end >= begin) {
+                        size = static_cast<size_t>(end - begin);
+                        sized = true;
+                        data.reserve(size);
                     }
+                    stream->clear();
+                    stream->seekg(begin);
                 }
-                throw std::runtime_error("Failed to resolve uri " + uri.toString());
-            } else {
-                return *archives.at(defaultScheme);
+
+                while (!request->cancelled) {
+                    auto offset = data.size();
+                    size_t count = READ_SIZE;
+                    if (sized && size - offset < count)
+                        count = size - offset;
+                    data.resize(offset + count);
+                    stream->read(data.data() + offset, static_cast<std::streamsize>(count));
+                    auto read = static_cast<size_t>(stream->gcount());
+                    data.resize(offset + read);
+                    if (stream->bad())
+                        throw std::runtime_error("Failed to read " + request->uri.toString());
+                    if (read < count || (sized && data.size() == size)) {
+                        complete = true;
+                        break;
+                    }
+                }
+            }
+        } catch (const std::exception &e) {
+            Log::instance().log(ERROR, e.what());
+            exception = std::current_exception();
+        }
+
+        std::lock_guard<std::mutex> g(mutex);
+        activeReads--;
+        if (exception) {
+            request->exception = exception;
+            finishLoad(request);
+        } else if (request->cancelled) {
+            finishLoad(request);
+        } else if (!complete) {
+            // The load was cancelled and referenced again while reading.
+            request->state = LoadRequest::QUEUED_READ;
+            readQueue.insert(request);
+        } else {
+            request->archive = std::move(archive);
+            request->view = std::move(view);
+            request->data = std::move(data);
+            request->state = LoadRequest::QUEUED_DECODE;
+            decodeQueue.insert(request);
+        }
+        dispatchLoads();
+    }
+
+    void ResourceRegistry::decodeBundle() {
+        std::shared_ptr<LoadRequest> request;
+        {
+            std::lock_guard<std::mutex> g(mutex);
+            pendingDecodes--;
+            if (decodeQueue.empty()) {
+                activeDecodes--;
+                return;
+            }
+            request = *decodeQueue.begin();
+            decodeQueue.erase(decodeQueue.begin());
+            request->state = LoadRequest::DECODING;
+        }
+
+        ResourceBundle bundle;
+        bool decoded = false;
+        std::exception_ptr exception;
+        if (!request->cancelled) {
+            try {
+                std::shared_lock l(importerMutex);
+                std::filesystem::path path(request->uri.getFile());
+                const char *data = request->view ? request->view.data : request->data.data();
+                size_t size = request->view ? request->view.size : request->data.size();
+                MemoryStream stream(data, size);
+                bundle = getImporter(path.extension().string()).read(stream, request->uri, request->archive.get());
+                decoded = true;
+            } catch (const std::exception &e) {
+                Log::instance().log(ERROR, e.what());
+                exception = std::current_exception();
+            }
+        }
+
+        std::lock_guard<std::mutex> g(mutex);
+        activeDecodes--;
+        if (!exception && !decoded && !request->cancelled) {
+            // The load was cancelled and referenced again before decoding started.
+            request->state = LoadRequest::QUEUED_DECODE;
+            decodeQueue.insert(request);
+            dispatchLoads();
+            return;
+        }
+
+        request->view = {};
+        request->data = {};
+        request->archive = nullptr;
+        if (exception) {
+            request->exception = exception;
+        } else if (!request->cancelled) {
+            auto &file = request->uri.getFile();
+            auto size = bundle.getSize();
+            bundles[file] = std::move(bundle);
+            bundleSizes[file] = size;
+            statistics.residentBytes += size;
+
+            auto milliseconds = std::chrono::duration_cast<std::chrono::milliseconds>(
+                std::chrono::steady_clock::now() - request->start).count();
+            size_t bucket = 0;
+            while (milliseconds > 0 && bucket < LOAD_LATENCY_BUCKETS - 1) {
+                milliseconds >>= 1;
+                bucket++;
             }
+            statistics.loadLatency.at(bucket)++;
+        }
+        finishLoad(request);
+        dispatchLoads();
+    }
+
+    void ResourceRegistry::finishLoad(std::shared_ptr<LoadRequest> request) {
+        auto &file = request->uri.getFile();
+        loadRequests.erase(file);
+        loadingUris.erase(request->uri);
+        if (request->cancelled) {
+            loadTasks.erase(file);
+            uris.erase(request->uri);
+            request->task->cancel();
         } else {
-            return *archives.at(uri.getScheme());
+            if (!request->exception) {
+                loadTasks.erase(file);
+            }
+            request->task->execute();
+        }
+    }
+
+    std::shared_ptr<Archive> ResourceRegistry::resolveUri(const Uri &uri) {
+        if (!uri.getScheme().empty()) {
+            std::shared_lock l(archiveMutex);
+            return archives.at(uri.getScheme());
+        }
+
+        if (!defaultScheme.empty()) {
+            std::shared_lock l(archiveMutex);
+            return archives.at(defaultScheme);
+        }
+
+        // Archives list the names of their files exactly as they accept them, so hits need no exists call.
+        auto &file = uri.getFile();
+        const auto now = std::chrono::steady_clock::now();
+        bool rescan;
+        {
+            std::shared_lock l(archiveMutex);
+            auto it = pathIndex.find(file);
+            if (it != pathIndex.end()) {
+                return archives.at(it->second.front());
+            }
+            rescan = now - lastRescan >= rescanInterval;
+        }
+
+        // The file may have been added to an archive after it was indexed.
+        if (rescan) {
+            std::unique_lock l(archiveMutex);
+            if (now - lastRescan >= rescanInterval) {
+                lastRescan = now;
+                for (auto &pair: archives) {
+                    if (indexedPaths.find(pair.first) != indexedPaths.end() && pair.second->changed()) {
+                        unindexArchive(pair.first);
+                        indexArchive(pair.first, *pair.second);
+                    }
+                }
+            }
+        }
+
+        std::shared_lock l(archiveMutex);
+        auto it = pathIndex.find(file);
+        if (it != pathIndex.end()) {
+            return archives.at(it->second.front());
+        }
+
+        // Archives may accept paths which they do not list such as absolute paths.
+        for (auto &pair: archives) {
+            if (pair.second->exists(file)) {
+                return pair.second;
+            }
+        }
+        throw std::runtime_error("Failed to resolve uri " + uri.toString());
+    }
+
+    void ResourceRegistry::indexArchive(const std::string &scheme, Archive &archive) {
+        std::vector<std::string> paths;
+        if (!archive.list(paths)) {
+            unlistedArchives.insert(scheme);
+            return;
+        }
+        for (auto &path: paths) {
+            pathIndex[path].emplace_back(scheme);
+        }
+        indexedPaths[scheme] = std::move(paths);
+    }
+
+    void ResourceRegistry::unindexArchive(const std::string &scheme) {
+        unlistedArchives.erase(scheme);
+        auto it = indexedPaths.find(scheme);
+        if (it == indexedPaths.end())
+            return;
+        for (auto &path: it->second) {
+            auto schemes = pathIndex.find(path);
+            if (schemes == pathIndex.end())
+                continue;
+            auto &value = schemes->second;
+            value.erase(std::remove(value.begin(), value.end(), scheme), value.end());
+            if (value.empty()) {
+                pathIndex.erase(schemes);
+            }
         }
+        indexedPaths.erase(it);
     }
 }
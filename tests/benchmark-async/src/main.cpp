@@ -0,0 +1,147 @@
+/**
+ *   xEngine - C++ Game Engine Library
+ *   Copyright (C) 2026 Julia Zampiccoli
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU Lesser General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   Lesser General Public License for more details.
+ *
+ *   You should have received a copy of the Lesser General Public License
+ *   along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "xng/xng.hpp"
+
+#include "measure.hpp"
+
+#include <iostream>
+#include <iomanip>
+
+using namespace xng;
+
+static void printResult(const std::string &name, const unsigned int threads, const size_t count, const double nanoseconds) {
+    std::cout << std::left << std::setw(40) << name
+            << std::right << std::setw(4) << threads
+            << std::setw(10) << count
+            << std::setw(14) << std::fixed << std::setprecision(2) << nanoseconds / static_cast<double>(count)
+            << " ns/op\n";
+}
+
+static void busyWait(const std::chrono::nanoseconds duration) {
+    const auto end = std::chrono::steady_clock::now() + duration;
+    while (std::chrono::steady_clock::now() < end);
+}
+
+template<typename F>
+static void benchmarkTasks(const std::string &name, const unsigned int threads, const size_t count, const F &work) {
+    ThreadPool pool(threads);
+    std::vector<std::shared_ptr<Task> > tasks;
+    tasks.reserve(count);
+    printResult(name, threads, count, measure([&]() {
+        for (size_t i = 0; i < count; i++) {
+            tasks.emplace_back(pool.addTask(work));
+        }
+        for (auto &task: tasks) {
+            task->join();
+        }
+    }));
+}
+
+static void benchmarkParallelFor(const unsigned int threads, const size_t count, const size_t grainSize) {
+    ThreadPool pool(threads);
+    std::vector<float> values(count, 1);
+    printResult("ThreadPool::parallelFor (grain " + std::to_string(grainSize) + ")",
+                threads,
+                count,
+                measure([&]() {
+                    pool.parallelFor(0, count, [&](size_t i) {
+                        values[i] = values[i] * 0.5f + 1.0f;
+                    }, grainSize);
+                }));
+}
+
+static void benchmarkPriorities(const unsigned int threads) {
+    ThreadPool pool(threads);
+    const size_t count = 1000;
+    std::vector<std::shared_ptr<Task> > tasks;
+
+    // Saturate the pool with background work before submitting the frame critical tasks.
+    for (size_t i = 0; i < count; i++) {
+        tasks.emplace_back(pool.addTask([]() { busyWait(std::chrono::microseconds(10)); }, ThreadPool::PRIORITY_LOW));
+    }
+    printResult("ThreadPool::addTask (high, busy)", threads, 1, measure([&]() {
+        pool.addTask([]() {}, ThreadPool::PRIORITY_HIGH)->join();
+    }));
+    for (auto &task: tasks) {
+        task->join();
+    }
+}
+
+static void benchmarkContinuations(const unsigned int threads) {
+    ThreadPool pool(threads);
+    const size_t count = 10000;
+    printResult("ThreadPool::then (chain)", threads, count, measure([&]() {
+        auto task = pool.addTask([]() {});
+        for (size_t i = 1; i < count; i++) {
+            task = pool.then(task, []() {});
+        }
+        task->join();
+    }));
+
+    std::vector<std::shared_ptr<Task> > tasks;
+    for (size_t i = 0; i < count; i++) {
+        tasks.emplace_back(pool.addTask([]() {}));
+    }
+    printResult("Task::whenAll", threads, count, measure([&]() {
+        Task::whenAll(tasks)->join();
+    }));
+}
+
+static void benchmarkNestedJoin(const unsigned int threads) {
+    // Every task waits on a child task, which deadlocks a pool whose workers block in join.
+    ThreadPool pool(threads);
+    const size_t count = 10000;
+    std::vector<std::shared_ptr<Task> > tasks;
+    tasks.reserve(count);
+    printResult("Task::join (nested)", threads, count, measure([&]() {
+        for (size_t i = 0; i < count; i++) {
+            tasks.emplace_back(pool.addTask([&pool]() {
+                pool.addTask([]() {})->join();
+            }));
+        }
+        for (auto &task: tasks) {
+            task->join();
+        }
+    }));
+}
+
+int main(int argc, char *argv[]) {
+    std::vector<unsigned int> threadCounts = {1, 2, 4};
+    if (std::thread::hardware_concurrency() > 4) {
+        threadCounts.emplace_back(std::thread::hardware_concurrency());
+    }
+
+    for (auto threads: threadCounts) {
+        benchmarkTasks("ThreadPool::addTask (empty)", threads, 100000, []() {});
+        benchmarkTasks("ThreadPool::addTask (1us)", threads, 100000, []() {
+            busyWait(std::chrono::microseconds(1));
+        });
+        benchmarkTasks("ThreadPool::addTask (1ms)", threads, 256, []() {
+            busyWait(std::chrono::milliseconds(1));
+        });
+        for (size_t grainSize: {0, 64, 4096}) {
+            benchmarkParallelFor(threads, 1000000, grainSize);
+        }
+        benchmarkPriorities(threads);
+        benchmarkContinuations(threads);
+        benchmarkNestedJoin(threads);
+        std::cout << "\n";
+    }
+    return 0;
+}
@@ -0,0 +1,290 @@
+/**
+ *   xEngine - C++ Game Engine Library
+ *   Copyright (C) 2026 Julia Zampiccoli
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU Lesser General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   Lesser General Public License for more details.
+ *
+ *   You should have received a copy of the Lesser General Public License
+ *   along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "xng/xng.hpp"
+
+#include "asyncruntime.hpp"
+#include "check.hpp"
+
+#include <iostream>
+#include <iomanip>
+
+using namespace xng;
+
+/**
+ * Streams meshes through a MeshStreamer on the async test runtime like RenderScene::commit.
+ */
+struct MeshScene {
+    AsyncRuntime runtime;
+    ChunkStreamer chunkStreamer;
+    MeshStreamer meshStreamer;
+    FrameLoop loop;
+
+    std::map<MeshStreamer::Handle, Mesh> meshes;
+
+    std::vector<std::chrono::nanoseconds> compactionTimes; // The compaction time of each commit which compacted
+
+    MeshScene()
+        : chunkStreamer(runtime.getHeap(), KB(64), 64),
+          meshStreamer(runtime.getHeap(), chunkStreamer),
+          loop(runtime, 2) {
+    }
+
+    void frame() {
+        RenderQueue queue;
+        meshStreamer.commit(queue);
+        const auto compactionTime = meshStreamer.getStatistics().compactionTime;
+        if (compactionTime.count() > 0) {
+            compactionTimes.emplace_back(compactionTime);
+        }
+        chunkStreamer.commit(queue);
+        loop.submit(queue);
+    }
+
+    void create(std::mt19937 &rng) {
+        std::uniform_int_distribution<size_t> vertexCount(64, 4096);
+        std::uniform_real_distribution<float> value(-100, 100);
+
+        Mesh mesh;
+        mesh.primitive = Mesh::TRIANGLES;
+        mesh.positions.resize(vertexCount(rng));
+        for (auto &position: mesh.positions) {
+            position = Vec3f(value(rng), value(rng), value(rng));
+        }
+        std::uniform_int_distribution<unsigned int> index(0, static_cast<unsigned int>(mesh.positions.size() - 1));
+        mesh.indices.resize(mesh.positions.size() * 3);
+        for (auto &i: mesh.indices) {
+            i = index(rng);
+        }
+        meshes.emplace(meshStreamer.create(mesh), std::move(mesh));
+    }
+
+    void destroy(const MeshStreamer::Handle handle) {
+        meshStreamer.destroy(handle);
+        meshes.erase(handle);
+    }
+
+    /**
+     * Run frames until all uploads are complete and check the buffer contents against the allocations.
+     */
+    void verify() {
+        for (int i = 0; i < 10000; i++) {
+            bool complete = true;
+            for (auto &pair: meshes) {
+                complete = complete && meshStreamer.isUploadComplete(pair.first);
+            }
+            if (complete)
+                break;
+            frame();
+        }
+        loop.synchronize();
+
+        const auto positions = runtime.getHeap().read(meshStreamer.getVertexBuffers().at(POSITION));
+        const auto indices = runtime.getHeap().read(meshStreamer.getIndexBuffer());
+        for (auto &pair: meshes) {
+            check(meshStreamer.isUploadComplete(pair.first), "upload complete");
+            const auto &alloc = meshStreamer.getAllocation(pair.first);
+            const auto &mesh = pair.second;
+
+            const auto positionSize = getVertexAttributeSize(POSITION);
+            const auto positionOffset = alloc.baseVertex * positionSize;
+            check(positionOffset + mesh.positions.size() * positionSize <= positions.size(), "position range");
+            for (size_t i = 0; i < mesh.positions.size(); i++) {
+                float position[3];
+                std::memcpy(position, positions.data() + positionOffset + i * positionSize, sizeof(position));
+                check(position[0] == mesh.positions[i].x
+                      && position[1] == mesh.positions[i].y
+                      && position[2] == mesh.positions[i].z,
+                      "positions of mesh " + std::to_string(pair.first));
+            }
+
+            check(alloc.drawCall.offset + mesh.indices.size() * sizeof(unsigned int) <= indices.size(), "index range");
+            check(std::memcmp(indices.data() + alloc.drawCall.offset,
+                              mesh.indices.data(),
+                              mesh.indices.size() * sizeof(unsigned int)) == 0,
+                  "indices of mesh " + std::to_string(pair.first));
+        }
+    }
+
+    size_t getBufferSize() const {
+        size_t ret = meshStreamer.getIndexBuffer().getDescription().size;
+        for (auto &pair: meshStreamer.getVertexBuffers()) {
+            ret += pair.second.getDescription().size;
+        }
+        return ret;
+    }
+};
+
+static void printRow(const std::string &name, const MeshScene &scene, const int frames) {
+    const auto statistics = scene.meshStreamer.getStatistics();
+    std::cout << std::left << std::setw(18) << name
+            << std::right << std::setw(8) << scene.meshes.size()
+            << std::setw(12) << scene.getBufferSize() / 1024 << " KiB"
+            << std::setw(12) << statistics.usedBytes / 1024 << " KiB"
+            << std::setw(10) << std::fixed << std::setprecision(1) << statistics.fragmentation * 100 << " %"
+            << std::setw(12) << statistics.relocatedBytes / 1024 << " KiB"
+            << std::setw(12) << statistics.reclaimedBytes / 1024 << " KiB"
+            << std::setw(8) << frames << "\n";
+}
+
+/**
+ * Run frames until the mesh streamer checked all allocations.
+ *
+ * @return The number of frames
+ */
+static int compact(MeshScene &scene) {
+    int frames = 0;
+    while (scene.meshStreamer.isCompactionPending()) {
+        check(frames < 10000, "compaction finishes");
+        scene.frame();
+        frames++;
+    }
+    return frames;
+}
+
+/**
+ * Destroy the slots at the end of a transform buffer and check that the buffer shrinks.
+ */
+static void testSlotBuffer(std::mt19937 &rng) {
+    AsyncRuntime runtime;
+    ChunkStreamer chunkStreamer(runtime.getHeap(), KB(64), 64);
+    BufferStreamer<Mat4f> transforms(runtime.getHeap(), chunkStreamer);
+    FrameLoop loop(runtime, 2);
+
+    const auto frame = [&]() {
+        RenderQueue queue;
+        transforms.commit(queue);
+        chunkStreamer.commit(queue);
+        loop.submit(queue);
+    };
+
+    std::vector<BufferStreamer<Mat4f>::Slot> slots;
+    for (int i = 0; i < 1024; i++) {
+        slots.emplace_back(transforms.create());
+        transforms.upload(slots.back(), MatrixMath::identity());
+        transforms.flush(slots.back());
+    }
+    for (int i = 0; i < 4; i++) {
+        frame();
+    }
+    loop.synchronize();
+    check(transforms.isUploadComplete(slots.back()), "slot upload complete");
+    const auto loadedSize = transforms.getStatistics().size;
+
+    std::shuffle(slots.begin() + 64, slots.end(), rng);
+    for (auto it = slots.begin() + 64; it != slots.end(); ++it) {
+        transforms.destroy(*it);
+    }
+    transforms.destroy(slots.at(10));
+    check(transforms.create() == slots.at(10), "the lowest free slot is reused");
+    frame();
+    loop.synchronize();
+
+    const auto statistics = transforms.getStatistics();
+    check(statistics.size == 64 * sizeof(Mat4f), "slot buffer is shrunk");
+    std::cout << "Slot buffer " << loadedSize / 1024 << " KiB -> " << statistics.size / 1024 << " KiB after destroying "
+            << slots.size() - 64 << " of " << slots.size() << " slots\n";
+}
+
+int main(int argc, char *argv[]) {
+    constexpr auto budget = std::chrono::microseconds(200);
+
+    std::mt19937 rng(9);
+    MeshScene scene;
+    scene.meshStreamer.setCompactionBudget(budget);
+
+    std::cout << std::left << std::setw(18) << "State"
+            << std::right << std::setw(8) << "Meshes"
+            << std::setw(16) << "Buffers"
+            << std::setw(16) << "Used"
+            << std::setw(12) << "Holes"
+            << std::setw(16) << "Relocated"
+            << std::setw(16) << "Reclaimed"
+            << std::setw(8) << "Frames" << "\n";
+
+    // Load a level
+    for (int i = 0; i < 400; i++) {
+        scene.create(rng);
+        if (i % 16 == 0)
+            scene.frame();
+    }
+    scene.verify();
+    printRow("Level loaded", scene, 0);
+    const auto loadedSize = scene.getBufferSize();
+
+    // Unload most of the level, the remaining meshes are scattered over the buffers.
+    std::vector<MeshStreamer::Handle> handles;
+    for (auto &pair: scene.meshes) {
+        handles.emplace_back(pair.first);
+    }
+    std::shuffle(handles.begin(), handles.end(), rng);
+    handles.resize(handles.size() * 3 / 4);
+    for (auto handle: handles) {
+        scene.destroy(handle);
+    }
+    printRow("Level unloaded", scene, 0);
+    const auto fragmentation = scene.meshStreamer.getStatistics().fragmentation;
+
+    const auto revision = scene.meshStreamer.getRevision();
+    auto frames = compact(scene);
+    scene.verify();
+    printRow("Compacted", scene, frames);
+
+    const auto statistics = scene.meshStreamer.getStatistics();
+    check(scene.meshStreamer.getRevision() > revision, "meshes were relocated");
+    check(statistics.fragmentation < fragmentation / 4, "fragmentation is reduced");
+    check(scene.getBufferSize() < loadedSize / 2, "buffers are shrunk");
+    check(statistics.reclaimedBytes > 0, "reclaimed bytes are reported");
+
+    // Load a smaller level into the compacted buffers
+    for (int i = 0; i < 100; i++) {
+        scene.create(rng);
+    }
+    scene.verify();
+    printRow("Level reloaded", scene, 0);
+
+    // Interleave destruction and creation with compaction
+    for (int i = 0; i < 200; i++) {
+        if (!scene.meshes.empty() && i % 2 == 0) {
+            auto it = scene.meshes.begin();
+            std::advance(it, std::uniform_int_distribution<size_t>(0, scene.meshes.size() - 1)(rng));
+            scene.destroy(it->first);
+        }
+        if (i % 3 == 0) {
+            scene.create(rng);
+        }
+        scene.frame();
+    }
+    frames = compact(scene);
+    scene.verify();
+    printRow("Churn compacted", scene, frames);
+
+    // The maximum includes preemption by the runtime worker thread on machines with few cores
+    auto &times = scene.compactionTimes;
+    std::sort(times.begin(), times.end());
+    const auto toMicroseconds = [](const std::chrono::nanoseconds time) {
+        return std::chrono::duration_cast<std::chrono::microseconds>(time).count();
+    };
+    std::cout << "\nCompaction time per frame over " << times.size() << " frames, budget " << budget.count() << " us: "
+            << "median " << toMicroseconds(times.at(times.size() / 2)) << " us, "
+            << "95th percentile " << toMicroseconds(times.at(times.size() * 95 / 100)) << " us, "
+            << "max " << toMicroseconds(times.back()) << " us\n";
+
+    testSlotBuffer(rng);
+    return 0;
+}
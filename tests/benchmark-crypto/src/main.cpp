@@ -0,0 +1,165 @@
+/**
+ *   xEngine - C++ Game Engine Library
+ *   Copyright (C) 2026 Julia Zampiccoli
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU Lesser General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   Lesser General Public License for more details.
+ *
+ *   You should have received a copy of the Lesser General Public License
+ *   along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include "xng/xng.hpp"
+
+#include "xng/adapters/cryptopp/cryptopp.hpp"
+
+#include "measure.hpp"
+
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <random>
+
+#ifdef _WIN32
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#endif
+
+using namespace xng;
+
+static const std::string INPUT_FILE = "benchmark-crypto.bin";
+static const std::string COMPRESSED_FILE = "benchmark-crypto.bin.gz";
+
+/**
+ * @return The peak resident set size of the process in bytes
+ */
+static size_t getPeakRss() {
+#ifdef _WIN32
+    PROCESS_MEMORY_COUNTERS counters{};
+    GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters));
+    return counters.PeakWorkingSetSize;
+#else
+    rusage usage{};
+    getrusage(RUSAGE_SELF, &usage);
+#ifdef __APPLE__
+    return static_cast<size_t>(usage.ru_maxrss);
+#else
+    return static_cast<size_t>(usage.ru_maxrss) * 1024;
+#endif
+#endif
+}
+
+static void printResult(const std::string &name, const size_t bytes, const double nanoseconds) {
+    std::cout << std::left << std::setw(40) << name
+            << std::right << std::setw(12) << std::fixed << std::setprecision(1)
+            << (static_cast<double>(bytes) / (1024.0 * 1024.0)) / (nanoseconds / 1000000000.0) << " MB/s"
+            << std::setw(12) << static_cast<double>(getPeakRss()) / (1024.0 * 1024.0) << " MB peak RSS\n";
+}
+
+static void generateInput(const size_t size) {
+    // Compressible data: random runs of a small alphabet
+    std::mt19937 rng(42);
+    std::ofstream fs(INPUT_FILE, std::ios::binary);
+    std::vector<char> buffer(1024 * 1024);
+    size_t written = 0;
+    while (written < size) {
+        for (auto &c: buffer) {
+            c = static_cast<char>('a' + rng() % 16);
+        }
+        auto count = std::min(buffer.size(), size - written);
+        fs.write(buffer.data(), static_cast<std::streamsize>(count));
+        written += count;
+    }
+}
+
+static void benchmarkStream(SHA &sha, GZip &gzip, const size_t size) {
+    std::string hash;
+    printResult("SHA::Hasher (stream)", size, measure([&]() {
+        std::ifstream input(INPUT_FILE, std::ios::binary);
+        SHAOutputStream stream(sha.createSha256());
+        stream << input.rdbuf();
+        hash = stream.finish();
+    }));
+
+    printResult("GZip::createCompressor (stream)", size, measure([&]() {
+        std::ifstream input(INPUT_FILE, std::ios::binary);
+        std::ofstream output(COMPRESSED_FILE, std::ios::binary);
+        GZipOutputStream stream(gzip.createCompressor(), output);
+        stream << input.rdbuf();
+        stream.finish();
+    }));
+
+    std::string decompressedHash;
+    printResult("GZip::createDecompressor + SHA (stream)", size, measure([&]() {
+        std::ifstream input(COMPRESSED_FILE, std::ios::binary);
+        GZipInputStream stream(gzip.createDecompressor(), input);
+        SHAOutputStream hashStream(sha.createSha256());
+        hashStream << stream.rdbuf();
+        decompressedHash = hashStream.finish();
+    }));
+
+    if (hash != decompressedHash)
+        throw std::runtime_error("Stream round trip hash mismatch");
+}
+
+static void benchmarkBuffer(SHA &sha, GZip &gzip, const size_t size) {
+    std::string hash;
+    printResult("SHA::sha256 (buffer)", size, measure([&]() {
+        hash = sha.sha256(readFile(INPUT_FILE));
+    }));
+
+    printResult("GZip::compress (buffer)", size, measure([&]() {
+        auto compressed = gzip.compress(readFile(INPUT_FILE));
+        std::ofstream output(COMPRESSED_FILE, std::ios::binary);
+        output.write(compressed.data(), static_cast<std::streamsize>(compressed.size()));
+    }));
+
+    std::string decompressedHash;
+    printResult("GZip::decompress + SHA (buffer)", size, measure([&]() {
+        decompressedHash = sha.sha256(gzip.decompress(readFile(COMPRESSED_FILE)));
+    }));
+
+    if (hash != decompressedHash)
+        throw std::runtime_error("Buffer round trip hash mismatch");
+}
+
+/**
+ * Usage: benchmark-crypto [all|stream|buffer] [size in MB]
+ *
+ * The peak RSS is a process wide maximum, when running all benchmarks the streaming benchmarks run first.
+ * Run the modes in separate processes to compare the peak RSS independently.
+ */
+int main(int argc, char *argv[]) {
+    std::string mode = argc > 1 ? argv[1] : "all";
+    size_t size = (argc > 2 ? std::stoul(argv[2]) : 256) * 1024 * 1024;
+
+    cryptopp::CryptoProvider provider;
+    auto sha = provider.createSHA();
+    auto gzip = provider.createGzip();
+
+    generateInput(size);
+
+    std::cout << "Input " << size / (1024 * 1024) << " MB, baseline "
+            << std::fixed << std::setprecision(1) << static_cast<double>(getPeakRss()) / (1024.0 * 1024.0)
+            << " MB peak RSS\n";
+
+    if (mode == "all" || mode == "stream")
+        benchmarkStream(*sha, *gzip, size);
+    if (mode == "all" || mode == "buffer")
+        benchmarkBuffer(*sha, *gzip, size);
+
+    std::filesystem::remove(INPUT_FILE);
+    std::filesystem::remove(COMPRESSED_FILE);
+
+    return 0;
+}
@@ -0,0 +1,241 @@
+/**
+ *   xEngine - C++ Game Engine Library
+ *   Copyright (C) 2026 Julia Zampiccoli
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU Lesser General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   Lesser General Public License for more details.
+ *
+ *   You should have received a copy of the Lesser General Public License
+ *   along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include "xng/xng.hpp"
+
+#include "check.hpp"
+#include "measure.hpp"
+
+#include <iostream>
+#include <iomanip>
+#include <random>
+#include <array>
+#include <algorithm>
+#include <limits>
+
+using namespace xng;
+
+struct Object {
+    Vec3f boundsMin;
+    Vec3f boundsMax;
+    Mat4f model;
+};
+
+/**
+ * Unit sized boxes with random rotation and scale scattered in a cube around the origin.
+ */
+static std::vector<Object> createObjects(size_t count, float worldSize) {
+    std::mt19937 rng(1);
+    std::uniform_real_distribution<float> position(-worldSize, worldSize);
+    std::uniform_real_distribution<float> angle(0, 360);
+    std::uniform_real_distribution<float> scale(0.5f, 2.0f);
+
+    std::vector<Object> ret;
+    ret.reserve(count);
+    for (size_t i = 0; i < count; i++) {
+        Transform transform(Vec3f(position(rng), position(rng), position(rng)),
+                            Vec3f(angle(rng), angle(rng), angle(rng)),
+                            Vec3f(scale(rng), scale(rng), scale(rng)));
+        ret.push_back({Vec3f(-0.5f, -0.5f, -0.5f), Vec3f(0.5f, 0.5f, 0.5f), transform.model()});
+    }
+    return ret;
+}
+
+/**
+ * @return True if all corners of the world space bounding box of the object are outside of the same clip plane.
+ */
+static bool isOutside(const Object &object, const Mat4f &viewProjection) {
+    Vec3f min(std::numeric_limits<float>::max());
+    Vec3f max(std::numeric_limits<float>::lowest());
+    for (int corner = 0; corner < 8; corner++) {
+        auto p = object.model * Vec4f(corner & 1 ? object.boundsMax.x : object.boundsMin.x,
+                                      corner & 2 ? object.boundsMax.y : object.boundsMin.y,
+                                      corner & 4 ? object.boundsMax.z : object.boundsMin.z,
+                                      1);
+        min = Vec3f(std::min(min.x, p.x), std::min(min.y, p.y), std::min(min.z, p.z));
+        max = Vec3f(std::max(max.x, p.x), std::max(max.y, p.y), std::max(max.z, p.z));
+    }
+
+    std::array<int, 6> outside{};
+    for (int corner = 0; corner < 8; corner++) {
+        Vec4f p(corner & 1 ? max.x : min.x,
+                corner & 2 ? max.y : min.y,
+                corner & 4 ? max.z : min.z,
+                1);
+        auto clip = viewProjection * p;
+        outside[0] += clip.x < -clip.w;
+        outside[1] += clip.x > clip.w;
+        outside[2] += clip.y < -clip.w;
+        outside[3] += clip.y > clip.w;
+        outside[4] += clip.z < -clip.w;
+        outside[5] += clip.z > clip.w;
+    }
+    return std::find(outside.begin(), outside.end(), 8) != outside.end();
+}
+
+/**
+ * @return True if any corner of the object is inside the clip volume.
+ */
+static bool isCornerInside(const Object &object, const Mat4f &viewProjection) {
+    const auto mvp = viewProjection * object.model;
+    for (int corner = 0; corner < 8; corner++) {
+        Vec4f p(corner & 1 ? object.boundsMax.x : object.boundsMin.x,
+                corner & 2 ? object.boundsMax.y : object.boundsMin.y,
+                corner & 4 ? object.boundsMax.z : object.boundsMin.z,
+                1);
+        auto clip = mvp * p;
+        if (std::abs(clip.x) <= clip.w && std::abs(clip.y) <= clip.w && std::abs(clip.z) <= clip.w)
+            return true;
+    }
+    return false;
+}
+
+static Camera createCamera(const Transform &transform) {
+    return Camera(transform, Camera::getPerspectiveProjection(60, 16.0f / 9.0f, 0.1f, 200));
+}
+
+static void testCulling() {
+    const auto objects = createObjects(20000, 100);
+    const auto camera = createCamera(Transform(Vec3f(3, -2, 5), Vec3f(10, 30, 0), Vec3f(1)));
+    const auto viewProjection = camera.getProjection() * camera.getView();
+
+    DrawCuller culler;
+    culler.setCamera(camera.getTransform().getPosition(), camera.getView(), camera.getProjection());
+    for (auto &object: objects) {
+        culler.add(object.boundsMin, object.boundsMax, object.model);
+    }
+
+    // Without a sort order or culling all draws are returned in order
+    std::vector<unsigned int> visible;
+    auto stats = culler.cull(visible);
+    check(stats.culled == 0 && visible.size() == objects.size(), "disabled culler returns all draws");
+    for (size_t i = 0; i < visible.size(); i++) {
+        check(visible[i] == i, "disabled culler keeps the order");
+    }
+
+    culler.setEnableCulling(true);
+    stats = culler.cull(visible);
+    check(stats.draws == objects.size() && stats.submitted + stats.culled == stats.draws, "statistics");
+    check(stats.culled > 0 && stats.submitted > 0, "some draws culled");
+
+    std::vector<bool> isVisible(objects.size(), false);
+    for (auto index: visible) {
+        isVisible.at(index) = true;
+    }
+    for (size_t i = 0; i < objects.size(); i++) {
+        if (isVisible[i]) {
+            check(!isOutside(objects[i], viewProjection), "visible bounding boxes are not outside");
+        } else {
+            check(!isCornerInside(objects[i], viewProjection), "culled draws are not inside");
+        }
+    }
+
+    auto distance = [&](unsigned int index) {
+        auto &m = objects.at(index).model;
+        return (Vec3f(m.get(3, 0), m.get(3, 1), m.get(3, 2)) - camera.getTransform().getPosition()).magnitude();
+    };
+    culler.setSortOrder(DrawCuller::SORT_FRONT_TO_BACK);
+    culler.cull(visible);
+    for (size_t i = 1; i < visible.size(); i++) {
+        check(distance(visible[i - 1]) <= distance(visible[i]) + 1e-3f, "front to back");
+    }
+    culler.setSortOrder(DrawCuller::SORT_BACK_TO_FRONT);
+    culler.cull(visible);
+    for (size_t i = 1; i < visible.size(); i++) {
+        check(distance(visible[i - 1]) + 1e-3f >= distance(visible[i]), "back to front");
+    }
+
+    // Unbounded draws are never culled, the box is beyond the far plane
+    culler.clear();
+    const auto far = MatrixMath::translate(camera.getTransform().getPosition() + Vec3f(1000, 0, 0));
+    culler.add(Vec3f(-0.5f), Vec3f(0.5f), far);
+    culler.addUnbounded(far);
+    stats = culler.cull(visible);
+    check(stats.culled == 1 && visible.size() == 1 && visible.at(0) == 1, "unbounded draw not culled");
+}
+
+static void benchmarkCulling(const std::vector<Object> &objects, const Camera &camera) {
+    DrawCuller culler;
+    culler.setCamera(camera.getTransform().getPosition(), camera.getView(), camera.getProjection());
+    std::vector<unsigned int> visible;
+
+    auto run = [&](bool cull, DrawCuller::SortOrder order, double &addTime, double &cullTime) {
+        culler.setEnableCulling(cull);
+        culler.setSortOrder(order);
+        const int iterations = 10;
+        addTime = 0;
+        cullTime = 0;
+        DrawCuller::Statistics stats;
+        for (int i = 0; i < iterations; i++) {
+            addTime += measureMilliseconds([&]() {
+                culler.clear();
+                culler.reserve(objects.size());
+                for (auto &object: objects) {
+                    culler.add(object.boundsMin, object.boundsMax, object.model);
+                }
+            });
+            cullTime += measureMilliseconds([&]() {
+                stats = culler.cull(visible);
+            });
+        }
+        addTime /= iterations;
+        cullTime /= iterations;
+        return stats;
+    };
+
+    const std::array<std::pair<std::string, std::pair<bool, DrawCuller::SortOrder> >, 4> configurations = {
+        {
+            {"Sort only", {false, DrawCuller::SORT_FRONT_TO_BACK}},
+            {"Cull", {true, DrawCuller::SORT_NONE}},
+            {"Cull + front to back", {true, DrawCuller::SORT_FRONT_TO_BACK}},
+            {"Cull + back to front", {true, DrawCuller::SORT_BACK_TO_FRONT}},
+        }
+    };
+    for (auto &configuration: configurations) {
+        double addTime, cullTime;
+        auto stats = run(configuration.second.first, configuration.second.second, addTime, cullTime);
+        std::cout << std::left << std::setw(10) << objects.size()
+                << std::setw(24) << configuration.first
+                << std::right << std::setw(10) << stats.submitted
+                << std::setw(10) << stats.culled
+                << std::setw(12) << std::fixed << std::setprecision(2) << addTime << " ms"
+                << std::setw(12) << cullTime << " ms"
+                << std::setw(12) << cullTime * 1e6 / static_cast<double>(objects.size()) << " ns\n";
+    }
+}
+
+int main(int argc, char *argv[]) {
+    testCulling();
+
+    // The camera is in the center of the objects so the frustum covers a fraction of them in any direction
+    const auto camera = createCamera(Transform(Vec3f(0), Vec3f(0), Vec3f(1)));
+
+    std::cout << "DrawCuller, average of 10 frames\n";
+    std::cout << std::left << std::setw(10) << "Draws"
+            << std::setw(24) << "Stage"
+            << std::right << std::setw(10) << "Visible"
+            << std::setw(10) << "Culled"
+            << std::setw(15) << "Bounds"
+            << std::setw(15) << "Cull + sort"
+            << std::setw(15) << "Per draw" << "\n";
+    for (size_t count: {100000, 250000, 1000000}) {
+        benchmarkCulling(createObjects(count, 100), camera);
+    }
+    return 0;
+}
@@ -0,0 +1,404 @@
+/**
+ *   xEngine - C++ Game Engine Library
+ *   Copyright (C) 2026 Julia Zampiccoli
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU Lesser General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   Lesser General Public License for more details.
+ *
+ *   You should have received a copy of the Lesser General Public License
+ *   along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "xng/xng.hpp"
+
+#include "measure.hpp"
+
+#include <iostream>
+#include <iomanip>
+#include <random>
+#include <algorithm>
+#include <fstream>
+
+using namespace xng;
+
+struct BenchmarkComponent final : Component {
+    COMPONENT_TYPENAME(BenchmarkComponent)
+
+    std::string getTypeName() const override { return typeName; }
+
+    float value = 0;
+};
+
+static void printResult(const std::string &name, const size_t count, const double nanoseconds) {
+    std::cout << std::left << std::setw(36) << name
+            << std::right << std::setw(10) << count
+            << std::setw(14) << std::fixed << std::setprecision(2) << nanoseconds / static_cast<double>(count)
+            << " ns/op\n";
+}
+
+static void benchmarkComponentPool(const size_t count) {
+    std::vector<EntityHandle> entities;
+    entities.reserve(count);
+    for (size_t i = 0; i < count; i++) {
+        entities.emplace_back(static_cast<int>(i));
+    }
+
+    std::vector<EntityHandle> shuffled = entities;
+    std::shuffle(shuffled.begin(), shuffled.end(), std::mt19937(count));
+
+    ComponentPool<BenchmarkComponent> pool;
+
+    printResult("ComponentPool::create", count, measure([&]() {
+        for (auto &entity: entities) {
+            pool.create(entity);
+        }
+    }));
+
+    float sum = 0;
+    printResult("ComponentPool::lookup", count, measure([&]() {
+        for (auto &entity: shuffled) {
+            sum += pool.lookup(entity).value;
+        }
+    }));
+
+    printResult("ComponentPool::iterate", count, measure([&]() {
+        for (auto &pair: pool) {
+            sum += pair.component.value;
+        }
+    }));
+
+    printResult("ComponentPool::destroy", count, measure([&]() {
+        for (auto &entity: shuffled) {
+            pool.destroy(entity);
+        }
+    }));
+
+    if (sum != 0 || pool.size() != 0) {
+        throw std::runtime_error("Invalid pool state");
+    }
+}
+
+static void benchmarkSceneLookup(const size_t count) {
+    EntityScene scene;
+    std::vector<EntityHandle> entities;
+    entities.reserve(count);
+    for (size_t i = 0; i < count; i++) {
+        auto entity = scene.create();
+        scene.createComponent(entity, BenchmarkComponent());
+        entities.emplace_back(entity);
+    }
+
+    size_t found = 0;
+    printResult("EntityScene::checkComponent", count, measure([&]() {
+        for (auto &entity: entities) {
+            found += scene.checkComponent<BenchmarkComponent>(entity);
+        }
+    }));
+
+    float sum = 0;
+    printResult("EntityScene::getComponent", count, measure([&]() {
+        for (auto &entity: entities) {
+            sum += scene.getComponent<BenchmarkComponent>(entity).value;
+        }
+    }));
+
+    if (found != count || sum != 0) {
+        throw std::runtime_error("Invalid scene state");
+    }
+}
+
+class BenchmarkListener final : public EntityScene::Listener {
+public:
+    size_t updates = 0;
+
+    void onComponentUpdate(const EntityHandle &entity,
+                           const Component &oldComponent,
+                           const Component &newComponent) override {
+        updates++;
+    }
+
+    bool requiresOldComponent(const std::string &typeName) override {
+        return false;
+    }
+};
+
+static void benchmarkListeners(const size_t count, const EntityScene::ListenerMode mode, const std::string &name) {
+    constexpr size_t updatesPerFrame = 4;
+
+    EntityScene scene;
+    BenchmarkListener listener;
+    scene.setListenerMode(mode);
+    scene.addListener(listener);
+
+    std::vector<EntityHandle> entities;
+    entities.reserve(count);
+    for (size_t i = 0; i < count; i++) {
+        auto entity = scene.create();
+        scene.createComponent(entity, BenchmarkComponent());
+        entities.emplace_back(entity);
+    }
+    scene.dispatchChanges();
+    listener.updates = 0;
+
+    BenchmarkComponent value;
+    printResult(name, count * updatesPerFrame, measure([&]() {
+        for (size_t i = 0; i < updatesPerFrame; i++) {
+            for (auto &entity: entities) {
+                value.value = static_cast<float>(i);
+                scene.updateComponent(entity, value);
+            }
+        }
+        scene.dispatchChanges();
+    }));
+
+    const auto expected = mode == EntityScene::LISTENER_DEFERRED ? count : count * updatesPerFrame;
+    if (listener.updates != expected) {
+        throw std::runtime_error("Invalid listener update count");
+    }
+}
+
+static constexpr const char *schedulerComponentNames[] = {
+        "SchedulerComponent0",
+        "SchedulerComponent1",
+        "SchedulerComponent2",
+        "SchedulerComponent3"
+};
+
+template<int N>
+struct SchedulerComponent final : Component {
+    static constexpr auto typeName = schedulerComponentNames[N];
+
+    std::string getTypeName() const override { return typeName; }
+};
+
+class SchedulerSystem : public System {
+public:
+    SchedulerSystem(std::string name, ComponentAccess access, const std::chrono::microseconds workDuration)
+            : name(std::move(name)), access(std::move(access)), workDuration(workDuration) {}
+
+    void update(DeltaTime deltaTime, EntityScene &scene, EventBus &eventBus) override {
+        const auto end = std::chrono::steady_clock::now() + workDuration;
+        while (std::chrono::steady_clock::now() < end);
+    }
+
+    std::string getName() override { return name; }
+
+    ComponentAccess getComponentAccess() override { return access; }
+
+private:
+    std::string name;
+    ComponentAccess access;
+    std::chrono::microseconds workDuration;
+};
+
+static void benchmarkScheduler(const bool runAsync, const std::string &name) {
+    const auto work = std::chrono::microseconds(500);
+    const size_t frames = 100;
+
+    // Two independent chains of systems, the longest chain is WriteA -> ReadAWriteD -> ReadD.
+    SystemPipeline pipeline({
+                                    std::make_shared<SchedulerSystem>(
+                                            "WriteA", ComponentAccess().write<SchedulerComponent<0> >(), work),
+                                    std::make_shared<SchedulerSystem>(
+                                            "WriteB", ComponentAccess().write<SchedulerComponent<1> >(), work),
+                                    std::make_shared<SchedulerSystem>(
+                                            "WriteC", ComponentAccess().write<SchedulerComponent<2> >(), work),
+                                    std::make_shared<SchedulerSystem>(
+                                            "ReadAWriteD", ComponentAccess().read<SchedulerComponent<0> >()
+                                                    .write<SchedulerComponent<3> >(), work),
+                                    std::make_shared<SchedulerSystem>(
+                                            "ReadBC", ComponentAccess().read<SchedulerComponent<1> >()
+                                                    .read<SchedulerComponent<2> >(), work),
+                                    std::make_shared<SchedulerSystem>(
+                                            "ReadD", ComponentAccess().read<SchedulerComponent<3> >(), work),
+                            },
+                            runAsync,
+                            name);
+
+    EntityScene scene;
+    EventBus eventBus;
+    ECSProfiler profiler;
+
+    printResult(name, frames, measure([&]() {
+        for (size_t i = 0; i < frames; i++) {
+            profiler.beginFrame();
+            profiler.beginPipelineUpdate();
+            pipeline.update(DeltaTime(), scene, eventBus, profiler, true);
+            profiler.endPipelineUpdate(name);
+            profiler.endFrame();
+        }
+    }));
+
+    const auto &frame = profiler.getFrames().frames.at(0);
+    if (!frame.criticalPath.empty()) {
+        std::cout << "Critical path:";
+        for (auto &system: frame.criticalPath) {
+            std::cout << " " << system;
+        }
+        std::cout << "\n";
+    }
+
+    for (auto &pair: profiler.getSystemStatistics()) {
+        std::cout << "  " << std::left << std::setw(30) << pair.first
+                << " min " << pair.second.min
+                << " avg " << pair.second.average
+                << " p99 " << pair.second.p99
+                << " max " << pair.second.max << " ns\n";
+    }
+
+    std::ofstream trace("benchmark-ecs-" + std::string(runAsync ? "async" : "serial") + ".trace.json");
+    profiler.exportChromeTrace(trace);
+}
+
+/**
+ * Create a forest of trees with nodesPerTree nodes where each node is attached to a random earlier node of its tree.
+ */
+static std::vector<EntityHandle> createTransformForest(EntityScene &scene,
+                                                       const size_t count,
+                                                       const size_t nodesPerTree,
+                                                       const bool parentByName) {
+    std::mt19937 random(count);
+    std::vector<EntityHandle> entities;
+    entities.reserve(count);
+    for (size_t i = 0; i < count; i++) {
+        const auto treeStart = i - i % nodesPerTree;
+        TransformComponent component;
+        component.transform.setPosition(Vec3f(1, 0, 0));
+        if (i != treeStart) {
+            const auto parent = entities.at(treeStart + random() % (i - treeStart));
+            if (parentByName) {
+                component.parent = scene.getEntityName(parent);
+            } else {
+                component.parentEntity = parent;
+            }
+        }
+        auto entity = parentByName ? scene.create("Node" + std::to_string(i)) : scene.create();
+        scene.createComponent(entity, component);
+        entities.emplace_back(entity);
+    }
+    return entities;
+}
+
+static void benchmarkTransforms(const size_t count) {
+    const size_t nodesPerTree = 100;
+    float sum = 0;
+
+    {
+        EntityScene scene;
+        auto entities = createTransformForest(scene, count, nodesPerTree, true);
+        printResult("getAbsoluteTransform (name)", count, measure([&]() {
+            for (auto &entity: entities) {
+                auto &component = scene.getComponent<TransformComponent>(entity);
+                sum += TransformComponent::getAbsoluteTransform(component, scene).getPosition().x;
+            }
+        }));
+    }
+
+    EntityScene scene;
+    auto entities = createTransformForest(scene, count, nodesPerTree, false);
+    printResult("getAbsoluteTransform (handle)", count, measure([&]() {
+        for (auto &entity: entities) {
+            auto &component = scene.getComponent<TransformComponent>(entity);
+            sum += TransformComponent::getAbsoluteTransform(component, scene).getPosition().x;
+        }
+    }));
+
+    TransformHierarchy hierarchy(scene);
+    printResult("TransformHierarchy::rebuild", count, measure([&]() {
+        hierarchy.update();
+    }));
+
+    printResult("TransformHierarchy::get", count, measure([&]() {
+        for (auto &entity: entities) {
+            sum += hierarchy.getWorldPosition(entity).x;
+        }
+    }));
+
+    printResult("TransformHierarchy::update (none)", count, measure([&]() {
+        hierarchy.update();
+    }));
+
+    // Move every 100th tree, the update cost is proportional to the size of the moved subtrees
+    for (size_t i = 0; i < count; i += nodesPerTree * 100) {
+        auto component = scene.getComponent<TransformComponent>(entities.at(i));
+        component.transform.setPosition(Vec3f(2, 0, 0));
+        scene.updateComponent(entities.at(i), component);
+    }
+    printResult("TransformHierarchy::update (1/100)", count, measure([&]() {
+        hierarchy.update();
+    }));
+
+    for (auto parallel: {false, true}) {
+        for (size_t i = 0; i < count; i += nodesPerTree) {
+            auto component = scene.getComponent<TransformComponent>(entities.at(i));
+            component.transform.setPosition(Vec3f(parallel ? 3 : 4, 0, 0));
+            scene.updateComponent(entities.at(i), component);
+        }
+        printResult(parallel ? "TransformHierarchy::update (par)" : "TransformHierarchy::update (all)",
+                    count,
+                    measure([&]() {
+                        hierarchy.update(parallel);
+                    }));
+    }
+
+    // Verify the cached transforms against the uncached resolution
+    for (auto &entity: entities) {
+        auto &component = scene.getComponent<TransformComponent>(entity);
+        if (TransformComponent::getAbsoluteTransform(component, scene) != hierarchy.getWorldTransform(entity)) {
+            throw std::runtime_error("Invalid cached transform");
+        }
+    }
+
+    // Parents without a TransformComponent are treated as no parent by both resolutions
+    for (auto byName: {false, true}) {
+        auto parent = byName ? scene.create("Parent" + std::to_string(count)) : scene.create();
+        TransformComponent component;
+        component.transform.setPosition(Vec3f(5, 0, 0));
+        if (byName) {
+            component.parent = scene.getEntityName(parent);
+        } else {
+            component.parentEntity = parent;
+        }
+        auto entity = scene.create();
+        scene.createComponent(entity, component);
+        hierarchy.update();
+        if (TransformComponent::getAbsoluteTransform(component, scene) != hierarchy.getWorldTransform(entity)
+            || hierarchy.getWorldTransform(entity) != component.transform) {
+            throw std::runtime_error("Invalid transform of entity with parent without TransformComponent");
+        }
+    }
+
+    if (sum <= 0) {
+        throw std::runtime_error("Invalid transform sum");
+    }
+}
+
+int main(int argc, char *argv[]) {
+    for (size_t count = 1000; count <= 1000000; count *= 10) {
+        benchmarkComponentPool(count);
+        std::cout << "\n";
+    }
+    for (size_t count = 1000; count <= 1000000; count *= 10) {
+        benchmarkSceneLookup(count);
+        std::cout << "\n";
+    }
+    for (size_t count = 1000; count <= 1000000; count *= 10) {
+        benchmarkListeners(count, EntityScene::LISTENER_IMMEDIATE, "EntityScene::update (immediate)");
+        benchmarkListeners(count, EntityScene::LISTENER_DEFERRED, "EntityScene::update (deferred)");
+        std::cout << "\n";
+    }
+    for (size_t count = 1000; count <= 100000; count *= 10) {
+        benchmarkTransforms(count);
+        std::cout << "\n";
+    }
+    benchmarkScheduler(false, "SystemPipeline::update (serial)");
+    benchmarkScheduler(true, "SystemPipeline::update (async)");
+    return 0;
+}
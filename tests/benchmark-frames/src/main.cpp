@@ -0,0 +1,175 @@
+/**
+ *   xEngine - C++ Game Engine Library
+ *   Copyright (C) 2026 Julia Zampiccoli
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU Lesser General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   Lesser General Public License for more details.
+ *
+ *   You should have received a copy of the Lesser General Public License
+ *   along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "xng/xng.hpp"
+
+#include "asyncruntime.hpp"
+#include "check.hpp"
+
+#include <iostream>
+#include <iomanip>
+
+using namespace xng;
+
+/**
+ * Streams random data into regions of a stream buffer while frames are in flight.
+ *
+ * Uploads are released before they finish, flushed, and span multiple chunks.
+ * The runtime fails if staging memory read by an in flight execution is written,
+ * and the stream buffer must end up containing the last upload of every region.
+ */
+static void testStreaming(const size_t framesInFlight) {
+    constexpr size_t chunkSize = KB(4);
+    constexpr size_t regionSize = KB(10);
+    constexpr size_t regionCount = 12;
+
+    AsyncRuntime runtime(std::chrono::microseconds(300));
+    auto &heap = runtime.getHeap();
+
+    ChunkStreamer chunkStreamer(heap, chunkSize, 16);
+    StreamBuffer buffer(heap, chunkStreamer, rg::Buffer::CAPABILITY_STORAGE);
+
+    std::mt19937 rng(static_cast<unsigned int>(framesInFlight));
+    std::uniform_int_distribution<int> byte(0, 255);
+    std::uniform_int_distribution<int> chance(0, 99);
+
+    std::vector<std::vector<uint8_t> > expected(regionCount);
+    std::vector<StreamBuffer::Handle> handles(regionCount, StreamBuffer::INVALID_HANDLE);
+
+    FrameLoop loop(runtime, framesInFlight);
+
+    for (int frame = 0; frame < 200; frame++) {
+        RenderQueue queue;
+        for (size_t region = 0; region < regionCount; region++) {
+            if (chance(rng) >= 20) {
+                continue;
+            }
+            if (handles.at(region) != StreamBuffer::INVALID_HANDLE) {
+                buffer.release(handles.at(region));
+            }
+            auto &data = expected.at(region);
+            data.resize(regionSize);
+            for (auto &b: data) {
+                b = static_cast<uint8_t>(byte(rng));
+            }
+            handles.at(region) = buffer.upload(data.data(), data.size(), region * regionSize);
+            if (chance(rng) < 25) {
+                buffer.flush(handles.at(region));
+            }
+        }
+        buffer.commit(queue);
+        chunkStreamer.commit(queue);
+        loop.submit(queue);
+    }
+
+    // Drain the streamer, every commit stages at most the frame budget.
+    for (int frame = 0; frame < 1000 && chunkStreamer.getPendingBytes() > 0; frame++) {
+        RenderQueue queue;
+        buffer.commit(queue);
+        chunkStreamer.commit(queue);
+        loop.submit(queue);
+    }
+    check(chunkStreamer.getPendingBytes() == 0, "all uploads were staged");
+
+    // The transfers of the last chunks finish, the following commit copies them to the stream buffer.
+    for (int i = 0; i < 2; i++) {
+        loop.synchronize();
+        RenderQueue queue;
+        buffer.commit(queue);
+        chunkStreamer.commit(queue);
+        loop.submit(queue);
+    }
+    loop.synchronize();
+
+    const auto contents = heap.read(buffer.getBuffer());
+    for (size_t region = 0; region < regionCount; region++) {
+        if (expected.at(region).empty())
+            continue;
+        check(buffer.isUploadComplete(handles.at(region)), "upload complete");
+        check(contents.size() >= (region + 1) * regionSize, "stream buffer size");
+        check(std::memcmp(contents.data() + region * regionSize, expected.at(region).data(), regionSize) == 0,
+              "stream buffer contains the last upload of region " + std::to_string(region));
+    }
+
+    // All frames have finished so the next commit frees the whole staging ring.
+    RenderQueue queue;
+    chunkStreamer.commit(queue);
+    check(chunkStreamer.getStagingUsage() == 0, "staging ranges are recycled");
+    loop.submit(queue);
+    loop.synchronize();
+}
+
+/**
+ * Simulates a frame that needs cpuTime to record and gpuTime to execute.
+ *
+ * @return The average frame time in milliseconds.
+ */
+static double benchmarkFrames(const size_t framesInFlight,
+                              const std::chrono::microseconds cpuTime,
+                              const std::chrono::microseconds gpuTime) {
+    AsyncRuntime runtime;
+    runtime.setExecutionTime(gpuTime);
+    auto &heap = runtime.getHeap();
+
+    ChunkStreamer chunkStreamer(heap, KB(64), 16);
+    StreamBuffer buffer(heap, chunkStreamer, rg::Buffer::CAPABILITY_STORAGE);
+    std::vector<uint8_t> data(KB(16));
+    StreamBuffer::Handle handle = StreamBuffer::INVALID_HANDLE;
+
+    FrameLoop loop(runtime, framesInFlight);
+
+    constexpr int frames = 100;
+    const auto start = std::chrono::steady_clock::now();
+    for (int frame = 0; frame < frames; frame++) {
+        const auto recordStart = std::chrono::steady_clock::now();
+        RenderQueue queue;
+        if (handle != StreamBuffer::INVALID_HANDLE) {
+            buffer.release(handle);
+        }
+        std::fill(data.begin(), data.end(), static_cast<uint8_t>(frame));
+        handle = buffer.upload(data.data(), data.size(), 0);
+        buffer.flush(handle);
+        buffer.commit(queue);
+        chunkStreamer.commit(queue);
+        while (std::chrono::steady_clock::now() - recordStart < cpuTime) {
+            std::this_thread::yield();
+        }
+        loop.submit(queue);
+    }
+    loop.synchronize();
+    const auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::milli>(end - start).count() / frames;
+}
+
+int main(int argc, char *argv[]) {
+    for (size_t framesInFlight: {1, 2, 3}) {
+        testStreaming(framesInFlight);
+    }
+
+    const auto cpuTime = std::chrono::microseconds(2000);
+    const auto gpuTime = std::chrono::microseconds(2000);
+    std::cout << "Frame time with " << cpuTime.count() / 1000.0 << " ms cpu and "
+            << gpuTime.count() / 1000.0 << " ms gpu work per frame\n";
+    std::cout << std::left << std::setw(18) << "Frames in flight" << std::right << std::setw(14) << "Frame time\n";
+    for (size_t framesInFlight: {1, 2, 3}) {
+        std::cout << std::left << std::setw(18) << framesInFlight
+                << std::right << std::setw(10) << std::fixed << std::setprecision(3)
+                << benchmarkFrames(framesInFlight, cpuTime, gpuTime) << " ms\n";
+    }
+    return 0;
+}
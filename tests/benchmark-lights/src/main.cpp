@@ -0,0 +1,188 @@
+/**
+ *   xEngine - C++ Game Engine Library
+ *   Copyright (C) 2026 Julia Zampiccoli
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU Lesser General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   Lesser General Public License for more details.
+ *
+ *   You should have received a copy of the Lesser General Public License
+ *   along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include "xng/xng.hpp"
+
+#include "check.hpp"
+#include "measure.hpp"
+
+#include <iostream>
+#include <iomanip>
+#include <random>
+#include <cstring>
+
+using namespace xng;
+
+/**
+ * Stands in for the gpu buffer, the dirty ranges are copied like the streamer uploads would.
+ *
+ * @return The number of uploaded bytes
+ */
+template<typename T>
+static size_t upload(SlotArray<T> &slots, std::vector<uint8_t> &buffer, size_t *rangeCount = nullptr) {
+    size_t ret = 0;
+    buffer.resize(std::max(buffer.size(), slots.size() * sizeof(T)));
+    const auto ranges = slots.getDirtyRanges();
+    for (auto &range: ranges) {
+        std::memcpy(buffer.data() + range.offset, slots.data() + range.offset, range.size);
+        ret += range.size;
+    }
+    if (rangeCount != nullptr)
+        *rangeCount += ranges.size();
+    slots.clearDirty();
+    return ret;
+}
+
+static ShaderPointLight::CPU createLight(const Vec3f &position, float power) {
+    RenderPointLight light([]() {
+    });
+    light.set(position, ColorRGB(255, 255, 255), power, false, 0.1f, 100);
+    return light.getData();
+}
+
+static void testSlotArray() {
+    SlotArray<ShaderPointLight::CPU> slots;
+    auto a = slots.create(createLight(Vec3f(1, 0, 0), 1));
+    auto b = slots.create(createLight(Vec3f(2, 0, 0), 1));
+    auto c = slots.create(createLight(Vec3f(3, 0, 0), 1));
+    check(a == 0 && b == 1 && c == 2, "slots are assigned in order");
+
+    auto ranges = slots.getDirtyRanges();
+    check(ranges.size() == 1 && ranges.at(0).offset == 0 && ranges.at(0).size == 3 * sizeof(ShaderPointLight::CPU),
+          "adjacent dirty slots are merged");
+    slots.clearDirty();
+    check(!slots.isDirty() && slots.getDirtyRanges().empty(), "clearDirty");
+
+    slots.set(c, createLight(Vec3f(4, 0, 0), 1));
+    slots.set(a, createLight(Vec3f(5, 0, 0), 1));
+    slots.set(c, createLight(Vec3f(6, 0, 0), 1));
+    ranges = slots.getDirtyRanges();
+    check(ranges.size() == 2
+          && ranges.at(0).offset == 0
+          && ranges.at(1).offset == 2 * sizeof(ShaderPointLight::CPU)
+          && ranges.at(1).size == sizeof(ShaderPointLight::CPU),
+          "separate dirty slots are sorted and uploaded once");
+    slots.clearDirty();
+
+    slots.destroy(b);
+    check(slots.get(b).color == Vec4f(0, 0, 0, 0), "destroyed slots are zeroed lights");
+    check(slots.getActiveCount() == 2 && slots.size() == 3, "destroyed slot count");
+    ranges = slots.getDirtyRanges();
+    check(ranges.size() == 1 && ranges.at(0).offset == sizeof(ShaderPointLight::CPU), "destroyed slot is uploaded");
+    slots.clearDirty();
+
+    check(slots.create(createLight(Vec3f(7, 0, 0), 1)) == b, "destroyed slots are reused");
+    check(slots.size() == 3, "reuse does not grow the array");
+}
+
+/**
+ * Random light changes, creations and destructions, the uploaded buffer must match the slots every frame.
+ */
+static void testRandomUpdates() {
+    std::mt19937 rng(2);
+    std::uniform_real_distribution<float> position(-50, 50);
+    SlotArray<ShaderPointLight::CPU> slots;
+    std::vector<SlotArray<ShaderPointLight::CPU>::Slot> active;
+    std::vector<uint8_t> buffer;
+    for (int frame = 0; frame < 200; frame++) {
+        auto operations = std::uniform_int_distribution<int>(0, 20)(rng);
+        for (int i = 0; i < operations; i++) {
+            auto operation = std::uniform_int_distribution<int>(0, 2)(rng);
+            if (operation == 0 || active.empty()) {
+                active.emplace_back(slots.create(createLight(Vec3f(position(rng), 0, 0), 1)));
+            } else {
+                auto index = std::uniform_int_distribution<size_t>(0, active.size() - 1)(rng);
+                if (operation == 1) {
+                    slots.set(active.at(index), createLight(Vec3f(position(rng), 1, 0), 2));
+                } else {
+                    slots.destroy(active.at(index));
+                    active.erase(active.begin() + static_cast<long>(index));
+                }
+            }
+        }
+        upload(slots, buffer);
+        check(std::memcmp(buffer.data(), slots.data(), slots.size() * sizeof(ShaderPointLight::CPU)) == 0,
+              "uploaded buffer matches the slots");
+        check(slots.getActiveCount() == active.size(), "active count");
+    }
+}
+
+static void benchmarkUpdates(size_t lightCount, double changedFraction) {
+    std::mt19937 rng(3);
+    std::uniform_real_distribution<float> position(-50, 50);
+
+    SlotArray<ShaderPointLight::CPU> slots;
+    std::vector<uint8_t> buffer;
+    for (size_t i = 0; i < lightCount; i++) {
+        slots.create(createLight(Vec3f(position(rng), position(rng), position(rng)), 1));
+    }
+    upload(slots, buffer);
+
+    const auto changed = static_cast<size_t>(static_cast<double>(lightCount) * changedFraction);
+    std::vector<ShaderPointLight::CPU> lights;
+    for (size_t i = 0; i < changed; i++) {
+        lights.emplace_back(createLight(Vec3f(position(rng), position(rng), position(rng)), 2));
+    }
+    std::uniform_int_distribution<unsigned int> slot(0, static_cast<unsigned int>(lightCount - 1));
+
+    const int frames = 20;
+    size_t bytes = 0;
+    size_t ranges = 0;
+    double milliseconds = 0;
+    for (int frame = 0; frame < frames; frame++) {
+        for (auto &light: lights) {
+            slots.set(slot(rng), light);
+        }
+        milliseconds += measureMilliseconds([&]() {
+            bytes += upload(slots, buffer, &ranges);
+        });
+    }
+
+    // The previous implementation uploaded all lights whenever any light changed
+    const auto fullBytes = lightCount * sizeof(ShaderPointLight::CPU);
+    const auto frameBytes = bytes / frames;
+    std::cout << std::left << std::setw(10) << lightCount
+            << std::right << std::setw(9) << std::fixed << std::setprecision(1) << changedFraction * 100 << "%"
+            << std::setw(15) << fullBytes / 1024 << " KiB"
+            << std::setw(15) << frameBytes / 1024 << " KiB"
+            << std::setw(10) << ranges / frames
+            << std::setw(11) << std::setprecision(1)
+            << static_cast<double>(fullBytes) / static_cast<double>(std::max<size_t>(frameBytes, 1)) << "x"
+            << std::setw(11) << std::setprecision(3) << milliseconds / frames << " ms\n";
+}
+
+int main(int argc, char *argv[]) {
+    testSlotArray();
+    testRandomUpdates();
+
+    std::cout << "Point light buffer uploads per frame (" << sizeof(ShaderPointLight::CPU) << " bytes per light)\n";
+    std::cout << std::left << std::setw(10) << "Lights"
+            << std::right << std::setw(10) << "Changed"
+            << std::setw(19) << "Full upload"
+            << std::setw(19) << "Incremental"
+            << std::setw(10) << "Ranges"
+            << std::setw(12) << "Reduction"
+            << std::setw(14) << "Commit" << "\n";
+    for (size_t count: {1000, 10000, 100000}) {
+        for (double fraction: {0.001, 0.01, 0.1}) {
+            benchmarkUpdates(count, fraction);
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,588 @@
+/**
+ *   xEngine - C++ Game Engine Library
+ *   Copyright (C) 2026 Julia Zampiccoli
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU Lesser General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   Lesser General Public License for more details.
+ *
+ *   You should have received a copy of the Lesser General Public License
+ *   along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include "xng/xng.hpp"
+
+#include "check.hpp"
+#include "measure.hpp"
+
+#include <iostream>
+#include <iomanip>
+#include <map>
+#include <random>
+#include <tuple>
+#include <array>
+#include <algorithm>
+#include <limits>
+#include <numeric>
+
+using namespace xng;
+
+/**
+ * The previous implementation of Mesh::computeSmoothNormals which deduplicates positions with a std::map.
+ */
+static Mesh legacyComputeSmoothNormals(const Mesh &mesh) {
+    const auto vertexCount = mesh.positions.size();
+
+    std::map<std::tuple<float, float, float>, std::vector<unsigned int> > positionToVertices;
+    for (unsigned int i = 0; i < vertexCount; i++) {
+        const auto &p = mesh.positions.at(i);
+        positionToVertices[{p.x, p.y, p.z}].push_back(i);
+    }
+
+    std::vector<Vec3f> smoothNormals(vertexCount, Vec3f(0, 0, 0));
+    std::vector<Vec3f> tangents(vertexCount, Vec3f(0, 0, 0));
+
+    auto accumulate = [&](unsigned int i0, unsigned int i1, unsigned int i2) {
+        const Vec3f &p0 = mesh.positions.at(i0);
+        const Vec3f &p1 = mesh.positions.at(i1);
+        const Vec3f &p2 = mesh.positions.at(i2);
+        Vec3f faceNormal = (p2 - p0).cross(p1 - p0);
+
+        for (auto idx: {i0, i1, i2}) {
+            const auto &p = mesh.positions.at(idx);
+            for (auto sharedIdx: positionToVertices.at({p.x, p.y, p.z})) {
+                smoothNormals[sharedIdx] += faceNormal;
+            }
+        }
+    };
+
+    // The tangent pass of the previous implementation built a second map and accumulated the same way
+    std::map<std::tuple<float, float, float>, std::vector<unsigned int> > tangentVertices;
+    for (unsigned int i = 0; i < vertexCount; i++) {
+        const auto &p = mesh.positions.at(i);
+        tangentVertices[{p.x, p.y, p.z}].push_back(i);
+    }
+    auto accumulateTangent = [&](unsigned int i0, unsigned int i1, unsigned int i2) {
+        Vec3f t = mesh.positions.at(i1) - mesh.positions.at(i0);
+        for (auto idx: {i0, i1, i2}) {
+            const auto &p = mesh.positions.at(idx);
+            for (auto sharedIdx: tangentVertices.at({p.x, p.y, p.z})) {
+                tangents[sharedIdx] += t;
+            }
+        }
+    };
+
+    if (!mesh.indices.empty()) {
+        for (size_t i = 0; i < mesh.indices.size(); i += 3) {
+            accumulate(mesh.indices.at(i), mesh.indices.at(i + 1), mesh.indices.at(i + 2));
+            accumulateTangent(mesh.indices.at(i), mesh.indices.at(i + 1), mesh.indices.at(i + 2));
+        }
+    } else {
+        for (unsigned int i = 0; i < vertexCount; i += 3) {
+            accumulate(i, i + 1, i + 2);
+            accumulateTangent(i, i + 1, i + 2);
+        }
+    }
+
+    for (auto &n: smoothNormals) {
+        float len = n.length();
+        if (len > 1e-6f)
+            n /= len;
+        else
+            n = Vec3f(0, 0, 1);
+    }
+
+    Mesh result = mesh;
+    result.normals = std::move(smoothNormals);
+    result.tangents = std::move(tangents);
+    return result;
+}
+
+/**
+ * A noisy height field resembling a surface scan, stored as an unindexed triangle soup like scanned meshes are commonly exported.
+ */
+static Mesh createScan(size_t resolution, bool indexed) {
+    std::mt19937 rng(1);
+    // Noise of a tenth of the sample spacing
+    auto amplitude = 0.1f / static_cast<float>(resolution);
+    std::uniform_real_distribution<float> noise(-amplitude, amplitude);
+
+    std::vector<Vec3f> grid;
+    grid.reserve((resolution + 1) * (resolution + 1));
+    for (size_t y = 0; y <= resolution; y++) {
+        for (size_t x = 0; x <= resolution; x++) {
+            auto u = static_cast<float>(x) / static_cast<float>(resolution);
+            auto v = static_cast<float>(y) / static_cast<float>(resolution);
+            grid.emplace_back(u, std::sin(u * 12.0f) * std::cos(v * 9.0f) * 0.1f + noise(rng), v);
+        }
+    }
+
+    Mesh ret;
+    ret.primitive = Mesh::TRIANGLES;
+    auto addVertex = [&](size_t x, size_t y) {
+        auto index = y * (resolution + 1) + x;
+        if (indexed) {
+            ret.indices.emplace_back(static_cast<unsigned int>(index));
+        } else {
+            ret.positions.emplace_back(grid.at(index));
+            ret.uvs.emplace_back(grid.at(index).x, grid.at(index).z);
+        }
+    };
+    if (indexed) {
+        ret.positions = grid;
+        for (auto &p: grid) {
+            ret.uvs.emplace_back(p.x, p.z);
+        }
+    }
+    for (size_t y = 0; y < resolution; y++) {
+        for (size_t x = 0; x < resolution; x++) {
+            addVertex(x, y);
+            addVertex(x + 1, y);
+            addVertex(x + 1, y + 1);
+            addVertex(x, y);
+            addVertex(x + 1, y + 1);
+            addVertex(x, y + 1);
+        }
+    }
+    return ret;
+}
+
+static float maxAngleDegrees(const std::vector<Vec3f> &a, const std::vector<Vec3f> &b) {
+    float minDot = 1;
+    for (size_t i = 0; i < a.size(); i++) {
+        minDot = std::min(minDot, a.at(i).dot(b.at(i)));
+    }
+    return std::acos(std::clamp(minDot, -1.0f, 1.0f)) * 180.0f / PI;
+}
+
+static void benchmarkSmoothNormals(size_t resolution, bool indexed) {
+    auto mesh = createScan(resolution, indexed);
+
+    Mesh legacy;
+    Mesh welded;
+    auto legacyTime = measureMilliseconds([&]() { legacy = legacyComputeSmoothNormals(mesh); });
+    auto weldedTime = measureMilliseconds([&]() { welded = Mesh::computeSmoothNormals(mesh); });
+
+    check(welded.normals.size() == mesh.positions.size(), "normal count");
+    check(welded.tangents.size() == mesh.positions.size(), "tangent count");
+
+    std::cout << std::left << std::setw(10) << (indexed ? "Indexed" : "Soup")
+            << std::right << std::setw(12) << mesh.positions.size()
+            << std::setw(14) << std::fixed << std::setprecision(1) << legacyTime << " ms"
+            << std::setw(14) << weldedTime << " ms"
+            << std::setw(10) << std::setprecision(1) << legacyTime / weldedTime << "x"
+            << std::setw(12) << std::setprecision(2) << maxAngleDegrees(legacy.normals, welded.normals) << " deg\n";
+}
+
+static void testCrease() {
+    auto cube = Mesh::normalizedCube(4);
+
+    // The faces of the cube do not share vertices, welding smooths across the cube edges unless they are creased.
+    auto smooth = Mesh::computeSmoothNormals(cube);
+    auto creased = Mesh::computeSmoothNormals(cube, 0, PI / 4);
+    check(creased.positions.size() == cube.positions.size(), "split of unshared vertices");
+
+    size_t smoothed = 0;
+    for (size_t i = 0; i < cube.positions.size(); i++) {
+        auto &expected = cube.normals.at(i);
+        check(std::abs(std::abs(creased.normals.at(i).dot(expected)) - 1) < 1e-4f, "creased cube normal");
+        if (std::abs(smooth.normals.at(i).dot(expected)) < 0.999f)
+            smoothed++;
+    }
+    check(smoothed > 0, "smoothed cube edges");
+
+    // Indexed box with shared corner vertices, hard edges must split the corners into one vertex per face.
+    Mesh box;
+    box.primitive = Mesh::TRIANGLES;
+    for (int i = 0; i < 8; i++) {
+        box.positions.emplace_back(i & 1 ? 1.0f : -1.0f, i & 2 ? 1.0f : -1.0f, i & 4 ? 1.0f : -1.0f);
+        box.uvs.emplace_back(0.5f, 0.5f);
+    }
+    box.indices = {
+        0, 2, 3, 0, 3, 1, 4, 5, 7, 4, 7, 6,
+        0, 1, 5, 0, 5, 4, 2, 6, 7, 2, 7, 3,
+        0, 4, 6, 0, 6, 2, 1, 3, 7, 1, 7, 5
+    };
+    box.boneWeights["root"] = {{0, 1.0f}};
+    auto boxCreased = Mesh::computeSmoothNormals(box, 0, PI / 4);
+    check(boxCreased.positions.size() == 24, "box split vertex count");
+    check(boxCreased.boneWeights.at("root").size() == 3, "box split bone weights");
+    for (size_t i = 0; i < boxCreased.indices.size(); i += 3) {
+        auto &p0 = boxCreased.positions.at(boxCreased.indices.at(i));
+        auto &p1 = boxCreased.positions.at(boxCreased.indices.at(i + 1));
+        auto &p2 = boxCreased.positions.at(boxCreased.indices.at(i + 2));
+        auto faceNormal = (p2 - p0).cross(p1 - p0);
+        faceNormal /= faceNormal.length();
+        for (size_t c = 0; c < 3; c++) {
+            check(boxCreased.normals.at(boxCreased.indices.at(i + c)).dot(faceNormal) > 0.9999f, "box face normal");
+        }
+    }
+
+    auto boxSmooth = Mesh::computeSmoothNormals(box);
+    check(boxSmooth.positions.size() == 8, "smooth box vertex count");
+}
+
+static void testWeldEpsilon() {
+    auto mesh = createScan(64, false);
+    auto exact = Mesh::computeSmoothNormals(mesh);
+
+    std::mt19937 rng(2);
+    std::uniform_real_distribution<float> jitter(-1e-6f, 1e-6f);
+    auto jittered = mesh;
+    for (auto &p: jittered.positions) {
+        p += Vec3f(jitter(rng), jitter(rng), jitter(rng));
+    }
+
+    auto unwelded = Mesh::computeSmoothNormals(jittered);
+    auto welded = Mesh::computeSmoothNormals(jittered, 1e-5f);
+    check(maxAngleDegrees(exact.normals, welded.normals) < 0.1f, "welded jittered normals");
+    check(maxAngleDegrees(exact.normals, unwelded.normals) > 1.0f, "unwelded jittered normals");
+
+    // Vertex 2 is within epsilon of vertex 1 but not of vertex 0, all three are welded through vertex 1.
+    Mesh chain;
+    chain.primitive = Mesh::TRIANGLES;
+    chain.positions = {
+        Vec3f(0, 0, 0), Vec3f(0.8e-3f, 0, 0), Vec3f(1.6e-3f, 0, 0),
+        Vec3f(0, 1, 0), Vec3f(0, 0, 1),
+        Vec3f(1, 1, 0), Vec3f(1, 0, 0),
+        Vec3f(1, 0, 2), Vec3f(0, 0, 2)
+    };
+    chain.uvs.resize(chain.positions.size(), Vec2f(0.5f, 0.5f));
+    chain.indices = {0, 3, 4, 1, 5, 6, 2, 7, 8};
+    auto chainWelded = Mesh::computeSmoothNormals(chain, 1e-3f);
+    check(chainWelded.normals.at(0).dot(chainWelded.normals.at(1)) > 0.9999f
+          && chainWelded.normals.at(0).dot(chainWelded.normals.at(2)) > 0.9999f,
+          "welded chain normals");
+}
+
+/**
+ * The triangles of the mesh as position triples, rotated so the smallest position comes first and sorted.
+ */
+static std::vector<std::array<float, 9> > getTriangles(const Mesh &mesh) {
+    std::vector<std::array<float, 9> > ret;
+    auto count = mesh.indices.empty() ? mesh.positions.size() / 3 : mesh.indices.size() / 3;
+    for (size_t t = 0; t < count; t++) {
+        std::array<Vec3f, 3> p;
+        for (size_t c = 0; c < 3; c++) {
+            p[c] = mesh.positions.at(mesh.indices.empty() ? t * 3 + c : mesh.indices.at(t * 3 + c));
+        }
+        auto less = [](const Vec3f &a, const Vec3f &b) {
+            return std::tie(a.x, a.y, a.z) < std::tie(b.x, b.y, b.z);
+        };
+        while (less(p[1], p[0]) || less(p[2], p[0])) {
+            std::rotate(p.begin(), p.begin() + 1, p.end());
+        }
+        ret.push_back({p[0].x, p[0].y, p[0].z, p[1].x, p[1].y, p[1].z, p[2].x, p[2].y, p[2].z});
+    }
+    std::sort(ret.begin(), ret.end());
+    return ret;
+}
+
+/**
+ * Rasterize the mesh with back face culling and a depth test from the six axis directions
+ * and return the average number of shaded fragments per covered pixel.
+ */
+static float analyzeOverdraw(const Mesh &mesh) {
+    const int resolution = 256;
+
+    Vec3f min = mesh.positions.at(0);
+    Vec3f max = min;
+    for (auto &p: mesh.positions) {
+        min = Vec3f(std::min(min.x, p.x), std::min(min.y, p.y), std::min(min.z, p.z));
+        max = Vec3f(std::max(max.x, p.x), std::max(max.y, p.y), std::max(max.z, p.z));
+    }
+    auto extent = std::max(max.x - min.x, std::max(max.y - min.y, max.z - min.z));
+
+    size_t shaded = 0;
+    size_t covered = 0;
+    std::vector<float> depth(resolution * resolution);
+    for (int view = 0; view < 6; view++) {
+        auto axis = view / 2;
+        auto sign = view % 2 == 0 ? 1.0f : -1.0f;
+        std::fill(depth.begin(), depth.end(), std::numeric_limits<float>::max());
+
+        auto project = [&](const Vec3f &p) {
+            float v[3] = {(p.x - min.x) / extent, (p.y - min.y) / extent, (p.z - min.z) / extent};
+            return Vec3f(v[(axis + 1) % 3] * (resolution - 1), v[(axis + 2) % 3] * (resolution - 1), v[axis] * sign);
+        };
+
+        for (size_t t = 0; t < mesh.indices.size(); t += 3) {
+            auto &p0 = mesh.positions.at(mesh.indices.at(t));
+            auto &p1 = mesh.positions.at(mesh.indices.at(t + 1));
+            auto &p2 = mesh.positions.at(mesh.indices.at(t + 2));
+            auto normal = (p2 - p0).cross(p1 - p0);
+            float n[3] = {normal.x, normal.y, normal.z};
+            if (n[axis] * sign >= 0)
+                continue; // Facing away from the viewer looking along the axis
+
+            auto a = project(p0);
+            auto b = project(p1);
+            auto c = project(p2);
+            auto area = (b.x - a.x) * (c.y - a.y) - (c.x - a.x) * (b.y - a.y);
+            if (area == 0)
+                continue;
+
+            auto minX = std::max(0, static_cast<int>(std::floor(std::min(a.x, std::min(b.x, c.x)))));
+            auto maxX = std::min(resolution - 1, static_cast<int>(std::ceil(std::max(a.x, std::max(b.x, c.x)))));
+            auto minY = std::max(0, static_cast<int>(std::floor(std::min(a.y, std::min(b.y, c.y)))));
+            auto maxY = std::min(resolution - 1, static_cast<int>(std::ceil(std::max(a.y, std::max(b.y, c.y)))));
+            for (int y = minY; y <= maxY; y++) {
+                for (int x = minX; x <= maxX; x++) {
+                    auto px = static_cast<float>(x) + 0.5f;
+                    auto py = static_cast<float>(y) + 0.5f;
+                    auto w0 = ((b.x - px) * (c.y - py) - (c.x - px) * (b.y - py)) / area;
+                    auto w1 = ((c.x - px) * (a.y - py) - (a.x - px) * (c.y - py)) / area;
+                    auto w2 = 1 - w0 - w1;
+                    if (w0 < 0 || w1 < 0 || w2 < 0)
+                        continue;
+                    auto z = a.z * w0 + b.z * w1 + c.z * w2;
+                    auto &d = depth[y * resolution + x];
+                    if (z < d) {
+                        if (d == std::numeric_limits<float>::max())
+                            covered++;
+                        d = z;
+                        shaded++;
+                    }
+                }
+            }
+        }
+    }
+    return covered == 0 ? 0 : static_cast<float>(shaded) / static_cast<float>(covered);
+}
+
+/**
+ * A sphere with large radial bumps which occlude each other, with the triangles in random order.
+ */
+static Mesh createBumpySphere(int segments) {
+    auto ret = Mesh::sphere(1, segments, segments);
+    for (auto &p: ret.positions) {
+        auto bump = 1.0f + 0.4f * std::sin(p.x * 9.0f) * std::sin(p.y * 11.0f) * std::sin(p.z * 7.0f);
+        p *= bump;
+    }
+
+    std::mt19937 rng(3);
+    std::vector<size_t> order(ret.indices.size() / 3);
+    std::iota(order.begin(), order.end(), 0);
+    std::shuffle(order.begin(), order.end(), rng);
+    std::vector<unsigned int> indices;
+    for (auto t: order) {
+        indices.insert(indices.end(), ret.indices.begin() + t * 3, ret.indices.begin() + t * 3 + 3);
+    }
+    ret.indices = std::move(indices);
+    return ret;
+}
+
+static void printOptimizerStage(const std::string &name, const Mesh &mesh, double milliseconds) {
+    auto stats = MeshOptimizer::analyzeVertexCache(mesh);
+    std::cout << "  " << std::left << std::setw(24) << name
+            << std::right << std::setw(10) << mesh.positions.size()
+            << std::setw(8) << std::fixed << std::setprecision(3) << stats.getACMR()
+            << std::setw(8) << stats.getATVR()
+            << std::setw(10) << (mesh.indices.empty() ? std::string("-") : std::to_string(analyzeOverdraw(mesh)).substr(0, 5))
+            << std::setw(12) << std::setprecision(1) << milliseconds << " ms\n";
+}
+
+static void benchmarkOptimizer(const std::string &name, const Mesh &mesh) {
+    std::cout << name << " (" << (mesh.indices.empty() ? mesh.positions.size() : mesh.indices.size()) / 3 << " triangles)\n";
+    printOptimizerStage("Source", mesh, 0);
+
+    Mesh deduplicated, cache, overdraw, fetch;
+    printOptimizerStage("removeDuplicateVertices", deduplicated, measureMilliseconds([&]() {
+        deduplicated = MeshOptimizer::removeDuplicateVertices(mesh);
+    }));
+    printOptimizerStage("optimizeVertexCache", cache, measureMilliseconds([&]() {
+        cache = MeshOptimizer::optimizeVertexCache(deduplicated);
+    }));
+    printOptimizerStage("optimizeOverdraw", overdraw, measureMilliseconds([&]() {
+        overdraw = MeshOptimizer::optimizeOverdraw(cache);
+    }));
+    printOptimizerStage("optimizeVertexFetch", fetch, measureMilliseconds([&]() {
+        fetch = MeshOptimizer::optimizeVertexFetch(overdraw);
+    }));
+
+    auto triangles = getTriangles(mesh);
+    check(getTriangles(deduplicated) == triangles, name + " deduplicated triangles");
+    check(getTriangles(cache) == triangles, name + " vertex cache triangles");
+    check(getTriangles(overdraw) == triangles, name + " overdraw triangles");
+    check(getTriangles(fetch) == triangles, name + " vertex fetch triangles");
+    check(fetch.uvs.size() == fetch.positions.size(), name + " remapped uvs");
+}
+
+static void testOptimizer() {
+    auto soup = createScan(16, false);
+    auto deduplicated = MeshOptimizer::removeDuplicateVertices(soup);
+    check(deduplicated.positions.size() == 17 * 17, "deduplicated vertex count");
+    check(deduplicated.indices.size() == soup.positions.size(), "deduplicated index count");
+
+    // Bone weights distinguish otherwise identical vertices and follow the remapped vertices
+    Mesh skinned;
+    skinned.primitive = Mesh::TRIANGLES;
+    skinned.positions = {Vec3f(0, 0, 0), Vec3f(1, 0, 0), Vec3f(0, 1, 0), Vec3f(0, 0, 0), Vec3f(1, 0, 0), Vec3f(0, 1, 0)};
+    skinned.boneWeights["a"] = {{0, 1.0f}, {1, 1.0f}, {2, 1.0f}, {3, 1.0f}, {4, 1.0f}};
+    skinned.boneWeights["b"] = {{5, 1.0f}};
+    auto merged = MeshOptimizer::optimize(skinned);
+    check(merged.positions.size() == 4, "skinned vertex count");
+    check(merged.boneWeights.at("a").size() == 3 && merged.boneWeights.at("b").size() == 1, "skinned bone weights");
+    for (auto &weight: merged.boneWeights.at("b")) {
+        check(merged.positions.at(weight.vertex) == Vec3f(0, 1, 0), "skinned bone weight vertex");
+    }
+
+    bool thrown = false;
+    try {
+        MeshOptimizer::optimize(Mesh()); // Default meshes are POINTS
+    } catch (const std::runtime_error &) {
+        thrown = true;
+    }
+    check(thrown, "non triangle mesh rejected");
+}
+
+/**
+ * Verify that the meshlets cover every triangle exactly once, respect the limits and have conservative bounds.
+ */
+static void checkMeshlets(const std::string &name, const Mesh &mesh, size_t maxVertices, size_t maxTriangles) {
+    Mesh rebuilt;
+    rebuilt.primitive = Mesh::TRIANGLES;
+    rebuilt.positions = mesh.positions;
+    for (auto &meshlet: mesh.meshlets) {
+        check(meshlet.vertexCount <= maxVertices && meshlet.triangleCount <= maxTriangles, name + " meshlet limits");
+        check(meshlet.vertexOffset + meshlet.vertexCount <= mesh.meshletVertices.size(), name + " meshlet vertex range");
+        check((meshlet.triangleOffset + meshlet.triangleCount) * 3 <= mesh.meshletTriangles.size(), name + " meshlet triangle range");
+        for (size_t i = 0; i < meshlet.triangleCount * 3; i++) {
+            auto local = mesh.meshletTriangles.at(meshlet.triangleOffset * 3 + i);
+            check(local < meshlet.vertexCount, name + " meshlet local index");
+            rebuilt.indices.push_back(mesh.meshletVertices.at(meshlet.vertexOffset + local));
+        }
+        for (size_t i = 0; i < meshlet.vertexCount; i++) {
+            auto &p = mesh.positions.at(mesh.meshletVertices.at(meshlet.vertexOffset + i));
+            check((p - meshlet.center).length() <= meshlet.radius * 1.0001f + 1e-6f, name + " meshlet bounding sphere");
+        }
+    }
+    check(rebuilt.indices.size() == mesh.indices.size(), name + " meshlet triangle count");
+    check(getTriangles(rebuilt) == getTriangles(mesh), name + " meshlet triangles");
+
+    // A meshlet reported as back facing must not contain a triangle facing the camera
+    std::mt19937 rng(5);
+    std::uniform_real_distribution<float> distribution(-4, 4);
+    for (int i = 0; i < 64; i++) {
+        Vec3f camera(distribution(rng), distribution(rng), distribution(rng));
+        for (auto &meshlet: mesh.meshlets) {
+            if (!meshlet.isBackFacing(camera))
+                continue;
+            for (size_t t = 0; t < meshlet.triangleCount; t++) {
+                auto vertex = [&](size_t c) -> const Vec3f & {
+                    auto local = mesh.meshletTriangles.at((meshlet.triangleOffset + t) * 3 + c);
+                    return mesh.positions.at(mesh.meshletVertices.at(meshlet.vertexOffset + local));
+                };
+                auto normal = (vertex(2) - vertex(0)).cross(vertex(1) - vertex(0));
+                check(normal.dot(camera - vertex(0)) <= 1e-5f * normal.length(), name + " meshlet cone conservative");
+            }
+        }
+    }
+}
+
+static void benchmarkMeshlets(const std::string &name, const Mesh &mesh) {
+    for (auto limits: {std::make_pair<size_t, size_t>(32, 64),
+                       std::make_pair<size_t, size_t>(64, 124),
+                       std::make_pair<size_t, size_t>(128, 256)}) {
+        Mesh meshlets;
+        auto milliseconds = measureMilliseconds([&]() {
+            meshlets = MeshOptimizer::buildMeshlets(mesh, limits.first, limits.second);
+        });
+        checkMeshlets(name, meshlets, limits.first, limits.second);
+
+        size_t vertices = 0;
+        size_t cullable = 0;
+        for (auto &meshlet: meshlets.meshlets) {
+            vertices += meshlet.vertexCount;
+            if (meshlet.coneCutoff < 1)
+                cullable++;
+        }
+        auto count = static_cast<double>(meshlets.meshlets.size());
+        std::cout << "  " << std::left << std::setw(24) << name
+                << std::right << std::setw(5) << limits.first << "/" << std::left << std::setw(5) << limits.second
+                << std::right << std::setw(10) << meshlets.meshlets.size()
+                << std::setw(10) << std::fixed << std::setprecision(1)
+                << 100.0 * static_cast<double>(vertices) / (count * static_cast<double>(limits.first)) << "%"
+                << std::setw(10) << 100.0 * static_cast<double>(mesh.indices.size() / 3) / (count * static_cast<double>(limits.second)) << "%"
+                << std::setw(10) << 100.0 * static_cast<double>(cullable) / count << "%"
+                << std::setw(10) << milliseconds << " ms\n";
+    }
+}
+
+static void testMeshlets() {
+    auto sphere = MeshOptimizer::optimize(Mesh::sphere(1, 32, 32));
+    checkMeshlets("Sphere", MeshOptimizer::buildMeshlets(sphere), MeshOptimizer::DEFAULT_MESHLET_VERTICES,
+                  MeshOptimizer::DEFAULT_MESHLET_TRIANGLES);
+    checkMeshlets("Sphere", MeshOptimizer::buildMeshlets(sphere, 3, 1), 3, 1);
+
+    auto scan = MeshOptimizer::optimize(createScan(32, false));
+    checkMeshlets("Scan", MeshOptimizer::buildMeshlets(scan, 16, 8), 16, 8);
+
+    // The normals of the gently curved height field fit in a narrow cone
+    auto patch = MeshOptimizer::buildMeshlets(MeshOptimizer::optimize(createScan(4, false)));
+    for (auto &meshlet: patch.meshlets) {
+        check(meshlet.coneCutoff < 1, "flat meshlet cullable");
+    }
+
+    for (auto limits: {std::make_pair<size_t, size_t>(2, 124),
+                       std::make_pair<size_t, size_t>(257, 124),
+                       std::make_pair<size_t, size_t>(64, 0)}) {
+        bool thrown = false;
+        try {
+            MeshOptimizer::buildMeshlets(sphere, limits.first, limits.second);
+        } catch (const std::runtime_error &) {
+            thrown = true;
+        }
+        check(thrown, "invalid meshlet limits rejected");
+    }
+}
+
+int main(int argc, char *argv[]) {
+    testCrease();
+    testWeldEpsilon();
+    testOptimizer();
+    testMeshlets();
+
+    std::cout << "Mesh::computeSmoothNormals on " << ThreadPool::getPool().getThreadCount() << " threads\n";
+    std::cout << std::left << std::setw(10) << "Mesh"
+            << std::right << std::setw(12) << "Vertices"
+            << std::setw(17) << "std::map"
+            << std::setw(17) << "Spatial hash"
+            << std::setw(11) << "Speedup"
+            << std::setw(16) << "Max deviation" << "\n";
+    for (size_t resolution: {64, 256, 512}) {
+        benchmarkSmoothNormals(resolution, false);
+        benchmarkSmoothNormals(resolution, true);
+    }
+    std::cout << "\n";
+
+    std::cout << "MeshOptimizer, FIFO cache of " << MeshOptimizer::DEFAULT_CACHE_SIZE << " vertices\n";
+    std::cout << "  " << std::left << std::setw(24) << "Stage"
+            << std::right << std::setw(10) << "Vertices"
+            << std::setw(8) << "ACMR"
+            << std::setw(8) << "ATVR"
+            << std::setw(10) << "Overdraw"
+            << std::setw(15) << "Time" << "\n";
+    benchmarkOptimizer("Scan triangle soup", createScan(256, false));
+    benchmarkOptimizer("Shuffled bumpy sphere", createBumpySphere(256));
+    std::cout << "\n";
+
+    std::cout << "MeshOptimizer::buildMeshlets\n";
+    std::cout << "  " << std::left << std::setw(24) << "Mesh"
+            << std::right << std::setw(11) << "Limits"
+            << std::setw(10) << "Meshlets"
+            << std::setw(11) << "Vertices"
+            << std::setw(11) << "Triangles"
+            << std::setw(11) << "Cullable"
+            << std::setw(13) << "Time" << "\n";
+    benchmarkMeshlets("Scan", MeshOptimizer::optimize(createScan(256, false)));
+    benchmarkMeshlets("Bumpy sphere", MeshOptimizer::optimize(createBumpySphere(256)));
+    return 0;
+}
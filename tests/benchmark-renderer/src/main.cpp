@@ -436,7 +436,7 @@ RenderText getStatsText(const RendererStatistics &stats,
     txt += std::to_wstring(
                 std::chrono::duration_cast<std::chrono::milliseconds>(stats.frameSubmit - stats.frameStart).
                 count())
-            + L" ms\nGPU: ";
+            + L" ms\nWait: ";
     txt += std::to_wstring(
                 std::chrono::duration_cast<std::chrono::milliseconds>(stats.frameEnd - stats.frameSubmit).
                 count())
@@ -656,5 +656,7 @@ int main(int argc, char *argv[]) {
         ren.draw(surface, *scene);
     }
 
+    ren.synchronize();
+
     return 0;
 }
@@ -0,0 +1,618 @@
+/**
+ *   xEngine - C++ Game Engine Library
+ *   Copyright (C) 2026 Julia Zampiccoli
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU Lesser General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   Lesser General Public License for more details.
+ *
+ *   You should have received a copy of the Lesser General Public License
+ *   along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "xng/xng.hpp"
+
+#include "xng/adapters/cryptopp/cryptopp.hpp"
+
+#include "measure.hpp"
+
+#include <array>
+#include <fstream>
+#include <iostream>
+#include <iomanip>
+#include <random>
+#include <thread>
+#include <atomic>
+#include <new>
+#include <cstdlib>
+#include <cstring>
+
+using namespace xng;
+
+static std::atomic<size_t> allocationCount = 0;
+static std::atomic<size_t> allocationBytes = 0;
+
+void *operator new(size_t size) {
+    allocationCount.fetch_add(1, std::memory_order_relaxed);
+    allocationBytes.fetch_add(size, std::memory_order_relaxed);
+    auto *ret = std::malloc(size == 0 ? 1 : size);
+    if (ret == nullptr)
+        throw std::bad_alloc();
+    return ret;
+}
+
+void operator delete(void *pointer) noexcept {
+    std::free(pointer);
+}
+
+void operator delete(void *pointer, size_t) noexcept {
+    std::free(pointer);
+}
+
+static std::atomic<size_t> copyBytes = 0;
+
+#if defined(__GLIBC__)
+// Count the bytes copied by memcpy / memmove calls of the engine and the standard library.
+// The glibc implementations are invoked through volatile pointers so that the compiler cannot fold the calls back into memcpy.
+extern "C" void *__memcpy_chk(void *destination, const void *source, size_t size, size_t destinationSize);
+extern "C" void *__memmove_chk(void *destination, const void *source, size_t size, size_t destinationSize);
+
+static void *(*volatile libcMemcpy)(void *, const void *, size_t, size_t) = __memcpy_chk;
+static void *(*volatile libcMemmove)(void *, const void *, size_t, size_t) = __memmove_chk;
+
+extern "C" void *memcpy(void *destination, const void *source, size_t size) noexcept {
+    copyBytes.fetch_add(size, std::memory_order_relaxed);
+    return libcMemcpy(destination, source, size, size);
+}
+
+extern "C" void *memmove(void *destination, const void *source, size_t size) noexcept {
+    copyBytes.fetch_add(size, std::memory_order_relaxed);
+    return libcMemmove(destination, source, size, size);
+}
+#endif
+
+/**
+ * A resource holding opaque bytes, imported from .blob files.
+ */
+struct Blob final : ResourceBase {
+    RESOURCE_TYPENAME(Blob)
+
+    std::vector<uint8_t> data;
+
+    std::unique_ptr<ResourceBase> clone() override {
+        return std::make_unique<Blob>(*this);
+    }
+
+    size_t getSize() const override {
+        return data.size();
+    }
+};
+
+class BlobImporter : public ResourceImporter {
+public:
+    ResourceBundle read(std::istream &stream, const Uri &path, Archive *archive) override {
+        auto blob = std::make_unique<Blob>();
+        readStream(stream, blob->data);
+
+        // Simulate the decoding work of a real importer
+        uint8_t key = 0;
+        for (auto &byte: blob->data) {
+            byte ^= key;
+            key = static_cast<uint8_t>(key * 31 + byte);
+        }
+
+        ResourceBundle ret;
+        ret.add("", std::move(blob));
+        return ret;
+    }
+
+    const std::set<std::string> &getSupportedFormats() const override {
+        static const std::set<std::string> formats = {".blob"};
+        return formats;
+    }
+};
+
+/**
+ * An archive which delays reads to simulate a storage device with the given latency and bandwidth.
+ */
+class ThrottledArchive : public Archive {
+public:
+    class StreamBuf : public std::streambuf {
+    public:
+        StreamBuf(const std::vector<char> &data, size_t bytesPerSecond)
+            : data(data), bytesPerSecond(bytesPerSecond) {}
+
+    protected:
+        int_type underflow() override {
+            if (gptr() < egptr())
+                return traits_type::to_int_type(*gptr());
+            if (offset >= data.size())
+                return traits_type::eof();
+            auto count = std::min(PAGE_SIZE, data.size() - offset);
+            std::this_thread::sleep_for(std::chrono::microseconds(count * 1000000 / bytesPerSecond));
+            auto *begin = const_cast<char *>(data.data()) + offset;
+            setg(begin, begin, begin + count);
+            offset += count;
+            return traits_type::to_int_type(*gptr());
+        }
+
+    private:
+        static const size_t PAGE_SIZE = 64 * 1024;
+
+        const std::vector<char> &data;
+        size_t bytesPerSecond;
+        size_t offset = 0;
+    };
+
+    class Stream : public std::istream {
+    public:
+        Stream(const std::vector<char> &data, size_t bytesPerSecond)
+            : std::istream(nullptr), buf(data, bytesPerSecond) {
+            rdbuf(&buf);
+        }
+
+    private:
+        StreamBuf buf;
+    };
+
+    ThrottledArchive(std::chrono::microseconds latency, size_t bytesPerSecond)
+        : latency(latency), bytesPerSecond(bytesPerSecond) {}
+
+    bool exists(const std::string &name) override {
+        return files.find(name) != files.end();
+    }
+
+    std::unique_ptr<std::istream> open(const std::string &name) override {
+        std::this_thread::sleep_for(latency);
+        return std::make_unique<Stream>(files.at(name), bytesPerSecond);
+    }
+
+    std::unique_ptr<std::iostream> openRW(const std::string &name) override {
+        throw std::runtime_error("No RW in throttled archive");
+    }
+
+    void addFile(const std::string &name, std::vector<char> data) {
+        files[name] = std::move(data);
+    }
+
+private:
+    std::chrono::microseconds latency;
+    size_t bytesPerSecond;
+    std::map<std::string, std::vector<char> > files;
+};
+
+static const size_t BUNDLE_COUNT = 256;
+static const size_t BUNDLE_SIZE = 1024 * 1024;
+static const size_t WORKING_SET = 16;
+static const size_t STEPS = 1000;
+
+static Uri getBundleUri(size_t index) {
+    return Uri("memory://bundle" + std::to_string(index) + ".blob");
+}
+
+static std::string formatHistogram(const ResourceRegistry::Statistics &stats) {
+    std::string ret;
+    for (size_t i = 0; i < stats.loadLatency.size(); i++) {
+        if (stats.loadLatency.at(i) == 0)
+            continue;
+        std::string bucket = i + 1 == stats.loadLatency.size()
+                                 ? ">=" + std::to_string(1u << (i - 1)) + "ms"
+                                 : "<" + std::to_string(1u << i) + "ms";
+        ret += bucket + ":" + std::to_string(stats.loadLatency.at(i)) + " ";
+    }
+    return ret;
+}
+
+/**
+ * Walk randomly over a level made of bundles and reference the bundles around the player,
+ * bundles which are left behind are frequently referenced again shortly after.
+ */
+static void benchmarkBudget(size_t budget) {
+    ResourceRegistry registry;
+    std::vector<std::unique_ptr<ResourceImporter> > importers;
+    importers.emplace_back(std::make_unique<BlobImporter>());
+    registry.setImporters(std::move(importers));
+    registry.setMemoryBudget(budget);
+
+    auto &archive = dynamic_cast<MemoryArchive &>(registry.getArchive("memory"));
+    std::mt19937 rng(1);
+    for (size_t i = 0; i < BUNDLE_COUNT; i++) {
+        std::vector<uint8_t> data(BUNDLE_SIZE);
+        for (auto &byte: data) {
+            byte = static_cast<uint8_t>(rng());
+        }
+        archive.addData("bundle" + std::to_string(i) + ".blob", std::move(data));
+    }
+
+    size_t position = BUNDLE_COUNT / 2;
+    std::set<size_t> referenced;
+    size_t peakResident = 0;
+    size_t checksum = 0;
+
+    const auto start = std::chrono::steady_clock::now();
+    for (size_t step = 0; step < STEPS; step++) {
+        auto move = static_cast<int>(rng() % 5) - 2;
+        position = std::clamp<long>(static_cast<long>(position) + move, 0, BUNDLE_COUNT - WORKING_SET);
+
+        std::set<size_t> workingSet;
+        for (size_t i = position; i < position + WORKING_SET; i++) {
+            workingSet.insert(i);
+        }
+        for (auto index: workingSet) {
+            if (referenced.find(index) == referenced.end()) {
+                registry.incRef(getBundleUri(index));
+            }
+        }
+        for (auto index: referenced) {
+            if (workingSet.find(index) == workingSet.end()) {
+                registry.decRef(getBundleUri(index));
+            }
+        }
+        referenced = workingSet;
+
+        for (auto index: referenced) {
+            auto &blob = dynamic_cast<const Blob &>(registry.get(getBundleUri(index)));
+            checksum += blob.data.at(step % BUNDLE_SIZE);
+        }
+        peakResident = std::max(peakResident, registry.getStatistics().residentBytes);
+    }
+    const auto end = std::chrono::steady_clock::now();
+
+    for (auto index: referenced) {
+        registry.decRef(getBundleUri(index));
+    }
+
+    auto stats = registry.getStatistics();
+    auto ms = static_cast<double>(std::chrono::duration_cast<std::chrono::microseconds>(end - start).count()) / 1000.0;
+    std::cout << std::right << std::setw(8) << budget / (1024 * 1024) << " MB"
+            << std::setw(12) << std::fixed << std::setprecision(1) << ms << " ms"
+            << std::setw(8) << stats.hits
+            << std::setw(8) << stats.misses
+            << std::setw(8) << stats.evictions
+            << std::setw(10) << peakResident / (1024 * 1024) << " MB"
+            << "   " << formatHistogram(stats)
+            << " (" << checksum % 10 << ")\n";
+}
+
+enum LoadScenario {
+    SCENARIO_FIFO, // The background and needed bundles are referenced with the same priority
+    SCENARIO_PRIORITIZED, // The needed bundle is referenced with a higher priority
+    SCENARIO_CANCELLED // The background bundles are released before the needed bundle is referenced
+};
+
+/**
+ * Queue loads of background bundles from a throttled archive and measure the time until the bundle which is
+ * referenced afterwards is available.
+ */
+static void benchmarkTimeToNeeded(const std::string &name, LoadScenario scenario) {
+    const size_t backgroundCount = 64;
+    const size_t size = 512 * 1024;
+
+    auto archive = std::make_shared<ThrottledArchive>(std::chrono::microseconds(500), 256 * 1024 * 1024);
+    for (size_t i = 0; i <= backgroundCount; i++) {
+        archive->addFile("bundle" + std::to_string(i) + ".blob", std::vector<char>(size, static_cast<char>(i)));
+    }
+
+    ResourceRegistry registry;
+    std::vector<std::unique_ptr<ResourceImporter> > importers;
+    importers.emplace_back(std::make_unique<BlobImporter>());
+    registry.setImporters(std::move(importers));
+    registry.addArchive("slow", archive);
+    registry.setMaxConcurrentLoads(2, 0);
+
+    auto getUri = [](size_t index) {
+        return Uri("slow://bundle" + std::to_string(index) + ".blob");
+    };
+
+    for (size_t i = 0; i < backgroundCount; i++) {
+        registry.incRef(getUri(i), scenario == SCENARIO_PRIORITIZED ? -1 : 0);
+    }
+    if (scenario == SCENARIO_CANCELLED) {
+        for (size_t i = 0; i < backgroundCount; i++) {
+            registry.decRef(getUri(i));
+        }
+    }
+
+    const auto needed = getUri(backgroundCount);
+    const auto start = std::chrono::steady_clock::now();
+    registry.incRef(needed, scenario == SCENARIO_PRIORITIZED ? 1 : 0);
+    registry.await(needed);
+    const auto end = std::chrono::steady_clock::now();
+
+    if (dynamic_cast<const Blob &>(registry.get(needed)).data.size() != size)
+        throw std::runtime_error("Invalid bundle data");
+
+    // Loads which were cancelled are not recorded in the latency histogram
+    size_t loaded = 0;
+    for (auto count: registry.getStatistics().loadLatency) {
+        loaded += count;
+    }
+    registry.decRef(needed);
+    if (scenario != SCENARIO_CANCELLED) {
+        for (size_t i = 0; i < backgroundCount; i++) {
+            registry.decRef(getUri(i));
+        }
+    }
+
+    auto ms = static_cast<double>(std::chrono::duration_cast<std::chrono::microseconds>(end - start).count()) / 1000.0;
+    std::cout << std::left << std::setw(40) << name
+            << std::right << std::setw(10) << std::fixed << std::setprecision(2) << ms << " ms"
+            << std::setw(10) << loaded << " bundles loaded\n";
+}
+
+/**
+ * Resolve uris without a scheme across directory archives through the registry index
+ * and by asking every archive whether it contains the file.
+ */
+static void benchmarkResolve() {
+    const size_t archiveCount = 50;
+    const size_t filesPerArchive = 20;
+    const size_t resolveCount = 100000;
+
+    auto root = std::filesystem::temp_directory_path() / "benchmark-resource";
+    std::filesystem::remove_all(root);
+
+    ResourceRegistry registry;
+    std::vector<std::shared_ptr<Archive> > archives;
+    for (size_t i = 0; i < archiveCount; i++) {
+        auto directory = root / ("archive" + std::to_string(i));
+        std::filesystem::create_directories(directory / "textures");
+        for (size_t f = 0; f < filesPerArchive; f++) {
+            std::ofstream(directory / "textures" / ("file" + std::to_string(i * filesPerArchive + f) + ".blob")) << f;
+        }
+        auto archive = std::make_shared<DirectoryArchive>(directory);
+        archives.emplace_back(archive);
+        registry.addArchive("archive" + std::to_string(i), archive);
+    }
+
+    std::mt19937 rng(1);
+    std::vector<Uri> uris;
+    uris.reserve(resolveCount);
+    for (size_t i = 0; i < resolveCount; i++) {
+        uris.emplace_back("textures/file" + std::to_string(rng() % (archiveCount * filesPerArchive)) + ".blob");
+    }
+
+    size_t found = 0;
+    auto scan = measureMilliseconds([&]() {
+        for (auto &uri: uris) {
+            for (auto &archive: archives) {
+                if (archive->exists(uri.getFile())) {
+                    found++;
+                    break;
+                }
+            }
+        }
+    });
+    auto index = measureMilliseconds([&]() {
+        for (auto &uri: uris) {
+            if (registry.resolveUri(uri)) {
+                found++;
+            }
+        }
+    });
+
+    // Files added on disk are found after the archive is indexed again.
+    std::ofstream(root / "archive7" / "textures" / "added.blob") << 1;
+    if (registry.resolveUri(Uri("textures/added.blob")) != archives.at(7))
+        throw std::runtime_error("Added file not resolved");
+
+    // Uris which no archive contains, checking the archives for changes on every miss and once per interval
+    const size_t missCount = 1000;
+    const auto resolveMisses = [&]() {
+        return measureMilliseconds([&]() {
+            for (size_t i = 0; i < missCount; i++) {
+                try {
+                    registry.resolveUri(Uri("textures/missing" + std::to_string(i) + ".blob"));
+                    throw std::logic_error("Missing file resolved");
+                } catch (const std::runtime_error &) {
+                }
+            }
+        });
+    };
+    registry.setRescanInterval(std::chrono::milliseconds(0));
+    auto missRescan = resolveMisses();
+    registry.setRescanInterval(ResourceRegistry::DEFAULT_RESCAN_INTERVAL);
+    auto missInterval = resolveMisses();
+
+    std::filesystem::remove_all(root);
+
+    std::cout << "Resolve " << resolveCount << " uris across " << archiveCount << " directory archives\n";
+    std::cout << std::left << std::setw(40) << "Archive::exists scan"
+            << std::right << std::setw(10) << std::fixed << std::setprecision(2) << scan << " ms\n";
+    std::cout << std::left << std::setw(40) << "ResourceRegistry::resolveUri"
+            << std::right << std::setw(10) << std::fixed << std::setprecision(2) << index << " ms"
+            << " (" << found << ")\n";
+    std::cout << std::left << std::setw(40) << ("Resolve " + std::to_string(missCount) + " misses, rescan each")
+            << std::right << std::setw(10) << std::fixed << std::setprecision(2) << missRescan << " ms\n";
+    std::cout << std::left << std::setw(40) << ("Resolve " + std::to_string(missCount) + " misses, rescan 1/s")
+            << std::right << std::setw(10) << std::fixed << std::setprecision(2) << missInterval << " ms\n\n";
+}
+
+/**
+ * Copy and destroy handles of shared bundles from multiple threads concurrently
+ * and compare to incrementing and decrementing the reference counts through the registry by uri.
+ */
+static void benchmarkHandleCopies(unsigned int threads) {
+    const size_t bundleCount = 16;
+    const size_t copies = 1000000;
+
+    ResourceRegistry registry;
+    std::vector<std::unique_ptr<ResourceImporter> > importers;
+    importers.emplace_back(std::make_unique<BlobImporter>());
+    registry.setImporters(std::move(importers));
+
+    auto &archive = dynamic_cast<MemoryArchive &>(registry.getArchive("memory"));
+    std::vector<ResourceHandle<Blob> > handles;
+    for (size_t i = 0; i < bundleCount; i++) {
+        archive.addData("handle" + std::to_string(i) + ".blob", std::vector<uint8_t>(16));
+        handles.emplace_back(Uri("memory://handle" + std::to_string(i) + ".blob"), &registry);
+    }
+    registry.awaitAll();
+
+    auto run = [&](const std::function<void(size_t)> &work) {
+        return measureMilliseconds([&]() {
+            std::vector<std::thread> workers;
+            for (unsigned int t = 0; t < threads; t++) {
+                workers.emplace_back([&, t]() {
+                    for (size_t i = t; i < copies; i += threads) {
+                        work(i);
+                    }
+                });
+            }
+            for (auto &worker: workers) {
+                worker.join();
+            }
+        });
+    };
+
+    auto copy = run([&](size_t i) {
+        ResourceHandle<Blob> handle = handles.at(i % bundleCount);
+        ResourceHandle<Blob> other = handle;
+    });
+    auto locked = run([&](size_t i) {
+        auto &uri = handles.at(i % bundleCount).getUri();
+        registry.incRef(uri);
+        registry.incRef(uri);
+        registry.decRef(uri);
+        registry.decRef(uri);
+    });
+
+    auto print = [&](const std::string &name, double ms) {
+        std::cout << std::left << std::setw(40) << name
+                << std::right << std::setw(4) << threads
+                << std::setw(10) << std::fixed << std::setprecision(2) << ms * 1000000.0 / (copies * 2) << " ns/copy\n";
+    };
+    print("ResourceHandle copy", copy);
+    print("ResourceRegistry::incRef / decRef", locked);
+}
+
+template<typename F>
+static void benchmarkLoad(const std::string &name, size_t loads, const F &func) {
+    auto count = allocationCount.load();
+    auto bytes = allocationBytes.load();
+    auto copied = copyBytes.load();
+    auto time = measureMilliseconds([&]() {
+        for (size_t i = 0; i < loads; i++) {
+            func();
+        }
+    });
+    count = allocationCount.load() - count;
+    bytes = allocationBytes.load() - bytes;
+    copied = copyBytes.load() - copied;
+    std::cout << std::left << std::setw(48) << name
+            << std::right << std::setw(10) << std::fixed << std::setprecision(3) << time / loads << " ms"
+            << std::setw(10) << std::setprecision(1) << static_cast<double>(count) / loads
+            << std::setw(12) << bytes / loads / 1024 << " KB"
+            << std::setw(12) << copied / loads / 1024 << " KB\n";
+}
+
+static void benchmarkLoads() {
+    const size_t loads = 200;
+    const std::string name = "file.blob";
+
+    MemoryArchive archive;
+    archive.addData(name, std::vector<uint8_t>(BUNDLE_SIZE, 1));
+
+    std::cout << "Load " << BUNDLE_SIZE / 1024 << " KB file\n";
+    std::cout << std::left << std::setw(48) << "" << std::right << std::setw(13) << "Time"
+            << std::setw(10) << "Allocs" << std::setw(15) << "Allocated" << std::setw(15) << "Copied" << "\n";
+
+    // The previous MemoryArchive::open copied the file into a string stream and importers copied it out again
+    auto data = std::vector<uint8_t>(BUNDLE_SIZE, 1);
+    benchmarkLoad("stringstream copy + chunked read", loads, [&]() {
+        auto copy = data;
+        std::stringstream stream(std::string(copy.begin(), copy.end()));
+        std::vector<char> buffer;
+        std::array<char, 1024> chunk{};
+        while (!stream.eof()) {
+            stream.read(chunk.data(), chunk.size());
+            buffer.insert(buffer.end(), chunk.begin(), chunk.begin() + stream.gcount());
+        }
+    });
+
+    benchmarkLoad("Archive::open + readStreamView", loads, [&]() {
+        auto stream = archive.open(name);
+        std::vector<char> storage;
+        auto view = readStreamView(*stream, storage);
+        if (view.size() != BUNDLE_SIZE)
+            throw std::runtime_error("Invalid view size");
+    });
+
+    std::vector<char> buffer;
+    benchmarkLoad("Archive::read into reused buffer", loads, [&]() {
+        archive.read(name, buffer);
+    });
+
+    // Pak entries are decoded into the buffer of the caller
+    auto cryptoDriver = cryptopp::CryptoProvider();
+    auto sha = cryptoDriver.createSHA();
+    auto aes = cryptoDriver.createAES();
+    auto zip = cryptoDriver.createGzip();
+    std::vector<char> entry(BUNDLE_SIZE);
+    for (size_t i = 0; i < entry.size(); i++) {
+        entry[i] = static_cast<char>(i % 251);
+    }
+    for (auto compressed: {false, true}) {
+        PakBuilder builder;
+        builder.addEntry(name, entry);
+        auto chunks = builder.build(0, compressed, false, *sha, *zip, *aes, "", {}, 0);
+        std::stringstream stream(std::string(chunks.at(0).begin(), chunks.at(0).end()));
+        PakArchive pakArchive(Pak(stream, *zip, *sha));
+        benchmarkLoad(std::string("PakArchive::read into reused buffer") + (compressed ? " (gzip)" : ""),
+                      loads,
+                      [&]() {
+                          pakArchive.read(name, buffer);
+                          if (buffer.size() != BUNDLE_SIZE)
+                              throw std::runtime_error("Invalid pak entry size");
+                      });
+    }
+
+    ResourceRegistry registry;
+    std::vector<std::unique_ptr<ResourceImporter> > importers;
+    importers.emplace_back(std::make_unique<BlobImporter>());
+    registry.setImporters(std::move(importers));
+    dynamic_cast<MemoryArchive &>(registry.getArchive("memory")).addData(name, std::vector<uint8_t>(BUNDLE_SIZE, 1));
+    benchmarkLoad("ResourceRegistry load", loads, [&]() {
+        ResourceHandle<Blob> handle(Uri("memory://" + name), &registry);
+        handle.get();
+    });
+}
+
+int main(int argc, char *argv[]) {
+    benchmarkLoads();
+    std::cout << "\n";
+
+    benchmarkResolve();
+
+    std::cout << "Concurrent handle copies\n";
+    for (unsigned int threads: {1, 2, 4, 8}) {
+        benchmarkHandleCopies(threads);
+    }
+    std::cout << "\n";
+
+    std::cout << "Time to first needed bundle behind 64 queued bundles\n";
+    benchmarkTimeToNeeded("FIFO", SCENARIO_FIFO);
+    benchmarkTimeToNeeded("Prioritized", SCENARIO_PRIORITIZED);
+    benchmarkTimeToNeeded("Background cancelled", SCENARIO_CANCELLED);
+    std::cout << "\n";
+
+    std::cout << "Random walk over " << BUNDLE_COUNT << " bundles of " << BUNDLE_SIZE / 1024
+            << " KB with a working set of " << WORKING_SET << " bundles\n";
+    std::cout << std::right << std::setw(11) << "Budget"
+            << std::setw(15) << "Time"
+            << std::setw(8) << "Hits"
+            << std::setw(8) << "Misses"
+            << std::setw(8) << "Evict"
+            << std::setw(13) << "Peak"
+            << "   Load latency\n";
+    for (size_t budget: {0, 32, 64, 128, 512}) {
+        benchmarkBudget(budget * 1024 * 1024);
+    }
+    return 0;
+}
@@ -0,0 +1,259 @@
+/**
+ *   xEngine - C++ Game Engine Library
+ *   Copyright (C) 2026 Julia Zampiccoli
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU Lesser General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   Lesser General Public License for more details.
+ *
+ *   You should have received a copy of the Lesser General Public License
+ *   along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include "xng/xng.hpp"
+
+#include "asyncruntime.hpp"
+#include "check.hpp"
+
+#include <iostream>
+#include <iomanip>
+
+using namespace xng;
+
+struct UploadRecord {
+    ChunkStreamer::Handle handle = ChunkStreamer::INVALID_HANDLE;
+    int priority = 0;
+    int frame = 0;
+    std::vector<uint8_t> data;
+};
+
+struct LatencyStatistics {
+    size_t count = 0;
+    double sum = 0;
+    int max = 0;
+};
+
+struct StressResult {
+    double milliseconds = 0;
+    int frames = 0;
+    size_t copiedBytes = 0;
+    size_t overflowBytes = 0;
+    size_t maxPendingBytes = 0;
+    std::map<int, LatencyStatistics> latency;
+};
+
+/**
+ * Saturates the chunk streamer with uploads of random size and priority into fixed slots of a target buffer.
+ *
+ * Each frame requests more bytes than the frame budget allows, some uploads are flushed and some are replaced
+ * before completing. After the load stops the streamer must complete all uploads and the target buffer must
+ * contain the last upload of every slot.
+ */
+static StressResult stress(const size_t framesInFlight, const int loadFrames, const size_t bytesPerFrame) {
+    constexpr size_t chunkSize = KB(16);
+    constexpr size_t chunkCount = 64;
+    constexpr size_t slotSize = KB(64);
+    constexpr size_t slotCount = 256;
+    constexpr int priorities = 4;
+
+    AsyncRuntime runtime(std::chrono::microseconds(200));
+    auto &heap = runtime.getHeap();
+    ChunkStreamer streamer(heap, chunkSize, chunkCount);
+
+    const auto target = heap.allocateBuffer(rg::Buffer(slotSize * slotCount,
+                                                       rg::Buffer::CAPABILITY_STORAGE
+                                                       | rg::Buffer::CAPABILITY_TRANSFER_DST,
+                                                       rg::Buffer::MEMORY_GPU_ONLY));
+
+    std::mt19937 rng(5);
+    std::uniform_int_distribution<size_t> uploadSize(256, slotSize);
+    std::uniform_int_distribution<size_t> slotIndex(0, slotCount - 1);
+    std::uniform_int_distribution<int> priority(0, priorities - 1);
+    std::uniform_int_distribution<int> chance(0, 99);
+    std::uniform_int_distribution<int> byte(0, 255);
+
+    std::vector<UploadRecord> slots(slotCount);
+    std::vector<std::vector<uint8_t> > expected(slotCount);
+    std::vector<bool> pending(slotCount, false);
+
+    StressResult ret;
+    FrameLoop loop(runtime, framesInFlight);
+
+    const auto start = std::chrono::steady_clock::now();
+    int frame = 0;
+    for (; frame < loadFrames + 10000; frame++) {
+        const auto load = frame < loadFrames;
+        const auto anyPending = std::find(pending.begin(), pending.end(), true) != pending.end();
+        if (!load && !anyPending) {
+            break;
+        }
+
+        size_t requested = 0;
+        while (load && requested < bytesPerFrame) {
+            const auto slot = slotIndex(rng);
+            auto &record = slots.at(slot);
+            if (record.handle != ChunkStreamer::INVALID_HANDLE) {
+                streamer.release(record.handle);
+            }
+            record.data.resize(uploadSize(rng));
+            for (auto &b: record.data) {
+                b = static_cast<uint8_t>(byte(rng));
+            }
+            record.priority = priority(rng);
+            record.frame = frame;
+            record.handle = streamer.upload(record.data.data(), record.data.size(), target, slot * slotSize,
+                                            record.priority);
+            if (chance(rng) < 2) {
+                streamer.flush(record.handle);
+            }
+            expected.at(slot) = record.data;
+            pending.at(slot) = true;
+            requested += record.data.size();
+        }
+
+        RenderQueue queue;
+        streamer.commit(queue);
+        loop.submit(queue);
+
+        ret.copiedBytes += streamer.getStatistics().copiedBytes;
+        ret.overflowBytes += streamer.getStatistics().overflowBytes;
+        ret.maxPendingBytes = std::max(ret.maxPendingBytes, streamer.getPendingBytes());
+
+        for (size_t slot = 0; slot < slotCount; slot++) {
+            auto &record = slots.at(slot);
+            if (pending.at(slot) && streamer.isUploadComplete(record.handle)) {
+                const auto latency = frame - record.frame;
+                auto &statistics = ret.latency[record.priority];
+                statistics.count++;
+                statistics.sum += latency;
+                statistics.max = std::max(statistics.max, latency);
+                pending.at(slot) = false;
+            }
+        }
+    }
+    loop.synchronize();
+    const auto end = std::chrono::steady_clock::now();
+
+    ret.frames = frame;
+    ret.milliseconds = std::chrono::duration<double, std::milli>(end - start).count();
+
+    check(std::find(pending.begin(), pending.end(), true) == pending.end(), "all uploads complete");
+
+    const auto contents = heap.read(target);
+    for (size_t slot = 0; slot < slotCount; slot++) {
+        const auto &data = expected.at(slot);
+        if (data.empty())
+            continue;
+        check(std::memcmp(contents.data() + slot * slotSize, data.data(), data.size()) == 0,
+              "slot " + std::to_string(slot) + " contains the last upload");
+    }
+    return ret;
+}
+
+/**
+ * Uploads into an idle streamer are staged by upload() and copied without waiting for a later commit.
+ */
+static void testDirectStaging() {
+    AsyncRuntime runtime;
+    auto &heap = runtime.getHeap();
+    ChunkStreamer streamer(heap, KB(4), 16);
+    const auto target = heap.allocateBuffer(rg::Buffer(KB(16),
+                                                       rg::Buffer::CAPABILITY_TRANSFER_DST,
+                                                       rg::Buffer::MEMORY_GPU_ONLY));
+
+    std::vector<uint8_t> data(KB(10), 7);
+    const auto handle = streamer.upload(data.data(), data.size(), target, 0);
+    check(streamer.getPendingBytes() == 0, "idle uploads are staged directly");
+
+    FrameLoop loop(runtime, 1);
+    RenderQueue queue;
+    streamer.commit(queue);
+    check(streamer.getStatistics().stagedBytes == data.size(), "directly staged bytes are reported");
+    loop.submit(queue);
+
+    RenderQueue next;
+    streamer.commit(next);
+    check(streamer.isUploadComplete(handle), "the upload is copied in the following frame");
+    loop.submit(next);
+
+    check(std::memcmp(heap.read(target).data(), data.data(), data.size()) == 0, "target contents");
+    streamer.release(handle);
+}
+
+/**
+ * Saturated with low priority data the oldest upload still completes, and high priority uploads overtake.
+ */
+static void testPriorities() {
+    AsyncRuntime runtime;
+    auto &heap = runtime.getHeap();
+    ChunkStreamer streamer(heap, KB(4), 16);
+    streamer.setFrameBudget(KB(8));
+    const auto target = heap.allocateBuffer(rg::Buffer(MB(4),
+                                                       rg::Buffer::CAPABILITY_TRANSFER_DST,
+                                                       rg::Buffer::MEMORY_GPU_ONLY));
+
+    FrameLoop loop(runtime, 2);
+    std::vector<uint8_t> data(KB(64), 1);
+
+    // Occupy the streamer so the following uploads are queued
+    const auto first = streamer.upload(data.data(), data.size(), target, 0, 0);
+    std::vector<ChunkStreamer::Handle> low;
+    for (size_t i = 1; i < 32; i++) {
+        low.emplace_back(streamer.upload(data.data(), data.size(), target, i * data.size(), 0));
+    }
+    const auto high = streamer.upload(data.data(), KB(8), target, MB(3), 10);
+
+    int highLatency = -1;
+    int firstLatency = -1;
+    for (int frame = 0; frame < 100 && (highLatency < 0 || firstLatency < 0); frame++) {
+        RenderQueue queue;
+        streamer.commit(queue);
+        loop.submit(queue);
+        if (highLatency < 0 && streamer.isUploadComplete(high))
+            highLatency = frame;
+        if (firstLatency < 0 && streamer.isUploadComplete(first))
+            firstLatency = frame;
+    }
+    check(highLatency >= 0 && highLatency <= 4, "high priority upload overtakes queued uploads");
+    check(firstLatency >= 0, "the oldest upload makes progress");
+    check(!streamer.isUploadComplete(low.back()), "low priority uploads are still queued");
+    loop.synchronize();
+}
+
+int main(int argc, char *argv[]) {
+    testDirectStaging();
+    testPriorities();
+
+    std::cout << "Staging ring 1 MiB, frame budget 256 KiB, 2 frames in flight\n";
+    std::cout << std::left << std::setw(12) << "Load/frame"
+            << std::right << std::setw(8) << "Frames"
+            << std::setw(14) << "Throughput"
+            << std::setw(14) << "Per frame"
+            << std::setw(12) << "Overflow"
+            << std::setw(14) << "Max pending"
+            << "   Latency in frames (avg / max) for priority 3 2 1 0\n";
+    for (const size_t load: {KB(128), KB(256), KB(512), MB(1)}) {
+        const auto result = stress(2, 200, load);
+        std::cout << std::left << std::setw(12) << (std::to_string(load / 1024) + " KiB")
+                << std::right << std::setw(8) << result.frames
+                << std::setw(9) << std::fixed << std::setprecision(1)
+                << static_cast<double>(result.copiedBytes) / MB(1) / (result.milliseconds / 1000) << " MB/s"
+                << std::setw(10) << result.copiedBytes / result.frames / 1024 << " KiB"
+                << std::setw(8) << result.overflowBytes / 1024 << " KiB"
+                << std::setw(10) << result.maxPendingBytes / 1024 << " KiB  ";
+        for (int priority = 3; priority >= 0; priority--) {
+            const auto &latency = result.latency.count(priority) ? result.latency.at(priority) : LatencyStatistics();
+            std::cout << std::setw(6) << std::setprecision(1) << latency.sum / std::max<size_t>(latency.count, 1)
+                    << " / " << std::setw(4) << latency.max;
+        }
+        std::cout << "\n";
+    }
+    return 0;
+}
@@ -0,0 +1,623 @@
+/**
+ *   xEngine - C++ Game Engine Library
+ *   Copyright (C) 2026 Julia Zampiccoli
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU Lesser General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   Lesser General Public License for more details.
+ *
+ *   You should have received a copy of the Lesser General Public License
+ *   along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef XENGINE_ASYNCRUNTIME_HPP
+#define XENGINE_ASYNCRUNTIME_HPP
+
+#include "xng/xng.hpp"
+
+#include <random>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <cstring>
+#include <optional>
+
+using namespace xng;
+
+/**
+ * A heap with cpu memory backed buffers.
+ *
+ * map() rejects buffers which are referenced by in flight executions because backends may wait for them.
+ * mapUnsynchronized() accepts them, instead the runtime snapshots the mapped ranges read by a submission
+ * and the execution fails if they were modified before the submission finished executing.
+ */
+class AsyncHeap final : public rg::Heap {
+public:
+    rg::HeapResource<rg::Buffer> allocateBuffer(const rg::Buffer &desc) override {
+        rg::ResourceId::Handle handle;
+        {
+            std::lock_guard guard(mutex);
+            handle = nextHandle++;
+            allocations[handle].data.resize(desc.size);
+            allocations[handle].desc = desc;
+        }
+        return {handle, desc, *this};
+    }
+
+    rg::HeapResource<rg::Texture> allocateTexture(const rg::Texture &desc) override {
+        throw std::runtime_error("Textures are not supported");
+    }
+
+    std::unique_ptr<rg::HeapMapping> map(const rg::HeapResource<rg::Buffer> &target) override {
+        std::lock_guard guard(mutex);
+        if (target.getDescription().memoryType == rg::Buffer::MEMORY_GPU_ONLY) {
+            throw std::runtime_error("Mapped a gpu only buffer");
+        }
+        const auto it = busy.find(target.getHandle());
+        if (it != busy.end() && it->second > 0) {
+            throw std::runtime_error("Mapped a buffer referenced by an in flight execution");
+        }
+        return std::make_unique<Mapping>(allocations.at(target.getHandle()).data);
+    }
+
+    std::unique_ptr<rg::HeapMapping> mapUnsynchronized(const rg::HeapResource<rg::Buffer> &target) override {
+        std::lock_guard guard(mutex);
+        if (target.getDescription().memoryType != rg::Buffer::MEMORY_CPU_TO_GPU) {
+            throw std::runtime_error("Mapped a buffer which is not cpu to gpu unsynchronized");
+        }
+        return std::make_unique<Mapping>(allocations.at(target.getHandle()).data);
+    }
+
+    size_t getMemoryUsage() override {
+        std::lock_guard guard(mutex);
+        size_t ret = 0;
+        for (auto &pair: allocations) {
+            ret += pair.second.data.size();
+        }
+        return ret;
+    }
+
+    void copy(const rg::Resource<rg::Buffer> &target,
+              const rg::Resource<rg::Buffer> &source,
+              const size_t targetOffset,
+              const size_t sourceOffset,
+              const size_t count) {
+        std::lock_guard guard(mutex);
+        auto &dst = allocations.at(target.getHandle()).data;
+        const auto &src = allocations.at(source.getHandle()).data;
+        if (targetOffset + count > dst.size() || sourceOffset + count > src.size()) {
+            throw std::runtime_error("Out of bounds buffer copy");
+        }
+        if (target.getHandle() == source.getHandle()
+            && targetOffset < sourceOffset + count
+            && sourceOffset < targetOffset + count) {
+            throw std::runtime_error("Overlapping buffer copy");
+        }
+        std::memcpy(dst.data() + targetOffset, src.data() + sourceOffset, count);
+    }
+
+    std::vector<uint8_t> read(const rg::Resource<rg::Buffer> &buffer) {
+        std::lock_guard guard(mutex);
+        return allocations.at(buffer.getHandle()).data;
+    }
+
+    struct Snapshot {
+        rg::ResourceId::Handle handle;
+        size_t offset;
+        std::vector<uint8_t> data;
+    };
+
+    /**
+     * @return A copy of the range if the buffer is cpu mapped memory
+     */
+    std::optional<Snapshot> snapshot(const rg::ResourceId &buffer, const rg::BufferAccess &access) {
+        std::lock_guard guard(mutex);
+        const auto &allocation = allocations.at(buffer.getHandle());
+        if (allocation.desc.memoryType == rg::Buffer::MEMORY_GPU_ONLY) {
+            return std::nullopt;
+        }
+        const auto size = access.size == 0 ? allocation.data.size() - access.offset : access.size;
+        const auto begin = allocation.data.begin() + static_cast<long>(access.offset);
+        return Snapshot{buffer.getHandle(), access.offset, std::vector(begin, begin + static_cast<long>(size))};
+    }
+
+    void setBusy(const std::vector<rg::ResourceId::Handle> &handles, const int delta) {
+        std::lock_guard guard(mutex);
+        for (auto handle: handles) {
+            busy[handle] += delta;
+        }
+    }
+
+    bool matches(const Snapshot &snapshot) {
+        std::lock_guard guard(mutex);
+        const auto it = allocations.find(snapshot.handle);
+        return it == allocations.end()
+               || std::memcmp(it->second.data.data() + snapshot.offset,
+                              snapshot.data.data(),
+                              snapshot.data.size()) == 0;
+    }
+
+private:
+    struct Allocation {
+        std::vector<uint8_t> data;
+        rg::Buffer desc;
+        int references = 0;
+    };
+
+    class Mapping final : public rg::HeapMapping {
+    public:
+        explicit Mapping(std::vector<uint8_t> &data)
+            : memory(data) {
+        }
+
+        uint8_t *data() override {
+            return memory.data();
+        }
+
+        size_t size() override {
+            return memory.size();
+        }
+
+        void flush() override {
+        }
+
+        void invalidate() override {
+        }
+
+    private:
+        std::vector<uint8_t> &memory;
+    };
+
+    void incrementReference(const rg::ResourceId &handle) override {
+        std::lock_guard guard(mutex);
+        allocations.at(handle.getHandle()).references++;
+    }
+
+    void decrementReference(const rg::ResourceId &handle) override {
+        std::lock_guard guard(mutex);
+        auto &allocation = allocations.at(handle.getHandle());
+        if (--allocation.references == 0) {
+            allocations.erase(handle.getHandle());
+        }
+    }
+
+    std::mutex mutex;
+    rg::ResourceId::Handle nextHandle = 0;
+    std::unordered_map<rg::ResourceId::Handle, Allocation> allocations;
+    std::unordered_map<rg::ResourceId::Handle, int> busy; // The number of in flight executions referencing a buffer
+};
+
+class AsyncTransferContext final : public rg::TransferContext {
+public:
+    explicit AsyncTransferContext(AsyncHeap &heap)
+        : heap(heap) {
+    }
+
+    void copyBuffer(const rg::Resource<rg::Buffer> &target,
+                    const rg::Resource<rg::Buffer> &source,
+                    const size_t targetOffset,
+                    const size_t sourceOffset,
+                    const size_t count) override {
+        heap.copy(target, source, targetOffset, sourceOffset, count);
+    }
+
+    void copyTexture(const rg::Resource<rg::Texture> &,
+                     const rg::Resource<rg::Texture> &,
+                     const std::vector<TextureCopyRegion> &) override { unsupported(); }
+
+    void copyBufferToTexture(const rg::Resource<rg::Texture> &,
+                             const rg::Resource<rg::Buffer> &,
+                             rg::Texture::SubResource,
+                             size_t,
+                             const Rectu &,
+                             rg::ColorFormat) override { unsupported(); }
+
+    void copyTextureToBuffer(const rg::Resource<rg::Buffer> &,
+                             const rg::Resource<rg::Texture> &,
+                             rg::Texture::SubResource,
+                             size_t,
+                             const Rectu &,
+                             rg::ColorFormat) override { unsupported(); }
+
+    void clearTexture(const rg::Resource<rg::Texture> &,
+                      const rg::Texture::SubResource &,
+                      const rg::Texture::ClearValue &) override { unsupported(); }
+
+    void blitTexture(const rg::Resource<rg::Texture> &,
+                     const rg::Resource<rg::Texture> &,
+                     const rg::Texture::SubResource &,
+                     const rg::Texture::SubResource &,
+                     const Rectu &,
+                     const Rectu &,
+                     const rg::TextureFiltering &) override { unsupported(); }
+
+    void generateMipMaps(const rg::Resource<rg::Texture> &) override { unsupported(); }
+
+private:
+    [[noreturn]] static void unsupported() {
+        throw std::runtime_error("Unsupported transfer command");
+    }
+
+    AsyncHeap &heap;
+};
+
+/**
+ * The streaming passes only record transfer commands, raster and compute commands are rejected.
+ */
+class UnsupportedContext final : public rg::RasterContext, public rg::ComputeContext {
+public:
+    void beginRenderPass(const std::vector<rg::Attachment> &, const rg::Attachment &) override { unsupported(); }
+
+    void beginRenderPass(const std::vector<rg::Attachment> &,
+                         const std::optional<rg::Attachment> &,
+                         const std::optional<rg::Attachment> &) override { unsupported(); }
+
+    void endRenderPass() override { unsupported(); }
+
+    void bindPipeline(const rg::PipelineCache::Handle &) override { unsupported(); }
+
+    void bindVertexBuffer(const rg::Resource<rg::Buffer> &, unsigned int, size_t, size_t) override { unsupported(); }
+
+    void bindIndexBuffer(const rg::Resource<rg::Buffer> &, rg::IndexFormat) override { unsupported(); }
+
+    void bindUniformBuffer(const std::string &,
+                           const rg::Resource<rg::Buffer> &,
+                           size_t,
+                           size_t) override { unsupported(); }
+
+    void bindStorageBuffer(const std::string &,
+                           const rg::Resource<rg::Buffer> &,
+                           size_t,
+                           size_t) override { unsupported(); }
+
+    void bindTexture(const std::string &, const std::vector<rg::TextureBinding> &) override { unsupported(); }
+
+    void setShaderParameter(const std::string &, const rg::ShaderPrimitive &) override { unsupported(); }
+
+    void setViewport(Vec2i, Vec2u) override { unsupported(); }
+
+    void setStencilReference(int) override { unsupported(); }
+
+    void drawArray(const rg::DrawCall &) override { unsupported(); }
+
+    void drawIndexed(const rg::DrawCall &, int) override { unsupported(); }
+
+    void drawArrayInstanced(const rg::DrawCall &, unsigned int) override { unsupported(); }
+
+    void drawIndexedInstanced(const rg::DrawCall &, int, unsigned int) override { unsupported(); }
+
+    void drawArrayMulti(const std::vector<rg::DrawCall> &) override { unsupported(); }
+
+    void drawIndexedMulti(const std::vector<std::pair<rg::DrawCall, int> > &) override { unsupported(); }
+
+    void drawArrayIndirect(const rg::Resource<rg::Buffer> &, size_t) override { unsupported(); }
+
+    void drawIndexedIndirect(const rg::Resource<rg::Buffer> &, size_t) override { unsupported(); }
+
+    void drawArrayMultiIndirect(const rg::Resource<rg::Buffer> &, size_t, size_t, size_t) override { unsupported(); }
+
+    void drawIndexedMultiIndirect(const rg::Resource<rg::Buffer> &, size_t, size_t, size_t) override { unsupported(); }
+
+    void drawArrayMultiIndirectCount(const rg::Resource<rg::Buffer> &,
+                                     const rg::Resource<rg::Buffer> &,
+                                     size_t,
+                                     size_t,
+                                     size_t,
+                                     size_t) override { unsupported(); }
+
+    void drawIndexedMultiIndirectCount(const rg::Resource<rg::Buffer> &,
+                                       const rg::Resource<rg::Buffer> &,
+                                       size_t,
+                                       size_t,
+                                       size_t,
+                                       size_t) override { unsupported(); }
+
+    void dispatch(Vec3u) override { unsupported(); }
+
+    void dispatchIndirect(const rg::Resource<rg::Buffer> &, size_t) override { unsupported(); }
+
+private:
+    [[noreturn]] static void unsupported() {
+        throw std::runtime_error("Unsupported command");
+    }
+};
+
+/**
+ * A runtime which executes the submitted graphs in submission order on a worker thread,
+ * fences are signaled asynchronously once the worker has executed the corresponding graphs.
+ *
+ * Executions containing graphics or compute passes take at least executionTime to simulate gpu load.
+ */
+class AsyncRuntime final : public rg::Runtime {
+public:
+    explicit AsyncRuntime(const std::chrono::microseconds maxJitter = std::chrono::microseconds(0))
+        : maxJitter(maxJitter),
+          worker([this]() { run(); }) {
+    }
+
+    ~AsyncRuntime() override {
+        {
+            std::lock_guard guard(mutex);
+            shutdown = true;
+        }
+        condition.notify_all();
+        worker.join();
+    }
+
+    std::shared_ptr<rg::Surface> createSurface(std::shared_ptr<Window>, size_t) override {
+        throw std::runtime_error("Surfaces are not supported");
+    }
+
+    rg::Heap &getResourceHeap() override {
+        return heap;
+    }
+
+    rg::PipelineCache &getPipelineCache() override {
+        throw std::runtime_error("Pipelines are not supported");
+    }
+
+    const DeviceInformation &getDeviceInformation() override {
+        return deviceInformation;
+    }
+
+    rg::TextureFormatLimits getTextureFormatLimits(rg::TextureType,
+                                                   rg::ColorFormat,
+                                                   rg::Texture::Capability) override {
+        throw std::runtime_error("Textures are not supported");
+    }
+
+    void setEnableTimers(bool) override {
+    }
+
+    std::unique_ptr<rg::Fence> execute(const rg::Graph &graph) override {
+        return execute(std::vector{graph});
+    }
+
+    std::unique_ptr<rg::Fence> execute(const std::vector<rg::Graph> &graphs) override {
+        auto job = std::make_shared<Job>();
+        job->graphs = graphs;
+        job->timeline.submitTimeHost = std::chrono::high_resolution_clock::now();
+        for (auto &graph: graphs) {
+            for (auto &pass: graph.passes) {
+                job->simulateLoad |= !std::holds_alternative<rg::TransferPass>(pass);
+                std::visit([this, &job](auto &&p) {
+                    for (auto &usage: p.bufferUsages) {
+                        if (usage.first.getNameSpace() != rg::ResourceId::HEAP)
+                            continue;
+                        job->handles.emplace_back(usage.first.getHandle());
+                        for (auto &entry: usage.second.entries) {
+                            const rg::BufferAccess &access = getAccess(entry);
+                            if (access.type != rg::BufferAccess::TransferSrc)
+                                continue;
+                            auto snapshot = heap.snapshot(usage.first, access);
+                            if (snapshot.has_value()) {
+                                job->snapshots.emplace_back(std::move(snapshot.value()));
+                            }
+                        }
+                    }
+                }, pass);
+            }
+        }
+        heap.setBusy(job->handles, 1);
+        {
+            std::lock_guard guard(mutex);
+            jobs.emplace_back(job);
+        }
+        condition.notify_all();
+        return std::make_unique<Fence>(*this, job);
+    }
+
+    AsyncHeap &getHeap() {
+        return heap;
+    }
+
+    void setExecutionTime(const std::chrono::microseconds time) {
+        std::lock_guard guard(mutex);
+        executionTime = time;
+    }
+
+    /**
+     * @return The number of executions which were submitted but have not finished yet.
+     */
+    size_t getPendingExecutions() {
+        std::lock_guard guard(mutex);
+        return jobs.size() + (executing ? 1 : 0);
+    }
+
+private:
+    struct Job {
+        std::vector<rg::Graph> graphs;
+        std::vector<rg::ResourceId::Handle> handles; // The heap buffers referenced by the job
+        std::vector<AsyncHeap::Snapshot> snapshots; // The mapped memory read by the job at submission
+        rg::Timeline timeline;
+        bool simulateLoad = false;
+        bool signaled = false;
+        std::exception_ptr error = nullptr;
+    };
+
+    class Fence final : public rg::Fence {
+    public:
+        Fence(AsyncRuntime &runtime, std::shared_ptr<Job> job)
+            : runtime(runtime), job(std::move(job)) {
+        }
+
+        bool isSignaled() override {
+            std::lock_guard guard(runtime.mutex);
+            rethrow();
+            return job->signaled;
+        }
+
+        bool wait(const size_t timeOut) override {
+            std::unique_lock lock(runtime.mutex);
+            const auto ret = runtime.condition.wait_for(lock,
+                                                        std::chrono::nanoseconds(timeOut),
+                                                        [this]() { return job->signaled; });
+            rethrow();
+            return ret;
+        }
+
+        const rg::Timeline &getTimeline() override {
+            wait(std::numeric_limits<size_t>::max());
+            return job->timeline;
+        }
+
+    private:
+        void rethrow() const {
+            if (job->error != nullptr) {
+                std::rethrow_exception(job->error);
+            }
+        }
+
+        AsyncRuntime &runtime;
+        std::shared_ptr<Job> job;
+    };
+
+    void run() {
+        std::mt19937 rng(4);
+        std::uniform_int_distribution<long> jitter(0, maxJitter.count());
+        while (true) {
+            std::shared_ptr<Job> job;
+            std::chrono::microseconds duration{};
+            {
+                std::unique_lock lock(mutex);
+                condition.wait(lock, [this]() { return shutdown || !jobs.empty(); });
+                if (jobs.empty()) {
+                    return;
+                }
+                job = std::move(jobs.front());
+                jobs.pop_front();
+                executing = true;
+                duration = std::chrono::microseconds(jitter(rng));
+                if (job->simulateLoad) {
+                    duration += executionTime;
+                }
+            }
+
+            const auto start = std::chrono::steady_clock::now();
+            std::exception_ptr error = nullptr;
+            try {
+                execute(*job);
+            } catch (...) {
+                error = std::current_exception();
+            }
+            while (std::chrono::steady_clock::now() - start < duration) {
+                std::this_thread::yield();
+            }
+            // The memory is in use until the fence is signaled
+            if (error == nullptr) {
+                try {
+                    checkSnapshots(*job);
+                } catch (...) {
+                    error = std::current_exception();
+                }
+            }
+            const auto end = std::chrono::steady_clock::now();
+            job->timeline.slices.emplace_back("Execute",
+                                              start.time_since_epoch(),
+                                              end.time_since_epoch());
+            job->graphs.clear();
+
+            heap.setBusy(job->handles, -1);
+            {
+                std::lock_guard guard(mutex);
+                job->error = error;
+                job->signaled = true;
+                executing = false;
+            }
+            condition.notify_all();
+        }
+    }
+
+    static const rg::BufferAccess &getAccess(const rg::BufferAccess &access) {
+        return access;
+    }
+
+    static const rg::BufferAccess &getAccess(const rg::GraphicsResourceAccess<rg::BufferAccess>::Entry &entry) {
+        return entry.access;
+    }
+
+    void checkSnapshots(const Job &job) {
+        for (auto &snapshot: job.snapshots) {
+            if (!heap.matches(snapshot)) {
+                throw std::runtime_error("Mapped memory was written while in flight");
+            }
+        }
+    }
+
+    void execute(Job &job) {
+        checkSnapshots(job);
+        AsyncTransferContext transfer(heap);
+        UnsupportedContext unsupported;
+        for (auto &graph: job.graphs) {
+            for (auto &pass: graph.passes) {
+                if (std::holds_alternative<rg::TransferPass>(pass)) {
+                    std::get<rg::TransferPass>(pass).callback(transfer);
+                } else if (std::holds_alternative<rg::ComputePass>(pass)) {
+                    std::get<rg::ComputePass>(pass).callback(unsupported);
+                } else {
+                    std::get<rg::GraphicsPass>(pass).callback(unsupported, transfer, unsupported);
+                }
+            }
+        }
+    }
+
+    AsyncHeap heap;
+    DeviceInformation deviceInformation{"Async", "xEngine", "1", {}};
+
+    std::chrono::microseconds executionTime{};
+    std::chrono::microseconds maxJitter{};
+
+    std::mutex mutex;
+    std::condition_variable condition;
+    std::deque<std::shared_ptr<Job> > jobs;
+    bool executing = false;
+    bool shutdown = false;
+
+    std::thread worker;
+};
+
+/**
+ * Submits frames like Renderer::draw and keeps at most framesInFlight frames executing.
+ */
+class FrameLoop {
+public:
+    FrameLoop(rg::Runtime &runtime, const size_t framesInFlight)
+        : runtime(runtime), framesInFlight(framesInFlight) {
+    }
+
+    void submit(RenderQueue &queue) {
+        inFlightFrames.emplace_back(queue.submit(runtime));
+        while (inFlightFrames.size() >= framesInFlight) {
+            waitFrame();
+        }
+    }
+
+    void synchronize() {
+        while (!inFlightFrames.empty()) {
+            waitFrame();
+        }
+    }
+
+private:
+    void waitFrame() {
+        const auto fence = std::move(inFlightFrames.front());
+        inFlightFrames.pop_front();
+        if (!fence->wait(10'000'000'000ULL)) {
+            throw std::runtime_error("Frame timed out");
+        }
+    }
+
+    rg::Runtime &runtime;
+    size_t framesInFlight;
+    std::deque<std::shared_ptr<rg::Fence> > inFlightFrames;
+};
+
+#endif //XENGINE_ASYNCRUNTIME_HPP
@@ -0,0 +1,33 @@
+/**
+ *   xEngine - C++ Game Engine Library
+ *   Copyright (C) 2026 Julia Zampiccoli
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU Lesser General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   Lesser General Public License for more details.
+ *
+ *   You should have received a copy of the Lesser General Public License
+ *   along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef XENGINE_CHECK_HPP
+#define XENGINE_CHECK_HPP
+
+#include <stdexcept>
+#include <string>
+
+/**
+ * Throw if the condition of a test does not hold.
+ */
+inline void check(bool condition, const std::string &message) {
+    if (!condition)
+        throw std::runtime_error("Check failed: " + message);
+}
+
+#endif //XENGINE_CHECK_HPP
@@ -18,10 +18,36 @@
 
 #include "xng/xng.hpp"
 
+#include "xng/adapters/cryptopp/cryptopp.hpp"
+
+#include "measure.hpp"
+
 #include <fstream>
+#include <chrono>
+#include <iomanip>
+
+static void printMount(const std::string &name, const double nanoseconds) {
+    std::cout << std::left << std::setw(36) << name
+              << std::right << std::setw(12) << std::fixed << std::setprecision(3) << nanoseconds / 1000000.0
+              << " ms\n";
+}
+
+static void printThroughput(const std::string &name, const size_t bytes, const double nanoseconds) {
+    std::cout << std::left << std::setw(36) << name
+              << std::right << std::setw(12) << std::fixed << std::setprecision(1)
+              << (static_cast<double>(bytes) / (1024.0 * 1024.0)) / (nanoseconds / 1000000000.0)
+              << " MB/s\n";
+}
+
+static void writeChunks(const std::vector<std::vector<char>> &chunks, const std::vector<std::filesystem::path> &paths) {
+    for (size_t i = 0; i < chunks.size(); i++) {
+        std::ofstream fs(paths.at(i), std::ios::binary);
+        fs.write(chunks.at(i).data(), static_cast<std::streamsize>(chunks.at(i).size()));
+    }
+}
 
 int main(int argc, char *argv[]) {
-    auto cryptoDriver = xng::cryptopp::CryptoPPDriver();
+    auto cryptoDriver = xng::cryptopp::CryptoProvider();
     auto sha = cryptoDriver.createSHA();
     auto aes = cryptoDriver.createAES();
     auto zip = cryptoDriver.createGzip();
@@ -85,6 +111,198 @@ int main(int argc, char *argv[]) {
         fs.close();
     }
 
+    // Streaming builds from files, the output must not depend on the number of threads
+    size_t inputBytes = 0;
+    xng::PakBuilder fileBuilder;
+    xng::ThreadPool singlePool(1);
+    xng::PakBuilder singleBuilder(singlePool);
+    for (auto &path: paths) {
+        inputBytes += std::filesystem::file_size(path);
+        fileBuilder.addEntry(path, std::filesystem::path(path));
+        singleBuilder.addEntry(path, std::filesystem::path(path));
+    }
+
+    auto buildIv = xng::AES::getRandomIv(*ran);
+    std::vector<std::filesystem::path> parallelPaths;
+    std::vector<std::filesystem::path> singlePaths;
+
+    printThroughput("PakBuilder::build ("
+                    + std::to_string(xng::ThreadPool::getPool().getThreadCount())
+                    + " threads)", inputBytes, measure([&]() {
+        parallelPaths = fileBuilder.build("assets_parallel.pak", 0, true, true, *sha, *zip, *aes, "test", buildIv);
+    }));
+
+    printThroughput("PakBuilder::build (1 thread)", inputBytes, measure([&]() {
+        singlePaths = singleBuilder.build("assets_single.pak", 0, true, true, *sha, *zip, *aes, "test", buildIv);
+    }));
+
+    printThroughput("PakBuilder::build (raw, chunked)", inputBytes, measure([&]() {
+        fileBuilder.build("assets_parallel_chunked.pak", 64 * 1024, false, false, *sha, *zip, *aes, "", {});
+    }));
+
+    if (xng::readFile(parallelPaths.at(0)) != xng::readFile(singlePaths.at(0)))
+        throw std::runtime_error("Pak builder output depends on the thread count");
+
+    // Uncompressed and unencrypted paks, single file and chunked, for the mount and read measurements
+    auto rawData = builder.build(0, false, false, *sha, *zip, *aes, "", {});
+    std::vector<std::filesystem::path> rawPaths = {"assets_raw.pak"};
+    writeChunks(rawData, rawPaths);
+
+    auto chunkedData = builder.build(64 * 1024, false, false, *sha, *zip, *aes, "", {});
+    std::vector<std::filesystem::path> chunkedPaths;
+    for (size_t i = 0; i < chunkedData.size(); i++) {
+        chunkedPaths.emplace_back("assets_chunked.pak." + std::to_string(i));
+    }
+    writeChunks(chunkedData, chunkedPaths);
+
+    const int passes = 10;
+
+    xng::Pak streamPak;
+    std::ifstream rawStream;
+    printMount("Mount (stream)", measure([&]() {
+        rawStream = std::ifstream(rawPaths.at(0), std::ios_base::in | std::ios::binary);
+        streamPak = xng::Pak(rawStream, *zip, *sha);
+    }));
+
+    xng::Pak mappedPak;
+    printMount("Mount (mmap)", measure([&]() {
+        mappedPak = xng::Pak(rawPaths.at(0), *zip, *sha);
+    }));
+
+    xng::Pak chunkedPak(chunkedPaths, *zip, *sha);
+
+    size_t totalBytes = 0;
+    for (auto &path: paths) {
+        auto expected = xng::readFile(path);
+        if (streamPak.get(path, true) != expected
+            || mappedPak.get(path, true) != expected
+            || chunkedPak.get(path, true) != expected) {
+            throw std::runtime_error("Pak entry data mismatch: " + path);
+        }
+        auto view = mappedPak.getView(path, true);
+        if (!view || !std::equal(view.data, view.data + view.size, expected.begin(), expected.end())) {
+            throw std::runtime_error("Pak entry view mismatch: " + path);
+        }
+        totalBytes += expected.size();
+    }
+
+    size_t checksum = 0;
+
+    printThroughput("Pak::get (stream)", totalBytes * passes, measure([&]() {
+        for (int i = 0; i < passes; i++) {
+            for (auto &path: paths) {
+                checksum += streamPak.get(path).size();
+            }
+        }
+    }));
+
+    printThroughput("Pak::get (mmap)", totalBytes * passes, measure([&]() {
+        for (int i = 0; i < passes; i++) {
+            for (auto &path: paths) {
+                checksum += mappedPak.get(path).size();
+            }
+        }
+    }));
+
+    printThroughput("Pak::get (mmap, chunked)", totalBytes * passes, measure([&]() {
+        for (int i = 0; i < passes; i++) {
+            for (auto &path: paths) {
+                checksum += chunkedPak.get(path).size();
+            }
+        }
+    }));
+
+    printThroughput("Pak::getView (mmap)", totalBytes * passes, measure([&]() {
+        for (int i = 0; i < passes; i++) {
+            for (auto &path: paths) {
+                auto view = mappedPak.getView(path);
+                checksum += view.size + static_cast<unsigned char>(view.size > 0 ? view.data[view.size - 1] : 0);
+            }
+        }
+    }));
+
+    // Compressed paks with and without blocks, reading the first 4KB of the largest entry through a PakArchive
+    std::string largestPath;
+    size_t largestSize = 0;
+    for (auto &path: paths) {
+        auto size = std::filesystem::file_size(path);
+        if (size >= largestSize) {
+            largestSize = size;
+            largestPath = path;
+        }
+    }
+
+    auto wholeData = builder.build(0, true, false, *sha, *zip, *aes, "", {}, 0);
+    std::vector<std::filesystem::path> wholePaths = {"assets_whole.pak"};
+    writeChunks(wholeData, wholePaths);
+
+    auto blockData = builder.build(0, true, false, *sha, *zip, *aes, "", {});
+    std::vector<std::filesystem::path> blockPaths = {"assets_blocks.pak"};
+    writeChunks(blockData, blockPaths);
+
+    xng::PakArchive wholeArchive(xng::Pak(wholePaths, *zip, *sha));
+    xng::PakArchive blockArchive(xng::Pak(blockPaths, *zip, *sha), true, 0);
+
+    auto expected = xng::readFile(largestPath);
+    for (auto *archive: {&wholeArchive, &blockArchive}) {
+        auto entryStream = archive->open(largestPath);
+        std::vector<char> data((std::istreambuf_iterator<char>(*entryStream)), std::istreambuf_iterator<char>());
+        if (data != expected)
+            throw std::runtime_error("Pak archive stream mismatch: " + largestPath);
+
+        if (!expected.empty()) {
+            auto offset = expected.size() / 2;
+            entryStream->clear();
+            entryStream->seekg(static_cast<std::streamoff>(offset));
+            char c;
+            entryStream->read(&c, 1);
+            if (c != expected.at(offset))
+                throw std::runtime_error("Pak archive stream seek mismatch: " + largestPath);
+        }
+    }
+
+    const size_t partialSize = 4096;
+    for (auto &pair: std::vector<std::pair<std::string, xng::PakArchive *>>{{"whole", &wholeArchive},
+                                                                            {"blocks", &blockArchive}}) {
+        printMount("PakArchive::open + 4KB (" + pair.first + ")", measure([&]() {
+            for (int i = 0; i < passes; i++) {
+                auto entryStream = pair.second->open(largestPath);
+                std::vector<char> buffer(partialSize);
+                entryStream->read(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+                checksum += entryStream->gcount();
+            }
+        }) / passes);
+    }
+
+    // Uris without a scheme resolve to the archive which can open the file as written
+    xng::PakBuilder slashBuilder;
+    slashBuilder.addEntry("/absolute.txt", std::vector<char>{'p'});
+    auto slashData = slashBuilder.build(0, true, false, *sha, *zip, *aes, "", {});
+    std::vector<std::filesystem::path> slashPaths = {"assets_slash.pak"};
+    writeChunks(slashData, slashPaths);
+
+    auto memoryArchive = std::make_shared<xng::MemoryArchive>();
+    memoryArchive->addData("absolute.txt", {'m'});
+    memoryArchive->addData("relative.txt", {'r'});
+
+    xng::ResourceRegistry registry;
+    registry.addArchive("files", memoryArchive);
+    registry.addArchive("pak", std::make_shared<xng::PakArchive>(xng::Pak(slashPaths, *zip, *sha)));
+
+    const auto readUri = [&](const std::string &file) {
+        auto entryStream = registry.resolveUri(xng::Uri(file))->open(file);
+        return static_cast<char>(entryStream->get());
+    };
+    if (readUri("/absolute.txt") != 'p' || readUri("absolute.txt") != 'm')
+        throw std::runtime_error("Leading slash pak entry resolved to the wrong archive");
+    try {
+        registry.resolveUri(xng::Uri("/relative.txt"));
+        throw std::logic_error("Leading slash uri resolved to an archive without the file");
+    } catch (const std::runtime_error &) {
+    }
+
+    std::cout << "Checksum: " << checksum << "\n";
+
     std::cout << "Successfully created and extracted pak files.\n";
 
     return 0;